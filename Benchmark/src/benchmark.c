@@ -0,0 +1,352 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "baseTypes.h"
+#include "application.h"
+#include "framework.h"
+#include "profiler.h"
+#include "sound.h"
+#include "levelmgr.h"
+#include "objmgr.h"
+#include "jobs.h"
+#include "world.h"
+#include "worldBatch.h"
+#include "random.h"
+
+// Allocations are counted through the debug CRT's hook on Windows, and by wrapping malloc on glibc.
+// Anywhere else (or under a sanitizer, which owns malloc) the counts are reported as unavailable.
+#if defined(_MSC_VER) && defined(_DEBUG)
+#include <crtdbg.h>
+#define BENCH_COUNT_ALLOCATIONS
+#elif defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+#define BENCH_COUNT_ALLOCATIONS
+#define BENCH_WRAP_MALLOC
+#endif
+
+// Workers allocate too, so the counts are bumped atomically
+#ifdef _MSC_VER
+#define _atomicIncrement(value)	InterlockedIncrement64((volatile LONG64*)(value))
+#else
+#define _atomicIncrement(value)	__atomic_add_fetch((value), 1, __ATOMIC_RELAXED)
+#endif
+
+
+#define BENCH_RANDOM_SEED		1
+
+#define BENCH_NUM_MIXES			(sizeof(_mixes) / sizeof(_mixes[0]))
+#define BENCH_NUM_POPULATIONS	(sizeof(_populations) / sizeof(_populations[0]))
+#define BENCH_NUM_ZONES			(sizeof(_zones) / sizeof(_zones[0]))
+
+/// @brief The proportions of each enemy type in a wave, scaled up to each population
+typedef struct benchMix_t {
+	const char* name;
+	uint16_t	bounders;
+	uint16_t	hunters;
+	uint16_t	shadowLords;
+} BenchMix;
+
+// Taken from the game's wave definitions
+static const BenchMix _mixes[] = {
+	{ "wave 1",		1, 0, 0 },		// bounders only
+	{ "wave 4",		1, 1, 0 },		// bounders and hunters
+	{ "wave 19",	0, 2, 1 },		// hunters and shadow lords
+	{ "wave 30",	0, 0, 1 }		// shadow lords only
+};
+static const uint32_t _populations[] = { 10, 100, 1000, 10000 };
+
+// Subsystems timed separately. Allocations are counted against the innermost one open, so objMgrUpdate's
+// count covers the objects' own updates, but not the parallel updates, physics and collision nested inside it.
+// The sounds the level plays are mixed too, for a sink that throws them away.
+static const char* const _zones[] = { "levelMgrUpdate", "objMgrUpdate", "objParallelUpdate", "physicsMgrUpdate", "collisionMgrUpdate", "soundMix" };
+
+static LevelDef _levelDefs[BENCH_NUM_MIXES * BENCH_NUM_POPULATIONS];
+static volatile bool _isCounting = false;
+static uint64_t _allocations[BENCH_NUM_ZONES + 1];	// the last counts allocations outside every zone
+
+static void _benchBuildLevelDefs();
+static void _benchRun(const BenchMix* mix, const LevelDef* levelDef, uint32_t ticks, uint32_t milliseconds);
+static void _benchTick(Level* level, uint32_t milliseconds);
+static void _benchRunBatch(uint32_t numWorlds, uint32_t ticks, uint32_t milliseconds);
+static void _benchCountAllocation();
+#if defined(BENCH_COUNT_ALLOCATIONS) && !defined(BENCH_WRAP_MALLOC)
+static int _benchAllocHook(int allocType, void* userData, size_t size, int blockType, long requestNumber, const unsigned char* filename, int lineNumber);
+#endif
+
+/// @brief Benchmark entry point. Runs every wave mix at every population up to the max, without drawing, and reports the cost per tick.
+/// Then steps a batch of whole games at once, and reports the cost per game.
+/// Usage: Benchmark [ticks] [milliseconds per tick] [max enemies] [worker threads] [batched worlds]
+/// @param argc
+/// @param argv
+/// @return
+int main(int argc, char* argv[])
+{
+	const uint32_t ticks = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 120;
+	const uint32_t milliseconds = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) : 16;
+	const uint32_t maxEnemies = argc > 3 ? (uint32_t)strtoul(argv[3], NULL, 10) : 10000;
+	const uint32_t numWorkers = argc > 4 ? (uint32_t)strtoul(argv[4], NULL, 10) : JOBS_WORKERS_AUTO;
+	const uint32_t numWorlds = argc > 5 ? (uint32_t)strtoul(argv[5], NULL, 10) : 64;
+
+#if defined(BENCH_COUNT_ALLOCATIONS) && !defined(BENCH_WRAP_MALLOC)
+	_CrtSetAllocHook(_benchAllocHook);
+#endif
+
+#ifdef FW_HEADLESS
+	Application* app = appNew(NULL, "Joust Benchmark", NULL, NULL);
+#else
+	Application* app = appNew(GetModuleHandle(NULL), "Joust Benchmark", NULL, NULL);
+#endif
+	if (app == NULL)
+	{
+		return 1;
+	}
+	appSetNumWorkers(app, numWorkers);
+	appSetSoundSink(app, soundSinkNewNull());
+
+	GLWindow* window = fwInitWindow(app);
+	if (window != NULL)
+	{
+		// Room for the biggest population, plus the player, platforms, backgrounds and displays
+		const uint32_t MAX_OBJECTS = maxEnemies + 100;
+		_benchBuildLevelDefs();
+		// The same seed, and so the same AI decisions, every run, so runs are comparable
+		World* world = worldNew(_levelDefs, BENCH_NUM_MIXES * BENCH_NUM_POPULATIONS, MAX_OBJECTS, BENCH_RANDOM_SEED);
+		profilerSetEnabled(true);
+
+		printf("%u ticks of %u ms per run on %u worker threads, allocations %s\n\n", ticks, milliseconds, jobsGetNumWorkers(),
+#ifdef BENCH_COUNT_ALLOCATIONS
+			"counted");
+#else
+			"not counted in this build");
+#endif
+
+		for (uint32_t p = 0; p < BENCH_NUM_POPULATIONS && _populations[p] <= maxEnemies; ++p)
+		{
+			for (uint32_t m = 0; m < BENCH_NUM_MIXES; ++m)
+			{
+				_benchRun(&_mixes[m], &_levelDefs[p * BENCH_NUM_MIXES + m], ticks, milliseconds);
+			}
+		}
+
+		profilerSetEnabled(false);
+		worldDelete(world);
+
+		if (numWorlds > 0)
+		{
+			_benchRunBatch(numWorlds, ticks, milliseconds);
+		}
+		fwShutdownWindow(window);
+	}
+
+	appDelete(app);
+	return 0;
+}
+
+/// @brief Scales every mix up to every population
+static void _benchBuildLevelDefs()
+{
+	for (uint32_t p = 0; p < BENCH_NUM_POPULATIONS; ++p)
+	{
+		for (uint32_t m = 0; m < BENCH_NUM_MIXES; ++m)
+		{
+			const BenchMix* mix = &_mixes[m];
+			const uint32_t parts = (uint32_t)mix->bounders + mix->hunters + mix->shadowLords;
+			LevelDef* levelDef = &_levelDefs[p * BENCH_NUM_MIXES + m];
+
+			levelDef->type = LEVELTYPE_WAVE;
+			levelDef->numHunters = (uint16_t)(_populations[p] * mix->hunters / parts);
+			levelDef->numShadowLords = (uint16_t)(_populations[p] * mix->shadowLords / parts);
+			levelDef->numBounders = (uint16_t)(_populations[p] - levelDef->numHunters - levelDef->numShadowLords);
+		}
+	}
+}
+
+/// @brief Loads a wave, spawns all of it at once, and times a number of ticks of it
+/// @param mix
+/// @param levelDef
+/// @param ticks
+/// @param milliseconds
+static void _benchRun(const BenchMix* mix, const LevelDef* levelDef, uint32_t ticks, uint32_t milliseconds)
+{
+	const uint32_t WARMUP_TICKS = 10;
+	const uint32_t population = (uint32_t)levelDef->numBounders + levelDef->numHunters + levelDef->numShadowLords;
+
+	Level* level = levelMgrLoad(levelDef);
+	levelMgrSpawnAllEnemies(level);
+
+	// Keep one-off work (waking everything, building the static BVH) out of the measurement
+	for (uint32_t i = 0; i < WARMUP_TICKS; ++i)
+	{
+		_benchTick(level, milliseconds);
+	}
+
+	profilerReset();
+	ZeroMemory(_allocations, sizeof(_allocations));
+	const uint64_t overflows = jobsGetNumOverflows();
+	_isCounting = true;
+
+	const uint64_t start = profilerGetNanoseconds();
+	for (uint32_t i = 0; i < ticks; ++i)
+	{
+		_benchTick(level, milliseconds);
+	}
+	const uint64_t elapsed = profilerGetNanoseconds() - start;
+
+	_isCounting = false;
+
+	const double nanosecondsPerTick = ticks > 0 ? (double)elapsed / ticks : 0.0;
+	printf("%-8s %6u enemies %12.0f ns/tick %10.1f ns/entity\n", mix->name, population, nanosecondsPerTick, nanosecondsPerTick / population);
+	for (uint32_t z = 0; z <= BENCH_NUM_ZONES; ++z)
+	{
+		ProfileZoneStats stats = { 0 };
+		const char* name = z < BENCH_NUM_ZONES ? _zones[z] : "(outside zones)";
+		if (z < BENCH_NUM_ZONES) { profilerGetZoneStats(name, &stats); }
+
+#ifdef BENCH_COUNT_ALLOCATIONS
+		printf("    %-20s %12.0f ns/tick %10llu allocations\n", name, stats.meanMicroseconds * 1e3, (unsigned long long)_allocations[z]);
+#else
+		printf("    %-20s %12.0f ns/tick %10s allocations\n", name, stats.meanMicroseconds * 1e3, "n/a");
+#endif
+	}
+	if (jobsGetNumOverflows() > overflows)
+	{
+		printf("    task rings/deques were full %llu times\n", (unsigned long long)(jobsGetNumOverflows() - overflows));
+	}
+
+	fflush(stdout);
+
+	levelMgrUnload(level);
+}
+
+/// @brief One fixed step, the same as the game's minus level transitions and drawing
+/// @param level
+/// @param milliseconds
+static void _benchTick(Level* level, uint32_t milliseconds)
+{
+	profilerBeginZone("levelMgrUpdate");
+	levelMgrUpdate(level, milliseconds);
+	profilerEndZone();
+
+	profilerBeginZone("objMgrUpdate");
+	objMgrUpdate(milliseconds);
+	profilerEndZone();
+
+	soundUpdate(milliseconds);
+}
+
+/// @brief Steps a batch of games, each from the first wave, under actions that change at random every few ticks
+/// @param numWorlds
+/// @param ticks
+/// @param milliseconds
+static void _benchRunBatch(uint32_t numWorlds, uint32_t ticks, uint32_t milliseconds)
+{
+	const uint32_t TICKS_PER_ACTION = 8;
+
+	WorldBatch* batch = worldBatchNew(numWorlds, BENCH_RANDOM_SEED);
+	WorldActions* actions = (WorldActions*)calloc(numWorlds, sizeof(WorldActions));
+	WorldObservation* observations = (WorldObservation*)calloc(numWorlds, sizeof(WorldObservation));
+	RandStream random = randStreamNew(BENCH_RANDOM_SEED, 0);
+	assert(actions != NULL && observations != NULL);
+
+	uint32_t numResets = 0;
+	uint64_t score = 0;
+	const uint64_t start = profilerGetNanoseconds();
+	for (uint32_t i = 0; i < ticks; ++i)
+	{
+		if (i % TICKS_PER_ACTION == 0)
+		{
+			for (uint32_t w = 0; w < numWorlds; ++w)
+			{
+				actions[w] = (WorldActions)randGetInt(&random, 0, WORLD_ACTION_LEFT | WORLD_ACTION_RIGHT | WORLD_ACTION_FLAP);
+			}
+		}
+
+		worldBatchStep(batch, actions, milliseconds, observations);
+
+		for (uint32_t w = 0; w < numWorlds; ++w)
+		{
+			if (observations[w].isGameOver)
+			{
+				score += observations[w].score;
+				worldBatchReset(batch, w, &observations[w]);
+				++numResets;
+			}
+		}
+	}
+	const uint64_t elapsed = profilerGetNanoseconds() - start;
+
+	for (uint32_t w = 0; w < numWorlds; ++w)
+	{
+		score += observations[w].score;
+	}
+
+	const double nanosecondsPerTick = ticks > 0 ? (double)elapsed / ticks : 0.0;
+	printf("batch    %6u worlds  %12.0f ns/tick %10.1f ns/world  (%u games over, %llu points)\n", numWorlds, nanosecondsPerTick, nanosecondsPerTick / numWorlds,
+		numResets, (unsigned long long)score);
+	fflush(stdout);
+
+	free(observations);
+	free(actions);
+	worldBatchDelete(batch);
+}
+
+/// @brief Counts an allocation against the zone it happened in, from any thread. Must not allocate itself.
+static void _benchCountAllocation()
+{
+	if (!_isCounting)
+	{
+		return;
+	}
+
+	const char* zone = profilerGetCurrentZone();
+	uint32_t z = 0;
+	while (z < BENCH_NUM_ZONES && (zone == NULL || strcmp(zone, _zones[z]) != 0))
+	{
+		++z;
+	}
+	_atomicIncrement(&_allocations[z]);
+}
+
+#ifdef BENCH_WRAP_MALLOC
+// glibc exports its allocator under these names as well, so the ones here can forward to it
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* memory, size_t size);
+
+void* malloc(size_t size)
+{
+	_benchCountAllocation();
+	return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+	_benchCountAllocation();
+	return __libc_calloc(count, size);
+}
+
+void* realloc(void* memory, size_t size)
+{
+	_benchCountAllocation();
+	return __libc_realloc(memory, size);
+}
+#elif defined(BENCH_COUNT_ALLOCATIONS)
+/// @brief Debug CRT allocation hook
+/// @return TRUE, to let the allocation go ahead
+static int _benchAllocHook(int allocType, void* userData, size_t size, int blockType, long requestNumber, const unsigned char* filename, int lineNumber)
+{
+	(void)userData;
+	(void)size;
+	(void)requestNumber;
+	(void)filename;
+	(void)lineNumber;
+
+	// The CRT's own bookkeeping isn't the game's doing
+	if ((allocType == _HOOK_ALLOC || allocType == _HOOK_REALLOC) && blockType != _CRT_BLOCK)
+	{
+		_benchCountAllocation();
+	}
+	return TRUE;
+}
+#endif
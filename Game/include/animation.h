@@ -2,15 +2,16 @@
 
 
 #include "sprite.h"
+#include "spriteAtlas.h"
 
 
 typedef struct animation_t {
-	Sprite**	spriteFrames;
+	SpriteId	firstFrame;		// the frames are consecutive in the sprite atlas
 	uint8_t		numFrames;
 } Animation;
 
 
-Animation* animationNew(uint8_t numFrames, const SpriteSheet* const sheet, Bounds2D firstSpriteBounds, float pixelsBetweenFrames, float depth);
+Animation* animationNew(uint8_t numFrames, uint8_t sheetIndex, Bounds2D firstSpriteBounds, float pixelsBetweenFrames, float depth);
 void animationDelete(Animation* animation);
 
 void animationDraw(const Animation* const animation, uint8_t frameNumber, Coord2D screenPosition, Coord2D objDimensions, bool horzReflect);
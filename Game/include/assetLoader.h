@@ -0,0 +1,25 @@
+#pragma once
+
+#include "baseTypes.h"
+#include "wav.h"
+#include "spriteAtlas.h"
+
+
+// Loads the sprite atlas's image and the sounds in the background, so the game can start drawing straight away.
+// Reading files and decoding run as background tasks on the job system's workers, which no simulation step waiting on
+// its own tasks ever picks up; uploading the atlas to GL is left for whichever
+// thread renders, which picks up every sheet that has finished decoding each time it calls assetLoaderRunUploads.
+// Everything else polls: a sheet draws transparent, and a sound is silent, until it's loaded.
+//
+// Assets come from an asset pack when it's up to date, and are decoded from their source files otherwise, after which
+// the pack is written again for next time. Without any workers, everything is loaded before assetLoaderStart returns.
+
+void assetLoaderStart(const char* packPath, const SpriteAtlasSheetDef* const sheets, uint8_t numSheets, const char* const* soundPaths, uint8_t numSounds);
+void assetLoaderShutdown();
+
+bool assetLoaderUpdate();
+void assetLoaderRunUploads();
+
+bool assetLoaderIsSheetLoaded(uint8_t sheetIndex);
+const WavInfo* assetLoaderGetSound(uint8_t soundIndex);
+bool assetLoaderIsDone();
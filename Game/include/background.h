@@ -1,10 +1,10 @@
 #pragma once
 
-#include <Windows.h>
-#include <gl/GL.h>
+#include "platform.h"
 
 #include "object.h"
 #include "sprite.h"
+#include "spriteAtlas.h"
 
 
 // This class's name is a misnomer. It should be called something more like "Image", but there is not enough time to refactor.
@@ -12,9 +12,9 @@
 
 typedef struct background_t {
 	Object		obj;
-	Sprite*		sprite;
+	SpriteId	sprite;
 } Background;
 
 
-Background* backgroundNew(const SpriteSheet* const sheet, Bounds2D spriteBounds, Coord2D size);
+Background* backgroundNew(SpriteId sprite, Coord2D size);
 void backgroundDelete(Object* background);
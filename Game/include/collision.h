@@ -22,4 +22,30 @@ typedef struct collision_t {
 } Collision;
 
 
+// Boxes in structure-of-arrays form, so one box can be tested against 4 of them per instruction.
+// Every array must have room for the boxes tested rounded up to whole lanes, plus one more lane.
+#define COLLISION_BATCH_LANES 4
+
+typedef struct collisionBatch_t {
+	float*		centerX;
+	float*		centerY;
+	float*		halfWidth;
+	float*		halfHeight;
+
+	// Results, per box
+	float*		deltaX;			// box center - tested center
+	float*		deltaY;
+	float*		intersectX;		// negative on both axes when overlapping
+	float*		intersectY;
+	uint32_t*	hitMask;		// bit (i % 32) of word (i / 32) is set when box i overlaps
+} CollisionBatch;
+
+
 Collision detectCollision(const Bounds2D* const thisBounds, const Bounds2D* const otherBounds);
+
+CollisionBatch* collisionBatchNew(uint32_t maxBoxes);
+void collisionBatchDelete(CollisionBatch* batch);
+
+uint32_t detectCollisionBatch(Coord2D center, Coord2D halfSize, CollisionBatch* batch, uint32_t first, uint32_t count);
+bool collisionBatchIsHit(const CollisionBatch* const batch, uint32_t index);
+Collision collisionBatchGet(const CollisionBatch* const batch, uint32_t index);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "entity.h"
+#include "pool.h"
 
 
 typedef struct collisionBox_t {
@@ -8,5 +9,10 @@ typedef struct collisionBox_t {
 } CollisionBox;
 
 
+void collisionBoxInitPool(uint32_t maxCollisionBoxes);
+void collisionBoxDeinitPool();
+Pool* collisionBoxGetPool();
+void collisionBoxSetPool(Pool* pool);
+
 CollisionBox* collisionBoxNew(Coord2D topLeftPos, Coord2D size);
 void collisionBoxDelete(Object* collisionBox);
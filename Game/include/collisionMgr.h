@@ -4,11 +4,16 @@
 #include "entity.h"
 
 
+typedef struct collmgr_t CollisionMgrState;
+
 void collisionMgrInit(uint32_t maxObjects);
 void collisionMgrShutdown();
 
+CollisionMgrState* collisionMgrGetState();
+void collisionMgrSetState(CollisionMgrState* state);
+
 // Add/Remove should ONLY be called from the object manager's add/remove functions
 void collisionMgrAdd(Entity* obj);
 void collisionMgrRemove(Entity* obj);
 
-void handleAllCollisions(Entity* obj);
+void collisionMgrUpdate();
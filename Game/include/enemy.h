@@ -2,6 +2,8 @@
 
 #include "object.h"
 #include "player.h"
+#include "random.h"
+#include "pool.h"
 
 
 typedef enum enemyType_t {
@@ -20,10 +22,16 @@ typedef void (*EnemyActionCB)(const char*);
 void enemySetEnemyActionCB(EnemyActionCB cb);
 void enemyClearEnemyActionCB();
 
-void enemyInitAnimations(const SpriteSheet* const sheet);
+void enemyInitAnimations(uint8_t sheetIndex);
 void enemyDeinitAnimations();
 
-Enemy* enemyNew(Coord2D startPos, Coord2D size, EnemyType type);
+void enemyInitPool(uint32_t maxEnemies);
+void enemyDeinitPool();
+void enemyResetPool();
+Pool* enemyGetPool();
+void enemySetPool(Pool* pool);
+
+Enemy* enemyNew(Coord2D startPos, Coord2D size, EnemyType type, RandStream random);
 void enemyDelete(Object* enemy);
 
 void enemySetPlayerReference(const Player* player);
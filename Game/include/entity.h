@@ -1,8 +1,7 @@
 #pragma once
 
-#include <Windows.h>
 #include <stdlib.h>
-#include <gl/GL.h>
+#include "platform.h"
 #include <assert.h>
 
 #include "object.h"
@@ -15,6 +14,7 @@ typedef struct entity_t {
 
 	bool				awake;      // for collision -> things that need to have collision checked vs other things (is it moving?)
 	bool				isGrounded;
+	bool				isStatic;   // never moves once created, so the collision manager can keep it in a prebuilt hierarchy
 	Bounds2D			gameBounds;
 	Coord2D				velocity;
 	Coord2D				terminalVelocity;
@@ -24,6 +24,9 @@ typedef struct entity_t {
 	Coord2D flyingSize;
 	Coord2D flyingPosition;
 
+	uint32_t			_collIndex; // slot in the collision manager's packed list, maintained by the manager
+	uint32_t			_physIndex; // slot in the physics manager's packed list, maintained by the manager
+
 } Entity;
 
 
@@ -37,5 +40,4 @@ void entityInit(Entity* entity, ObjVtable* vtable, Coord2D pos, Coord2D size);
 void entityDeinit(Entity* entity);
 
 
-void entityDefaultUpdate(Object* obj, uint32_t milliseconds);
 void entityDefaultCollide(Object* thisObj, Object* otherObj, Collision collision);
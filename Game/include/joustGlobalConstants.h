@@ -1,6 +1,7 @@
 #pragma once
 
 #include "baseTypes.h"
+#include "levelmgr.h"
 
 
 // Note: This file is used mostly to record specific pixel locations of the sprites used in Joust.
@@ -200,3 +201,8 @@ typedef enum wordsIndex_t
 
 	WORDS_COUNT
 } WordsIndex;
+
+
+// Levels, laid out as worlds expect them: hiscores, title, then the waves in order
+extern const LevelDef LEVEL_DEFS[];
+extern const uint32_t NUMBER_LEVEL_DEFS;
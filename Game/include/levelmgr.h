@@ -1,5 +1,6 @@
 #pragma once
 #include "baseTypes.h"
+#include "player.h"
 
 
 #ifdef __cplusplus
@@ -25,24 +26,37 @@ typedef enum levelType_t {
 typedef struct leveldef_t {
     LevelType type;
     
-    uint8_t numBounders;
-    uint8_t numHunters;
-    uint8_t numShadowLords;
+    uint16_t numBounders;
+    uint16_t numHunters;
+    uint16_t numShadowLords;
 } LevelDef;
 
 typedef struct level_t Level;
+typedef struct levelmgr_t LevelMgrState;
 
 
-void levelMgrInit();
+void levelMgrInit(const LevelDef* levelDefs, uint32_t numLevelDefs, uint64_t seed);
 void levelMgrShutdown();
+bool levelMgrUpdateAssets();
+
+LevelMgrState* levelMgrGetState();
+void levelMgrSetState(LevelMgrState* state);
 
 Level* levelMgrLoad(const LevelDef* levelDef);
 void levelMgrUnload(Level* level);
 
 void levelMgrDraw(Level* level);
 LUO levelMgrUpdate(Level* level, uint32_t milliseconds);
+void levelMgrSpawnAllEnemies(Level* level);
 
 LevelType levelGetType(const Level* const level);
+uint16_t levelGetNumEnemies(const Level* const level);
+Object* levelGetEnemy(const Level* const level, uint16_t index);
+
+Player* levelMgrGetPlayer();
+uint32_t levelMgrGetScore();
+uint32_t levelMgrGetWaveNumber();
+uint16_t levelMgrGetNumAliveEnemies();
 
 
 #ifdef __cplusplus
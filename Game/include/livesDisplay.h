@@ -2,6 +2,7 @@
 
 #include "object.h"
 #include "sprite.h"
+#include "spriteAtlas.h"
 
 
 // NOTE: this class and "numberDisplay" are very similar. If there is time to refactor, have them inherit from a common "horizontalLayoutGroup" class or something
@@ -10,7 +11,7 @@
 typedef struct livesDisplay_t {
 	Object obj; // Note: the internal object's position should be TL position of highest digit to print. Size will be used to determine the other values in this object.
 
-	Sprite* sprite; // Note: there is only one sprite being repeatedly drawn here, not a group of several sprites
+	SpriteId sprite; // Note: there is only one sprite being repeatedly drawn here, not a group of several sprites
 	uint8_t numSprites;
 	uint8_t numSpritesToDisplay;
 
@@ -20,7 +21,7 @@ typedef struct livesDisplay_t {
 } LivesDisplay;
 
 
-void livesDisplayInit(const SpriteSheet* const sheet);
+void livesDisplayInit(uint8_t sheetIndex);
 void livesDisplayShutdown();
 
 LivesDisplay* livesDisplayNew(Coord2D pos, Coord2D size, uint8_t numSprites, uint8_t pixelsBetweenSprites);
@@ -2,6 +2,7 @@
 
 #include "object.h"
 #include "sprite.h"
+#include "spriteAtlas.h"
 
 
 typedef enum numberColor_t {
@@ -25,7 +26,7 @@ typedef struct numberDisplay_t {
 } NumberDisplay;
 
 
-void numberDisplayInit(const SpriteSheet* const sheet);
+void numberDisplayInit(uint8_t sheetIndex);
 void numberDisplayShutdown();
 
 NumberDisplay* numberDisplayNew(NumberColor color, Coord2D pos, Coord2D size, uint8_t numDigits, uint8_t pixelsBetweenNumbers);
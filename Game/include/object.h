@@ -0,0 +1,82 @@
+#pragma once
+#include "baseTypes.h"
+#include "collision.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// Generational reference to an object registered w/ the object manager: slot index in the low bits, generation in the high bits.
+// Resolve it through objMgrGet, which returns NULL once the object has been removed, instead of leaving a dangling pointer.
+typedef uint32_t ObjHandle;
+#define OBJ_HANDLE_INVALID 0
+
+
+// object "virtual" functions
+typedef struct object_t Object;
+typedef void (*ObjDeleteFunc)(Object*);
+typedef void (*ObjDrawFunc)(const Object*);	// may only read the object, as it runs however many times the frame rate calls for between updates
+typedef void (*ObjUpdateFunc)(Object*, uint32_t);
+typedef void (*ObjCollideFunc)(Object*, Object*, Collision);
+
+
+typedef struct object_vtable_t {
+    ObjDeleteFunc   delete;
+    ObjDrawFunc     draw;
+    ObjUpdateFunc   update;
+    ObjCollideFunc  collide;
+    ObjUpdateFunc   lateUpdate; // runs after the batched entity physics, for logic that reacts to the new position/velocity
+    ObjUpdateFunc   parallelUpdate; // in place of update, for objects that may update alongside each other on worker threads.
+                                    // Runs after every ordinary update, and may only write to its own object.
+} ObjVtable;
+
+typedef struct object_t {
+    ObjVtable*      vtable;
+
+    bool            markedForDelete; // for garbage collection, deleted by the object manager at the end of the update
+    bool            enabled;    // for general things that need to be on or not
+    bool            collidable; // I would like this to be similar to an interface or something more general than this
+
+    Coord2D         position;
+    Coord2D         prevPosition; // position before the latest update, for interpolated drawing
+    Coord2D         size;
+
+    ObjHandle       _handle;    // assigned by the object manager on registration
+    uint32_t        _mgrIndex;  // slot in the object manager's packed list, maintained by the manager
+} Object;
+
+
+typedef void (*ObjRegistrationFunc)(Object*);
+
+
+// class-wide registration methods
+void objEnableRegistration(ObjRegistrationFunc registerFunc, ObjRegistrationFunc deregisterFunc);
+void objDisableRegistration();
+
+// class-wide draw interpolation
+void objSetInterpolation(float interpolation);
+
+// object API
+void objInit(Object* obj, ObjVtable* vtable, Coord2D pos, bool isCollidable);
+void objDeinit(Object* obj);
+void objDraw(const Object* obj);
+void objUpdate(Object* obj, uint32_t milliseconds);
+void objParallelUpdate(Object* obj, uint32_t milliseconds);
+bool objHasParallelUpdate(const Object* obj);
+void objLateUpdate(Object* obj, uint32_t milliseconds);
+
+void objDefaultUpdate(Object* obj, uint32_t milliseconds);
+
+void objEnable(Object* obj);
+void objDisable(Object* obj);
+
+bool objIsEnabled(Object* obj);
+
+ObjHandle objGetHandle(const Object* obj);
+
+Coord2D objGetInterpolationOffset(const Object* obj);
+
+#ifdef __cplusplus
+}
+#endif
\ No newline at end of file
@@ -1,20 +1,30 @@
 #pragma once
 #include "baseTypes.h"
-#include "Object.h"
+#include "object.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+typedef struct objmgr_t ObjMgrState;
+
 void objMgrInit(uint32_t maxObjects);
 void objMgrShutdown();
 
+ObjMgrState* objMgrGetState();
+void objMgrSetState(ObjMgrState* state);
+
 void objMgrAdd(Object* obj);
 void objMgrRemove(Object* obj);
 
-void objMgrDraw();
+Object* objMgrGet(ObjHandle handle);
+void objMgrRelocate(ObjHandle handle, Object* newLocation);
+
+void objMgrDraw(float interpolation);
 void objMgrUpdate(uint32_t milliseconds);
 
+uint32_t objMgrGetChecksum();
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
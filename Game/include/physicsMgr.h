@@ -0,0 +1,19 @@
+#pragma once
+
+#include "baseTypes.h"
+#include "entity.h"
+
+
+typedef struct physmgr_t PhysicsMgrState;
+
+void physicsMgrInit(uint32_t maxObjects);
+void physicsMgrShutdown();
+
+PhysicsMgrState* physicsMgrGetState();
+void physicsMgrSetState(PhysicsMgrState* state);
+
+// Add/Remove should ONLY be called from the object manager's add/remove functions
+void physicsMgrAdd(Entity* entity);
+void physicsMgrRemove(Entity* entity);
+
+void physicsMgrUpdate(uint32_t milliseconds);
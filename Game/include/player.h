@@ -4,6 +4,7 @@
 
 #include "object.h"
 #include "entity.h"
+#include "pool.h"
 
 
 typedef struct player_t Player;
@@ -23,9 +24,14 @@ void playerClearPlayerKilledCB();
 void playerSetPlayerActionCB(PlayerActionCB cb);
 void playerClearPlayerActionCB();
 
-void playerInitAnimations(const SpriteSheet* const sheet);
+void playerInitAnimations(uint8_t sheetIndex);
 void playerDeinitAnimations();
 
+void playerInitPool(uint32_t maxPlayers);
+void playerDeinitPool();
+Pool* playerGetPool();
+void playerSetPool(Pool* pool);
+
 Player* playerNew(Coord2D startPos, Coord2D size);
 void playerDelete(Object* player);
 
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "baseTypes.h"
+
+
+// Fixed-size block allocator. Every element lives in one contiguous slab allocated up front, so allocating
+// and freeing never touches the heap. Resetting frees every element at once and hands them back out in slab order.
+typedef struct pool_t Pool;
+
+
+Pool* poolNew(uint32_t elementSize, uint32_t capacity);
+void poolDelete(Pool* pool);
+
+void* poolAlloc(Pool* pool);
+void poolFree(Pool* pool, void* element);
+void poolReset(Pool* pool);
+
+bool poolOwns(const Pool* const pool, const void* const element);
+uint32_t poolGetCount(const Pool* const pool);
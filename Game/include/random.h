@@ -5,8 +5,23 @@
 extern "C" {
 #endif
 
-float randGetFloat(float min, float max);
-int32_t randGetInt(int32_t min, int32_t max);
+// Counter-based random numbers (Philox4x32-10). Each draw is a pure function of the seed, the stream's id and how many
+// draws the stream has made, so streams never share state: they can be drawn from in any order, or on any thread,
+// and still produce the same numbers. Streams form a hierarchy - a child's id is its parent's with its index in the
+// low 32 bits - so a level's stream can hand every enemy in it a stream of its own.
+typedef struct randStream_t {
+    uint64_t    seed;
+    uint64_t    id;
+    uint64_t    counter;    // draws made so far
+} RandStream;
+
+RandStream randStreamNew(uint64_t seed, uint32_t id);
+RandStream randStreamDerive(const RandStream* parent, uint32_t index);
+
+uint32_t randAt(uint64_t seed, uint64_t id, uint64_t counter);
+uint32_t randNext(RandStream* stream);
+float randGetFloat(RandStream* stream, float min, float max);
+int32_t randGetInt(RandStream* stream, int32_t min, int32_t max);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,15 @@
+#pragma once
+
+// SSE is part of every x64 target (and x86 built w/ /arch:SSE or above), so SIMD kernels only need a scalar fallback for other targets
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define GAME_SSE
+#include <xmmintrin.h>
+
+/// <summary>
+/// Picks a where the mask is set, b elsewhere.
+/// </summary>
+static inline __m128 simdSelect(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+#endif
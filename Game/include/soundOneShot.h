@@ -2,13 +2,24 @@
 
 #include "stdbool.h"
 #include "stdint.h"
+#include "wav.h"
 
 
 typedef struct soundOneShot_t SoundOneShot;
+typedef struct soundOneShotState_t SoundOneShotState;
 
 
-SoundOneShot* soundOneShotNew(const char* fileName, uint32_t lengthMS);
+void soundOneShotInit();
+void soundOneShotShutdown();
+SoundOneShotState* soundOneShotGetState();
+void soundOneShotSetState(SoundOneShotState* state);
+void soundOneShotSetMuted(bool isMuted);
+
+
+SoundOneShot* soundOneShotNew(const WavInfo* wav);
 void soundOneShotDelete(SoundOneShot* oneShot);
+void soundOneShotLoad(SoundOneShot* oneShot, const WavInfo* wav);
+bool soundOneShotIsLoaded(const SoundOneShot* const oneShot);
 
 void soundOneShotUpdateInternalFields(uint32_t milliseconds);
 
@@ -1,7 +1,6 @@
 #pragma once
 
-#include <Windows.h>
-#include <gl/GL.h>
+#include "platform.h"
 
 #include "sprite.h"
 #include "baseTypes.h"
@@ -20,7 +19,6 @@ typedef struct sprite_t {
 } Sprite;
 
 
-Sprite* spriteNew(const SpriteSheet* const sheet, Bounds2D spriteUV, float depth);
-void spriteDelete(Sprite* sprite);
+void spriteInit(Sprite* sprite, const SpriteSheet* const sheet, Bounds2D spriteUV, float depth);
 
 void spriteDraw(const Sprite* const sprite, Coord2D screenPosition, Coord2D objDimensions, bool horzReflect);
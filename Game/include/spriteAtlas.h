@@ -0,0 +1,36 @@
+#pragma once
+
+#include "baseTypes.h"
+#include "sprite.h"
+
+
+// Every sprite sheet, packed into one texture, so every sprite draws w/ the same texture bound.
+// Initializing the atlas lays it out and creates its texture: its image is decoded (or taken from a cache of a previous
+// decode) and loaded separately, a sheet at a time if need be. Until a sheet is loaded, its sprites draw transparent.
+// Sprites are registered once, in pixels of the sheet they come from, and kept in one flat table: drawing one is an index into it.
+// Sprite pixel coordinates are measured from the bottom left of their sheet, as the sheets are flipped when loaded.
+
+typedef uint16_t SpriteId;
+
+typedef struct spriteAtlasSheetDef_t {
+	const char*	path;
+	uint16_t	WIDTH_PIXELS;
+	uint16_t	HEIGHT_PIXELS;
+} SpriteAtlasSheetDef;
+
+
+void spriteAtlasInit(const SpriteAtlasSheetDef* const sheets, uint8_t numSheets, uint16_t maxSprites);
+void spriteAtlasShutdown();
+
+unsigned char* spriteAtlasNewImage();
+void spriteAtlasDecodeSheet(uint8_t sheetIndex, unsigned char* pixels);
+void spriteAtlasLoadTexture(const void* pixels);
+void spriteAtlasLoadSheet(uint8_t sheetIndex, const void* pixels);
+
+SpriteId spriteAtlasAdd(uint8_t sheetIndex, Bounds2D spriteBounds, float depth);
+SpriteId spriteAtlasAddStrip(uint8_t sheetIndex, Bounds2D firstSpriteBounds, uint8_t numSprites, float pixelsPerSprite, float depth);
+
+const Sprite* spriteAtlasGet(SpriteId id);
+const SpriteSheet* spriteAtlasGetSheet();
+Coord2D spriteAtlasGetSheetOrigin(uint8_t sheetIndex);
+uint16_t spriteAtlasGetNumSprites();
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "baseTypes.h"
+#include "sprite.h"
+
+
+// Records every sprite drawn during a frame as a small draw command, then draws them all when the frame is rendered,
+// with one draw call per run of sprites sharing a sprite sheet, after sorting back to front, instead of one per sprite.
+// Frames are double buffered: one thread can record a frame while another renders the one recorded before it,
+// as long as a frame is never recorded into until the frame two before it has been rendered.
+void spriteBatchInit(uint32_t maxSprites);
+void spriteBatchShutdown();
+
+void spriteBatchAdd(const Sprite* const sprite, Coord2D screenPosition, Coord2D objDimensions, bool horzReflect);
+void spriteBatchEndFrame();
+void spriteBatchFlush();
+
+uint32_t spriteBatchGetDrawCalls();
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "baseTypes.h"
+
+
+// Bounding volume hierarchy over boxes that never move. Built once from a set of bounds, then
+// queried for every item overlapping a box in O(log n).
+typedef struct staticBvh_t StaticBvh;
+
+
+StaticBvh* staticBvhNew(uint32_t maxItems);
+void staticBvhDelete(StaticBvh* bvh);
+
+void staticBvhBuild(StaticBvh* bvh, const Bounds2D* const bounds, const uint32_t* const ids, uint32_t count);
+uint32_t staticBvhQuery(const StaticBvh* const bvh, const Bounds2D* const bounds, uint32_t* results, uint32_t maxResults);
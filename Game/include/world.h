@@ -0,0 +1,56 @@
+#pragma once
+#include "baseTypes.h"
+#include "levelmgr.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// Everything a game of Joust changes as it plays (objects, collision, physics, level progress, the player, the enemies) is
+// owned by a world, so any number of games can live in one process. Each manager reaches its world's state through a
+// pointer local to the thread, which worldMakeCurrent points at one world, so threads can simulate different worlds at the
+// same time. Jobs started while simulating a world carry it with them, onto whichever thread runs them.
+// Assets that never change while playing (sprite sheets, animations, sounds) are shared by every world.
+#ifdef _MSC_VER
+#define WORLD_LOCAL	__declspec(thread)
+#else
+#define WORLD_LOCAL	_Thread_local
+#endif
+
+// Level definitions passed to worldNew are laid out as the game's: the hiscores screen, the title screen, then each wave in order
+#define WORLD_LEVEL_INDEX_HISCORES		0
+#define WORLD_LEVEL_INDEX_TITLE_SCREEN	1
+#define WORLD_LEVEL_INDEX_FIRST_WAVE	2
+
+// The player's controls, as a bitmask
+typedef enum worldAction_e {
+    WORLD_ACTION_LEFT   = 1 << 0,
+    WORLD_ACTION_RIGHT  = 1 << 1,
+    WORLD_ACTION_FLAP   = 1 << 2,
+    WORLD_ACTION_START  = 1 << 3
+} WorldAction;
+
+typedef uint8_t WorldActions;
+
+typedef struct world_t World;
+
+
+World* worldNew(const LevelDef* levelDefs, uint32_t numLevelDefs, uint32_t maxObjects, uint64_t seed);
+void worldDelete(World* world);
+
+void worldMakeCurrent(World* world);
+World* worldGetCurrent();
+
+void worldLoadLevel(World* world, uint32_t levelIndex);
+Level* worldGetLevel(const World* world);
+void worldUpdate(World* world, uint32_t milliseconds);
+
+void worldSetActions(World* world, WorldActions actions);
+bool worldIsActionPressed(WorldAction action);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+#include "baseTypes.h"
+#include "world.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// A batch of independent games of Joust, stepped together across the job system, for training agents against.
+// Every world is controlled through actions rather than the keyboard, plays muted and is never drawn. Worlds share no
+// mutable state, so a step's observations don't depend on which thread stepped which world, or how many there are.
+
+#define WORLD_BATCH_OBSERVED_ENEMIES    8
+
+typedef struct worldObservedEnemy_t {
+    Coord2D position;
+    Coord2D velocity;
+    uint8_t type;               // EnemyType
+} WorldObservedEnemy;
+
+typedef struct worldObservation_t {
+    Coord2D playerPosition;
+    Coord2D playerVelocity;
+    bool isPlayerSpawned;       // false while waiting to respawn, or between waves
+    uint8_t lives;
+    uint32_t score;
+    uint32_t wave;              // counting from 1
+    uint16_t numAliveEnemies;   // in the wave, spawned or not
+    bool isGameOver;            // out of lives: only a reset gets the world playing again
+
+    uint8_t numEnemies;         // the nearest spawned enemies to the player, nearest first
+    WorldObservedEnemy enemies[WORLD_BATCH_OBSERVED_ENEMIES];
+} WorldObservation;
+
+typedef struct worldBatch_t WorldBatch;
+
+
+WorldBatch* worldBatchNew(uint32_t numWorlds, uint64_t seed);
+void worldBatchDelete(WorldBatch* batch);
+
+uint32_t worldBatchGetNumWorlds(const WorldBatch* batch);
+void worldBatchReset(WorldBatch* batch, uint32_t index, WorldObservation* observation);
+void worldBatchStep(WorldBatch* batch, const WorldActions* actions, uint32_t milliseconds, WorldObservation* observations);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -4,61 +4,39 @@
 
 
 /// <summary>
-/// Creates an animation based on a sequence of sprites in the passed in sprite sheet.
+/// Creates an animation based on a sequence of sprites in the passed in sprite sheet, and adds its frames to the sprite atlas.
 ///		<para>
 /// Assumes the sprites are ordered from left to right.
 ///		</para>
 /// </summary>
 /// <param name="numFrames"></param>
-/// <param name="sheet"></param>
+/// <param name="sheetIndex"> - Which of the sprite atlas's sheets the frames are on.</param>
 /// <param name="firstSpriteBounds"></param>
 /// <param name="pixelsBetweenFrames"></param>
 /// <param name="depth"></param>
 /// <returns></returns>
-Animation* animationNew(uint8_t numFrames, const SpriteSheet* const sheet, Bounds2D firstSpriteBounds, float pixelsBetweenFrames, float depth)
+Animation* animationNew(uint8_t numFrames, uint8_t sheetIndex, Bounds2D firstSpriteBounds, float pixelsBetweenFrames, float depth)
 {
 	assert(numFrames > 0);
-	assert(sheet != NULL);
 
 	Animation* animation = (Animation*)malloc(sizeof(Animation));
 	if (animation != NULL)
 	{
 		animation->numFrames = numFrames;
-		animation->spriteFrames = (Sprite**)malloc(numFrames * sizeof(Sprite*));
-		if (animation->spriteFrames != NULL)
-		{
-			// Determine the uv of the first frame
-			// Will need the width of the spriteFrame
-			// Will need the uv cost of x pixel(s) width
-			float uPixelsBetweenFrames = (float)pixelsBetweenFrames / (float)sheet->WIDTH_PIXELS;
-			Bounds2D spriteUV = {	.topLeft = {.x = firstSpriteBounds.topLeft.x / (float)sheet->WIDTH_PIXELS, .y = firstSpriteBounds.topLeft.y / (float)sheet->HEIGHT_PIXELS},
-										.botRight = {.x = firstSpriteBounds.botRight.x / (float)sheet->WIDTH_PIXELS, .y = firstSpriteBounds.botRight.y / (float)sheet->HEIGHT_PIXELS} };
-			float uCostPerFrame = spriteUV.botRight.x - spriteUV.topLeft.x;
 
-			animation->spriteFrames[0] = spriteNew(sheet, spriteUV, depth);
-			for (uint8_t i = 1; i < numFrames; ++i)
-			{
-				spriteUV.topLeft.x += uCostPerFrame + uPixelsBetweenFrames;
-				spriteUV.botRight.x += uCostPerFrame + uPixelsBetweenFrames;
-
-				animation->spriteFrames[i] = spriteNew(sheet, spriteUV, depth);
-			}
-		}
+		// Each frame starts a frame's width plus the gap after the one before it
+		const float pixelsPerFrame = (firstSpriteBounds.botRight.x - firstSpriteBounds.topLeft.x) + pixelsBetweenFrames;
+		animation->firstFrame = spriteAtlasAddStrip(sheetIndex, firstSpriteBounds, numFrames, pixelsPerFrame, depth);
 	}
 	return animation;
 }
 
 /// <summary>
-/// Deletes the passed in animation.
+/// Deletes the passed in animation. Its frames stay in the sprite atlas until it is shut down.
 /// </summary>
 /// <param name="animation"></param>
 void animationDelete(Animation* animation)
 {
-	for (uint8_t i = 0; i < animation->numFrames; ++i)
-	{
-		spriteDelete(animation->spriteFrames[i]);
-	}
-
 	free(animation);
 }
 
@@ -75,5 +53,5 @@ void animationDraw(const Animation* const animation, uint8_t frameNumber, Coord2
 {
 	assert(frameNumber < animation->numFrames);
 
-	spriteDraw(animation->spriteFrames[frameNumber], screenPosition, objDimensions, horzReflect);
+	spriteDraw(spriteAtlasGet(animation->firstFrame + frameNumber), screenPosition, objDimensions, horzReflect);
 }
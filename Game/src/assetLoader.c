@@ -0,0 +1,361 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "assetLoader.h"
+#include "assetPack.h"
+#include "jobs.h"
+
+
+static const char ASSET_LOADER_ATLAS[] = "atlas";	// the atlas's image's name in the pack; sounds go by their paths
+static const uint32_t ASSET_LOADER_VERSION = 1;		// bump whenever sheets or sounds are decoded differently, to rewrite old packs
+
+static struct assetLoader_t {
+	const char*			packPath;
+	uint64_t			sourceKey;			// which sources the pack is written from, and how the atlas lays them out
+	AssetPack*			pack;				// when it was up to date, and everything is loaded from it
+	uint8_t				numSheets;
+	const char* const*	soundPaths;
+	uint8_t				numSounds;
+
+	// From the pack
+	const AssetEntry*	atlasEntry;
+	JobCounter			atlasLoad;			// reading the atlas's image into memory
+
+	// From the source files, when the pack is out of date
+	unsigned char*		atlasPixels;
+	JobCounter*			sheetLoads;			// decoding each sheet into atlasPixels
+	void**				soundFiles;			// each sound's WAV file, which its WavInfo points into
+	JobCounter			packWrite;
+	bool				isPackWriteStarted;	// only touched by the thread that started the loader
+
+	WavInfo*			sounds;
+	JobCounter*			soundLoads;			// reading each sound into memory (from the pack, or its WAV file)
+
+	bool*				isSheetUploaded;	// only touched by the thread rendering
+} _assetLoader;
+
+
+// Function Prototypes
+static uint64_t _assetLoaderGetSourceKey(const SpriteAtlasSheetDef* const sheets, uint8_t numSheets, const char* const* soundPaths, uint8_t numSounds);
+static bool _assetLoaderIsDecoded();
+static void _assetLoaderReadAtlas(void* data);
+static void _assetLoaderDecodeSheet(void* data);
+static void _assetLoaderReadPackedSound(void* data);
+static void _assetLoaderReadSound(void* data);
+static void _assetLoaderWritePack(void* data);
+
+
+/// <summary>
+/// Starts loading the atlas's image (w/ its sheets laid out already) and the sounds. Deciding where to load them from only
+/// checks the files' times and maps the pack: the rest happens on the job system's workers, as background tasks.
+///		<para>
+/// Must be called from a thread in the job system's pool, which is the thread every other call but assetLoaderRunUploads
+/// and the polls must come from.
+///		</para>
+/// </summary>
+/// <param name="packPath"> - Where the pack is, or is to be written.</param>
+/// <param name="sheets"> - The sprite atlas's.</param>
+/// <param name="numSheets"></param>
+/// <param name="soundPaths"> - WAV files. Must outlive the loader.</param>
+/// <param name="numSounds"></param>
+void assetLoaderStart(const char* packPath, const SpriteAtlasSheetDef* const sheets, uint8_t numSheets, const char* const* soundPaths, uint8_t numSounds)
+{
+	assert(_assetLoader.sounds == NULL);
+
+	memset(&_assetLoader, 0, sizeof(_assetLoader));
+	_assetLoader.packPath = packPath;
+	_assetLoader.numSheets = numSheets;
+	_assetLoader.soundPaths = soundPaths;
+	_assetLoader.numSounds = numSounds;
+	_assetLoader.sheetLoads = (JobCounter*)calloc(numSheets, sizeof(JobCounter));
+	_assetLoader.isSheetUploaded = (bool*)calloc(numSheets, sizeof(bool));
+	_assetLoader.sounds = (WavInfo*)calloc(numSounds, sizeof(WavInfo));
+	_assetLoader.soundFiles = (void**)calloc(numSounds, sizeof(void*));
+	_assetLoader.soundLoads = (JobCounter*)calloc(numSounds, sizeof(JobCounter));
+	assert(_assetLoader.sheetLoads != NULL && _assetLoader.isSheetUploaded != NULL && _assetLoader.sounds != NULL && _assetLoader.soundFiles != NULL && _assetLoader.soundLoads != NULL);
+
+	const char** sources = (const char**)malloc(((size_t)numSheets + numSounds) * sizeof(const char*));
+	assert(sources != NULL);
+	for (uint8_t i = 0; i < numSheets; ++i)
+	{
+		sources[i] = sheets[i].path;
+	}
+	for (uint8_t i = 0; i < numSounds; ++i)
+	{
+		sources[numSheets + i] = soundPaths[i];
+	}
+	_assetLoader.sourceKey = _assetLoaderGetSourceKey(sheets, numSheets, soundPaths, numSounds);
+	if (!assetPackIsOutOfDate(packPath, sources, numSheets + numSounds, _assetLoader.sourceKey))
+	{
+		_assetLoader.pack = assetPackOpen(packPath);
+	}
+	free(sources);
+
+	// A pack written without a renderer has no atlas image in it. Anything else missing (or cut short) means the pack
+	// can't be trusted for any of it.
+	unsigned char* atlasPixels = spriteAtlasNewImage();
+	const AssetEntry* atlasEntry = NULL;
+	bool isPackWhole = _assetLoader.pack != NULL;
+	if (isPackWhole && atlasPixels != NULL)
+	{
+		const SpriteSheet* atlas = spriteAtlasGetSheet();
+		uint32_t width = 0;
+		uint32_t height = 0;
+		isPackWhole = assetPackGetImage(_assetLoader.pack, ASSET_LOADER_ATLAS, &width, &height) != NULL &&
+			width == atlas->WIDTH_PIXELS && height == atlas->HEIGHT_PIXELS;
+		atlasEntry = assetPackFind(_assetLoader.pack, ASSET_LOADER_ATLAS);
+	}
+	for (uint8_t i = 0; isPackWhole && i < numSounds; ++i)
+	{
+		isPackWhole = assetPackGetSound(_assetLoader.pack, soundPaths[i], &_assetLoader.sounds[i]);
+	}
+	if (!isPackWhole)
+	{
+		assetPackClose(_assetLoader.pack);
+		_assetLoader.pack = NULL;
+		memset(_assetLoader.sounds, 0, numSounds * sizeof(WavInfo));
+	}
+
+	if (_assetLoader.pack != NULL)
+	{
+		free(atlasPixels);
+		_assetLoader.atlasEntry = atlasEntry;
+		if (atlasEntry != NULL)
+		{
+			jobsRunBackground(_assetLoaderReadAtlas, NULL, &_assetLoader.atlasLoad);
+		}
+		for (uint8_t i = 0; i < numSounds; ++i)
+		{
+			jobsRunBackground(_assetLoaderReadPackedSound, (void*)(uintptr_t)i, &_assetLoader.soundLoads[i]);
+		}
+	}
+	else
+	{
+		_assetLoader.atlasPixels = atlasPixels;
+		for (uint8_t i = 0; atlasPixels != NULL && i < numSheets; ++i)
+		{
+			jobsRunBackground(_assetLoaderDecodeSheet, (void*)(uintptr_t)i, &_assetLoader.sheetLoads[i]);
+		}
+		for (uint8_t i = 0; i < numSounds; ++i)
+		{
+			jobsRunBackground(_assetLoaderReadSound, (void*)(uintptr_t)i, &_assetLoader.soundLoads[i]);
+		}
+	}
+
+	// Without workers, everything has loaded by now, and the pack can be written straight away
+	assetLoaderUpdate();
+}
+
+/// <summary>
+/// Waits for anything still loading, and frees everything loaded. Nothing loaded may be used after, so sounds must be
+/// unloaded first, and there must be nothing left to render.
+/// </summary>
+void assetLoaderShutdown()
+{
+	for (uint8_t i = 0; i < _assetLoader.numSheets; ++i)
+	{
+		jobsWait(&_assetLoader.sheetLoads[i]);
+	}
+	for (uint8_t i = 0; i < _assetLoader.numSounds; ++i)
+	{
+		jobsWait(&_assetLoader.soundLoads[i]);
+	}
+	jobsWait(&_assetLoader.atlasLoad);
+
+	// So the next run doesn't have to decode it all again
+	assetLoaderUpdate();
+	jobsWait(&_assetLoader.packWrite);
+
+	for (uint8_t i = 0; i < _assetLoader.numSounds; ++i)
+	{
+		free(_assetLoader.soundFiles[i]);
+	}
+	free(_assetLoader.soundLoads);
+	free(_assetLoader.soundFiles);
+	free(_assetLoader.sounds);
+	free(_assetLoader.isSheetUploaded);
+	free(_assetLoader.sheetLoads);
+	free(_assetLoader.atlasPixels);
+	assetPackClose(_assetLoader.pack);
+	memset(&_assetLoader, 0, sizeof(_assetLoader));
+}
+
+
+/// <summary>
+/// Moves loading along: once everything has been decoded from the source files, starts writing the pack.
+/// </summary>
+/// <returns>Whether everything is loaded.</returns>
+bool assetLoaderUpdate()
+{
+	if (_assetLoader.pack == NULL && !_assetLoader.isPackWriteStarted && _assetLoaderIsDecoded())
+	{
+		_assetLoader.isPackWriteStarted = true;
+		jobsRunBackground(_assetLoaderWritePack, NULL, &_assetLoader.packWrite);
+	}
+	return assetLoaderIsDone();
+}
+
+/// <summary>
+/// Uploads whichever of the atlas's sheets have loaded since the last call. Only called from the thread rendering.
+/// </summary>
+void assetLoaderRunUploads()
+{
+	for (uint8_t i = 0; i < _assetLoader.numSheets; ++i)
+	{
+		if (_assetLoader.isSheetUploaded[i] || !assetLoaderIsSheetLoaded(i))
+		{
+			continue;
+		}
+
+		if (_assetLoader.atlasEntry != NULL)
+		{
+			// The pack's image has every sheet in it already
+			spriteAtlasLoadTexture(assetPackGetData(_assetLoader.pack, _assetLoader.atlasEntry));
+			memset(_assetLoader.isSheetUploaded, true, _assetLoader.numSheets * sizeof(bool));
+			return;
+		}
+		if (_assetLoader.atlasPixels != NULL)
+		{
+			spriteAtlasLoadSheet(i, _assetLoader.atlasPixels);
+		}
+		_assetLoader.isSheetUploaded[i] = true;
+	}
+}
+
+
+/// <summary>
+/// May be called from any thread.
+/// </summary>
+/// <param name="sheetIndex"></param>
+/// <returns>Whether a sheet's pixels are ready to be uploaded.</returns>
+bool assetLoaderIsSheetLoaded(uint8_t sheetIndex)
+{
+	assert(sheetIndex < _assetLoader.numSheets);
+
+	return jobsIsDone(&_assetLoader.atlasLoad) && jobsIsDone(&_assetLoader.sheetLoads[sheetIndex]);
+}
+
+/// <param name="soundIndex"></param>
+/// <returns>A sound's format and samples, which stay valid until the loader is shut down, or NULL until it's loaded (or if it can't be).</returns>
+const WavInfo* assetLoaderGetSound(uint8_t soundIndex)
+{
+	assert(soundIndex < _assetLoader.numSounds);
+
+	const WavInfo* sound = &_assetLoader.sounds[soundIndex];
+	return jobsIsDone(&_assetLoader.soundLoads[soundIndex]) && sound->samples != NULL ? sound : NULL;
+}
+
+/// <returns>Whether everything is loaded, including writing the pack if it was out of date.</returns>
+bool assetLoaderIsDone()
+{
+	if (_assetLoader.pack == NULL)
+	{
+		return _assetLoader.isPackWriteStarted && jobsIsDone(&_assetLoader.packWrite);
+	}
+	return _assetLoaderIsDecoded();
+}
+
+
+/// <summary>
+/// Hashes everything a pack's contents depend on besides the source files' own bytes: which files they are, how the atlas
+/// packs the sheets, and how this version decodes them.
+/// </summary>
+/// <param name="sheets"></param>
+/// <param name="numSheets"></param>
+/// <param name="soundPaths"></param>
+/// <param name="numSounds"></param>
+/// <returns>The key to write the pack with, and check it against.</returns>
+static uint64_t _assetLoaderGetSourceKey(const SpriteAtlasSheetDef* const sheets, uint8_t numSheets, const char* const* soundPaths, uint8_t numSounds)
+{
+	uint64_t key = assetPackHash(ASSET_PACK_HASH_INIT, &ASSET_LOADER_VERSION, sizeof(ASSET_LOADER_VERSION));
+
+	const SpriteSheet* atlas = spriteAtlasGetSheet();
+	key = assetPackHash(key, &atlas->WIDTH_PIXELS, sizeof(atlas->WIDTH_PIXELS));
+	key = assetPackHash(key, &atlas->HEIGHT_PIXELS, sizeof(atlas->HEIGHT_PIXELS));
+	for (uint8_t i = 0; i < numSheets; ++i)
+	{
+		const Coord2D origin = spriteAtlasGetSheetOrigin(i);
+		key = assetPackHash(key, sheets[i].path, strlen(sheets[i].path) + 1);
+		key = assetPackHash(key, &sheets[i].WIDTH_PIXELS, sizeof(sheets[i].WIDTH_PIXELS));
+		key = assetPackHash(key, &sheets[i].HEIGHT_PIXELS, sizeof(sheets[i].HEIGHT_PIXELS));
+		key = assetPackHash(key, &origin, sizeof(origin));
+	}
+	for (uint8_t i = 0; i < numSounds; ++i)
+	{
+		key = assetPackHash(key, soundPaths[i], strlen(soundPaths[i]) + 1);
+	}
+	return key;
+}
+
+/// <returns>Whether every sheet and sound has loaded.</returns>
+static bool _assetLoaderIsDecoded()
+{
+	for (uint8_t i = 0; i < _assetLoader.numSheets; ++i)
+	{
+		if (!assetLoaderIsSheetLoaded(i)) { return false; }
+	}
+	for (uint8_t i = 0; i < _assetLoader.numSounds; ++i)
+	{
+		if (!jobsIsDone(&_assetLoader.soundLoads[i])) { return false; }
+	}
+	return true;
+}
+
+/// <summary>
+/// Reads the pack's atlas image into memory, so uploading it doesn't stall rendering on the disk.
+/// </summary>
+/// <param name="data"></param>
+static void _assetLoaderReadAtlas(void* data)
+{
+	(void)data;
+	assetPackPrefetch(_assetLoader.pack, _assetLoader.atlasEntry);
+}
+
+/// <param name="data"> - The sheet's index.</param>
+static void _assetLoaderDecodeSheet(void* data)
+{
+	spriteAtlasDecodeSheet((uint8_t)(uintptr_t)data, _assetLoader.atlasPixels);
+}
+
+/// <summary>
+/// Reads a sound's samples in the pack into memory, so the first time it plays doesn't stall on the disk.
+/// </summary>
+/// <param name="data"> - The sound's index.</param>
+static void _assetLoaderReadPackedSound(void* data)
+{
+	const uint8_t soundIndex = (uint8_t)(uintptr_t)data;
+	assetPackPrefetch(_assetLoader.pack, assetPackFind(_assetLoader.pack, _assetLoader.soundPaths[soundIndex]));
+}
+
+/// <param name="data"> - The sound's index.</param>
+static void _assetLoaderReadSound(void* data)
+{
+	const uint8_t soundIndex = (uint8_t)(uintptr_t)data;
+	_assetLoader.soundFiles[soundIndex] = wavLoad(_assetLoader.soundPaths[soundIndex], &_assetLoader.sounds[soundIndex]);
+}
+
+/// <summary>
+/// Writes everything decoded from the source files into the pack.
+/// </summary>
+/// <param name="data"></param>
+static void _assetLoaderWritePack(void* data)
+{
+	(void)data;
+	AssetPackWriter* writer = assetPackWriterNew(_assetLoader.sourceKey);
+	if (_assetLoader.atlasPixels != NULL)
+	{
+		const SpriteSheet* atlas = spriteAtlasGetSheet();
+		assetPackWriterAddImage(writer, ASSET_LOADER_ATLAS, atlas->WIDTH_PIXELS, atlas->HEIGHT_PIXELS, _assetLoader.atlasPixels);
+	}
+	for (uint8_t i = 0; i < _assetLoader.numSounds; ++i)
+	{
+		if (_assetLoader.sounds[i].samples != NULL)
+		{
+			assetPackWriterAddSound(writer, _assetLoader.soundPaths[i], &_assetLoader.sounds[i]);
+		}
+	}
+
+	// Everything is loaded already: the pack is for next time
+	assetPackClose(assetPackWriterFinish(writer, _assetLoader.packPath));
+}
@@ -5,11 +5,13 @@
 
 
 // =============== vTable ===============
-static void _backgroundDraw(Object* obj);
+static void _backgroundDraw(const Object* obj);
 static ObjVtable _backgroundVtable = {
 	backgroundDelete,
 	_backgroundDraw,
 	NULL,
+	NULL,
+	NULL,
 	NULL
 };
 
@@ -17,11 +19,10 @@ static ObjVtable _backgroundVtable = {
 /// <summary>
 /// Creates a background object. Sets the position to the center of the screen.
 /// </summary>
-/// <param name="sheet"></param>
-/// <param name="spriteBounds"></param>
+/// <param name="sprite"> - In the sprite atlas, which it is drawn from.</param>
 /// <param name="size"></param>
 /// <returns></returns>
-Background* backgroundNew(const SpriteSheet* const sheet, Bounds2D spriteBounds, Coord2D size)
+Background* backgroundNew(SpriteId sprite, Coord2D size)
 {
 	Background* background = (Background*)malloc(sizeof(Background));
 	if (background != NULL)
@@ -30,10 +31,7 @@ Background* backgroundNew(const SpriteSheet* const sheet, Bounds2D spriteBounds,
 		Bounds2D gameBounds = { .topLeft = {0, 0}, .botRight = SCREEN_RESOLUTION };
 		objInit(&background->obj, &_backgroundVtable, boundsGetCenter(&gameBounds), false);
 		background->obj.size = size;
-
-		Bounds2D spriteUV = { .topLeft = {spriteBounds.topLeft.x / (float)sheet->WIDTH_PIXELS, spriteBounds.topLeft.y / (float)sheet->HEIGHT_PIXELS},
-									.botRight = {spriteBounds.botRight.x / (float)sheet->WIDTH_PIXELS, spriteBounds.botRight.y / (float)sheet->HEIGHT_PIXELS} };
-		background->sprite = spriteNew(sheet, spriteUV, -0.99f);
+		background->sprite = sprite;
 	}
 	return background;
 }
@@ -48,7 +46,6 @@ void backgroundDelete(Object* background)
 	{
 		Background* backgroundCast = (Background*)background;
 		objDeinit(&backgroundCast->obj);
-		spriteDelete(backgroundCast->sprite);
 	}
 	free(background);
 }
@@ -58,9 +55,9 @@ void backgroundDelete(Object* background)
 /// Draws the background image.
 /// </summary>
 /// <param name="obj"></param>
-static void _backgroundDraw(Object* obj)
+static void _backgroundDraw(const Object* obj)
 {
-	Background* background = (Background*)obj;
+	const Background* background = (const Background*)obj;
 
-	spriteDraw(background->sprite, background->obj.position, background->obj.size, false);
+	spriteDraw(spriteAtlasGet(background->sprite), background->obj.position, background->obj.size, false);
 }
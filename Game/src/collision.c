@@ -1,7 +1,14 @@
+#include <stdlib.h>
 #include <assert.h>
 #include <math.h>
 
+#include "platform.h"
 #include "collision.h"
+#include "simd.h"
+
+
+// Function Prototypes
+static inline uint32_t _collisionBatchWriteHits(CollisionBatch* batch, uint32_t index, uint32_t hitBits, uint32_t end);
 
 
 /// <summary>
@@ -14,30 +21,181 @@ Collision detectCollision(const Bounds2D* const thisBounds, const Bounds2D* cons
 {
 	assert(thisBounds != NULL && otherBounds != NULL);
 
-	Collision resultingCollision = { .isColliding = false, .delta = {1.0f, 1.0f}, .intersect = {1.0f, 1.0f} };
-
 	Coord2D thisSize = boundsGetDimensions(thisBounds);
 	Coord2D thisCenter = boundsGetCenter(thisBounds);
 	Coord2D thisHalfSize = { .x = thisSize.x / 2, .y = thisSize.y / 2 };
 
 	Coord2D otherSize = boundsGetDimensions(otherBounds);
 	Coord2D otherCenter = boundsGetCenter(otherBounds);
-	Coord2D otherHalfSize = { .x = otherSize.x / 2, .y = otherSize.y / 2 };
 
-	float deltaX = thisCenter.x - otherCenter.x;
-	float deltaY = thisCenter.y - otherCenter.y;
+	// Test as a batch of one box, padded out to a whole lane
+	float centerX[COLLISION_BATCH_LANES] = { otherCenter.x };
+	float centerY[COLLISION_BATCH_LANES] = { otherCenter.y };
+	float halfWidth[COLLISION_BATCH_LANES] = { otherSize.x / 2 };
+	float halfHeight[COLLISION_BATCH_LANES] = { otherSize.y / 2 };
+	float deltaX[COLLISION_BATCH_LANES];
+	float deltaY[COLLISION_BATCH_LANES];
+	float intersectX[COLLISION_BATCH_LANES];
+	float intersectY[COLLISION_BATCH_LANES];
+	uint32_t hitMask[1] = { 0 };
+	CollisionBatch batch = { centerX, centerY, halfWidth, halfHeight, deltaX, deltaY, intersectX, intersectY, hitMask };
+	detectCollisionBatch(thisCenter, thisHalfSize, &batch, 0, 1);
+
+	// The batch's delta points from this box to the other, this function's the other way around
+	Collision resultingCollision = collisionBatchGet(&batch, 0);
+	resultingCollision.delta.x = -resultingCollision.delta.x;
+	resultingCollision.delta.y = -resultingCollision.delta.y;
+	return resultingCollision;
+}
+
+
+/// <summary>
+/// Creates a batch w/ room for the passed in number of boxes (plus the padding the lanes need).
+/// </summary>
+/// <param name="maxBoxes"></param>
+/// <returns></returns>
+CollisionBatch* collisionBatchNew(uint32_t maxBoxes)
+{
+	CollisionBatch* batch = (CollisionBatch*)malloc(sizeof(CollisionBatch));
+	if (batch != NULL)
+	{
+		// A batch can start at any box, so the last lane can reach up to LANES - 1 boxes past the end
+		const uint32_t capacity = maxBoxes + COLLISION_BATCH_LANES - 1;
+		float* memory = (float*)malloc(8 * capacity * sizeof(float));
+		batch->hitMask = (uint32_t*)malloc((capacity + 31) / 32 * sizeof(uint32_t));
+		assert(memory != NULL && batch->hitMask != NULL);
+		ZeroMemory(memory, 8 * capacity * sizeof(float));
+		ZeroMemory(batch->hitMask, (capacity + 31) / 32 * sizeof(uint32_t));
+
+		batch->centerX = memory;		memory += capacity;
+		batch->centerY = memory;		memory += capacity;
+		batch->halfWidth = memory;		memory += capacity;
+		batch->halfHeight = memory;		memory += capacity;
+		batch->deltaX = memory;			memory += capacity;
+		batch->deltaY = memory;			memory += capacity;
+		batch->intersectX = memory;		memory += capacity;
+		batch->intersectY = memory;
+	}
+	return batch;
+}
+
+/// <summary>
+/// Deletes the batch.
+/// </summary>
+/// <param name="batch"></param>
+void collisionBatchDelete(CollisionBatch* batch)
+{
+	if (batch != NULL)
+	{
+		free(batch->centerX);	// start of the shared allocation
+		free(batch->hitMask);
+	}
+	free(batch);
+}
+
 
-	float intersectX = (float)fabs(deltaX) - (thisHalfSize.x + otherHalfSize.x);
-	float intersectY = (float)fabs(deltaY) - (thisHalfSize.y + otherHalfSize.y);
+/// <summary>
+/// Tests one box against a range of the batch's boxes, filling in the deltas, intersects and hit mask for that range.
+///		<para>
+/// Produces the same values as testing each pair on its own.
+///		</para>
+/// </summary>
+/// <param name="center"></param>
+/// <param name="halfSize"></param>
+/// <param name="batch"></param>
+/// <param name="first">The first box to test against.</param>
+/// <param name="count">The number of boxes to test against.</param>
+/// <returns>The number of boxes overlapping the tested box.</returns>
+uint32_t detectCollisionBatch(Coord2D center, Coord2D halfSize, CollisionBatch* batch, uint32_t first, uint32_t count)
+{
+	const uint32_t end = first + count;
+	uint32_t numHits = 0;
+
+#ifdef GAME_SSE
+	const __m128 centerX = _mm_set1_ps(center.x);
+	const __m128 centerY = _mm_set1_ps(center.y);
+	const __m128 halfWidth = _mm_set1_ps(halfSize.x);
+	const __m128 halfHeight = _mm_set1_ps(halfSize.y);
+	const __m128 signBit = _mm_set1_ps(-0.0f);
+	const __m128 zero = _mm_setzero_ps();
+
+	for (uint32_t i = first; i < end; i += COLLISION_BATCH_LANES)
+	{
+		const __m128 deltaX = _mm_sub_ps(_mm_loadu_ps(&batch->centerX[i]), centerX);
+		const __m128 deltaY = _mm_sub_ps(_mm_loadu_ps(&batch->centerY[i]), centerY);
+		const __m128 intersectX = _mm_sub_ps(_mm_andnot_ps(signBit, deltaX), _mm_add_ps(halfWidth, _mm_loadu_ps(&batch->halfWidth[i])));
+		const __m128 intersectY = _mm_sub_ps(_mm_andnot_ps(signBit, deltaY), _mm_add_ps(halfHeight, _mm_loadu_ps(&batch->halfHeight[i])));
 
-	resultingCollision.delta.x = deltaX;
-	resultingCollision.delta.y = deltaY;
-	resultingCollision.intersect.x = intersectX;
-	resultingCollision.intersect.y = intersectY;
+		_mm_storeu_ps(&batch->deltaX[i], deltaX);
+		_mm_storeu_ps(&batch->deltaY[i], deltaY);
+		_mm_storeu_ps(&batch->intersectX[i], intersectX);
+		_mm_storeu_ps(&batch->intersectY[i], intersectY);
 
-	if (intersectX < 0.0f && intersectY < 0.0f)
+		const int hitBits = _mm_movemask_ps(_mm_and_ps(_mm_cmplt_ps(intersectX, zero), _mm_cmplt_ps(intersectY, zero)));
+		numHits += _collisionBatchWriteHits(batch, i, (uint32_t)hitBits, end);
+	}
+#else
+	for (uint32_t i = first; i < end; ++i)
 	{
-		resultingCollision.isColliding = true;
+		batch->deltaX[i] = batch->centerX[i] - center.x;
+		batch->deltaY[i] = batch->centerY[i] - center.y;
+		batch->intersectX[i] = (float)fabs(batch->deltaX[i]) - (halfSize.x + batch->halfWidth[i]);
+		batch->intersectY[i] = (float)fabs(batch->deltaY[i]) - (halfSize.y + batch->halfHeight[i]);
+
+		const bool isHit = batch->intersectX[i] < 0.0f && batch->intersectY[i] < 0.0f;
+		numHits += _collisionBatchWriteHits(batch, i, isHit ? 1 : 0, end);
 	}
+#endif
+
+	return numHits;
+}
+
+/// <param name="batch"></param>
+/// <param name="index"></param>
+/// <returns>Whether the box at the index overlapped the most recently tested box.</returns>
+bool collisionBatchIsHit(const CollisionBatch* const batch, uint32_t index)
+{
+	return (batch->hitMask[index / 32] >> (index % 32)) & 1;
+}
+
+/// <param name="batch"></param>
+/// <param name="index"></param>
+/// <returns>The result of the most recent test against the box at the index, w/ the delta pointing from the tested box to this one.</returns>
+Collision collisionBatchGet(const CollisionBatch* const batch, uint32_t index)
+{
+	Collision resultingCollision = {
+		.isColliding = collisionBatchIsHit(batch, index),
+		.delta = { .x = batch->deltaX[index], .y = batch->deltaY[index] },
+		.intersect = { .x = batch->intersectX[index], .y = batch->intersectY[index] }
+	};
 	return resultingCollision;
 }
+
+
+/// <summary>
+/// Records the hit bits of one lane group in the hit mask, ignoring the lanes past the end of the tested range.
+/// </summary>
+/// <param name="batch"></param>
+/// <param name="index">The box in the group's first lane.</param>
+/// <param name="hitBits">Bit n is set if the box in lane n overlapped.</param>
+/// <param name="end"></param>
+/// <returns>The number of hits recorded.</returns>
+static inline uint32_t _collisionBatchWriteHits(CollisionBatch* batch, uint32_t index, uint32_t hitBits, uint32_t end)
+{
+	uint32_t numHits = 0;
+	for (uint32_t lane = 0; lane < COLLISION_BATCH_LANES && index + lane < end; ++lane)
+	{
+		const uint32_t box = index + lane;
+		const uint32_t bit = 1u << (box % 32);
+		if ((hitBits >> lane) & 1)
+		{
+			batch->hitMask[box / 32] |= bit;
+			++numHits;
+		}
+		else
+		{
+			batch->hitMask[box / 32] &= ~bit;
+		}
+	}
+	return numHits;
+}
@@ -1,22 +1,67 @@
 #include <stdlib.h>
+#include <assert.h>
 
 #include "collisionBox.h"
 #include "shape.h"
+#include "pool.h"
+#include "world.h"
 
 
 static bool _debugDraw = false;
 
+static WORLD_LOCAL Pool* _collisionBoxPool = NULL;	// the current world's
+
 
 // =============== vTable ===============
-static void _collisionBoxDraw(Object* obj);
+static void _collisionBoxDraw(const Object* obj);
 static ObjVtable _collisionBoxVtable = {
 	collisionBoxDelete,
 	_collisionBoxDraw,
 	NULL,
+	NULL,
+	NULL,
 	NULL
 };
 
 
+/// <summary>
+/// Allocates room for the passed in number of collision boxes up front, so creating and deleting them doesn't touch the heap.
+/// The pool becomes the calling thread's current one.
+/// </summary>
+/// <param name="maxCollisionBoxes"></param>
+void collisionBoxInitPool(uint32_t maxCollisionBoxes)
+{
+	_collisionBoxPool = poolNew(sizeof(CollisionBox), maxCollisionBoxes);
+}
+
+/// <summary>
+/// Frees the collision box pool. Every collision box from the pool must have been deleted already.
+/// </summary>
+void collisionBoxDeinitPool()
+{
+	assert(_collisionBoxPool == NULL || poolGetCount(_collisionBoxPool) == 0);
+	poolDelete(_collisionBoxPool);
+	_collisionBoxPool = NULL;
+}
+
+/// <summary>
+/// </summary>
+/// <returns>The calling thread's current collision box pool</returns>
+Pool* collisionBoxGetPool()
+{
+	return _collisionBoxPool;
+}
+
+/// <summary>
+/// Makes a collision box pool the calling thread's current one, which new collision boxes are allocated from.
+/// </summary>
+/// <param name="pool">from collisionBoxGetPool, or NULL for none</param>
+void collisionBoxSetPool(Pool* pool)
+{
+	_collisionBoxPool = pool;
+}
+
+
 /// <summary>
 /// Creates a new collisionBox object.
 /// </summary>
@@ -25,7 +70,9 @@ static ObjVtable _collisionBoxVtable = {
 /// <returns></returns>
 CollisionBox* collisionBoxNew(Coord2D topLeftPos, Coord2D size)
 {
-	CollisionBox* collisionBox = (CollisionBox*)malloc(sizeof(CollisionBox));
+	// Only fall back to the heap if more are alive than the pool was sized for
+	CollisionBox* collisionBox = _collisionBoxPool != NULL ? (CollisionBox*)poolAlloc(_collisionBoxPool) : NULL;
+	if (collisionBox == NULL) { collisionBox = (CollisionBox*)malloc(sizeof(CollisionBox)); }
 	if (collisionBox != NULL)
 	{
 		// Determine the center position of the box
@@ -33,6 +80,7 @@ CollisionBox* collisionBoxNew(Coord2D topLeftPos, Coord2D size)
 
 		entityInit(&collisionBox->entity, &_collisionBoxVtable, boundsGetCenter(&boxBounds), size);
 		collisionBox->entity.collresp = COLLRESP_PLATFORM;
+		collisionBox->entity.isStatic = true;
 	}
 	return collisionBox;
 }
@@ -47,7 +95,9 @@ void collisionBoxDelete(Object* collisionBox)
 	{
 		entityDeinit(&((CollisionBox*)collisionBox)->entity);
 	}
-	free(collisionBox);
+
+	if (poolOwns(_collisionBoxPool, collisionBox)) { poolFree(_collisionBoxPool, collisionBox); }
+	else { free(collisionBox); }
 }
 
 
@@ -55,11 +105,11 @@ void collisionBoxDelete(Object* collisionBox)
 /// Draws the outline of the collision box if the internal debug boolean is set to true.
 /// </summary>
 /// <param name="obj"></param>
-static void _collisionBoxDraw(Object* obj)
+static void _collisionBoxDraw(const Object* obj)
 {
 	if (_debugDraw)
 	{
-		 CollisionBox* collisionBox = (CollisionBox*)obj;
+		 const CollisionBox* collisionBox = (const CollisionBox*)obj;
 
 		 float left = collisionBox->entity.obj.position.x - collisionBox->entity.obj.size.x / 2.0f;
 		 float right = collisionBox->entity.obj.position.x + collisionBox->entity.obj.size.x / 2.0f;
@@ -1,73 +1,220 @@
-#include <Windows.h>
 #include <assert.h>
 #include <math.h>
+#include <float.h>
+#include <string.h>
 
+#include "platform.h"
 #include "collisionMgr.h"
 #include "collision.h"
+#include "joustGlobalConstants.h"
+#include "staticBvh.h"
+#include "objmgr.h"
+#include "world.h"
 
 
-static struct collmgr_t {
-	Entity**	list;
+// Uniform grid broadphase over the screen for moving entities, w/ cells as big as the biggest of them, so each only spans a few.
+// Entities are inserted w/ their exact bounds. A collision response that pushes an entity into cells it wasn't in adds it to
+// those cells' overflow lists, and the entity being handled queries again for wherever a response pushed it.
+// Static entities (platforms) are kept out of the grid, in a BVH that is only rebuilt when entities are added/removed.
+static const float GRID_MIN_CELL_SIZE = 32.0f;	// bounds the number of cells, however small the entities get
+static const float GRID_SLACK = 0.0625f;		// bounds are widened by this much, so rounding can't hide an overlap from the narrowphase
+#define GRID_NONE	0xFFFFFFFFu
+
+typedef struct gridRange_t {
+	uint16_t	minX;
+	uint16_t	minY;
+	uint16_t	maxX;
+	uint16_t	maxY;
+} GridRange;
+
+static const GridRange GRID_RANGE_EMPTY = { 1, 1, 0, 0 };
+
+struct collmgr_t {
+	ObjHandle*	list;			// packed: the first count slots are all occupied
 	uint32_t	max;
 	uint32_t	count;
-} _collMgr = { NULL, 0, 0 };
+
+	// Broadphase grid, rebuilt every update
+	float		cellSize;
+	uint16_t	cellsX;
+	uint16_t	cellsY;
+	uint32_t	maxCells;
+	uint32_t*	cellStart;		// cellsX * cellsY + 1 offsets into cellEntries
+	uint32_t*	cellEntries;	// list indices, ascending within each cell
+	uint32_t	entryCapacity;
+	GridRange*	ranges;			// per list index, the cells it has been inserted into (empty if none)
+	bool		isGridBuilt;	// from the build until the end of the update
+
+	// Entities pushed into cells since the build: per cell, a list of entries, newest first
+	uint32_t*	cellOverflow;	// per cell, the first entry, or GRID_NONE
+	uint32_t*	overflowIndices;
+	uint32_t*	overflowNext;
+	uint32_t	numOverflow;
+	uint32_t	overflowCapacity;
+
+	// Static entities
+	StaticBvh*	staticBvh;
+	bool		isStaticDirty;
+	uint32_t	pendingFrom;	// list slots from here on may hold entities added since they were last checked for being static
+	Bounds2D*	staticBounds;	// scratch for rebuilding the BVH
+	uint32_t*	staticIds;
+
+	// Candidate gathering for a single entity
+	uint32_t*	queryStamps;	// per list index, the last query that gathered it
+	uint32_t	queryStamp;
+	uint32_t*	candidates;		// list indices, as of gathering, w/ room for the BVH to find every static entity again
+	ObjHandle*	handles;		// the handles at those indices
+	uint32_t*	sortScratch;	// merge buffers for sorting the candidates
+	ObjHandle*	handleScratch;
+	uint64_t*	sortBits;		// one bit per list index, all clear between sorts
+	CollisionBatch* batch;		// the candidates' boxes, for the narrowphase
+};
+
+static WORLD_LOCAL CollisionMgrState* _collMgr = NULL;	// the current world's
 
 
 // Function Prototypes
-static Collision _detectCollision(const Entity* const thisEntity, const Entity* const otherEntity);
+static void _buildGrid();
+static void _buildStaticBvh();
+static void _regridEntity(ObjHandle handle);
+static void _addOverflow(uint32_t cell, uint32_t index);
+static Bounds2D _getQueryBounds(const Entity* const entity);
+static GridRange _getGridRange(const Bounds2D* const bounds);
+static Bounds2D _getRangeBounds(GridRange range);
+static uint32_t _gatherCandidates(GridRange range, GridRange skip, uint32_t stamp, uint32_t numCandidates);
+static uint32_t _prepareCandidates(uint32_t first, uint32_t end);
+static uint32_t _gatherMoreCandidates(GridRange range, GridRange skip, uint32_t stamp, uint32_t current, uint32_t numCandidates);
+static void _sortCandidates(uint32_t* candidates, uint32_t numCandidates);
+static void _fillBatch(const Entity* const entity, uint32_t first, uint32_t end);
+static void _detectCandidateCollisions(const Entity* const entity, uint32_t first, uint32_t count);
+static void _handleCollisions(Entity* entity);
 
 
 /// <summary>
-/// Initializes the collision manager with empty values.
+/// Initializes a collision manager with empty values, sizes the broadphase grid from the screen resolution, and makes it the calling thread's current one.
 /// </summary>
 /// <param name="maxObjects"></param>
 void collisionMgrInit(uint32_t maxObjects)
 {
+	_collMgr = (CollisionMgrState*)malloc(sizeof(CollisionMgrState));
+	assert(_collMgr != NULL);
+	ZeroMemory(_collMgr, sizeof(CollisionMgrState));
+
 	// Allocate space for the list
-	_collMgr.list = (Entity**)malloc(maxObjects * sizeof(Entity*));
-	if (_collMgr.list != NULL)
+	_collMgr->list = (ObjHandle*)malloc(maxObjects * sizeof(ObjHandle));
+	if (_collMgr->list != NULL)
 	{
 		// Initialize list as empty
-		ZeroMemory(_collMgr.list, maxObjects * sizeof(Entity*));
-		_collMgr.max = maxObjects;
-		_collMgr.count = 0;
+		ZeroMemory(_collMgr->list, maxObjects * sizeof(ObjHandle));
+		_collMgr->max = maxObjects;
+		_collMgr->count = 0;
 	}
+
+	// Allocate the broadphase grid, for the smallest cells it can have
+	_collMgr->maxCells = (uint32_t)ceilf(SCREEN_RESOLUTION.x / GRID_MIN_CELL_SIZE) * (uint32_t)ceilf(SCREEN_RESOLUTION.y / GRID_MIN_CELL_SIZE);
+	_collMgr->cellStart = (uint32_t*)malloc(((size_t)_collMgr->maxCells + 1) * sizeof(uint32_t));
+	_collMgr->entryCapacity = maxObjects * 4;
+	_collMgr->cellEntries = (uint32_t*)malloc(_collMgr->entryCapacity * sizeof(uint32_t));
+	_collMgr->ranges = (GridRange*)malloc(maxObjects * sizeof(GridRange));
+	_collMgr->cellOverflow = (uint32_t*)malloc(_collMgr->maxCells * sizeof(uint32_t));
+	_collMgr->overflowCapacity = maxObjects;
+	_collMgr->overflowIndices = (uint32_t*)malloc(_collMgr->overflowCapacity * sizeof(uint32_t));
+	_collMgr->overflowNext = (uint32_t*)malloc(_collMgr->overflowCapacity * sizeof(uint32_t));
+	_collMgr->queryStamps = (uint32_t*)malloc(maxObjects * sizeof(uint32_t));
+	_collMgr->candidates = (uint32_t*)malloc(2 * (size_t)maxObjects * sizeof(uint32_t));
+	_collMgr->handles = (ObjHandle*)malloc(maxObjects * sizeof(ObjHandle));
+	_collMgr->sortScratch = (uint32_t*)malloc(maxObjects * sizeof(uint32_t));
+	_collMgr->handleScratch = (ObjHandle*)malloc(maxObjects * sizeof(ObjHandle));
+	_collMgr->sortBits = (uint64_t*)calloc(((size_t)maxObjects + 63) / 64, sizeof(uint64_t));
+	assert(_collMgr->cellStart != NULL && _collMgr->cellEntries != NULL && _collMgr->ranges != NULL && _collMgr->cellOverflow != NULL &&
+		_collMgr->overflowIndices != NULL && _collMgr->overflowNext != NULL && _collMgr->queryStamps != NULL && _collMgr->candidates != NULL &&
+		_collMgr->handles != NULL && _collMgr->sortScratch != NULL && _collMgr->handleScratch != NULL && _collMgr->sortBits != NULL);
+	_collMgr->isGridBuilt = false;
+	ZeroMemory(_collMgr->queryStamps, maxObjects * sizeof(uint32_t));
+	_collMgr->queryStamp = 0;
+	_collMgr->batch = collisionBatchNew(maxObjects);
+	assert(_collMgr->batch != NULL);
+
+	// Allocate the static hierarchy
+	_collMgr->staticBvh = staticBvhNew(maxObjects);
+	_collMgr->staticBounds = (Bounds2D*)malloc(maxObjects * sizeof(Bounds2D));
+	_collMgr->staticIds = (uint32_t*)malloc(maxObjects * sizeof(uint32_t));
+	assert(_collMgr->staticBvh != NULL && _collMgr->staticBounds != NULL && _collMgr->staticIds != NULL);
+	_collMgr->isStaticDirty = false;
+	_collMgr->pendingFrom = 0;
 }
 
 /// <summary>
-/// Ensures the collision manager is empty, and sets all references to NULL.
+/// Ensures the calling thread's current collision manager is empty, and frees it.
 /// </summary>
 void collisionMgrShutdown()
 {
 	// Ensure that the collision list has been totally emptied
-	assert(_collMgr.count == 0);
+	assert(_collMgr->count == 0);
 
 	// This manager does not own the objects, so only clean itself up
-	free(_collMgr.list);
-	_collMgr.list = NULL;
-	_collMgr.max = _collMgr.count = 0;
+	free(_collMgr->list);
+
+	free(_collMgr->cellStart);
+	free(_collMgr->cellEntries);
+	free(_collMgr->ranges);
+	free(_collMgr->cellOverflow);
+	free(_collMgr->overflowIndices);
+	free(_collMgr->overflowNext);
+	free(_collMgr->queryStamps);
+	free(_collMgr->candidates);
+	free(_collMgr->handles);
+	free(_collMgr->sortScratch);
+	free(_collMgr->handleScratch);
+	free(_collMgr->sortBits);
+	collisionBatchDelete(_collMgr->batch);
+
+	staticBvhDelete(_collMgr->staticBvh);
+	free(_collMgr->staticBounds);
+	free(_collMgr->staticIds);
+
+	free(_collMgr);
+	_collMgr = NULL;
+}
+
+/// <summary>
+/// </summary>
+/// <returns>The calling thread's current collision manager</returns>
+CollisionMgrState* collisionMgrGetState()
+{
+	return _collMgr;
+}
+
+/// <summary>
+/// Makes a collision manager the calling thread's current one.
+/// </summary>
+/// <param name="state">from collisionMgrGetState, or NULL for none</param>
+void collisionMgrSetState(CollisionMgrState* state)
+{
+	_collMgr = state;
 }
 
 
 /// <summary>
-/// Adds an entity to the collision manager if there is an open space.
+/// Adds an entity to the end of the collision manager's list if there is an open space.
 /// </summary>
 /// <param name="entity"></param>
 void collisionMgrAdd(Entity* entity)
 {
-	for (uint32_t i = 0; i < _collMgr.max; ++i)
+	assert(_collMgr->count < _collMgr->max);
+	if (_collMgr->count < _collMgr->max)
 	{
-		if (_collMgr.list[i] == NULL)
-		{
-			_collMgr.list[i] = entity;
-			++_collMgr.count;
-			return;
-		}
+		entity->_collIndex = _collMgr->count;
+		_collMgr->ranges[_collMgr->count] = GRID_RANGE_EMPTY;
+		_collMgr->list[_collMgr->count++] = objGetHandle(&entity->obj);
+
+		// Whether it's static is only known once its constructor finishes, so check at the next update
+		if (entity->_collIndex < _collMgr->pendingFrom) { _collMgr->pendingFrom = entity->_collIndex; }
 	}
 }
 
 /// <summary>
-/// Removes the entity from the collision manager.
+/// Removes the entity from the collision manager, moving the last entity into its slot.
 ///		<para>
 /// Note: Does not delete/free the entity.
 ///		</para>
@@ -75,86 +222,625 @@ void collisionMgrAdd(Entity* entity)
 /// <param name="entity"></param>
 void collisionMgrRemove(Entity* entity)
 {
-	// Check all of them just to be safe
-	for (uint32_t i = 0; i < _collMgr.max; ++i)
+	const uint32_t index = entity->_collIndex;
+	assert(index < _collMgr->count && _collMgr->list[index] == objGetHandle(&entity->obj));
+
+	const ObjHandle lastHandle = _collMgr->list[--_collMgr->count];
+	if (_collMgr->count >= _collMgr->pendingFrom && index < _collMgr->pendingFrom) { _collMgr->pendingFrom = index; }
+	Entity* last = (Entity*)objMgrGet(lastHandle);
+	_collMgr->list[index] = lastHandle;
+	last->_collIndex = index;
+	_collMgr->list[_collMgr->count] = OBJ_HANDLE_INVALID;
+
+	// Mid-update, the grid only knows the last entity by its old index
+	_collMgr->ranges[index] = GRID_RANGE_EMPTY;
+	if (_collMgr->isGridBuilt && index < _collMgr->count) { _regridEntity(lastHandle); }
+
+	// The BVH refers to static entities by slot
+	if (entity->isStatic || last->isStatic) { _collMgr->isStaticDirty = true; }
+}
+
+
+/// <summary>
+/// Checks for and handles the collisions of every awake entity. Should be called once per update, after all objects have moved.
+///		<para>
+/// Moving entities are bucketed into a uniform grid first, so each entity only runs the narrowphase against entities sharing a cell with it,
+/// plus the static entities its bounds overlap in the static BVH.
+///		</para>
+/// </summary>
+void collisionMgrUpdate()
+{
+	for (uint32_t i = _collMgr->pendingFrom; i < _collMgr->count && !_collMgr->isStaticDirty; ++i)
+	{
+		const Entity* entity = (const Entity*)objMgrGet(_collMgr->list[i]);
+		if (entity->isStatic) { _collMgr->isStaticDirty = true; }
+	}
+	_collMgr->pendingFrom = _collMgr->count;
+	if (_collMgr->isStaticDirty)
 	{
-		if (entity == _collMgr.list[i])
+		_buildStaticBvh();
+	}
+	_buildGrid();
+	_collMgr->isGridBuilt = true;
+
+	for (uint32_t i = 0; i < _collMgr->count; )
+	{
+		const ObjHandle handle = _collMgr->list[i];
+		Entity* entity = (Entity*)objMgrGet(handle);
+		if (entity->obj.enabled && entity->awake)
 		{
-			// Just clear the reference
-			_collMgr.list[i] = NULL;
-			--_collMgr.count;
-			return;
+			// Entities pushed around a lot leave a trail of cells they've moved out of; start over once it outgrows them
+			if (_collMgr->numOverflow > _collMgr->count)
+			{
+				_buildGrid();
+			}
+			_handleCollisions(entity);
 		}
+
+		// A response that removed this entity moved the last entity into its slot, which still needs handling
+		if (i < _collMgr->count && _collMgr->list[i] == handle) { ++i; }
 	}
+	_collMgr->isGridBuilt = false;
 }
 
 
 /// <summary>
-/// Checks for and handles all collisions occurring on the passed in entity.
+/// Sizes the grid's cells to the biggest enabled, moving entity, and buckets each of those entities into the cells its bounds overlap,
+/// using a counting sort so each cell's entries stay in list order.
 /// </summary>
-/// <param name="entity"></param>
-void handleAllCollisions(Entity* entity)
+static void _buildGrid()
 {
-	// Check if the object is "awake" or not
-		// Loop through all objects in the manager and check for a collision
-		// If collision occurs, react appropriately
-		// Continue looping to check for more collisions
+	float cellSize = GRID_MIN_CELL_SIZE;
+	for (uint32_t i = 0; i < _collMgr->count; ++i)
+	{
+		const Entity* entity = (const Entity*)objMgrGet(_collMgr->list[i]);
+		if (!entity->obj.enabled || entity->isStatic) { continue; }
+
+		if (entity->obj.size.x > cellSize) { cellSize = entity->obj.size.x; }
+		if (entity->obj.size.y > cellSize) { cellSize = entity->obj.size.y; }
+	}
+	_collMgr->cellSize = cellSize;
+	_collMgr->cellsX = (uint16_t)ceilf(SCREEN_RESOLUTION.x / cellSize);
+	_collMgr->cellsY = (uint16_t)ceilf(SCREEN_RESOLUTION.y / cellSize);
+
+	const uint32_t numCells = (uint32_t)_collMgr->cellsX * _collMgr->cellsY;
+	assert(numCells <= _collMgr->maxCells);
+	ZeroMemory(_collMgr->cellStart, (numCells + 1) * sizeof(uint32_t));
+	memset(_collMgr->cellOverflow, 0xFF, numCells * sizeof(uint32_t));
+	_collMgr->numOverflow = 0;
+
+	// Count the entries per cell
+	uint32_t numEntries = 0;
+	for (uint32_t i = 0; i < _collMgr->count; ++i)
+	{
+		const Entity* entity = (const Entity*)objMgrGet(_collMgr->list[i]);
+		if (!entity->obj.enabled || entity->isStatic)
+		{
+			_collMgr->ranges[i] = GRID_RANGE_EMPTY;
+			continue;
+		}
+
+		const Bounds2D bounds = _getQueryBounds(entity);
+		GridRange range = _getGridRange(&bounds);
+		_collMgr->ranges[i] = range;
+		for (uint32_t y = range.minY; y <= range.maxY; ++y)
+		{
+			for (uint32_t x = range.minX; x <= range.maxX; ++x)
+			{
+				++_collMgr->cellStart[y * _collMgr->cellsX + x + 1];
+				++numEntries;
+			}
+		}
+	}
+
+	if (numEntries > _collMgr->entryCapacity)
+	{
+		free(_collMgr->cellEntries);
+		_collMgr->entryCapacity = numEntries * 2;
+		_collMgr->cellEntries = (uint32_t*)malloc(_collMgr->entryCapacity * sizeof(uint32_t));
+		assert(_collMgr->cellEntries != NULL);
+	}
+
+	// Prefix sum the counts into offsets
+	for (uint32_t cell = 0; cell < numCells; ++cell)
+	{
+		_collMgr->cellStart[cell + 1] += _collMgr->cellStart[cell];
+	}
+
+	// Fill the cells, reusing the end of the previous cell as a write cursor
+	for (uint32_t i = 0; i < _collMgr->count; ++i)
+	{
+		GridRange range = _collMgr->ranges[i];
+		for (uint32_t y = range.minY; y <= range.maxY; ++y)
+		{
+			for (uint32_t x = range.minX; x <= range.maxX; ++x)
+			{
+				_collMgr->cellEntries[_collMgr->cellStart[y * _collMgr->cellsX + x]++] = i;
+			}
+		}
+	}
 
-	if (entity->awake)
+	// The fill advanced each offset to the start of the next cell, so shift them back
+	for (uint32_t cell = numCells; cell > 0; --cell)
 	{
-		for (uint32_t i = 0; i < _collMgr.max && _collMgr.list[i] != NULL; ++i)
+		_collMgr->cellStart[cell] = _collMgr->cellStart[cell - 1];
+	}
+	_collMgr->cellStart[0] = 0;
+}
+
+/// <summary>
+/// Rebuilds the static BVH from every static entity currently in the list.
+/// </summary>
+static void _buildStaticBvh()
+{
+	uint32_t numStatic = 0;
+	for (uint32_t i = 0; i < _collMgr->count; ++i)
+	{
+		const Entity* entity = (const Entity*)objMgrGet(_collMgr->list[i]);
+		if (entity->isStatic)
 		{
-			Entity* otherEntity = _collMgr.list[i];
+			_collMgr->staticBounds[numStatic] = _getQueryBounds(entity);
+			_collMgr->staticIds[numStatic] = i;
+			++numStatic;
+		}
+	}
+
+	staticBvhBuild(_collMgr->staticBvh, _collMgr->staticBounds, _collMgr->staticIds, numStatic);
+	_collMgr->isStaticDirty = false;
+}
+
+/// <summary>
+/// Adds an entity to any cells its bounds have been pushed into since it was last added to the grid. Responses only ever
+/// push entities a little way, so an entity that moved is left listed in the cells it moved out of too, which costs
+/// nothing but a candidate the narrowphase rules out.
+/// </summary>
+/// <param name="handle"></param>
+static void _regridEntity(ObjHandle handle)
+{
+	const Entity* entity = (const Entity*)objMgrGet(handle);
+	if (entity == NULL || !entity->obj.enabled || entity->isStatic) { return; }
+	const uint32_t index = entity->_collIndex;
+	if (index >= _collMgr->count || _collMgr->list[index] != handle) { return; }
 
-			// Make sure we don't detect collisions with ourself
-			if (otherEntity->obj.enabled && entity != otherEntity)
+	const Bounds2D bounds = _getQueryBounds(entity);
+	const GridRange range = _getGridRange(&bounds);
+	GridRange old = _collMgr->ranges[index];
+	if (range.minX >= old.minX && range.maxX <= old.maxX && range.minY >= old.minY && range.maxY <= old.maxY) { return; }
+
+	for (uint32_t y = range.minY; y <= range.maxY; ++y)
+	{
+		for (uint32_t x = range.minX; x <= range.maxX; ++x)
+		{
+			if (x < old.minX || x > old.maxX || y < old.minY || y > old.maxY)
 			{
-				// Check for collision with this object (just do AABB)
-				Collision collDetResult = _detectCollision(entity, _collMgr.list[i]);
+				_addOverflow(y * _collMgr->cellsX + x, index);
+			}
+		}
+	}
+
+	// Its cells are no longer a rectangle, but the bounding rectangle only gets in the way of adding it to cells it's already in
+	if (old.minX > old.maxX) { old = range; }
+	if (range.minX < old.minX) { old.minX = range.minX; }
+	if (range.minY < old.minY) { old.minY = range.minY; }
+	if (range.maxX > old.maxX) { old.maxX = range.maxX; }
+	if (range.maxY > old.maxY) { old.maxY = range.maxY; }
+	_collMgr->ranges[index] = old;
+}
+
+/// <summary>
+/// Adds a list index to the front of a cell's overflow list, growing the pool of overflow entries if it has run out.
+/// </summary>
+/// <param name="cell"></param>
+/// <param name="index"></param>
+static void _addOverflow(uint32_t cell, uint32_t index)
+{
+	if (_collMgr->numOverflow == _collMgr->overflowCapacity)
+	{
+		const uint32_t capacity = _collMgr->overflowCapacity * 2;
+		uint32_t* indices = (uint32_t*)realloc(_collMgr->overflowIndices, capacity * sizeof(uint32_t));
+		uint32_t* next = (uint32_t*)realloc(_collMgr->overflowNext, capacity * sizeof(uint32_t));
+		assert(indices != NULL && next != NULL);
+		_collMgr->overflowIndices = indices;
+		_collMgr->overflowNext = next;
+		_collMgr->overflowCapacity = capacity;
+	}
+
+	const uint32_t entry = _collMgr->numOverflow++;
+	_collMgr->overflowIndices[entry] = index;
+	_collMgr->overflowNext[entry] = _collMgr->cellOverflow[cell];
+	_collMgr->cellOverflow[cell] = entry;
+}
+
+/// <summary>
+/// The entity's bounds, w/ just enough slack that the narrowphase can't find an overlap they miss.
+/// </summary>
+/// <param name="entity"></param>
+/// <returns></returns>
+static Bounds2D _getQueryBounds(const Entity* const entity)
+{
+	const float halfWidth = entity->obj.size.x / 2 + GRID_SLACK;
+	const float halfHeight = entity->obj.size.y / 2 + GRID_SLACK;
+
+	Bounds2D bounds = {
+		.topLeft = { .x = entity->obj.position.x - halfWidth, .y = entity->obj.position.y - halfHeight },
+		.botRight = { .x = entity->obj.position.x + halfWidth, .y = entity->obj.position.y + halfHeight }
+	};
+	return bounds;
+}
+
+/// <summary>
+/// Converts a screen coordinate to a grid cell coordinate, clamped to the grid.
+/// </summary>
+/// <param name="coordinate"></param>
+/// <param name="numCells"></param>
+/// <returns>The cell coordinate along that axis.</returns>
+static inline uint16_t _getGridCell(float coordinate, uint16_t numCells)
+{
+	const float cell = coordinate / _collMgr->cellSize;
+	if (cell < 0.0f) { return 0; }
+	if (cell >= (float)numCells) { return numCells - 1; }
+	return (uint16_t)cell;
+}
 
-				if (collDetResult.isColliding)
+/// <summary>
+/// Finds the range of grid cells overlapped by some bounds. Anything off screen is clamped to the edge cells.
+/// </summary>
+/// <param name="bounds"></param>
+/// <returns>The inclusive range of cells.</returns>
+static GridRange _getGridRange(const Bounds2D* const bounds)
+{
+	GridRange range = {
+		.minX = _getGridCell(bounds->topLeft.x, _collMgr->cellsX),
+		.minY = _getGridCell(bounds->topLeft.y, _collMgr->cellsY),
+		.maxX = _getGridCell(bounds->botRight.x, _collMgr->cellsX),
+		.maxY = _getGridCell(bounds->botRight.y, _collMgr->cellsY)
+	};
+	return range;
+}
+
+/// <summary>
+/// Finds the area a range of grid cells covers. The edge cells also hold everything off screen past them, so they reach out forever.
+/// </summary>
+/// <param name="range"></param>
+/// <returns></returns>
+static Bounds2D _getRangeBounds(GridRange range)
+{
+	const float cellSize = _collMgr->cellSize;
+	Bounds2D bounds = {
+		.topLeft = { .x = range.minX > 0 ? range.minX * cellSize : -FLT_MAX, .y = range.minY > 0 ? range.minY * cellSize : -FLT_MAX },
+		.botRight = {
+			.x = range.maxX + 1 < _collMgr->cellsX ? (range.maxX + 1) * cellSize : FLT_MAX,
+			.y = range.maxY + 1 < _collMgr->cellsY ? (range.maxY + 1) * cellSize : FLT_MAX
+		}
+	};
+	return bounds;
+}
+
+/// <summary>
+/// Appends the list index of every entity in a range of grid cells, and every static entity overlapping them, that the current
+/// query hasn't gathered yet.
+/// </summary>
+/// <param name="range"></param>
+/// <param name="skip"> - Cells the query has gathered from already.</param>
+/// <param name="stamp"> - The current query's.</param>
+/// <param name="numCandidates"> - How many candidates the query has already.</param>
+/// <returns>The number of candidates now.</returns>
+static uint32_t _gatherCandidates(GridRange range, GridRange skip, uint32_t stamp, uint32_t numCandidates)
+{
+	for (uint32_t y = range.minY; y <= range.maxY; ++y)
+	{
+		for (uint32_t x = range.minX; x <= range.maxX; ++x)
+		{
+			if (x >= skip.minX && x <= skip.maxX && y >= skip.minY && y <= skip.maxY) { continue; }
+
+			const uint32_t cell = y * _collMgr->cellsX + x;
+			for (uint32_t entry = _collMgr->cellStart[cell]; entry < _collMgr->cellStart[cell + 1]; ++entry)
+			{
+				const uint32_t index = _collMgr->cellEntries[entry];
+				if (_collMgr->queryStamps[index] != stamp)
+				{
+					_collMgr->queryStamps[index] = stamp;
+					_collMgr->candidates[numCandidates++] = index;
+				}
+			}
+			for (uint32_t entry = _collMgr->cellOverflow[cell]; entry != GRID_NONE; entry = _collMgr->overflowNext[entry])
+			{
+				const uint32_t index = _collMgr->overflowIndices[entry];
+				if (_collMgr->queryStamps[index] != stamp)
 				{
-					// This needs to react appropriately now
-					// Just jump directly to "this" object's collide function (pass otherObject + Collision)
-					entity->obj.vtable->collide((Object*)entity, (Object*)_collMgr.list[i], collDetResult);
+					_collMgr->queryStamps[index] = stamp;
+					_collMgr->candidates[numCandidates++] = index;
 				}
 			}
 		}
 	}
+
+	// Static entities are only ever in the BVH, but a query made again can find the same ones
+	const Bounds2D bounds = _getRangeBounds(range);
+	const uint32_t room = 2 * _collMgr->max - numCandidates;
+	const uint32_t numStatic = staticBvhQuery(_collMgr->staticBvh, &bounds, &_collMgr->candidates[numCandidates], room);
+	assert(numStatic <= room);
+	const uint32_t end = numCandidates + numStatic;
+	for (uint32_t i = numCandidates; i < end; ++i)
+	{
+		const uint32_t index = _collMgr->candidates[i];
+		if (_collMgr->queryStamps[index] != stamp)
+		{
+			_collMgr->queryStamps[index] = stamp;
+			_collMgr->candidates[numCandidates++] = index;
+		}
+	}
+
+	return numCandidates;
+}
+
+/// <summary>
+/// Sorts a range of freshly gathered candidates into list order, so collision responses happen in the same order as a full scan
+/// would produce them, and looks up their handles. Handles are what's held on to, since a response removing an entity moves another
+/// into its index. A static slot can also be stale for the rest of the update if a response removed a static entity.
+/// </summary>
+/// <param name="first"></param>
+/// <param name="end"></param>
+/// <returns>The end of the range, once any stale slots are dropped.</returns>
+static uint32_t _prepareCandidates(uint32_t first, uint32_t end)
+{
+	_sortCandidates(&_collMgr->candidates[first], end - first);
+
+	uint32_t numKept = first;
+	for (uint32_t i = first; i < end; ++i)
+	{
+		const uint32_t index = _collMgr->candidates[i];
+		if (index < _collMgr->count)
+		{
+			_collMgr->candidates[numKept] = index;
+			_collMgr->handles[numKept++] = _collMgr->list[index];
+		}
+	}
+	return numKept;
 }
 
+/// <summary>
+/// Queries again for an entity a response has pushed into cells its query didn't cover. Only the new candidates after the
+/// current one in list order are kept, merged in among the rest, as a full scan would only reach those from here on.
+/// </summary>
+/// <param name="range"> - The cells to cover now.</param>
+/// <param name="skip"> - The cells already gathered from.</param>
+/// <param name="stamp"> - The entity's query's.</param>
+/// <param name="current"> - The candidate whose response pushed the entity.</param>
+/// <param name="numCandidates"></param>
+/// <returns>The number of candidates now.</returns>
+static uint32_t _gatherMoreCandidates(GridRange range, GridRange skip, uint32_t stamp, uint32_t current, uint32_t numCandidates)
+{
+	const uint32_t currentIndex = _collMgr->candidates[current];
+	uint32_t end = _gatherCandidates(range, skip, stamp, numCandidates);
+	uint32_t numNew = numCandidates;
+	for (uint32_t i = numCandidates; i < end; ++i)
+	{
+		if (_collMgr->candidates[i] > currentIndex)
+		{
+			_collMgr->candidates[numNew++] = _collMgr->candidates[i];
+		}
+	}
+	end = _prepareCandidates(numCandidates, numNew);
+	if (end == numCandidates)
+	{
+		return numCandidates;
+	}
+
+	// Merge the new candidates into the ones still to come
+	uint32_t left = current + 1;
+	uint32_t right = numCandidates;
+	uint32_t out = 0;
+	while (left < numCandidates || right < end)
+	{
+		const uint32_t from = right >= end || (left < numCandidates && _collMgr->candidates[left] <= _collMgr->candidates[right]) ? left++ : right++;
+		_collMgr->sortScratch[out] = _collMgr->candidates[from];
+		_collMgr->handleScratch[out++] = _collMgr->handles[from];
+	}
+	memcpy(&_collMgr->candidates[current + 1], _collMgr->sortScratch, out * sizeof(uint32_t));
+	memcpy(&_collMgr->handles[current + 1], _collMgr->handleScratch, out * sizeof(ObjHandle));
+	return end;
+}
 
 /// <summary>
-/// Detects whether a collision is occurring between the two passed in entities.
+/// Sorts the gathered candidate indices. Each grid cell lists its entries in list order, so the candidates arrive as a
+/// few sorted runs: merge neighbouring runs pairwise until one is left, ping-ponging with the scratch buffer.
+/// Entities pushed into cells since the grid was built arrive out of order though, so when there are enough candidates for
+/// the span of indices they cover, they're set as bits instead and read back in order.
 /// </summary>
-/// <param name="thisEntity"></param>
-/// <param name="otherEntity"></param>
-/// <returns>Information relating to the collision that may have occurred.</returns>
-Collision _detectCollision(const Entity* const thisEntity, const Entity* const otherEntity)
+/// <param name="candidates"></param>
+/// <param name="numCandidates"></param>
+static void _sortCandidates(uint32_t* candidates, uint32_t numCandidates)
 {
-	assert(thisEntity != NULL && otherEntity != NULL);
+	if (numCandidates > 32)
+	{
+		uint32_t lowest = UINT32_MAX;
+		uint32_t highest = 0;
+		for (uint32_t i = 0; i < numCandidates; ++i)
+		{
+			if (candidates[i] < lowest) { lowest = candidates[i]; }
+			if (candidates[i] > highest) { highest = candidates[i]; }
+		}
+
+		const uint32_t firstWord = lowest / 64;
+		const uint32_t endWord = highest / 64 + 1;
+		if (endWord - firstWord <= numCandidates * 2)
+		{
+			uint64_t* bits = _collMgr->sortBits;
+			for (uint32_t i = 0; i < numCandidates; ++i)
+			{
+				bits[candidates[i] / 64] |= 1ull << (candidates[i] % 64);
+			}
+
+			// Candidates are unique, so this gives them all back; clear the bits while reading them
+			uint32_t out = 0;
+			for (uint32_t word = firstWord; word < endWord; ++word)
+			{
+				unsigned long bit;
+				while (_BitScanForward64(&bit, bits[word]))
+				{
+					candidates[out++] = word * 64 + bit;
+					bits[word] &= bits[word] - 1;
+				}
+			}
+			return;
+		}
+	}
+
+	uint32_t* source = candidates;
+	uint32_t* destination = _collMgr->sortScratch;
+
+	while (numCandidates > 1)
+	{
+		uint32_t out = 0;
+		uint32_t start = 0;
+		while (start < numCandidates)
+		{
+			// Find two neighbouring runs
+			uint32_t middle = start + 1;
+			while (middle < numCandidates && source[middle - 1] <= source[middle])
+			{
+				++middle;
+			}
+			if (start == 0 && middle >= numCandidates)
+			{
+				// Down to one run
+				if (source != candidates)
+				{
+					memcpy(candidates, source, numCandidates * sizeof(uint32_t));
+				}
+				return;
+			}
+			uint32_t end = middle;
+			while (end < numCandidates && (end == middle || source[end - 1] <= source[end]))
+			{
+				++end;
+			}
 
-	Collision resultingCollision = { .isColliding = false, .delta = {1.0f, 1.0f}, .intersect = {1.0f, 1.0f} };
+			// Merge them
+			uint32_t left = start;
+			uint32_t right = middle;
+			while (left < middle && right < end)
+			{
+				destination[out++] = source[left] <= source[right] ? source[left++] : source[right++];
+			}
+			while (left < middle)
+			{
+				destination[out++] = source[left++];
+			}
+			while (right < end)
+			{
+				destination[out++] = source[right++];
+			}
+			start = end;
+		}
 
-	Coord2D thisPosition = thisEntity->obj.position;
-	Coord2D thisHalfSize = { .x = thisEntity->obj.size.x / 2, .y = thisEntity->obj.size.y / 2 };
-	Coord2D otherPosition = otherEntity->obj.position;
-	Coord2D otherHalfSize = { .x = otherEntity->obj.size.x / 2, .y = otherEntity->obj.size.y / 2 };
+		uint32_t* swap = source;
+		source = destination;
+		destination = swap;
+	}
+}
 
-	float deltaX = otherPosition.x - thisPosition.x;
-	float deltaY = otherPosition.y - thisPosition.y;
+/// <summary>
+/// Copies the boxes of a range of the gathered candidates into the narrowphase batch.
+/// The entity itself, and candidates removed by an earlier response, get a negative size so they can never be hit.
+/// </summary>
+/// <param name="entity"></param>
+/// <param name="first"></param>
+/// <param name="end"></param>
+static void _fillBatch(const Entity* const entity, uint32_t first, uint32_t end)
+{
+	CollisionBatch* batch = _collMgr->batch;
+	for (uint32_t i = first; i < end; ++i)
+	{
+		const Entity* otherEntity = (const Entity*)objMgrGet(_collMgr->handles[i]);
+		if (otherEntity != NULL && otherEntity != entity)
+		{
+			batch->centerX[i] = otherEntity->obj.position.x;
+			batch->centerY[i] = otherEntity->obj.position.y;
+			batch->halfWidth[i] = otherEntity->obj.size.x / 2;
+			batch->halfHeight[i] = otherEntity->obj.size.y / 2;
+		}
+		else
+		{
+			batch->centerX[i] = batch->centerY[i] = 0.0f;
+			batch->halfWidth[i] = batch->halfHeight[i] = -FLT_MAX;
+		}
+	}
+}
 
-	float intersectX = (float)fabs(deltaX) - (thisHalfSize.x + otherHalfSize.x);
-	float intersectY = (float)fabs(deltaY) - (thisHalfSize.y + otherHalfSize.y);
+/// <summary>
+/// Tests the entity's current box against a range of the batched candidates.
+/// </summary>
+/// <param name="entity"></param>
+/// <param name="first"></param>
+/// <param name="count"></param>
+static void _detectCandidateCollisions(const Entity* const entity, uint32_t first, uint32_t count)
+{
+	const Coord2D halfSize = { .x = entity->obj.size.x / 2, .y = entity->obj.size.y / 2 };
+	detectCollisionBatch(entity->obj.position, halfSize, _collMgr->batch, first, count);
+}
 
-	resultingCollision.delta.x = deltaX;
-	resultingCollision.delta.y = deltaY;
-	resultingCollision.intersect.x = intersectX;
-	resultingCollision.intersect.y = intersectY;
+/// <summary>
+/// Checks for and handles all collisions occurring on the passed in entity.
+///		<para>
+/// Every candidate is tested at once, then the hits are handled in list order. A response can move the entity, which makes the results
+/// for the candidates still to come stale, so from then on they are re-tested a lane group at a time as the walk reaches them.
+/// That gives the same results as testing them one by one, without re-testing the whole rest of the batch after every response.
+/// Moving the entity (or the one it hit) can also take it into cells it wasn't gathered or inserted from, so both are re-gridded,
+/// and the entity queries whichever cells it reaches that it hasn't yet. Only the entity and its candidates move while it's handled,
+/// so the cells it has queried can't have gained anything it doesn't have.
+///		</para>
+/// </summary>
+/// <param name="entity"></param>
+static void _handleCollisions(Entity* entity)
+{
+	const ObjHandle handle = objGetHandle(&entity->obj);
+	const uint32_t stamp = ++_collMgr->queryStamp;
+	const Bounds2D startBounds = _getQueryBounds(entity);
+	GridRange queried = _getGridRange(&startBounds);
+	uint32_t numCandidates = _prepareCandidates(0, _gatherCandidates(queried, GRID_RANGE_EMPTY, stamp, 0));
+	_fillBatch(entity, 0, numCandidates);
+	_detectCandidateCollisions(entity, 0, numCandidates);
 
-	if (intersectX < 0.0f && intersectY < 0.0f)
+	uint32_t testedUntil = numCandidates;	// results from here on were tested against an older box of the entity's
+	for (uint32_t i = 0; i < numCandidates; ++i)
 	{
-		resultingCollision.isColliding = true;
+		if (i >= testedUntil)
+		{
+			const uint32_t count = numCandidates - i < COLLISION_BATCH_LANES ? numCandidates - i : COLLISION_BATCH_LANES;
+			_detectCandidateCollisions(entity, i, count);
+			testedUntil = i + count;
+		}
+		if (!collisionBatchIsHit(_collMgr->batch, i)) { continue; }
+
+		// An earlier response may have disabled it since the batch was filled
+		Entity* otherEntity = (Entity*)objMgrGet(_collMgr->handles[i]);
+		if (otherEntity != NULL && otherEntity->obj.enabled)
+		{
+			// Just jump directly to "this" object's collide function (pass otherObject + Collision)
+			entity->obj.vtable->collide((Object*)entity, (Object*)otherEntity, collisionBatchGet(_collMgr->batch, i));
+			testedUntil = i + 1;
+
+			_regridEntity(_collMgr->handles[i]);
+			_regridEntity(handle);
+			if (objMgrGet(handle) == NULL) { continue; }
+
+			const Bounds2D bounds = _getQueryBounds(entity);
+			GridRange range = _getGridRange(&bounds);
+			if (range.minX < queried.minX || range.minY < queried.minY || range.maxX > queried.maxX || range.maxY > queried.maxY)
+			{
+				// Cover the cells queried too, so what's been gathered from stays a rectangle
+				if (queried.minX < range.minX) { range.minX = queried.minX; }
+				if (queried.minY < range.minY) { range.minY = queried.minY; }
+				if (queried.maxX > range.maxX) { range.maxX = queried.maxX; }
+				if (queried.maxY > range.maxY) { range.maxY = queried.maxY; }
+
+				const uint32_t end = _gatherMoreCandidates(range, queried, stamp, i, numCandidates);
+				_fillBatch(entity, i + 1, end);
+				numCandidates = end;
+				queried = range;
+			}
+		}
 	}
-	return resultingCollision;
 }
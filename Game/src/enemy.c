@@ -1,10 +1,14 @@
 #include <math.h>
 #include <stdlib.h>
+#include <assert.h>
 
 #include "enemy.h"
 #include "random.h"
 #include "animation.h"
 #include "joustGlobalConstants.h"
+#include "objmgr.h"
+#include "pool.h"
+#include "world.h"
 
 
 #define ENEMY_ANIM_WING_UP_FRAME	1
@@ -16,6 +20,7 @@ typedef struct enemy_t {
 	
 	EnemyType			enemyType;
 
+	RandStream			_random;	// its own, so the AI's decisions don't depend on the order enemies update in
 	uint32_t			_msPerDirection;
 	uint32_t			_msDirectionCounter;
 	uint32_t			_msPerFlap;
@@ -71,47 +76,55 @@ static Animation* _animShadowLordRunSlowing = NULL;
 static Animation* _animShadowLordFlying = NULL;
 
 
-static const Player* _playerReference = NULL;
+// The current world's
+static WORLD_LOCAL ObjHandle _playerReference = OBJ_HANDLE_INVALID;
+
+static WORLD_LOCAL Pool* _enemyPool = NULL;
 
 
 static EnemyActionCB _enemyActionCB = NULL;
 
 
 static void _enemyTriggerEnemyActionCB(const char* action);
+static void _enemyGetAnimations(const Enemy* const enemy, const Animation** animIdle, const Animation** animRun, const Animation** animRunSlow, const Animation** animFly);
+static void _enemyAdvanceAnimation(Enemy* enemy, const Animation* animIdle, const Animation* animRun, const Animation* animRunSlow, const Animation* animFly);
 
 
 // =============== vTable ===============
-static void _enemyDraw(Object* obj);
+static void _enemyDraw(const Object* obj);
 static void _enemyUpdate(Object* obj, uint32_t milliseconds);
 static void _enemyCollide(Object* thisObj, Object* otherObj, Collision collision); //now deprecated
+static void _enemyLateUpdate(Object* obj, uint32_t milliseconds);
 static ObjVtable _enemyVtable = {
 	enemyDelete,
 	_enemyDraw,
-	_enemyUpdate,
-	_enemyCollide
+	NULL,
+	_enemyCollide,
+	_enemyLateUpdate,
+	_enemyUpdate		// only reads the player, and writes nothing but the enemy itself
 };
 
 
 /// <summary>
 /// Initializes all enemy animations.
 /// </summary>
-/// <param name="sheet"></param>
-void enemyInitAnimations(const SpriteSheet* const sheet)
+/// <param name="sheetIndex"> - Which of the sprite atlas's sheets the animations are on.</param>
+void enemyInitAnimations(uint8_t sheetIndex)
 {
-	_animBounderIdle = animationNew(ENEMY_BOUNDER_ANIMATION_IDLE_NUM_FRAMES, sheet, ENEMY_BOUNDER_ANIMATION_IDLE_FIRST_SPRITE_BOUNDS, ENEMY_BOUNDER_ANIMATION_IDLE_PIXELS_BETWEEN_FRAMES, 0);
-	_animBounderRunning = animationNew(ENEMY_BOUNDER_ANIMATION_RUNNING_NUM_FRAMES, sheet, ENEMY_BOUNDER_ANIMATION_RUNNING_FIRST_SPRITE_BOUNDS, ENEMY_BOUNDER_ANIMATION_RUNNING_PIXELS_BETWEEN_FRAMES, 0);
-	_animBounderRunSlowing = animationNew(ENEMY_BOUNDER_ANIMATION_RUNSLOWING_NUM_FRAMES, sheet, ENEMY_BOUNDER_ANIMATION_RUNSLOWING_FIRST_SPRITE_BOUNDS, ENEMY_BOUNDER_ANIMATION_RUNSLOWING_PIXELS_BETWEEN_FRAMES, 0);
-	_animBounderFlying = animationNew(ENEMY_BOUNDER_ANIMATION_FLYING_NUM_FRAMES, sheet, ENEMY_BOUNDER_ANIMATION_FLYING_FIRST_SPRITE_BOUNDS, ENEMY_BOUNDER_ANIMATION_FLYING_PIXELS_BETWEEN_FRAMES, 0);
-
-	_animHunterIdle = animationNew(ENEMY_HUNTER_ANIMATION_IDLE_NUM_FRAMES, sheet, ENEMY_HUNTER_ANIMATION_IDLE_FIRST_SPRITE_BOUNDS, ENEMY_HUNTER_ANIMATION_IDLE_PIXELS_BETWEEN_FRAMES, 0);
-	_animHunterRunning = animationNew(ENEMY_HUNTER_ANIMATION_RUNNING_NUM_FRAMES, sheet, ENEMY_HUNTER_ANIMATION_RUNNING_FIRST_SPRITE_BOUNDS, ENEMY_HUNTER_ANIMATION_RUNNING_PIXELS_BETWEEN_FRAMES, 0);
-	_animHunterRunSlowing = animationNew(ENEMY_HUNTER_ANIMATION_RUNSLOWING_NUM_FRAMES, sheet, ENEMY_HUNTER_ANIMATION_RUNSLOWING_FIRST_SPRITE_BOUNDS, ENEMY_HUNTER_ANIMATION_RUNSLOWING_PIXELS_BETWEEN_FRAMES, 0);
-	_animHunterFlying = animationNew(ENEMY_HUNTER_ANIMATION_FLYING_NUM_FRAMES, sheet, ENEMY_HUNTER_ANIMATION_FLYING_FIRST_SPRITE_BOUNDS, ENEMY_HUNTER_ANIMATION_FLYING_PIXELS_BETWEEN_FRAMES, 0);
-
-	_animShadowLordIdle = animationNew(ENEMY_SHADOWLORD_ANIMATION_IDLE_NUM_FRAMES, sheet, ENEMY_SHADOWLORD_ANIMATION_IDLE_FIRST_SPRITE_BOUNDS, ENEMY_SHADOWLORD_ANIMATION_IDLE_PIXELS_BETWEEN_FRAMES, 0);
-	_animShadowLordRunning = animationNew(ENEMY_SHADOWLORD_ANIMATION_RUNNING_NUM_FRAMES, sheet, ENEMY_SHADOWLORD_ANIMATION_RUNNING_FIRST_SPRITE_BOUNDS, ENEMY_SHADOWLORD_ANIMATION_RUNNING_PIXELS_BETWEEN_FRAMES, 0);
-	_animShadowLordRunSlowing = animationNew(ENEMY_SHADOWLORD_ANIMATION_RUNSLOWING_NUM_FRAMES, sheet, ENEMY_SHADOWLORD_ANIMATION_RUNSLOWING_FIRST_SPRITE_BOUNDS, ENEMY_SHADOWLORD_ANIMATION_RUNSLOWING_PIXELS_BETWEEN_FRAMES, 0);
-	_animShadowLordFlying = animationNew(ENEMY_SHADOWLORD_ANIMATION_FLYING_NUM_FRAMES, sheet, ENEMY_SHADOWLORD_ANIMATION_FLYING_FIRST_SPRITE_BOUNDS, ENEMY_SHADOWLORD_ANIMATION_FLYING_PIXELS_BETWEEN_FRAMES, 0);
+	_animBounderIdle = animationNew(ENEMY_BOUNDER_ANIMATION_IDLE_NUM_FRAMES, sheetIndex, ENEMY_BOUNDER_ANIMATION_IDLE_FIRST_SPRITE_BOUNDS, ENEMY_BOUNDER_ANIMATION_IDLE_PIXELS_BETWEEN_FRAMES, 0);
+	_animBounderRunning = animationNew(ENEMY_BOUNDER_ANIMATION_RUNNING_NUM_FRAMES, sheetIndex, ENEMY_BOUNDER_ANIMATION_RUNNING_FIRST_SPRITE_BOUNDS, ENEMY_BOUNDER_ANIMATION_RUNNING_PIXELS_BETWEEN_FRAMES, 0);
+	_animBounderRunSlowing = animationNew(ENEMY_BOUNDER_ANIMATION_RUNSLOWING_NUM_FRAMES, sheetIndex, ENEMY_BOUNDER_ANIMATION_RUNSLOWING_FIRST_SPRITE_BOUNDS, ENEMY_BOUNDER_ANIMATION_RUNSLOWING_PIXELS_BETWEEN_FRAMES, 0);
+	_animBounderFlying = animationNew(ENEMY_BOUNDER_ANIMATION_FLYING_NUM_FRAMES, sheetIndex, ENEMY_BOUNDER_ANIMATION_FLYING_FIRST_SPRITE_BOUNDS, ENEMY_BOUNDER_ANIMATION_FLYING_PIXELS_BETWEEN_FRAMES, 0);
+
+	_animHunterIdle = animationNew(ENEMY_HUNTER_ANIMATION_IDLE_NUM_FRAMES, sheetIndex, ENEMY_HUNTER_ANIMATION_IDLE_FIRST_SPRITE_BOUNDS, ENEMY_HUNTER_ANIMATION_IDLE_PIXELS_BETWEEN_FRAMES, 0);
+	_animHunterRunning = animationNew(ENEMY_HUNTER_ANIMATION_RUNNING_NUM_FRAMES, sheetIndex, ENEMY_HUNTER_ANIMATION_RUNNING_FIRST_SPRITE_BOUNDS, ENEMY_HUNTER_ANIMATION_RUNNING_PIXELS_BETWEEN_FRAMES, 0);
+	_animHunterRunSlowing = animationNew(ENEMY_HUNTER_ANIMATION_RUNSLOWING_NUM_FRAMES, sheetIndex, ENEMY_HUNTER_ANIMATION_RUNSLOWING_FIRST_SPRITE_BOUNDS, ENEMY_HUNTER_ANIMATION_RUNSLOWING_PIXELS_BETWEEN_FRAMES, 0);
+	_animHunterFlying = animationNew(ENEMY_HUNTER_ANIMATION_FLYING_NUM_FRAMES, sheetIndex, ENEMY_HUNTER_ANIMATION_FLYING_FIRST_SPRITE_BOUNDS, ENEMY_HUNTER_ANIMATION_FLYING_PIXELS_BETWEEN_FRAMES, 0);
+
+	_animShadowLordIdle = animationNew(ENEMY_SHADOWLORD_ANIMATION_IDLE_NUM_FRAMES, sheetIndex, ENEMY_SHADOWLORD_ANIMATION_IDLE_FIRST_SPRITE_BOUNDS, ENEMY_SHADOWLORD_ANIMATION_IDLE_PIXELS_BETWEEN_FRAMES, 0);
+	_animShadowLordRunning = animationNew(ENEMY_SHADOWLORD_ANIMATION_RUNNING_NUM_FRAMES, sheetIndex, ENEMY_SHADOWLORD_ANIMATION_RUNNING_FIRST_SPRITE_BOUNDS, ENEMY_SHADOWLORD_ANIMATION_RUNNING_PIXELS_BETWEEN_FRAMES, 0);
+	_animShadowLordRunSlowing = animationNew(ENEMY_SHADOWLORD_ANIMATION_RUNSLOWING_NUM_FRAMES, sheetIndex, ENEMY_SHADOWLORD_ANIMATION_RUNSLOWING_FIRST_SPRITE_BOUNDS, ENEMY_SHADOWLORD_ANIMATION_RUNSLOWING_PIXELS_BETWEEN_FRAMES, 0);
+	_animShadowLordFlying = animationNew(ENEMY_SHADOWLORD_ANIMATION_FLYING_NUM_FRAMES, sheetIndex, ENEMY_SHADOWLORD_ANIMATION_FLYING_FIRST_SPRITE_BOUNDS, ENEMY_SHADOWLORD_ANIMATION_FLYING_PIXELS_BETWEEN_FRAMES, 0);
 }
 
 /// <summary>
@@ -159,16 +172,66 @@ void enemyDeinitAnimations()
 }
 
 
+/// <summary>
+/// Allocates room for the passed in number of enemies up front, so creating and deleting them doesn't touch the heap.
+/// The pool becomes the calling thread's current one.
+/// </summary>
+/// <param name="maxEnemys"></param>
+void enemyInitPool(uint32_t maxEnemys)
+{
+	_enemyPool = poolNew(sizeof(Enemy), maxEnemys);
+}
+
+/// <summary>
+/// Frees the enemy pool. Every enemy from the pool must have been deleted already.
+/// </summary>
+void enemyDeinitPool()
+{
+	assert(_enemyPool == NULL || poolGetCount(_enemyPool) == 0);
+	poolDelete(_enemyPool);
+	_enemyPool = NULL;
+}
+
+/// <summary>
+/// </summary>
+/// <returns>The calling thread's current enemy pool</returns>
+Pool* enemyGetPool()
+{
+	return _enemyPool;
+}
+
+/// <summary>
+/// Makes an enemy pool the calling thread's current one, which new enemies are allocated from.
+/// </summary>
+/// <param name="pool">from enemyGetPool, or NULL for none</param>
+void enemySetPool(Pool* pool)
+{
+	_enemyPool = pool;
+}
+
+/// <summary>
+/// Hands out the pool's enemies in order again, so the next wave's enemies are contiguous. Every enemy from the pool must have been deleted already.
+/// </summary>
+void enemyResetPool()
+{
+	assert(poolGetCount(_enemyPool) == 0);
+	poolReset(_enemyPool);
+}
+
+
 /// <summary>
 /// Creates a new enemy object based on the passed in type.
 /// </summary>
 /// <param name="startPos"></param>
 /// <param name="size"></param>
 /// <param name="type"></param>
+/// <param name="random">the stream the enemy's AI draws from</param>
 /// <returns></returns>
-Enemy* enemyNew(Coord2D startPos, Coord2D size, EnemyType type)
+Enemy* enemyNew(Coord2D startPos, Coord2D size, EnemyType type, RandStream random)
 {
-	Enemy* enemy = (Enemy*)malloc(sizeof(Enemy));
+	// Only fall back to the heap if more are alive than the pool was sized for
+	Enemy* enemy = _enemyPool != NULL ? (Enemy*)poolAlloc(_enemyPool) : NULL;
+	if (enemy == NULL) { enemy = (Enemy*)malloc(sizeof(Enemy)); }
 	if (enemy != NULL)
 	{
 		entityInit(&enemy->entity, &_enemyVtable, startPos, size);
@@ -180,11 +243,12 @@ Enemy* enemyNew(Coord2D startPos, Coord2D size, EnemyType type)
 		enemy->entity.flyingSize = ENEMY_SIZE_FLYING;
 		enemy->entity.flyingPosition = startPos;
 
+		enemy->_random = random;
 		enemy->_msDirectionCounter = 0;
 		enemy->_msFlapCounter = 0;
-		enemy->_msPerDirection = randGetInt(_MS_PER_DIRECTION_MIN, _MS_PER_DIRECTION_MAX);
-		enemy->_msPerFlap = randGetInt(_MS_PER_FLAP_MIN, _MS_PER_FLAP_MAX);
-		enemy->_currentDirection = (randGetInt(0, 2) == 0) ? false : true;
+		enemy->_msPerDirection = randGetInt(&enemy->_random, _MS_PER_DIRECTION_MIN, _MS_PER_DIRECTION_MAX);
+		enemy->_msPerFlap = randGetInt(&enemy->_random, _MS_PER_FLAP_MIN, _MS_PER_FLAP_MAX);
+		enemy->_currentDirection = (randGetInt(&enemy->_random, 0, 2) == 0) ? false : true;
 		enemy->_intendedDirection = enemy->_currentDirection;
 
 		enemy->_animation = NULL;
@@ -243,7 +307,9 @@ void enemyDelete(Object* enemy)
 	{
 		entityDeinit(&((Enemy*)enemy)->entity);
 	}
-	free(enemy);
+
+	if (poolOwns(_enemyPool, enemy)) { poolFree(_enemyPool, enemy); }
+	else { free(enemy); }
 }
 
 
@@ -251,93 +317,28 @@ void enemyDelete(Object* enemy)
 /// Draws the enemy onto the screen based on its internal state.
 /// </summary>
 /// <param name="obj"></param>
-static void _enemyDraw(Object* obj)
+static void _enemyDraw(const Object* obj)
 {
-	Enemy* enemy = (Enemy*)obj;
+	const Enemy* enemy = (const Enemy*)obj;
 
-	// Get the appropriate animations based on the enemy type
 	const Animation* animIdle = NULL;
 	const Animation* animRun = NULL;
 	const Animation* animRunSlow = NULL;
 	const Animation* animFly = NULL;
-	switch (enemy->enemyType)
-	{
-		case ENEMYTYPE_BOUNDER:
-		{
-			animIdle = _animBounderIdle;
-			animRun = _animBounderRunning;
-			animRunSlow = _animBounderRunSlowing;
-			animFly = _animBounderFlying;
-			break;
-		}
-		case ENEMYTYPE_HUNTER:
-		{
-			animIdle = _animHunterIdle;
-			animRun = _animHunterRunning;
-			animRunSlow = _animHunterRunSlowing;
-			animFly = _animHunterFlying;
-			break;
-		}
-		case ENEMYTYPE_SHADOWLORD:
-		{
-			animIdle = _animShadowLordIdle;
-			animRun = _animShadowLordRunning;
-			animRunSlow = _animShadowLordRunSlowing;
-			animFly = _animShadowLordFlying;
-			break;
-		}
-		default:
-		{
-			assert(false);
-			break;
-		}
-	}
+	_enemyGetAnimations(enemy, &animIdle, &animRun, &animRunSlow, &animFly);
 
-	// Get the appropriate animation speed/timer based on the enemy's current animation
-	uint32_t animationSpeed = 0;
-	uint32_t* animationTimer = NULL;
 	Coord2D enemySize = enemy->entity.obj.size;
 	Coord2D enemyPos = enemy->entity.obj.position;
-	if (enemy->_animation == animIdle)
-	{
-		animationSpeed = enemy->_amSpeedMSIdle;
-		animationTimer = &enemy->_amTimerIdle;
-	}
-	else if (enemy->_animation == animRun)
-	{
-		animationSpeed = enemy->_amSpeedMSRun;
-		animationTimer = &enemy->_amTimerRun;
-	}
-	else if (enemy->_animation == animRunSlow)
-	{
-		animationSpeed = enemy->_amSpeedMSRunSlow;
-		animationTimer = &enemy->_amTimerRunSlow;
-	}
-	else if (enemy->_animation == animFly)
+	if (enemy->_animation == animFly)
 	{
-		animationSpeed = enemy->_amSpeedMSFly;
-		animationTimer = &enemy->_amTimerFly;
 		enemySize = enemy->entity.flyingSize;
 		enemyPos = enemy->entity.flyingPosition;
 	}
-	assert(animationTimer != NULL);
 
-	// Check if the animation should move to the next sprite frame
-	if (*animationTimer >= animationSpeed)
-	{
-		*animationTimer = 0;
-		if (++enemy->_amCurFrame >= enemy->_animation->numFrames)
-		{
-			if (enemy->_animation == animFly)
-			{
-				enemy->_amCurFrame = ENEMY_ANIM_WING_UP_FRAME;
-			}
-			else
-			{
-				enemy->_amCurFrame = 0;
-			}
-		}
-	}
+	// Draw between the last two updates
+	Coord2D interpolationOffset = objGetInterpolationOffset(obj);
+	enemyPos.x += interpolationOffset.x;
+	enemyPos.y += interpolationOffset.y;
 
 	// Draw the current sprite frame
 	animationDraw(enemy->_animation, enemy->_amCurFrame, enemyPos, enemySize, !enemy->_currentDirection);
@@ -361,7 +362,7 @@ static void _enemyDraw(Object* obj)
 }
 
 /// <summary>
-/// Updates the enemy based on its internal state. This involves setting the specific animation if necessary, updating the enemy's position and velocity, and performing AI behavior.
+/// Updates the enemy based on its internal state. This involves setting the specific animation if necessary, and performing AI behavior by steering the enemy's velocity (the physics manager integrates it afterwards).
 ///		<para>
 /// AI behavior is random unless the player is within sight of the enemy, in which case the enemy moves towards (and above) the player.
 ///		</para>
@@ -377,45 +378,20 @@ static void _enemyUpdate(Object* obj, uint32_t milliseconds)
 	const Animation* animRun = NULL;
 	const Animation* animRunSlow = NULL;
 	const Animation* animFly = NULL;
-	switch (enemy->enemyType)
-	{
-		case ENEMYTYPE_BOUNDER:
-		{
-			animIdle = _animBounderIdle;
-			animRun = _animBounderRunning;
-			animRunSlow = _animBounderRunSlowing;
-			animFly = _animBounderFlying;
-			break;
-		}
-		case ENEMYTYPE_HUNTER:
-		{
-			animIdle = _animHunterIdle;
-			animRun = _animHunterRunning;
-			animRunSlow = _animHunterRunSlowing;
-			animFly = _animHunterFlying;
-			break;
-		}
-		case ENEMYTYPE_SHADOWLORD:
-		{
-			animIdle = _animShadowLordIdle;
-			animRun = _animShadowLordRunning;
-			animRunSlow = _animShadowLordRunSlowing;
-			animFly = _animShadowLordFlying;
-			break;
-		}
-		default:
-		{
-			break;
-		}
-	}
+	_enemyGetAnimations(enemy, &animIdle, &animRun, &animRunSlow, &animFly);
 
-	// Radius check to player
-	Coord2D playerPosition = playerGetPositionGrounded(_playerReference);
+	// Radius check to player (who may no longer exist)
+	const Player* player = (const Player*)objMgrGet(_playerReference);
 	Coord2D enemyPosition = enemy->entity.obj.position;
+	Coord2D playerPosition = enemyPosition;
+	if (player != NULL)
+	{
+		playerPosition = playerGetPositionGrounded(player);
+	}
 		// If player/enemy are flying get their respective positions
-	if (playerGetGroundedState(_playerReference) == false)
+	if (player != NULL && playerGetGroundedState(player) == false)
 	{
-		playerPosition = playerGetPositionFlying(_playerReference);
+		playerPosition = playerGetPositionFlying(player);
 	}
 	if (enemy->entity.isGrounded == false)
 	{
@@ -423,7 +399,7 @@ static void _enemyUpdate(Object* obj, uint32_t milliseconds)
 	}
 
 	float distanceFromPlayerSquared = (float)pow(playerPosition.x - enemyPosition.x, 2) + (float)pow(playerPosition.y - enemyPosition.y, 2);
-	if (distanceFromPlayerSquared <= (float)pow(enemy->_sightRadius, 2) && objIsEnabled((Object*)_playerReference)) // Player is in sight, move towards them
+	if (distanceFromPlayerSquared <= (float)pow(enemy->_sightRadius, 2) && player != NULL && objIsEnabled((Object*)player)) // Player is in sight, move towards them
 	{
 		// Check for a necessary flap  (player is above enemy)
 		if (playerPosition.y <= enemyPosition.y)
@@ -481,7 +457,7 @@ static void _enemyUpdate(Object* obj, uint32_t milliseconds)
 		if (enemy->_msFlapCounter >= enemy->_msPerFlap)
 		{
 			enemy->_msFlapCounter = 0;
-			enemy->_msPerFlap = randGetInt(_MS_PER_FLAP_MIN, _MS_PER_FLAP_MAX);
+			enemy->_msPerFlap = randGetInt(&enemy->_random, _MS_PER_FLAP_MIN, _MS_PER_FLAP_MAX);
 
 			// Now flap
 			enemy->entity.velocity.y -= ENT_BALANCE_FLAP_SINGLE * ENT_DEFAULT_VELOCITY_CHANGE;
@@ -510,10 +486,10 @@ static void _enemyUpdate(Object* obj, uint32_t milliseconds)
 
 			// New random counter for changing direction
 			enemy->_msDirectionCounter = 0;
-			enemy->_msPerDirection = randGetInt(_MS_PER_DIRECTION_MIN, _MS_PER_DIRECTION_MAX);
+			enemy->_msPerDirection = randGetInt(&enemy->_random, _MS_PER_DIRECTION_MIN, _MS_PER_DIRECTION_MAX);
 		}
 
-		if (enemy->_currentDirection == false && enemy->entity.velocity.x != -(enemy->entity.terminalVelocity.x)) // I think the 2nd check here is irrelevant as velocity is already capped in entityDefaultUpdate
+		if (enemy->_currentDirection == false && enemy->entity.velocity.x != -(enemy->entity.terminalVelocity.x)) // I think the 2nd check here is irrelevant as velocity is already capped by the physics manager
 		{
 			enemy->entity.velocity.x -= ENT_DEFAULT_VELOCITY_CHANGE / ((enemy->entity.isGrounded) ? 1 : 2);
 		}
@@ -522,9 +498,24 @@ static void _enemyUpdate(Object* obj, uint32_t milliseconds)
 			enemy->entity.velocity.x += ENT_DEFAULT_VELOCITY_CHANGE / ((enemy->entity.isGrounded) ? 1 : 2);
 		}
 	}
+}
 
-	// Call the parent class's default update
-	entityDefaultUpdate(obj, milliseconds);
+/// <summary>
+/// Reacts to the enemy's integrated position and velocity, by updating its animation timers, facing direction and flying position,
+/// then moves its animation on a frame if the timer for it has run out. This is the only place frames advance, so the update reads
+/// the same frames however often the enemy's drawn.
+/// </summary>
+/// <param name="obj"></param>
+/// <param name="milliseconds"></param>
+static void _enemyLateUpdate(Object* obj, uint32_t milliseconds)
+{
+	Enemy* enemy = (Enemy*)obj;
+
+	const Animation* animIdle = NULL;
+	const Animation* animRun = NULL;
+	const Animation* animRunSlow = NULL;
+	const Animation* animFly = NULL;
+	_enemyGetAnimations(enemy, &animIdle, &animRun, &animRunSlow, &animFly);
 
 	// Update the animation speeds/timers accordingly
 	if (enemy->_animation == animIdle)
@@ -578,6 +569,8 @@ static void _enemyUpdate(Object* obj, uint32_t milliseconds)
 
 	// This will reset if the enemy is on top of a platform anyway
 	enemy->entity.isGrounded = false;
+
+	_enemyAdvanceAnimation(enemy, animIdle, animRun, animRunSlow, animFly);
 }
 
 /// <summary>
@@ -733,20 +726,115 @@ static void _enemyTriggerEnemyActionCB(const char* action)
 
 
 /// <summary>
-/// Sets a class reference to the player.
+/// Finds the animations belonging to the enemy's type.
+/// </summary>
+/// <param name="enemy"></param>
+/// <param name="animIdle"></param>
+/// <param name="animRun"></param>
+/// <param name="animRunSlow"></param>
+/// <param name="animFly"></param>
+static void _enemyGetAnimations(const Enemy* const enemy, const Animation** animIdle, const Animation** animRun, const Animation** animRunSlow, const Animation** animFly)
+{
+	switch (enemy->enemyType)
+	{
+		case ENEMYTYPE_BOUNDER:
+		{
+			*animIdle = _animBounderIdle;
+			*animRun = _animBounderRunning;
+			*animRunSlow = _animBounderRunSlowing;
+			*animFly = _animBounderFlying;
+			break;
+		}
+		case ENEMYTYPE_HUNTER:
+		{
+			*animIdle = _animHunterIdle;
+			*animRun = _animHunterRunning;
+			*animRunSlow = _animHunterRunSlowing;
+			*animFly = _animHunterFlying;
+			break;
+		}
+		case ENEMYTYPE_SHADOWLORD:
+		{
+			*animIdle = _animShadowLordIdle;
+			*animRun = _animShadowLordRunning;
+			*animRunSlow = _animShadowLordRunSlowing;
+			*animFly = _animShadowLordFlying;
+			break;
+		}
+		default:
+		{
+			break;
+		}
+	}
+}
+
+/// <summary>
+/// Moves the enemy's animation on to its next frame once the timer for the animation has run out. Flying loops back to the wing up frame.
+/// </summary>
+/// <param name="enemy"></param>
+/// <param name="animIdle"></param>
+/// <param name="animRun"></param>
+/// <param name="animRunSlow"></param>
+/// <param name="animFly"></param>
+static void _enemyAdvanceAnimation(Enemy* enemy, const Animation* animIdle, const Animation* animRun, const Animation* animRunSlow, const Animation* animFly)
+{
+	// Get the appropriate animation speed/timer based on the enemy's current animation
+	uint32_t animationSpeed = 0;
+	uint32_t* animationTimer = NULL;
+	if (enemy->_animation == animIdle)
+	{
+		animationSpeed = enemy->_amSpeedMSIdle;
+		animationTimer = &enemy->_amTimerIdle;
+	}
+	else if (enemy->_animation == animRun)
+	{
+		animationSpeed = enemy->_amSpeedMSRun;
+		animationTimer = &enemy->_amTimerRun;
+	}
+	else if (enemy->_animation == animRunSlow)
+	{
+		animationSpeed = enemy->_amSpeedMSRunSlow;
+		animationTimer = &enemy->_amTimerRunSlow;
+	}
+	else if (enemy->_animation == animFly)
+	{
+		animationSpeed = enemy->_amSpeedMSFly;
+		animationTimer = &enemy->_amTimerFly;
+	}
+	assert(animationTimer != NULL);
+
+	if (*animationTimer >= animationSpeed)
+	{
+		*animationTimer = 0;
+		if (++enemy->_amCurFrame >= enemy->_animation->numFrames)
+		{
+			if (enemy->_animation == animFly)
+			{
+				enemy->_amCurFrame = ENEMY_ANIM_WING_UP_FRAME;
+			}
+			else
+			{
+				enemy->_amCurFrame = 0;
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Sets the current world's reference to the player.
 /// </summary>
 /// <param name="player"></param>
 void enemySetPlayerReference(const Player* player)
 {
-	_playerReference = player;
+	_playerReference = objGetHandle((const Object*)player);
 }
 
 /// <summary>
-/// Clears the class reference to the player.
+/// Clears the current world's reference to the player.
 /// </summary>
 void enemyClearPlayerReference()
 {
-	_playerReference = NULL;
+	_playerReference = OBJ_HANDLE_INVALID;
 }
 
 /// <param name="enemy"></param>
@@ -11,7 +11,6 @@ float ENT_BALANCE_FLAP_MULTI = 2;
 float ENT_BALANCE_FLAP_SINGLE = 25;
 const float MAGIC_NUMBER_PLATFORMFLAP = 0.00005f; // This is here to put the entity always inside the top of a platform, so the "isGrounded" field is set while running
 
-static const float GRAVITY = 300;
 static const Coord2D DEFAULT_VELOCITY = { .x = 0, .y = 0 };
 static const Coord2D DEFAULT_TERMINAL_VELOCITY = { .x = 200, .y = 200 };
 static const CollisionResponse DEFAULT_COLLRESP = COLLRESP_NOTHING;
@@ -33,6 +32,7 @@ void entityInit(Entity* entity, ObjVtable* vtable, Coord2D pos, Coord2D size)
 	// Set the default values for this class
 	entity->awake = false;
 	entity->isGrounded = true;
+	entity->isStatic = false;
 	entity->velocity = DEFAULT_VELOCITY;
 	entity->terminalVelocity = DEFAULT_TERMINAL_VELOCITY;
 	entity->collresp = DEFAULT_COLLRESP;
@@ -55,61 +55,6 @@ void entityDeinit(Entity* entity)
 }
 
 
-/// <summary>
-/// Applies physics and gravity to an entity object based on its internal state. Checks for collision against game bounds (top/bottom = bounce | left/right = wrap).
-///		<para>
-/// Note: Also caps velocity based on the entity's internal terminal velocity.
-///		</para>
-/// </summary>
-/// <param name="obj"></param>
-/// <param name="milliseconds"></param>
-void entityDefaultUpdate(Object* obj, uint32_t milliseconds)
-{
-	Entity* entity = (Entity*)obj;
-
-	// Physics updates
-	float seconds = (float)milliseconds / 1000.0f;
-		// Check for velocity cap
-	entity->velocity.x = toolClampFloat(entity->velocity.x, -(entity->terminalVelocity.x), entity->terminalVelocity.x);
-	entity->velocity.y = toolClampFloat(entity->velocity.y, -(entity->terminalVelocity.y), entity->terminalVelocity.y);
-
-		// Initial position update
-	entity->obj.position.x += (entity->velocity.x * seconds);
-	entity->obj.position.y += (entity->velocity.y * seconds) + (0.5f * GRAVITY * (float)pow(seconds, 2));
-
-	// Check for game bounds
-	if (entity->obj.position.y + entity->obj.size.y / 2 > entity->gameBounds.botRight.y) //this will be where lava kills you? or probably not, as lava will be a collision box
-	{
-		entity->obj.position.y = entity->gameBounds.botRight.y - entity->obj.size.y / 2;
-		entity->velocity.y = 0;
-		entity->isGrounded = true;
-	}
-	else if (entity->obj.position.y - entity->obj.size.y / 2 < entity->gameBounds.topLeft.y)
-	{
-		entity->obj.position.y = entity->gameBounds.topLeft.y + entity->obj.size.y / 2;
-		entity->velocity.y = -(entity->velocity.y);
-	}
-
-		// Check for wall wrap
-	if (entity->obj.position.x < entity->gameBounds.topLeft.x)
-	{
-		float overlap = entity->gameBounds.topLeft.x - entity->obj.position.x;
-		entity->obj.position.x = entity->gameBounds.botRight.x - overlap;
-
-	}
-	else if (entity->obj.position.x > entity->gameBounds.botRight.x)
-	{
-		float overlap = entity->obj.position.x - entity->gameBounds.botRight.x;
-		entity->obj.position.x = entity->gameBounds.topLeft.x + overlap;
-	}
-
-	// Default obj update
-	objDefaultUpdate(obj, milliseconds);
-
-	// Apply gravity to velocity
-	entity->velocity.y += GRAVITY * seconds;
-}
-
 /// <summary>
 /// Handles collision response against platforms.
 /// </summary>
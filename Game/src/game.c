@@ -1,73 +1,107 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 #include <time.h>
 
 #include "baseTypes.h"
 #include "input.h"
 #include "application.h"
 #include "framework.h"
+#include "profiler.h"
 #include "sound.h"
 #include "levelmgr.h"
 #include "objmgr.h"
-#include "collisionMgr.h"
-
-
-#define LEVEL_INDEX_HISCORES		0
-#define LEVEL_INDEX_TITLE_SCREEN	1
-#define LEVEL_INDEX_FIRST_WAVE		2
+#include "spriteBatch.h"
+#include "assetLoader.h"
+#include "jobs.h"
+#include "world.h"
+#include "joustGlobalConstants.h"
 
 
 static uint8_t _numLevels = 1;
-static uint8_t _curWaveIndex = LEVEL_INDEX_FIRST_WAVE;
 
 
-static void _gameInit();
+static void _gameParseOptions(int argc, char* argv[], const char* positional[], uint32_t maxPositional);
+static bool _gameParseNumber(const char* text, uint64_t* value);
+static bool _gameStartInput(Application* app, uint32_t* seed);
+static void _gameInit(uint32_t seed);
 static void _gameShutdown();
-static void _gameDraw();
+static void _gameDraw(float interpolation);
+static void _gameRender();
 static void _gameUpdate(uint32_t milliseconds);
 
 
-// Level Order: hiscores (not implemented, will most likely just display your score), title, waves
-// Contains the first 30 specified waves, then last one is an "endless" wave consisting of Shadow Lords
-	// Has mostly the same as what I could find online. Wave 28 is different, and there are still some waves after 30 that do not seem formulaic. 
-	// Note that starting on wave 37, only Shadow Lords should appear (except for the wave after an egg wave). (Not coded)
-	// After wave 60 all waves should only contain Shadow Lords. (Not coded)
-static LevelDef _levelDefs[] = {	// { Leveltype, #Bounders, #Hunters, #ShadowLords }
-	{ LEVELTYPE_HISCORES,		0, 0, 0 },
-	{ LEVELTYPE_TITLE,			0, 0, 0 },		// Waves start below!
-	{ LEVELTYPE_WAVE,			3, 0, 0 },		// 1: "Prepare to Joust"
-	{ LEVELTYPE_WAVE,			4, 0, 0 },		
-	{ LEVELTYPE_WAVE,			6, 0, 0 },		
-	{ LEVELTYPE_WAVE,			3, 3, 0 },		
-	{ LEVELTYPE_WAVE,			0, 0, 1 },		// 5: EGG WAVE
-	{ LEVELTYPE_WAVE,			3, 3, 0 },		
-	{ LEVELTYPE_WAVE,			2, 4, 0 },		// 7: Survival Wave
-	{ LEVELTYPE_WAVE,			0, 6, 0 },		
-	{ LEVELTYPE_WAVE,			0, 6, 0 },		
-	{ LEVELTYPE_WAVE,			0, 0, 2 },		// 10: EGG WAVE
-	{ LEVELTYPE_WAVE,			3, 5, 0 },
-	{ LEVELTYPE_WAVE,			2, 6, 0 },		// 12: Survival Wave
-	{ LEVELTYPE_WAVE,			0, 7, 0 },
-	{ LEVELTYPE_WAVE,			0, 8, 0 },
-	{ LEVELTYPE_WAVE,			0, 0, 3 },		// 15: EGG WAVE
-	{ LEVELTYPE_WAVE,			0, 5, 1 },
-	{ LEVELTYPE_WAVE,			0, 5, 1 },		// 17: Survival
-	{ LEVELTYPE_WAVE,			0, 5, 1 },
-	{ LEVELTYPE_WAVE,			0, 4, 2 },
-	{ LEVELTYPE_WAVE,			0, 0, 4 },		// 20: EGG WAVE
-	{ LEVELTYPE_WAVE,			0, 3, 3 },
-	{ LEVELTYPE_WAVE,			0, 2, 4 },		// 22: Survival
-	{ LEVELTYPE_WAVE,			0, 2, 4 },
-	{ LEVELTYPE_WAVE,			0, 2, 4 },
-	{ LEVELTYPE_WAVE,			0, 0, 5 },		// 25: EGG WAVE
-	{ LEVELTYPE_WAVE,			0, 3, 5 },
-	{ LEVELTYPE_WAVE,			0, 3, 5 },		// 27: Survival
-	{ LEVELTYPE_WAVE,			0, 3, 5 },
-	{ LEVELTYPE_WAVE,			0, 3, 5 },
-	{ LEVELTYPE_WAVE,			0, 0, 6 },		// 30: EGG WAVE
-	{ LEVELTYPE_WAVE_ENDLESS,	0, 0, 6 }		// ENDLESS WAVE: Only Shadow Lords
-};
-static Level* _curLevel = NULL;
+static World* _world = NULL;
+static const char* _tracePath = NULL;	// where to dump the profiler's trace on shutdown, if anywhere
+static const char* _recordPath = NULL;	// where to record the session's input, if anywhere
+static const char* _replayPath = NULL;	// a recorded session to play back in place of live input
+static const char* _audioPath = NULL;	// where to record the audio mix as a WAV file, in place of playing it, if anywhere
+static uint32_t _numWorkers = JOBS_WORKERS_AUTO;	// worker threads for the job system
+static bool _isPipelined = false;	// render each frame on a thread of its own, while the next is simulated
+
+#ifdef FW_HEADLESS
+/// @brief Program Entry Point (headless)
+/// Usage: Game [updates] [milliseconds per fixed update] [-trace path] [-record path] [-replay path] [-audio path] [-workers count] [-pipelined]
+/// A replay runs until its recording ends unless a number of updates is given, and uses the recording's fixed step.
+/// @param argc 
+/// @param argv 
+/// @return 1 if a replay diverged from its recording, 2 if the command line was bad
+int main(int argc, char* argv[])
+{
+	const char GAME_NAME[] = "Joust (headless)";
+	const uint64_t DEFAULT_UPDATES = 100000;
+
+	const char* positional[2] = { NULL, NULL };
+	_gameParseOptions(argc, argv, positional, 2);
+	uint64_t maxUpdates = _replayPath != NULL ? 0 : DEFAULT_UPDATES;
+	uint64_t fixedStep = 0;
+	if ((positional[0] != NULL && !_gameParseNumber(positional[0], &maxUpdates)) ||
+		(positional[1] != NULL && (!_gameParseNumber(positional[1], &fixedStep) || fixedStep == 0 || fixedStep > UINT32_MAX)))
+	{
+		printf("Usage: %s [updates] [milliseconds per fixed update, at least 1] [-trace path] [-record path] [-replay path] [-audio path] [-workers count] [-pipelined]\n", argv[0]);
+		return 2;
+	}
+
+	Application* app = appNew(NULL, GAME_NAME, _gameDraw, _gameUpdate);
+	bool isDiverged = false;
+
+	if (app != NULL)
+	{
+		appSetMaxUpdates(app, maxUpdates);
+		if (fixedStep > 0) { appSetFixedStep(app, (uint32_t)fixedStep); }
+		appSetNumWorkers(app, _numWorkers);
+		appSetRenderFunc(app, _gameRender);
+		appSetPipelined(app, _isPipelined);
+		if (_audioPath != NULL) { appSetSoundSink(app, soundSinkNewWavFile(_audioPath)); }
+
+		GLWindow* window = fwInitWindow(app);
+		if (window != NULL)
+		{
+			uint32_t seed = (uint32_t)time(NULL);
+			if (_gameStartInput(app, &seed))
+			{
+				_gameInit(seed);
+
+				bool running = true;
+				while (running)
+				{
+					running = fwUpdateWindow(window);
+				}
+
+				_gameShutdown();
+				isDiverged = inputHasReplayDiverged();
+			}
+			fwShutdownWindow(window);
+		}
+
+		appDelete(app);
+	}
 
+	return isDiverged ? 1 : 0;
+}
+#else
 /// @brief Program Entry Point (WinMain)
+/// Command line: [-trace path] [-record path] [-replay path] [-audio path] [-workers count] [-pipelined]
 /// @param hInstance  
 /// @param hPrevInstance 
 /// @param lpCmdLine 
@@ -79,101 +113,195 @@ int WINAPI WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _
 
 	Application* app = appNew(hInstance, GAME_NAME, _gameDraw, _gameUpdate);
 
+	// The CRT has already split the command line up
+	_gameParseOptions(__argc, __argv, NULL, 0);
+
 	if (app != NULL)
 	{
+		appSetNumWorkers(app, _numWorkers);
+		appSetRenderFunc(app, _gameRender);
+		appSetPipelined(app, _isPipelined);
+		if (_audioPath != NULL) { appSetSoundSink(app, soundSinkNewWavFile(_audioPath)); }
+
 		GLWindow* window = fwInitWindow(app);
 		if (window != NULL)
 		{
-			_gameInit();
-
-			bool running = true;
-			while (running)
+			uint32_t seed = (uint32_t)time(NULL);
+			if (_gameStartInput(app, &seed))
 			{
-				running = fwUpdateWindow(window);
-			}
+				_gameInit(seed);
+
+				bool running = true;
+				while (running)
+				{
+					running = fwUpdateWindow(window);
+				}
 
-			_gameShutdown();
+				_gameShutdown();
+			}
 			fwShutdownWindow(window);
 		}
 
 		appDelete(app);
 	}
 }
+#endif
+
+/// @brief Picks the -trace, -record, -replay, -audio, -workers and -pipelined options out of the command line
+/// @param argc 
+/// @param argv 
+/// @param positional receives the arguments that aren't options, in order
+/// @param maxPositional 
+static void _gameParseOptions(int argc, char* argv[], const char* positional[], uint32_t maxPositional)
+{
+	uint32_t numPositional = 0;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-pipelined") == 0)
+		{
+			_isPipelined = true;
+		}
+		else if (argv[i][0] == '-' && i + 1 < argc)
+		{
+			if (strcmp(argv[i], "-trace") == 0) { _tracePath = argv[i + 1]; }
+			else if (strcmp(argv[i], "-record") == 0) { _recordPath = argv[i + 1]; }
+			else if (strcmp(argv[i], "-replay") == 0) { _replayPath = argv[i + 1]; }
+			else if (strcmp(argv[i], "-audio") == 0) { _audioPath = argv[i + 1]; }
+			else if (strcmp(argv[i], "-workers") == 0)
+			{
+				uint64_t numWorkers = 0;
+				if (_gameParseNumber(argv[i + 1], &numWorkers) && numWorkers <= UINT32_MAX) { _numWorkers = (uint32_t)numWorkers; }
+				else { printf("Bad worker count %s\n", argv[i + 1]); }
+			}
+			else { printf("Unknown option %s\n", argv[i]); }
+			++i;
+		}
+		else if (numPositional < maxPositional)
+		{
+			positional[numPositional++] = argv[i];
+		}
+	}
+}
+
+/// @brief Parses a whole command line argument as a decimal number
+/// @param text 
+/// @param value receives the number, if it is one
+/// @return false if it isn't, or has anything after it
+static bool _gameParseNumber(const char* text, uint64_t* value)
+{
+	char* end = NULL;
+	const unsigned long long number = strtoull(text, &end, 10);
+	if (text[0] < '0' || text[0] > '9' || *end != '\0')
+	{
+		return false;
+	}
+	*value = number;
+	return true;
+}
+
+/// @brief Starts recording and/or replaying the session's input, if asked to. A replay overrides the seed and fixed step.
+/// @param app 
+/// @param seed the seed to record, or receives the replay's
+/// @return false if the recording couldn't be started
+static bool _gameStartInput(Application* app, uint32_t* seed)
+{
+	if (_replayPath != NULL)
+	{
+		uint32_t fixedStep = 0;
+		if (!inputReplayStart(_replayPath, seed, &fixedStep) || fixedStep == 0)
+		{
+			printf("Couldn't replay %s\n", _replayPath);
+			return false;
+		}
+		appSetFixedStep(app, fixedStep);
+	}
+
+	// Recording a replay re-records it, with the replay's seed and step
+	if (_recordPath != NULL)
+	{
+		if (!inputRecordStart(_recordPath, *seed, appGetFixedStep(app)))
+		{
+			printf("Couldn't record to %s\n", _recordPath);
+			return false;
+		}
+	}
+
+	return true;
+}
 
 /// @brief Initialize code to run at application startup
-static void _gameInit()
+/// @param seed for every random stream in the game, which is recorded along with the input
+static void _gameInit(uint32_t seed)
 {
-	srand((unsigned int)time(NULL));
+	profilerSetEnabled(_tracePath != NULL);
 
 	const uint32_t MAX_OBJECTS = 500;
 	const uint32_t MAX_SOUNDS = 100;
-	objMgrInit(MAX_OBJECTS);
-	collisionMgrInit(MAX_OBJECTS);
-	levelMgrInit();
+	const uint32_t MAX_SPRITES = MAX_OBJECTS * 2;	// screen wrapping draws an object twice
+	spriteBatchInit(MAX_SPRITES);
+	_world = worldNew(LEVEL_DEFS, NUMBER_LEVEL_DEFS, MAX_OBJECTS, seed);
 
-	_curLevel = levelMgrLoad(&_levelDefs[LEVEL_INDEX_TITLE_SCREEN]);
+#ifdef FW_HEADLESS
+	// Nobody is around to press start, so go straight to the waves. Recordings always start from the title screen.
+	const bool isRecorded = _recordPath != NULL || _replayPath != NULL;
+	worldLoadLevel(_world, isRecorded ? WORLD_LEVEL_INDEX_TITLE_SCREEN : WORLD_LEVEL_INDEX_FIRST_WAVE);
+#else
+	worldLoadLevel(_world, WORLD_LEVEL_INDEX_TITLE_SCREEN);
 
 	ShowCursor(true);
+#endif
 }
 
 /// @brief Cleanup the game and free up any allocated resources
 static void _gameShutdown()
 {
-	levelMgrUnload(_curLevel);
+	if (_tracePath != NULL)
+	{
+		profilerWriteTrace(_tracePath);
+		profilerPrintStats(stdout);
+	}
+
+	worldDelete(_world);
+	_world = NULL;
+	spriteBatchShutdown();
+}
+
+/// @brief Records everything to draw for the current frame, for _gameRender to submit
+/// @param interpolation fraction of a fixed update since the last one, for smoothing movement
+static void _gameDraw(float interpolation) 
+{
+	profilerBeginZone("objMgrDraw");
+	objMgrDraw(interpolation);
+	profilerEndZone();
+
+	profilerBeginZone("levelMgrDraw");
+	levelMgrDraw(worldGetLevel(_world));
+	profilerEndZone();
 
-	levelMgrShutdown();
-	collisionMgrShutdown();
-	objMgrShutdown();
+	spriteBatchEndFrame();
 }
 
-/// @brief Draw everything to the screen for current frame
-static void _gameDraw() 
+/// @brief Submits the sprites the last draw recorded
+static void _gameRender()
 {
-	objMgrDraw();
-	levelMgrDraw(_curLevel);
+	// Sheets still loading in the background are uploaded as they arrive
+	assetLoaderRunUploads();
+
+	profilerBeginZone("spriteBatchFlush");
+	spriteBatchFlush();
+	profilerEndZone();
 }
 
-/// @brief Perform updates for all game objects, for the elapsed duration
+/// @brief Perform updates for all game objects for one fixed step
 /// @param milliseconds 
 static void _gameUpdate(uint32_t milliseconds)
 {
-	// Load and unload levels here for waves and game screens -> sequencing based on how the current level's update went
-	switch (levelMgrUpdate(_curLevel, milliseconds))
-	{
-		case LUO_TITLE:			// Show title screen
-		{
-			levelMgrUnload(_curLevel);
-			_curLevel = levelMgrLoad(&_levelDefs[LEVEL_INDEX_TITLE_SCREEN]);
-			break;
-		}
-		case LUO_HISCORES:		// Show hiscores
-		{
-			levelMgrUnload(_curLevel);
-			_curLevel = levelMgrLoad(&_levelDefs[LEVEL_INDEX_HISCORES]);
-			break;
-		}
-		case LUO_STARTWAVES:	// Load the first wave
-		{
-			levelMgrUnload(_curLevel);
-			_curLevel = levelMgrLoad(&_levelDefs[LEVEL_INDEX_FIRST_WAVE]);
-			_curWaveIndex = LEVEL_INDEX_FIRST_WAVE;
-			break;
-		}
-		case LUO_NEXTWAVE:		// Continue to the next wave
-		{
-			LevelType curLevelType = levelGetType(_curLevel);
-			levelMgrUnload(_curLevel);
-			if (curLevelType == LEVELTYPE_WAVE) { _curLevel = levelMgrLoad(&_levelDefs[++_curWaveIndex]); }
-			else if (curLevelType == LEVELTYPE_WAVE_ENDLESS) { _curLevel = levelMgrLoad(&_levelDefs[_curWaveIndex]); }
-			else { assert(false); }
+	levelMgrUpdateAssets();
+	worldUpdate(_world, milliseconds);
 
-			break;
-		}
-		default:
-		{
-			break;
-		}
+	// Lets a replay check it's still producing the recorded game
+	if (_recordPath != NULL || _replayPath != NULL)
+	{
+		inputSubmitChecksum(objMgrGetChecksum());
 	}
-
-	objMgrUpdate(milliseconds);
-}
+}
\ No newline at end of file
@@ -223,3 +223,46 @@ const Bounds2D WORDS_SPRITE_EGGWAVE = {	.topLeft = {.x = 6, .y = 53},
 Coord2D WORDS_BEWARE_SIZE = { .x = 0, .y = 0 };
 const Bounds2D WORDS_SPRITE_BEWARE = { .topLeft = {.x = 6, .y = 26},
 								.botRight = {.x = 698, .y = 6} };
+
+
+// Level Order: hiscores (not implemented, will most likely just display your score), title, waves
+// Contains the first 30 specified waves, then last one is an "endless" wave consisting of Shadow Lords
+	// Has mostly the same as what I could find online. Wave 28 is different, and there are still some waves after 30 that do not seem formulaic. 
+	// Note that starting on wave 37, only Shadow Lords should appear (except for the wave after an egg wave). (Not coded)
+	// After wave 60 all waves should only contain Shadow Lords. (Not coded)
+const LevelDef LEVEL_DEFS[] = {	// { Leveltype, #Bounders, #Hunters, #ShadowLords }
+	{ LEVELTYPE_HISCORES,		0, 0, 0 },
+	{ LEVELTYPE_TITLE,			0, 0, 0 },		// Waves start below!
+	{ LEVELTYPE_WAVE,			3, 0, 0 },		// 1: "Prepare to Joust"
+	{ LEVELTYPE_WAVE,			4, 0, 0 },		
+	{ LEVELTYPE_WAVE,			6, 0, 0 },		
+	{ LEVELTYPE_WAVE,			3, 3, 0 },		
+	{ LEVELTYPE_WAVE,			0, 0, 1 },		// 5: EGG WAVE
+	{ LEVELTYPE_WAVE,			3, 3, 0 },		
+	{ LEVELTYPE_WAVE,			2, 4, 0 },		// 7: Survival Wave
+	{ LEVELTYPE_WAVE,			0, 6, 0 },		
+	{ LEVELTYPE_WAVE,			0, 6, 0 },		
+	{ LEVELTYPE_WAVE,			0, 0, 2 },		// 10: EGG WAVE
+	{ LEVELTYPE_WAVE,			3, 5, 0 },
+	{ LEVELTYPE_WAVE,			2, 6, 0 },		// 12: Survival Wave
+	{ LEVELTYPE_WAVE,			0, 7, 0 },
+	{ LEVELTYPE_WAVE,			0, 8, 0 },
+	{ LEVELTYPE_WAVE,			0, 0, 3 },		// 15: EGG WAVE
+	{ LEVELTYPE_WAVE,			0, 5, 1 },
+	{ LEVELTYPE_WAVE,			0, 5, 1 },		// 17: Survival
+	{ LEVELTYPE_WAVE,			0, 5, 1 },
+	{ LEVELTYPE_WAVE,			0, 4, 2 },
+	{ LEVELTYPE_WAVE,			0, 0, 4 },		// 20: EGG WAVE
+	{ LEVELTYPE_WAVE,			0, 3, 3 },
+	{ LEVELTYPE_WAVE,			0, 2, 4 },		// 22: Survival
+	{ LEVELTYPE_WAVE,			0, 2, 4 },
+	{ LEVELTYPE_WAVE,			0, 2, 4 },
+	{ LEVELTYPE_WAVE,			0, 0, 5 },		// 25: EGG WAVE
+	{ LEVELTYPE_WAVE,			0, 3, 5 },
+	{ LEVELTYPE_WAVE,			0, 3, 5 },		// 27: Survival
+	{ LEVELTYPE_WAVE,			0, 3, 5 },
+	{ LEVELTYPE_WAVE,			0, 3, 5 },
+	{ LEVELTYPE_WAVE,			0, 0, 6 },		// 30: EGG WAVE
+	{ LEVELTYPE_WAVE_ENDLESS,	0, 0, 6 }		// ENDLESS WAVE: Only Shadow Lords
+};
+const uint32_t NUMBER_LEVEL_DEFS = sizeof(LEVEL_DEFS) / sizeof(LEVEL_DEFS[0]);
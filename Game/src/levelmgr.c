@@ -1,27 +1,40 @@
-#include <Windows.h>
 #include <stdlib.h>
-#include <gl/GLU.h>
 #include <assert.h>
 
+#include "platform.h"
 #include "baseTypes.h"
 #include "levelmgr.h"
 #include "objmgr.h"
-#include "SOIL.h"
 #include "sound.h"
 #include "entity.h"
 #include "player.h"
 #include "enemy.h"
 #include "background.h"
+#include "spriteAtlas.h"
+#include "assetLoader.h"
 #include "collisionBox.h"
 #include "joustGlobalConstants.h"
 #include "numberDisplay.h"
 #include "livesDisplay.h"
 #include "soundOneShot.h"
 #include "tools.h"
+#include "pool.h"
+#include "random.h"
+#include "world.h"
 
 
-static const char TITLE_SPRITE_SHEET[] = "asset/Joust_Title_Screen.png";
-static const char REMAINING_SPRITE_SHEET[] = "asset/Joust_Full_Sprite_Sheet_Bridge.png";
+enum spriteSheet_e {
+    SPRITE_SHEET_TITLE,
+    SPRITE_SHEET_REMAINING,
+
+    SPRITE_SHEET_COUNT
+};
+static const SpriteAtlasSheetDef SPRITE_SHEETS[SPRITE_SHEET_COUNT] = {
+    { "asset/Joust_Title_Screen.png", 302, 255 },
+    { "asset/Joust_Full_Sprite_Sheet_Bridge.png", 1353, 1269 }
+};
+static const uint16_t MAX_SPRITES = 256;   // every sprite the game draws, which are all added to the atlas up front
+static const char ASSET_PACK_PATH[] = "asset/joust.pack";
 
 enum sound_e {
     SOUND_DEATH,
@@ -36,7 +49,7 @@ enum sound_e {
 
     SOUND_COUNT
 };
-static const char SOUND_FILES[SOUND_COUNT][50] = {
+static const char* const SOUND_FILES[SOUND_COUNT] = {
     "asset/sounds/jDeath.wav",
     "asset/sounds/jExtraLife.wav",
     "asset/sounds/jFlap.wav",
@@ -47,19 +60,6 @@ static const char SOUND_FILES[SOUND_COUNT][50] = {
     "asset/sounds/jTie.wav",
     "asset/sounds/jWaveStart.wav"
 };
-static const uint32_t SOUND_LENGTHS[SOUND_COUNT] = { //in milliseconds
-    500,
-    1000,
-    200,
-    200,
-    100,
-    300,
-    2200,
-    900,
-    1100
-};
-static SoundOneShot* _sounds[SOUND_COUNT] = { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
-
 static const uint8_t NUMBER_OF_COLLISION_BOXES = 8;
 
 static const float SCALER_WORDSIZE_WIDTH = 2;
@@ -75,62 +75,93 @@ static const uint32_t _POINTS_KILL_BOUNDER = 500;
 static const uint32_t _POINTS_KILL_HUNTER = 750;
 static const uint32_t _POINTS_KILL_SHADOWLORD = 1500;
 
-
-static SpriteSheet* _spriteSheetTitle = NULL;
-static SpriteSheet* _spriteSheetRemaining = NULL;
-
-static Background* _titleBackground = NULL;
-static Background* _waveBackground = NULL;
-static Background* _hiscoresBackground = NULL;
-static Coord2D _hiscoresBackgroundStartPos = { .x = 0, .y = 0 };
-static Coord2D _hiscoresBackgroundEndPos = { .x = 0, .y = 0 };
-
-static NumberDisplay* _scorePlayer1 = NULL;
-static Coord2D _scorePlayer1WavePosition = { .x = 0, .y = 0 };
-static Coord2D _scorePlayer1HiscorePosition = { .x = 0, .y = 0 };
-static uint32_t _extraLifePointCounter = 0;
 static const uint32_t _extraLifePointsThreshold = 20000;
-static NumberDisplay* _waveCounter = NULL;
-
 static const float _endScreenLerpSpeed = 3000;
-static float _endScreenLerpTimer = 0;
-
-static Player* _player = NULL;
-static LivesDisplay* _playerLivesDisplay = NULL;
 static const uint8_t _playerMaxLives = 6;
 
-static CollisionBox** _collisionBoxes = NULL;
-
-static uint8_t _numAliveEnemies; // Should start at the number of enemies in each wave
-static uint8_t _numSpawnedEnemies = 0; // Should increase up to the number of enemies in the wave
-
-static Coord2D _spawnLocations[4]; // There are 4 spawn locations
 static const uint8_t _numSpawnLocations = 4;
 static const uint16_t _safeSpawnRadius = 200;
 static const uint32_t _spawnCycle = 2000; // This is number of milliseconds in between each potential spawn
-static uint32_t _spawnTimer = 0;
-static uint8_t _spawnActiveLocation = 0;
 
-static Sprite* _wordPopups[WORDS_COUNT];
 static uint32_t _popupDisplayTime = 5000;
-static uint32_t _popupDisplayTimer = 0;
-
-static bool _wasPressedLastFrame_Return = false;
 static bool _canSpawnCamp = false;
 
 
+// Assets, shared by every world: loaded along with the first level manager, freed along with the last
+static uint32_t _numStates = 0;
+
+static SoundOneShot* _sounds[SOUND_COUNT] = { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+
+static SpriteId _spriteTitleBackground = 0;
+static SpriteId _spriteWaveBackground = 0;
+static SpriteId _spriteHiscoresBackground = 0;
+
+static SpriteId _wordPopups[WORDS_COUNT];
+
+
+// Everything else is the world's own
+struct levelmgr_t {
+    Background* titleBackground;
+    Background* waveBackground;
+    Background* hiscoresBackground;
+    Coord2D hiscoresBackgroundStartPos;
+    Coord2D hiscoresBackgroundEndPos;
+
+    NumberDisplay* scorePlayer1;
+    Coord2D scorePlayer1WavePosition;
+    Coord2D scorePlayer1HiscorePosition;
+    uint32_t extraLifePointCounter;
+    NumberDisplay* waveCounter;
+
+    float endScreenLerpTimer;
+
+    Player* player;
+    LivesDisplay* playerLivesDisplay;
+
+    CollisionBox** collisionBoxes;
+
+    Pool* levelPool; // a level and its enemy handles share one element, sized for the biggest wave
+    uint32_t maxEnemiesPerLevel;
+
+    uint64_t randomSeed;
+    uint32_t numLevelsLoaded; // Each load gets its own random stream, so replaying a wave doesn't repeat it
+
+    uint16_t numAliveEnemies; // Should start at the number of enemies in each wave
+    uint16_t numSpawnedEnemies; // Should increase up to the number of enemies in the wave
+
+    Coord2D spawnLocations[4]; // There are 4 spawn locations
+    uint32_t spawnTimer;
+    uint8_t spawnActiveLocation;
+
+    uint32_t popupDisplayTimer;
+
+    bool wasPressedLastFrame_Return;
+
+    // The classes' own per-world state, owned here
+    Pool* playerPool;
+    Pool* enemyPool;
+    Pool* collisionBoxPool;
+    SoundOneShotState* sounds;
+};
+
+static WORLD_LOCAL LevelMgrState* _levelMgr = NULL; // the current world's
+
+
 typedef struct level_t
 {
     const LevelDef* def;
+    RandStream random;  // parent of every enemy's stream
 
     Background* background;
 
-    uint8_t numEnemies;
-    Enemy** enemies;
+    uint16_t numEnemies;
+    ObjHandle* enemies;
 } Level;
 
 
 // Function Prototypes
+static void _levelMgrInitAssets();
+static void _levelMgrDeinitAssets();
 static void _levelMgrInitSpriteSheets();
 static void _levelMgrDeinitSpriteSheets();
 static void _levelMgrInitBackgrounds();
@@ -145,11 +176,14 @@ static void _levelMgrInitLivesDisplay();
 static void _levelMgrDeinitLivesDisplay();
 static void _levelMgrInitEnemyAnimations();
 static void _levelMgrDeinitEnemyAnimations();
+static void _levelMgrInitPools(const LevelDef* levelDefs, uint32_t numLevelDefs);
+static void _levelMgrDeinitPools();
 static void _levelMgrInitCollisionBoxes();
 static void _levelMgrDeinitCollisionBoxes();
 static void _levelMgrInitSpawnLocations();
 static void _levelMgrDeinitSpawnLocations(); // This shouldn't actually do anything, as spawn locations are not dynamic memory, but have this and call it in case spawn locations become dynamic
 static void _levelMgrInitWordPopups();
+static void _levelMgrInitWordPopup(uint8_t word, Bounds2D spriteBounds, Coord2D* size);
 static void _levelMgrDeinitWordPopups();
 static void _levelMgrInitSounds();
 static void _levelMgrDeinitSounds();
@@ -162,55 +196,94 @@ static void _levelMgrPlayerKilled(void);
 static void _levelMgrPlaySound(const char* action);
 
 
-/// @brief Initialize the level manager
-void levelMgrInit()
+/// @brief Initialize a level manager for a new world, and make it the calling thread's current one. The first also loads the shared assets.
+/// The object, collision and physics managers the world's objects go into must be current already.
+/// @param levelDefs every level that may be loaded, used to size the level/enemy pools
+/// @param numLevelDefs 
+/// @param seed for every random stream the levels and their enemies use
+void levelMgrInit(const LevelDef* levelDefs, uint32_t numLevelDefs, uint64_t seed)
 {
+    _levelMgr = (LevelMgrState*)malloc(sizeof(LevelMgrState));
+    assert(_levelMgr != NULL);
+    ZeroMemory(_levelMgr, sizeof(LevelMgrState));
+
+    if (_numStates++ == 0) { _levelMgrInitAssets(); }
+
     // Initialize all class variables
-    _levelMgrInitSpriteSheets();
+    _levelMgr->randomSeed = seed;
+    _levelMgr->numLevelsLoaded = 0;
+    _levelMgrInitPools(levelDefs, numLevelDefs);
     _levelMgrInitBackgrounds();
-    numberDisplayInit(_spriteSheetRemaining);
     _levelMgrInitScore();
     _levelMgrInitWaveCounter();
     _levelMgrInitPlayer();
     _levelMgrInitLivesDisplay();
-    _levelMgrInitEnemyAnimations();
     _levelMgrInitCollisionBoxes();
     _levelMgrInitSpawnLocations();
-    _levelMgrInitWordPopups();
-    _levelMgrInitSounds();
+    soundOneShotInit();
+    _levelMgr->sounds = soundOneShotGetState();
 
     // Set the enemy class's reference to the player
-    enemySetPlayerReference(_player);
-   
-    // Set any necessary callbacks
-    playerSetEnemyKilledCB(_levelMgrEnemyKilled);
-    playerSetPlayerKilledCB(_levelMgrPlayerKilled);
-    playerSetPlayerActionCB(_levelMgrPlaySound);
-    enemySetEnemyActionCB(_levelMgrPlaySound);
+    enemySetPlayerReference(_levelMgr->player);
 }
 
-/// @brief Shutdown the level manager
+/// @brief Shutdown the calling thread's current level manager. The last also frees the shared assets.
 void levelMgrShutdown()
 {
-    enemyClearEnemyActionCB();
-    playerClearPlayerActionCB();
-    playerClearPlayerKilledCB();
-    playerClearEnemyKilledCB();
-
     enemyClearPlayerReference();
 
-    _levelMgrDeinitSounds();
-    _levelMgrDeinitWordPopups();
+    soundOneShotShutdown();
     _levelMgrDeinitSpawnLocations();
     _levelMgrDeinitCollisionBoxes();
-    _levelMgrDeinitEnemyAnimations();
     _levelMgrDeinitLivesDisplay();
     _levelMgrDeinitPlayer();
     _levelMgrDeinitWaveCounter();
     _levelMgrDeinitScore();
-    numberDisplayShutdown();
     _levelMgrDeinitBackgrounds();
-    _levelMgrDeinitSpriteSheets();
+    _levelMgrDeinitPools();
+
+    if (--_numStates == 0) { _levelMgrDeinitAssets(); }
+
+    free(_levelMgr);
+    _levelMgr = NULL;
+}
+
+/// @brief Picks up whichever shared assets have finished loading in the background since the last call. Nothing the worlds
+/// simulate depends on them, so this can be called as often or as rarely as suits, between updates, from the thread that
+/// initialized the first level manager.
+/// @return true once every asset is loaded
+bool levelMgrUpdateAssets()
+{
+    for (uint8_t i = 0; i < SOUND_COUNT; ++i)
+    {
+        const WavInfo* wav = !soundOneShotIsLoaded(_sounds[i]) ? assetLoaderGetSound(i) : NULL;
+        if (wav != NULL)
+        {
+            soundOneShotLoad(_sounds[i], wav);
+        }
+    }
+    return assetLoaderUpdate();
+}
+
+/// @brief The calling thread's current level manager
+/// @return 
+LevelMgrState* levelMgrGetState()
+{
+    return _levelMgr;
+}
+
+/// @brief Make a level manager the calling thread's current one, along with the player, enemy, collision box and sound state it owns
+/// @param state from levelMgrGetState, or NULL for none
+void levelMgrSetState(LevelMgrState* state)
+{
+    _levelMgr = state;
+
+    playerSetPool(state != NULL ? state->playerPool : NULL);
+    enemySetPool(state != NULL ? state->enemyPool : NULL);
+    collisionBoxSetPool(state != NULL ? state->collisionBoxPool : NULL);
+    soundOneShotSetState(state != NULL ? state->sounds : NULL);
+    if (state != NULL) { enemySetPlayerReference(state->player); }
+    else { enemyClearPlayerReference(); }
 }
 
 
@@ -219,17 +292,20 @@ void levelMgrShutdown()
 /// @return pointer to the loaded level
 Level* levelMgrLoad(const LevelDef* levelDef)
 {
-    Level* level = malloc(sizeof(Level));
+    // Only fall back to the heap if more than one level is loaded at a time
+    Level* level = poolAlloc(_levelMgr->levelPool);
+    if (level == NULL) { level = malloc(sizeof(Level) + sizeof(ObjHandle) * _levelMgr->maxEnemiesPerLevel); }
     if (level != NULL)
     {
         level->def = levelDef;
+        level->random = randStreamNew(_levelMgr->randomSeed, _levelMgr->numLevelsLoaded++);
         
         switch (level->def->type)
         {
             case LEVELTYPE_TITLE:
             {
                 // Set and enable the background
-                level->background = _titleBackground;
+                level->background = _levelMgr->titleBackground;
                 objEnable((Object*)level->background);
 
                 break;
@@ -237,12 +313,12 @@ Level* levelMgrLoad(const LevelDef* levelDef)
             case LEVELTYPE_HISCORES: // THIS IS PROBABLY NOT GOING TO BE FINISHED IN TIME -> just display user's score
             {
                 // Set and enable the background
-                level->background = _hiscoresBackground;
-                level->background->obj.position = _hiscoresBackgroundStartPos;
+                level->background = _levelMgr->hiscoresBackground;
+                level->background->obj.position = _levelMgr->hiscoresBackgroundStartPos;
                 objEnable((Object*)level->background);
 
                 // Reset the lerp timer
-                _endScreenLerpTimer = 0;
+                _levelMgr->endScreenLerpTimer = 0;
 
                 break;
             }
@@ -250,14 +326,14 @@ Level* levelMgrLoad(const LevelDef* levelDef)
             case LEVELTYPE_WAVE_ENDLESS:
             {
                 // Increment the wave counter
-                objEnable((Object*)_waveCounter);
-                _waveCounter->numberToDisplay++;
+                objEnable((Object*)_levelMgr->waveCounter);
+                _levelMgr->waveCounter->numberToDisplay++;
 
                 // Play necessary start sound and reset spawn location
-                if (_waveCounter->numberToDisplay == 1)
+                if (_levelMgr->waveCounter->numberToDisplay == 1)
                 {
                     soundOneShotPlayIsolated(_sounds[SOUND_START], true);
-                    _spawnActiveLocation = 0;
+                    _levelMgr->spawnActiveLocation = 0;
                 }
                 else
                 {
@@ -265,46 +341,49 @@ Level* levelMgrLoad(const LevelDef* levelDef)
                 }
             
                 // Reset any necessary timers
-                _popupDisplayTimer = 0;
-                _spawnTimer = 0;
+                _levelMgr->popupDisplayTimer = 0;
+                _levelMgr->spawnTimer = 0;
 
                 // Set and enable the background, score, lives display
-                level->background = _waveBackground;
+                level->background = _levelMgr->waveBackground;
                 objEnable((Object*)level->background);
-                numberDisplayChangePosition(_scorePlayer1, _scorePlayer1WavePosition);
-                objEnable((Object*)_scorePlayer1);
-                objEnable((Object*)_playerLivesDisplay);
+                numberDisplayChangePosition(_levelMgr->scorePlayer1, _levelMgr->scorePlayer1WavePosition);
+                objEnable((Object*)_levelMgr->scorePlayer1);
+                objEnable((Object*)_levelMgr->playerLivesDisplay);
 
                 // Enable all platform collision
                 for (uint8_t i = 0; i < NUMBER_OF_COLLISION_BOXES; ++i)
                 {
-                    objEnable((Object*)_collisionBoxes[i]);
+                    objEnable((Object*)_levelMgr->collisionBoxes[i]);
                 }
 
                 // Create all the enemies based on the level definition (disable all of them, spawning function will enable them)
                 level->numEnemies = levelDef->numBounders + level->def->numHunters + level->def->numShadowLords;
-                _numAliveEnemies = level->numEnemies;
-                _numSpawnedEnemies = 0;
-                level->enemies = (Enemy**)malloc(sizeof(Enemy*) * level->numEnemies);
-                assert(level->enemies != NULL);
+                _levelMgr->numAliveEnemies = level->numEnemies;
+                _levelMgr->numSpawnedEnemies = 0;
+                assert(level->numEnemies <= _levelMgr->maxEnemiesPerLevel);
+                level->enemies = (ObjHandle*)(level + 1);
                     // Bounders
-                uint8_t enemyIndex = 0;
-                for (uint8_t i = 0; i < levelDef->numBounders; ++i, ++enemyIndex)
+                uint16_t enemyIndex = 0;
+                for (uint16_t i = 0; i < levelDef->numBounders; ++i, ++enemyIndex)
                 {
-                    level->enemies[enemyIndex] = enemyNew(SPAWN_LOCATIONS[enemyIndex % NUMBER_SPAWN_LOCATIONS], ENEMY_SIZE_GROUNDED, ENEMYTYPE_BOUNDER);
-                    objDisable((Object*)level->enemies[enemyIndex]);
+                    Object* enemy = (Object*)enemyNew(SPAWN_LOCATIONS[enemyIndex % NUMBER_SPAWN_LOCATIONS], ENEMY_SIZE_GROUNDED, ENEMYTYPE_BOUNDER, randStreamDerive(&level->random, enemyIndex));
+                    objDisable(enemy);
+                    level->enemies[enemyIndex] = objGetHandle(enemy);
                 }
                     // Hunters
-                for (uint8_t i = 0; i < levelDef->numHunters; ++i, ++enemyIndex)
+                for (uint16_t i = 0; i < levelDef->numHunters; ++i, ++enemyIndex)
                 {
-                    level->enemies[enemyIndex] = enemyNew(SPAWN_LOCATIONS[enemyIndex % NUMBER_SPAWN_LOCATIONS], ENEMY_SIZE_GROUNDED, ENEMYTYPE_HUNTER);
-                    objDisable((Object*)level->enemies[enemyIndex]);
+                    Object* enemy = (Object*)enemyNew(SPAWN_LOCATIONS[enemyIndex % NUMBER_SPAWN_LOCATIONS], ENEMY_SIZE_GROUNDED, ENEMYTYPE_HUNTER, randStreamDerive(&level->random, enemyIndex));
+                    objDisable(enemy);
+                    level->enemies[enemyIndex] = objGetHandle(enemy);
                 }
                     // Shadow Lords
-                for (uint8_t i = 0; i < levelDef->numShadowLords; ++i, ++enemyIndex)
+                for (uint16_t i = 0; i < levelDef->numShadowLords; ++i, ++enemyIndex)
                 {
-                    level->enemies[enemyIndex] = enemyNew(SPAWN_LOCATIONS[enemyIndex % NUMBER_SPAWN_LOCATIONS], ENEMY_SIZE_GROUNDED, ENEMYTYPE_SHADOWLORD);
-                    objDisable((Object*)level->enemies[enemyIndex]);
+                    Object* enemy = (Object*)enemyNew(SPAWN_LOCATIONS[enemyIndex % NUMBER_SPAWN_LOCATIONS], ENEMY_SIZE_GROUNDED, ENEMYTYPE_SHADOWLORD, randStreamDerive(&level->random, enemyIndex));
+                    objDisable(enemy);
+                    level->enemies[enemyIndex] = objGetHandle(enemy);
                 }
 
                 break;
@@ -327,17 +406,22 @@ void levelMgrUnload(Level* level)
         // Turn off the associated background object
         objDisable((Object*)level->background);
 
-        // Delete all enemies if necessary
+        // Delete all enemies if necessary (skipping any that were already deleted)
         if (level->def->type == LEVELTYPE_WAVE || level->def->type == LEVELTYPE_WAVE_ENDLESS)
         {
-            for (uint8_t i = 0; i < level->numEnemies; ++i)
+            for (uint16_t i = 0; i < level->numEnemies; ++i)
             {
-                enemyDelete((Object*)level->enemies[i]);
+                Object* enemy = objMgrGet(level->enemies[i]);
+                if (enemy != NULL) { enemyDelete(enemy); }
             }
-            free(level->enemies);
+
+            // Every enemy is back in the pool, so the next wave's enemies are laid out in order again
+            enemyResetPool();
         }
     }
-    free(level);
+
+    if (poolOwns(_levelMgr->levelPool, level)) { poolFree(_levelMgr->levelPool, level); }
+    else { free(level); }
 }
 
 
@@ -352,21 +436,21 @@ void levelMgrDraw(Level* level)
         case LEVELTYPE_WAVE:
         case LEVELTYPE_WAVE_ENDLESS:
         {
-            if (_popupDisplayTimer <= _popupDisplayTime)
+            if (_levelMgr->popupDisplayTimer <= _popupDisplayTime)
             {
                 // Draw the wave popup
-                spriteDraw(_wordPopups[WORDS_WAVE], _DISPLAY_WAVE_LOCATION, WORDS_WAVE_SIZE, false);
+                spriteDraw(spriteAtlasGet(_wordPopups[WORDS_WAVE]), _DISPLAY_WAVE_LOCATION, WORDS_WAVE_SIZE, false);
 
                 // Draw any flavor text here as necessary
-                if (_waveCounter->numberToDisplay == 1)
+                if (_levelMgr->waveCounter->numberToDisplay == 1)
                 {
-                    spriteDraw(_wordPopups[WORDS_PREPARE], _DISPLAY_FLAVOR_TEXT_MIDDLE, WORDS_PREPARE_SIZE, false);
+                    spriteDraw(spriteAtlasGet(_wordPopups[WORDS_PREPARE]), _DISPLAY_FLAVOR_TEXT_MIDDLE, WORDS_PREPARE_SIZE, false);
                 }
             }
             else
             {
                 // Disable the number for the wave
-                objDisable((Object*)_waveCounter);
+                objDisable((Object*)_levelMgr->waveCounter);
             }
             break;
         }
@@ -388,9 +472,9 @@ LUO levelMgrUpdate(Level* level, uint32_t milliseconds)
     soundOneShotUpdateInternalFields(milliseconds);
 
     // Reset input latching if necessary
-    if (!inputKeyPressed(VK_RETURN) && _wasPressedLastFrame_Return)
+    if (!worldIsActionPressed(WORLD_ACTION_START) && _levelMgr->wasPressedLastFrame_Return)
     {
-        _wasPressedLastFrame_Return = false;
+        _levelMgr->wasPressedLastFrame_Return = false;
     }
 
     switch (level->def->type)
@@ -398,16 +482,16 @@ LUO levelMgrUpdate(Level* level, uint32_t milliseconds)
         case LEVELTYPE_TITLE:
         {
             // PLAYER INPUT TO MOVE FROM TITLE INTO GAME
-            if (inputKeyPressed(VK_RETURN) && !_wasPressedLastFrame_Return)
+            if (worldIsActionPressed(WORLD_ACTION_START) && !_levelMgr->wasPressedLastFrame_Return)
             {
-                _wasPressedLastFrame_Return = true;
+                _levelMgr->wasPressedLastFrame_Return = true;
 
                 // Reset the player's lives and score, and the wave counter
-                playerResetLives(_player);
-                _playerLivesDisplay->numSpritesToDisplay = playerGetLives(_player);
-                _scorePlayer1->numberToDisplay = 0;
-                _extraLifePointCounter = 0;
-                _waveCounter->numberToDisplay = 0;
+                playerResetLives(_levelMgr->player);
+                _levelMgr->playerLivesDisplay->numSpritesToDisplay = playerGetLives(_levelMgr->player);
+                _levelMgr->scorePlayer1->numberToDisplay = 0;
+                _levelMgr->extraLifePointCounter = 0;
+                _levelMgr->waveCounter->numberToDisplay = 0;
                 return LUO_STARTWAVES;
             }
 
@@ -416,18 +500,18 @@ LUO levelMgrUpdate(Level* level, uint32_t milliseconds)
         case LEVELTYPE_HISCORES:
         {
             // Lerp in the score and end game background
-            _endScreenLerpTimer += milliseconds;
-            Coord2D scoreNewPosition = toolLerp(_scorePlayer1WavePosition, _scorePlayer1HiscorePosition, toolClampFloat(_endScreenLerpTimer / _endScreenLerpSpeed, 0, 1));
-            numberDisplayChangePosition(_scorePlayer1, scoreNewPosition);
-            level->background->obj.position = toolLerp(_hiscoresBackgroundStartPos, _hiscoresBackgroundEndPos, toolClampFloat(_endScreenLerpTimer / _endScreenLerpSpeed, 0, 1));
+            _levelMgr->endScreenLerpTimer += milliseconds;
+            Coord2D scoreNewPosition = toolLerp(_levelMgr->scorePlayer1WavePosition, _levelMgr->scorePlayer1HiscorePosition, toolClampFloat(_levelMgr->endScreenLerpTimer / _endScreenLerpSpeed, 0, 1));
+            numberDisplayChangePosition(_levelMgr->scorePlayer1, scoreNewPosition);
+            level->background->obj.position = toolLerp(_levelMgr->hiscoresBackgroundStartPos, _levelMgr->hiscoresBackgroundEndPos, toolClampFloat(_levelMgr->endScreenLerpTimer / _endScreenLerpSpeed, 0, 1));
 
             // Move to title screen
-            if (inputKeyPressed(VK_RETURN) && !_wasPressedLastFrame_Return)
+            if (worldIsActionPressed(WORLD_ACTION_START) && !_levelMgr->wasPressedLastFrame_Return)
             {
-                _wasPressedLastFrame_Return = true;
+                _levelMgr->wasPressedLastFrame_Return = true;
 
                 // Turn off the score
-                objDisable((Object*)_scorePlayer1);
+                objDisable((Object*)_levelMgr->scorePlayer1);
                 return LUO_TITLE;
             }
 
@@ -437,16 +521,16 @@ LUO levelMgrUpdate(Level* level, uint32_t milliseconds)
         case LEVELTYPE_WAVE_ENDLESS:
         {
             // Update the popup timer
-            _popupDisplayTimer += milliseconds;
+            _levelMgr->popupDisplayTimer += milliseconds;
 
             // Check for the end of the wave (all enemies are dead)
-            if (_numAliveEnemies == 0)
+            if (_levelMgr->numAliveEnemies == 0)
             {
                 return LUO_NEXTWAVE;
             }
             
             // Check if the player is out of lives
-            if (playerGetLives(_player) == 0)
+            if (playerGetLives(_levelMgr->player) == 0)
             {
                 return LUO_HISCORES;
             }
@@ -466,6 +550,33 @@ LUO levelMgrUpdate(Level* level, uint32_t milliseconds)
 }
 
 
+/// @brief Spawns every enemy of a wave at once, spread over an even grid across the screen instead of one at a time at the spawn locations.
+/// Used to put the whole population to work immediately when stress testing the simulation.
+/// @param level 
+void levelMgrSpawnAllEnemies(Level* level)
+{
+    if (level->def->type != LEVELTYPE_WAVE && level->def->type != LEVELTYPE_WAVE_ENDLESS) { return; }
+
+    // Smallest square-ish grid with a cell per enemy
+    uint32_t columns = 1;
+    while (columns * columns < level->numEnemies) { ++columns; }
+    const uint32_t rows = (level->numEnemies + columns - 1) / columns;
+    const Coord2D cellSize = { .x = SCREEN_RESOLUTION.x / (float)columns, .y = SCREEN_RESOLUTION.y / (float)(rows > 0 ? rows : 1) };
+
+    for (uint16_t i = _levelMgr->numSpawnedEnemies; i < level->numEnemies; ++i)
+    {
+        Object* enemy = objMgrGet(level->enemies[i]);
+        if (enemy != NULL)
+        {
+            enemy->position.x = ((float)(i % columns) + 0.5f) * cellSize.x;
+            enemy->position.y = ((float)(i / columns) + 0.5f) * cellSize.y;
+            objEnable(enemy);
+        }
+    }
+    _levelMgr->numSpawnedEnemies = level->numEnemies;
+}
+
+
 /// <param name="level"></param>
 /// <returns>The level's type</returns>
 LevelType levelGetType(const Level* const level)
@@ -473,64 +584,125 @@ LevelType levelGetType(const Level* const level)
     return level->def->type;
 }
 
+/// @param level 
+/// @return how many enemies the level started with, dead or alive (none for screens that aren't waves)
+uint16_t levelGetNumEnemies(const Level* const level)
+{
+    return level->def->type == LEVELTYPE_WAVE || level->def->type == LEVELTYPE_WAVE_ENDLESS ? level->numEnemies : 0;
+}
+
+/// @param level 
+/// @param index below levelGetNumEnemies
+/// @return the enemy, or NULL if it has been killed
+Object* levelGetEnemy(const Level* const level, uint16_t index)
+{
+    assert(index < levelGetNumEnemies(level));
+    return objMgrGet(level->enemies[index]);
+}
+
+/// @return the current world's player
+Player* levelMgrGetPlayer()
+{
+    return _levelMgr->player;
+}
+
+/// @return the current world's score
+uint32_t levelMgrGetScore()
+{
+    return _levelMgr->scorePlayer1->numberToDisplay;
+}
+
+/// @return the current world's wave, counting from 1, or 0 before the first
+uint32_t levelMgrGetWaveNumber()
+{
+    return _levelMgr->waveCounter->numberToDisplay;
+}
+
+/// @return how many of the current wave's enemies are left to kill, spawned or not
+uint16_t levelMgrGetNumAliveEnemies()
+{
+    return _levelMgr->numAliveEnemies;
+}
+
+
+static void _levelMgrInitAssets()
+{
+    // Only the sprite atlas's image and the sounds take any time to load: they carry on in the background
+    _levelMgrInitSpriteSheets();
+    assetLoaderStart(ASSET_PACK_PATH, SPRITE_SHEETS, SPRITE_SHEET_COUNT, SOUND_FILES, SOUND_COUNT);
+    numberDisplayInit(SPRITE_SHEET_REMAINING);
+    livesDisplayInit(SPRITE_SHEET_REMAINING);
+    playerInitAnimations(SPRITE_SHEET_REMAINING);
+    _levelMgrInitEnemyAnimations();
+    _levelMgrInitWordPopups();
+    _levelMgrInitSounds();
+
+    // Set any necessary callbacks (they act on whichever world is current)
+    playerSetEnemyKilledCB(_levelMgrEnemyKilled);
+    playerSetPlayerKilledCB(_levelMgrPlayerKilled);
+    playerSetPlayerActionCB(_levelMgrPlaySound);
+    enemySetEnemyActionCB(_levelMgrPlaySound);
+}
+
+static void _levelMgrDeinitAssets()
+{
+    enemyClearEnemyActionCB();
+    playerClearPlayerActionCB();
+    playerClearPlayerKilledCB();
+    playerClearEnemyKilledCB();
+
+    _levelMgrDeinitSounds();
+    assetLoaderShutdown();
+    _levelMgrDeinitWordPopups();
+    _levelMgrDeinitEnemyAnimations();
+    playerDeinitAnimations();
+    livesDisplayShutdown();
+    numberDisplayShutdown();
+    _levelMgrDeinitSpriteSheets();
+}
 
 static void _levelMgrInitSpriteSheets()
 {
-    GLuint titleHandle = SOIL_load_OGL_texture(TITLE_SPRITE_SHEET, SOIL_LOAD_AUTO, SOIL_CREATE_NEW_ID, SOIL_FLAG_MIPMAPS | SOIL_FLAG_INVERT_Y | SOIL_FLAG_NTSC_SAFE_RGB | SOIL_FLAG_COMPRESS_TO_DXT);
-    _spriteSheetTitle = (SpriteSheet*)malloc(sizeof(SpriteSheet));
-    assert(_spriteSheetTitle != NULL);
-    _spriteSheetTitle->textureHandle = titleHandle;
-    _spriteSheetTitle->WIDTH_PIXELS = 302;
-    _spriteSheetTitle->HEIGHT_PIXELS = 255;
-        // Nearest neighbor scaling: THANK YOU JOSH!
-    glBindTexture(GL_TEXTURE_2D, titleHandle);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-    GLuint remainingHandle = SOIL_load_OGL_texture(REMAINING_SPRITE_SHEET, SOIL_LOAD_AUTO, SOIL_CREATE_NEW_ID, SOIL_FLAG_MIPMAPS | SOIL_FLAG_INVERT_Y | SOIL_FLAG_NTSC_SAFE_RGB | SOIL_FLAG_COMPRESS_TO_DXT);
-    _spriteSheetRemaining = (SpriteSheet*)malloc(sizeof(SpriteSheet));
-    assert(_spriteSheetRemaining != NULL);
-    _spriteSheetRemaining->textureHandle = remainingHandle;
-    _spriteSheetRemaining->WIDTH_PIXELS = 1353;
-    _spriteSheetRemaining->HEIGHT_PIXELS = 1269;
-        // Nearest neighbor scaling
-    glBindTexture(GL_TEXTURE_2D, remainingHandle);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    // Every sheet goes into one texture, so the whole frame draws without switching textures
+    spriteAtlasInit(SPRITE_SHEETS, SPRITE_SHEET_COUNT, MAX_SPRITES);
+
+    // The backgrounds are shared by every world's background objects
+    _spriteTitleBackground = spriteAtlasAdd(SPRITE_SHEET_TITLE, BACKGROUND_TITLE_SPRITE_BOUNDS, -0.99f);
+    _spriteWaveBackground = spriteAtlasAdd(SPRITE_SHEET_REMAINING, BACKGROUND_WAVES_SPRITE_BOUNDS, -0.99f);
+    _spriteHiscoresBackground = spriteAtlasAdd(SPRITE_SHEET_REMAINING, BACKGROUND_HISCORES_SPRITE_BOUNDS, -0.99f);
 }
 
 static void _levelMgrDeinitSpriteSheets()
 {
-    free(_spriteSheetRemaining);
-    free(_spriteSheetTitle);
+    spriteAtlasShutdown();
 }
 
 static void _levelMgrInitBackgrounds()
 {
     // Title
-    _titleBackground = backgroundNew(_spriteSheetTitle, BACKGROUND_TITLE_SPRITE_BOUNDS, BACKGROUND_TITLE_SIZE);
-    _titleBackground->obj.size = SCREEN_RESOLUTION;
-    objDisable((Object*)_titleBackground);
+    _levelMgr->titleBackground = backgroundNew(_spriteTitleBackground, BACKGROUND_TITLE_SIZE);
+    _levelMgr->titleBackground->obj.size = SCREEN_RESOLUTION;
+    objDisable((Object*)_levelMgr->titleBackground);
 
     // Wave
-    _waveBackground = backgroundNew(_spriteSheetRemaining, BACKGROUND_WAVES_SPRITE_BOUNDS, BACKGROUND_WAVES_SIZE);
-    _waveBackground->obj.size = SCREEN_RESOLUTION;
-    objDisable((Object*)_waveBackground);
+    _levelMgr->waveBackground = backgroundNew(_spriteWaveBackground, BACKGROUND_WAVES_SIZE);
+    _levelMgr->waveBackground->obj.size = SCREEN_RESOLUTION;
+    objDisable((Object*)_levelMgr->waveBackground);
 
     // Hiscores
-    _hiscoresBackground = backgroundNew(_spriteSheetRemaining, BACKGROUND_HISCORES_SPRITE_BOUNDS, BACKGROUND_HISCORES_SIZE);
-    _hiscoresBackgroundStartPos = _hiscoresBackground->obj.position;
-    _hiscoresBackgroundEndPos = _hiscoresBackground->obj.position;
-    _hiscoresBackgroundStartPos.y = 0 - _hiscoresBackground->obj.size.y;
-    _hiscoresBackgroundEndPos.y = 0 + _hiscoresBackground->obj.size.y;
-    objDisable((Object*)_hiscoresBackground);
+    _levelMgr->hiscoresBackground = backgroundNew(_spriteHiscoresBackground, BACKGROUND_HISCORES_SIZE);
+    _levelMgr->hiscoresBackgroundStartPos = _levelMgr->hiscoresBackground->obj.position;
+    _levelMgr->hiscoresBackgroundEndPos = _levelMgr->hiscoresBackground->obj.position;
+    _levelMgr->hiscoresBackgroundStartPos.y = 0 - _levelMgr->hiscoresBackground->obj.size.y;
+    _levelMgr->hiscoresBackgroundEndPos.y = 0 + _levelMgr->hiscoresBackground->obj.size.y;
+    objDisable((Object*)_levelMgr->hiscoresBackground);
 }
 
 static void _levelMgrDeinitBackgrounds()
 {
-    if (_titleBackground != NULL) { backgroundDelete((Object*)_titleBackground); }
-    if (_waveBackground != NULL) { backgroundDelete((Object*)_waveBackground); }
-    if (_hiscoresBackground != NULL) { backgroundDelete((Object*)_hiscoresBackground); }
+    if (_levelMgr->titleBackground != NULL) { backgroundDelete((Object*)_levelMgr->titleBackground); }
+    if (_levelMgr->waveBackground != NULL) { backgroundDelete((Object*)_levelMgr->waveBackground); }
+    if (_levelMgr->hiscoresBackground != NULL) { backgroundDelete((Object*)_levelMgr->hiscoresBackground); }
 }
 
 static void _levelMgrInitScore()
@@ -539,17 +711,17 @@ static void _levelMgrInitScore()
     Coord2D scoreBoardBR = { .x = (SCOREBOARD_BR.x / BACKGROUND_WAVES_SIZE.x) * SCREEN_RESOLUTION.x, .y = (SCOREBOARD_BR.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y };
     Coord2D scoreBoardSize = { .x = scoreBoardBR.x - scoreBoardTL.x, .y = scoreBoardBR.y - scoreBoardTL.y };
 
-    _scorePlayer1 = numberDisplayNew(NUMBERCOLOR_YELLOW, scoreBoardTL, scoreBoardSize, 7, 6); // 7 - digits (millions), 4 - pixelsBetweenNumbers
-    _scorePlayer1WavePosition = _scorePlayer1->obj.position;
-    _scorePlayer1HiscorePosition = boundsGetCenter(&SCREEN_BOUNDS);
-    _scorePlayer1HiscorePosition.x -= scoreBoardSize.x / 2;
+    _levelMgr->scorePlayer1 = numberDisplayNew(NUMBERCOLOR_YELLOW, scoreBoardTL, scoreBoardSize, 7, 6); // 7 - digits (millions), 4 - pixelsBetweenNumbers
+    _levelMgr->scorePlayer1WavePosition = _levelMgr->scorePlayer1->obj.position;
+    _levelMgr->scorePlayer1HiscorePosition = boundsGetCenter(&SCREEN_BOUNDS);
+    _levelMgr->scorePlayer1HiscorePosition.x -= scoreBoardSize.x / 2;
 
-    objDisable((Object*)_scorePlayer1);
+    objDisable((Object*)_levelMgr->scorePlayer1);
 }
 
 static void _levelMgrDeinitScore()
 {
-    numberDisplayDelete((Object*)_scorePlayer1);
+    numberDisplayDelete((Object*)_levelMgr->scorePlayer1);
     
 }
 
@@ -558,55 +730,52 @@ static void _levelMgrInitWaveCounter()
     // THESE WILL NEED TO BE ADJUSTED WHEN MOVING TO A LARGER SCREEN
     Coord2D topLeft = { .x = 475, .y = 238 };
     Coord2D size = { .x = 80, .y = 24 };
-    _waveCounter = numberDisplayNew(NUMBERCOLOR_WHITE, topLeft, size, 3, 6);
-    objDisable((Object*)_waveCounter);
-    //_waveCounter->numberToDisplay = 999;
+    _levelMgr->waveCounter = numberDisplayNew(NUMBERCOLOR_WHITE, topLeft, size, 3, 6);
+    objDisable((Object*)_levelMgr->waveCounter);
+    //_levelMgr->waveCounter->numberToDisplay = 999;
 }
 
 static void _levelMgrDeinitWaveCounter()
 {
-    numberDisplayDelete((Object*)_waveCounter);
+    numberDisplayDelete((Object*)_levelMgr->waveCounter);
 }
 
 static void _levelMgrInitPlayer()
 {
-    playerInitAnimations(_spriteSheetRemaining);
+    playerInitPool(1);
+    _levelMgr->playerPool = playerGetPool();
 
     // MOVE THESE TO THE GLOBAL CONST FILE!
     Coord2D playerStart = { .x = 0.0f, .y = 0.0f };
-    _player = playerNew(playerStart, PLAYER_SIZE_GROUNDED);
-    objDisable((Object*)_player);
+    _levelMgr->player = playerNew(playerStart, PLAYER_SIZE_GROUNDED);
+    objDisable((Object*)_levelMgr->player);
 }
 
 static void _levelMgrDeinitPlayer()
 {
-    playerDelete((Object*)_player);
+    playerDelete((Object*)_levelMgr->player);
     
-    playerDeinitAnimations();
+    playerDeinitPool();
 }
 
 static void _levelMgrInitLivesDisplay()
 {
-    livesDisplayInit(_spriteSheetRemaining);
-
     Coord2D livesDisplayTL = { .x = (LIVES_DISPLAY_TL.x / BACKGROUND_WAVES_SIZE.x) * SCREEN_RESOLUTION.x, .y = (LIVES_DISPLAY_TL.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y };
     Coord2D livesDisplayBR = { .x = (LIVES_DISPLAY_BR.x / BACKGROUND_WAVES_SIZE.x) * SCREEN_RESOLUTION.x, .y = (LIVES_DISPLAY_BR.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y };
     Coord2D livesDisplaySize = { .x = livesDisplayBR.x - livesDisplayTL.x, .y = livesDisplayBR.y - livesDisplayTL.y };
 
-    _playerLivesDisplay = livesDisplayNew(livesDisplayTL, livesDisplaySize, _playerMaxLives - 1, 6); //6 - pixels between lives
-    objDisable((Object*)_playerLivesDisplay);
+    _levelMgr->playerLivesDisplay = livesDisplayNew(livesDisplayTL, livesDisplaySize, _playerMaxLives - 1, 6); //6 - pixels between lives
+    objDisable((Object*)_levelMgr->playerLivesDisplay);
 }
 
 static void _levelMgrDeinitLivesDisplay()
 {
-    livesDisplayDelete((Object*)_playerLivesDisplay);
-
-    livesDisplayShutdown();
+    livesDisplayDelete((Object*)_levelMgr->playerLivesDisplay);
 }
 
 static void _levelMgrInitEnemyAnimations()
 {
-    enemyInitAnimations(_spriteSheetRemaining);
+    enemyInitAnimations(SPRITE_SHEET_REMAINING);
 }
 
 static void _levelMgrDeinitEnemyAnimations()
@@ -614,17 +783,41 @@ static void _levelMgrDeinitEnemyAnimations()
     enemyDeinitAnimations();
 }
 
+static void _levelMgrInitPools(const LevelDef* levelDefs, uint32_t numLevelDefs)
+{
+    // Size for the biggest wave, so no wave transition ever needs the heap
+    _levelMgr->maxEnemiesPerLevel = 0;
+    for (uint32_t i = 0; i < numLevelDefs; ++i)
+    {
+        const uint32_t numEnemies = (uint32_t)levelDefs[i].numBounders + levelDefs[i].numHunters + levelDefs[i].numShadowLords;
+        if (numEnemies > _levelMgr->maxEnemiesPerLevel) { _levelMgr->maxEnemiesPerLevel = numEnemies; }
+    }
+
+    _levelMgr->levelPool = poolNew(sizeof(Level) + sizeof(ObjHandle) * _levelMgr->maxEnemiesPerLevel, 1);
+    enemyInitPool(_levelMgr->maxEnemiesPerLevel);
+    _levelMgr->enemyPool = enemyGetPool();
+}
+
+static void _levelMgrDeinitPools()
+{
+    enemyDeinitPool();
+    poolDelete(_levelMgr->levelPool);
+    _levelMgr->levelPool = NULL;
+}
+
 static void _levelMgrInitCollisionBoxes()
 {
-    _collisionBoxes = (CollisionBox**)malloc(sizeof(CollisionBox*) * NUMBER_OF_COLLISION_BOXES);
-    assert(_collisionBoxes != NULL);
+    _levelMgr->collisionBoxes = (CollisionBox**)malloc(sizeof(CollisionBox*) * NUMBER_OF_COLLISION_BOXES);
+    assert(_levelMgr->collisionBoxes != NULL);
+    collisionBoxInitPool(NUMBER_OF_COLLISION_BOXES);
+    _levelMgr->collisionBoxPool = collisionBoxGetPool();
 
     // Create all platform collision boxes
             // Bottom platform
     Coord2D collisionBoxTL = { .x = (COLLBOX_BOT_TL.x / BACKGROUND_WAVES_SIZE.x) * SCREEN_RESOLUTION.x, .y = (COLLBOX_BOT_TL.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y };
     Coord2D collisionBoxBR = { .x = (COLLBOX_BOT_BR.x / BACKGROUND_WAVES_SIZE.x) * SCREEN_RESOLUTION.x, .y = (COLLBOX_BOT_BR.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y };
     Coord2D collisionBoxSize = { .x = collisionBoxBR.x - collisionBoxTL.x, .y = collisionBoxBR.y - collisionBoxTL.y };
-    _collisionBoxes[0] = collisionBoxNew(collisionBoxTL, collisionBoxSize);
+    _levelMgr->collisionBoxes[0] = collisionBoxNew(collisionBoxTL, collisionBoxSize);
         // Middle Left (wrap)
     collisionBoxTL.x = (COLLBOX_MIDLEFT_TL.x / BACKGROUND_WAVES_SIZE.x) * SCREEN_RESOLUTION.x;
     collisionBoxTL.y = (COLLBOX_MIDLEFT_TL.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y;
@@ -632,7 +825,7 @@ static void _levelMgrInitCollisionBoxes()
     collisionBoxBR.y = (COLLBOX_MIDLEFT_BR.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y;
     collisionBoxSize.x = collisionBoxBR.x - collisionBoxTL.x;
     collisionBoxSize.y = collisionBoxBR.y - collisionBoxTL.y;
-    _collisionBoxes[1] = collisionBoxNew(collisionBoxTL, collisionBoxSize);
+    _levelMgr->collisionBoxes[1] = collisionBoxNew(collisionBoxTL, collisionBoxSize);
         // Middle
     collisionBoxTL.x = (COLLBOX_MID_TL.x / BACKGROUND_WAVES_SIZE.x) * SCREEN_RESOLUTION.x;
     collisionBoxTL.y = (COLLBOX_MID_TL.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y;
@@ -640,7 +833,7 @@ static void _levelMgrInitCollisionBoxes()
     collisionBoxBR.y = (COLLBOX_MID_BR.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y;
     collisionBoxSize.x = collisionBoxBR.x - collisionBoxTL.x;
     collisionBoxSize.y = collisionBoxBR.y - collisionBoxTL.y;
-    _collisionBoxes[2] = collisionBoxNew(collisionBoxTL, collisionBoxSize);
+    _levelMgr->collisionBoxes[2] = collisionBoxNew(collisionBoxTL, collisionBoxSize);
         // Middle Right
     collisionBoxTL.x = (COLLBOX_MIDRIGHT_TL.x / BACKGROUND_WAVES_SIZE.x) * SCREEN_RESOLUTION.x;
     collisionBoxTL.y = (COLLBOX_MIDRIGHT_TL.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y;
@@ -648,7 +841,7 @@ static void _levelMgrInitCollisionBoxes()
     collisionBoxBR.y = (COLLBOX_MIDRIGHT_BR.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y;
     collisionBoxSize.x = collisionBoxBR.x - collisionBoxTL.x;
     collisionBoxSize.y = collisionBoxBR.y - collisionBoxTL.y;
-    _collisionBoxes[3] = collisionBoxNew(collisionBoxTL, collisionBoxSize);
+    _levelMgr->collisionBoxes[3] = collisionBoxNew(collisionBoxTL, collisionBoxSize);
         // Middle Right (wrap)
     collisionBoxTL.x = (COLLBOX_MIDRIGHT_WRAP_TL.x / BACKGROUND_WAVES_SIZE.x) * SCREEN_RESOLUTION.x;
     collisionBoxTL.y = (COLLBOX_MIDRIGHT_WRAP_TL.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y;
@@ -656,7 +849,7 @@ static void _levelMgrInitCollisionBoxes()
     collisionBoxBR.y = (COLLBOX_MIDRIGHT_WRAP_BR.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y;
     collisionBoxSize.x = collisionBoxBR.x - collisionBoxTL.x;
     collisionBoxSize.y = collisionBoxBR.y - collisionBoxTL.y;
-    _collisionBoxes[4] = collisionBoxNew(collisionBoxTL, collisionBoxSize);
+    _levelMgr->collisionBoxes[4] = collisionBoxNew(collisionBoxTL, collisionBoxSize);
         // Top Left (wrap)
     collisionBoxTL.x = (COLLBOX_TOPLEFT_TL.x / BACKGROUND_WAVES_SIZE.x) * SCREEN_RESOLUTION.x;
     collisionBoxTL.y = (COLLBOX_TOPLEFT_TL.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y;
@@ -664,7 +857,7 @@ static void _levelMgrInitCollisionBoxes()
     collisionBoxBR.y = (COLLBOX_TOPLEFT_BR.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y;
     collisionBoxSize.x = collisionBoxBR.x - collisionBoxTL.x;
     collisionBoxSize.y = collisionBoxBR.y - collisionBoxTL.y;
-    _collisionBoxes[5] = collisionBoxNew(collisionBoxTL, collisionBoxSize);
+    _levelMgr->collisionBoxes[5] = collisionBoxNew(collisionBoxTL, collisionBoxSize);
         // Top Middle
     collisionBoxTL.x = (COLLBOX_TOPMID_TL.x / BACKGROUND_WAVES_SIZE.x) * SCREEN_RESOLUTION.x;
     collisionBoxTL.y = (COLLBOX_TOPMID_TL.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y;
@@ -672,7 +865,7 @@ static void _levelMgrInitCollisionBoxes()
     collisionBoxBR.y = (COLLBOX_TOPMID_BR.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y;
     collisionBoxSize.x = collisionBoxBR.x - collisionBoxTL.x;
     collisionBoxSize.y = collisionBoxBR.y - collisionBoxTL.y;
-    _collisionBoxes[6] = collisionBoxNew(collisionBoxTL, collisionBoxSize);
+    _levelMgr->collisionBoxes[6] = collisionBoxNew(collisionBoxTL, collisionBoxSize);
         // Top Right (wrap)
     collisionBoxTL.x = (COLLBOX_TOPRIGHT_TL.x / BACKGROUND_WAVES_SIZE.x) * SCREEN_RESOLUTION.x;
     collisionBoxTL.y = (COLLBOX_TOPRIGHT_TL.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y;
@@ -680,13 +873,13 @@ static void _levelMgrInitCollisionBoxes()
     collisionBoxBR.y = (COLLBOX_TOPRIGHT_BR.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y;
     collisionBoxSize.x = collisionBoxBR.x - collisionBoxTL.x;
     collisionBoxSize.y = collisionBoxBR.y - collisionBoxTL.y;
-    _collisionBoxes[7] = collisionBoxNew(collisionBoxTL, collisionBoxSize);
+    _levelMgr->collisionBoxes[7] = collisionBoxNew(collisionBoxTL, collisionBoxSize);
 
 
     // Disable all collision boxes
     for (uint8_t i = 0; i < NUMBER_OF_COLLISION_BOXES; ++i)
     {
-        objDisable((Object*)_collisionBoxes[i]);
+        objDisable((Object*)_levelMgr->collisionBoxes[i]);
     }
 }
 
@@ -694,9 +887,10 @@ static void _levelMgrDeinitCollisionBoxes()
 {
     for (uint8_t i = 0; i < NUMBER_OF_COLLISION_BOXES; ++i)
     {
-        collisionBoxDelete((Object*)_collisionBoxes[i]);
+        collisionBoxDelete((Object*)_levelMgr->collisionBoxes[i]);
     }
-    free(_collisionBoxes);
+    free(_levelMgr->collisionBoxes);
+    collisionBoxDeinitPool();
 }
 
 static void _levelMgrInitSpawnLocations()
@@ -708,25 +902,25 @@ static void _levelMgrInitSpawnLocations()
     tempBounds.topLeft.y = (SPAWN_BOTTOM_LOCATION.topLeft.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y;
     tempBounds.botRight.x = (SPAWN_BOTTOM_LOCATION.botRight.x / BACKGROUND_WAVES_SIZE.x) * SCREEN_RESOLUTION.x;
     tempBounds.botRight.y = (SPAWN_BOTTOM_LOCATION.botRight.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y;
-    _spawnLocations[0] = boundsGetCenter(&tempBounds);
+    _levelMgr->spawnLocations[0] = boundsGetCenter(&tempBounds);
 
     tempBounds.topLeft.x = (SPAWN_LEFT_LOCATION.topLeft.x / BACKGROUND_WAVES_SIZE.x) * SCREEN_RESOLUTION.x;
     tempBounds.topLeft.y = (SPAWN_LEFT_LOCATION.topLeft.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y;
     tempBounds.botRight.x = (SPAWN_LEFT_LOCATION.botRight.x / BACKGROUND_WAVES_SIZE.x) * SCREEN_RESOLUTION.x;
     tempBounds.botRight.y = (SPAWN_LEFT_LOCATION.botRight.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y;
-    _spawnLocations[1] = boundsGetCenter(&tempBounds);
+    _levelMgr->spawnLocations[1] = boundsGetCenter(&tempBounds);
 
     tempBounds.topLeft.x = (SPAWN_RIGHT_LOCATION.topLeft.x / BACKGROUND_WAVES_SIZE.x) * SCREEN_RESOLUTION.x;
     tempBounds.topLeft.y = (SPAWN_RIGHT_LOCATION.topLeft.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y;
     tempBounds.botRight.x = (SPAWN_RIGHT_LOCATION.botRight.x / BACKGROUND_WAVES_SIZE.x) * SCREEN_RESOLUTION.x;
     tempBounds.botRight.y = (SPAWN_RIGHT_LOCATION.botRight.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y;
-    _spawnLocations[2] = boundsGetCenter(&tempBounds);
+    _levelMgr->spawnLocations[2] = boundsGetCenter(&tempBounds);
 
     tempBounds.topLeft.x = (SPAWN_TOP_LOCATION.topLeft.x / BACKGROUND_WAVES_SIZE.x) * SCREEN_RESOLUTION.x;
     tempBounds.topLeft.y = (SPAWN_TOP_LOCATION.topLeft.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y;
     tempBounds.botRight.x = (SPAWN_TOP_LOCATION.botRight.x / BACKGROUND_WAVES_SIZE.x) * SCREEN_RESOLUTION.x;
     tempBounds.botRight.y = (SPAWN_TOP_LOCATION.botRight.y / BACKGROUND_WAVES_SIZE.y) * SCREEN_RESOLUTION.y;
-    _spawnLocations[3] = boundsGetCenter(&tempBounds);
+    _levelMgr->spawnLocations[3] = boundsGetCenter(&tempBounds);
 }
 
 static void _levelMgrDeinitSpawnLocations()
@@ -736,79 +930,36 @@ static void _levelMgrDeinitSpawnLocations()
 
 static void _levelMgrInitWordPopups()
 {
-    // Calculate each sprite's UVs, and their respective size based on the starting screen size
-    Bounds2D spriteUV;
-
-    spriteUV.topLeft.x = WORDS_SPRITE_WAVE.topLeft.x / _spriteSheetRemaining->WIDTH_PIXELS;
-    spriteUV.topLeft.y = WORDS_SPRITE_WAVE.topLeft.y / _spriteSheetRemaining->HEIGHT_PIXELS;
-    spriteUV.botRight.x = WORDS_SPRITE_WAVE.botRight.x / _spriteSheetRemaining->WIDTH_PIXELS;
-    spriteUV.botRight.y = WORDS_SPRITE_WAVE.botRight.y / _spriteSheetRemaining->HEIGHT_PIXELS;
-    _wordPopups[WORDS_WAVE] = spriteNew(_spriteSheetRemaining, spriteUV, 0.99f);
-    WORDS_WAVE_SIZE.x = (spriteUV.botRight.x - spriteUV.topLeft.x) * SCREEN_RESOLUTION.x * SCALER_WORDSIZE_WIDTH;
-    WORDS_WAVE_SIZE.y = (spriteUV.topLeft.y - spriteUV.botRight.y) * SCREEN_RESOLUTION.y * SCALER_WORDSIZE_HEIGHT;
-
-    spriteUV.topLeft.x = WORDS_SPRITE_PREPARE.topLeft.x / _spriteSheetRemaining->WIDTH_PIXELS;
-    spriteUV.topLeft.y = WORDS_SPRITE_PREPARE.topLeft.y / _spriteSheetRemaining->HEIGHT_PIXELS;
-    spriteUV.botRight.x = WORDS_SPRITE_PREPARE.botRight.x / _spriteSheetRemaining->WIDTH_PIXELS;
-    spriteUV.botRight.y = WORDS_SPRITE_PREPARE.botRight.y / _spriteSheetRemaining->HEIGHT_PIXELS;
-    _wordPopups[WORDS_PREPARE] = spriteNew(_spriteSheetRemaining, spriteUV, 0.99f);
-    WORDS_PREPARE_SIZE.x = (spriteUV.botRight.x - spriteUV.topLeft.x) * SCREEN_RESOLUTION.x * SCALER_WORDSIZE_WIDTH;
-    WORDS_PREPARE_SIZE.y = (spriteUV.topLeft.y - spriteUV.botRight.y) * SCREEN_RESOLUTION.y * SCALER_WORDSIZE_HEIGHT;
-
-    spriteUV.topLeft.x = WORDS_SPRITE_GAMEOVER.topLeft.x / _spriteSheetRemaining->WIDTH_PIXELS;
-    spriteUV.topLeft.y = WORDS_SPRITE_GAMEOVER.topLeft.y / _spriteSheetRemaining->HEIGHT_PIXELS;
-    spriteUV.botRight.x = WORDS_SPRITE_GAMEOVER.botRight.x / _spriteSheetRemaining->WIDTH_PIXELS;
-    spriteUV.botRight.y = WORDS_SPRITE_GAMEOVER.botRight.y / _spriteSheetRemaining->HEIGHT_PIXELS;
-    _wordPopups[WORDS_GAMEOVER] = spriteNew(_spriteSheetRemaining, spriteUV, 0.99f);
-    WORDS_GAMEOVER_SIZE.x = (spriteUV.botRight.x - spriteUV.topLeft.x) * SCREEN_RESOLUTION.x * SCALER_WORDSIZE_WIDTH;
-    WORDS_GAMEOVER_SIZE.y = (spriteUV.topLeft.y - spriteUV.botRight.y) * SCREEN_RESOLUTION.y * SCALER_WORDSIZE_HEIGHT;
-
-    spriteUV.topLeft.x = WORDS_SPRITE_BUZZARD.topLeft.x / _spriteSheetRemaining->WIDTH_PIXELS;
-    spriteUV.topLeft.y = WORDS_SPRITE_BUZZARD.topLeft.y / _spriteSheetRemaining->HEIGHT_PIXELS;
-    spriteUV.botRight.x = WORDS_SPRITE_BUZZARD.botRight.x / _spriteSheetRemaining->WIDTH_PIXELS;
-    spriteUV.botRight.y = WORDS_SPRITE_BUZZARD.botRight.y / _spriteSheetRemaining->HEIGHT_PIXELS;
-    _wordPopups[WORDS_BUZZARD] = spriteNew(_spriteSheetRemaining, spriteUV, 0.99f);
-    WORDS_BUZZARD_SIZE.x = (spriteUV.botRight.x - spriteUV.topLeft.x) * SCREEN_RESOLUTION.x * SCALER_WORDSIZE_WIDTH;
-    WORDS_BUZZARD_SIZE.y = (spriteUV.topLeft.y - spriteUV.botRight.y) * SCREEN_RESOLUTION.y * SCALER_WORDSIZE_HEIGHT;
-
-    spriteUV.topLeft.x = WORDS_SPRITE_SURVIVAL.topLeft.x / _spriteSheetRemaining->WIDTH_PIXELS;
-    spriteUV.topLeft.y = WORDS_SPRITE_SURVIVAL.topLeft.y / _spriteSheetRemaining->HEIGHT_PIXELS;
-    spriteUV.botRight.x = WORDS_SPRITE_SURVIVAL.botRight.x / _spriteSheetRemaining->WIDTH_PIXELS;
-    spriteUV.botRight.y = WORDS_SPRITE_SURVIVAL.botRight.y / _spriteSheetRemaining->HEIGHT_PIXELS;
-    _wordPopups[WORDS_SURVIVAL] = spriteNew(_spriteSheetRemaining, spriteUV, 0.99f);
-    WORDS_SURVIVAL_SIZE.x = (spriteUV.botRight.x - spriteUV.topLeft.x) * SCREEN_RESOLUTION.x * SCALER_WORDSIZE_WIDTH;
-    WORDS_SURVIVAL_SIZE.y = (spriteUV.topLeft.y - spriteUV.botRight.y) * SCREEN_RESOLUTION.y * SCALER_WORDSIZE_HEIGHT;
-
-    spriteUV.topLeft.x = WORDS_SPRITE_EGGWAVE.topLeft.x / _spriteSheetRemaining->WIDTH_PIXELS;
-    spriteUV.topLeft.y = WORDS_SPRITE_EGGWAVE.topLeft.y / _spriteSheetRemaining->HEIGHT_PIXELS;
-    spriteUV.botRight.x = WORDS_SPRITE_EGGWAVE.botRight.x / _spriteSheetRemaining->WIDTH_PIXELS;
-    spriteUV.botRight.y = WORDS_SPRITE_EGGWAVE.botRight.y / _spriteSheetRemaining->HEIGHT_PIXELS;
-    _wordPopups[WORDS_EGGWAVE] = spriteNew(_spriteSheetRemaining, spriteUV, 0.99f);
-    WORDS_EGGWAVE_SIZE.x = (spriteUV.botRight.x - spriteUV.topLeft.x) * SCREEN_RESOLUTION.x * SCALER_WORDSIZE_WIDTH;
-    WORDS_EGGWAVE_SIZE.y = (spriteUV.topLeft.y - spriteUV.botRight.y) * SCREEN_RESOLUTION.y * SCALER_WORDSIZE_HEIGHT;
-
-    spriteUV.topLeft.x = WORDS_SPRITE_BEWARE.topLeft.x / _spriteSheetRemaining->WIDTH_PIXELS;
-    spriteUV.topLeft.y = WORDS_SPRITE_BEWARE.topLeft.y / _spriteSheetRemaining->HEIGHT_PIXELS;
-    spriteUV.botRight.x = WORDS_SPRITE_BEWARE.botRight.x / _spriteSheetRemaining->WIDTH_PIXELS;
-    spriteUV.botRight.y = WORDS_SPRITE_BEWARE.botRight.y / _spriteSheetRemaining->HEIGHT_PIXELS;
-    _wordPopups[WORDS_BEWARE] = spriteNew(_spriteSheetRemaining, spriteUV, 0.99f);
-    WORDS_BEWARE_SIZE.x = (spriteUV.botRight.x - spriteUV.topLeft.x) * SCREEN_RESOLUTION.x * SCALER_WORDSIZE_WIDTH;
-    WORDS_BEWARE_SIZE.y = (spriteUV.topLeft.y - spriteUV.botRight.y) * SCREEN_RESOLUTION.y * SCALER_WORDSIZE_HEIGHT;
+    _levelMgrInitWordPopup(WORDS_WAVE, WORDS_SPRITE_WAVE, &WORDS_WAVE_SIZE);
+    _levelMgrInitWordPopup(WORDS_PREPARE, WORDS_SPRITE_PREPARE, &WORDS_PREPARE_SIZE);
+    _levelMgrInitWordPopup(WORDS_GAMEOVER, WORDS_SPRITE_GAMEOVER, &WORDS_GAMEOVER_SIZE);
+    _levelMgrInitWordPopup(WORDS_BUZZARD, WORDS_SPRITE_BUZZARD, &WORDS_BUZZARD_SIZE);
+    _levelMgrInitWordPopup(WORDS_SURVIVAL, WORDS_SPRITE_SURVIVAL, &WORDS_SURVIVAL_SIZE);
+    _levelMgrInitWordPopup(WORDS_EGGWAVE, WORDS_SPRITE_EGGWAVE, &WORDS_EGGWAVE_SIZE);
+    _levelMgrInitWordPopup(WORDS_BEWARE, WORDS_SPRITE_BEWARE, &WORDS_BEWARE_SIZE);
+}
+
+static void _levelMgrInitWordPopup(uint8_t word, Bounds2D spriteBounds, Coord2D* size)
+{
+    _wordPopups[word] = spriteAtlasAdd(SPRITE_SHEET_REMAINING, spriteBounds, 0.99f);
+
+    // Size the word relative to its sheet, based on the starting screen size
+    const SpriteAtlasSheetDef* sheet = &SPRITE_SHEETS[SPRITE_SHEET_REMAINING];
+    size->x = (spriteBounds.botRight.x - spriteBounds.topLeft.x) / sheet->WIDTH_PIXELS * SCREEN_RESOLUTION.x * SCALER_WORDSIZE_WIDTH;
+    size->y = (spriteBounds.topLeft.y - spriteBounds.botRight.y) / sheet->HEIGHT_PIXELS * SCREEN_RESOLUTION.y * SCALER_WORDSIZE_HEIGHT;
 }
 
 static void _levelMgrDeinitWordPopups()
 {
-    for (uint8_t i = 0; i < WORDS_COUNT; ++i)
-    {
-        spriteDelete(_wordPopups[i]);
-    }
+    // The words belong to the sprite atlas
 }
 
 static void _levelMgrInitSounds()
 {
     for (uint8_t i = 0; i < SOUND_COUNT; ++i)
     {
-        _sounds[i] = soundOneShotNew(SOUND_FILES[i], SOUND_LENGTHS[i]);
+        // Silent until the loader has it
+        _sounds[i] = soundOneShotNew(assetLoaderGetSound(i));
     }
 }
 
@@ -828,14 +979,14 @@ static void _levelMgrDeinitSounds()
 /// <param name="milliseconds"></param>
 static void _levelMgrSpawnEntity(Level* level, uint32_t milliseconds)
 {
-    assert(_player != NULL);
+    assert(_levelMgr->player != NULL);
 
     // Check if it is time to spawn an entity
-    _spawnTimer += milliseconds;
-    if (_spawnTimer >= _spawnCycle)
+    _levelMgr->spawnTimer += milliseconds;
+    if (_levelMgr->spawnTimer >= _spawnCycle)
     {
         // Check if player needs to spawn (check if player is disabled & has at least 1 life)
-        if (!objIsEnabled((Object*)_player) && playerGetLives(_player) > 0)
+        if (!objIsEnabled((Object*)_levelMgr->player) && playerGetLives(_levelMgr->player) > 0)
         {
             // Avoid any spawn camping if the feature is disabled
             if (_canSpawnCamp == false)
@@ -846,39 +997,39 @@ static void _levelMgrSpawnEntity(Level* level, uint32_t milliseconds)
 
                     // Check if there are any enemies near the active spawn location
                     bool isOpenSpawn = true;
-                    for (uint8_t i = 0; i < level->numEnemies; ++i)
+                    for (uint16_t i = 0; i < level->numEnemies; ++i)
                     {
-                        Object* enemy = (Object*)level->enemies[i];
-                        if (objIsEnabled(enemy) && toolDistance(_spawnLocations[_spawnActiveLocation], enemy->position) <= _safeSpawnRadius)
+                        Object* enemy = objMgrGet(level->enemies[i]);
+                        if (enemy != NULL && objIsEnabled(enemy) && toolDistance(_levelMgr->spawnLocations[_levelMgr->spawnActiveLocation], enemy->position) <= _safeSpawnRadius)
                         {
                             isOpenSpawn = false;
                             break;
                         }
                     }
                     if (isOpenSpawn) { break; }
-                    if (++_spawnActiveLocation >= _numSpawnLocations) { _spawnActiveLocation = 0; }
+                    if (++_levelMgr->spawnActiveLocation >= _numSpawnLocations) { _levelMgr->spawnActiveLocation = 0; }
                 }
             }
 
             // Spawn player
-            ((Object*)_player)->position.x = _spawnLocations[_spawnActiveLocation].x;
-            ((Object*)_player)->position.y = _spawnLocations[_spawnActiveLocation].y - ((Object*)_player)->size.y / 2;
-            objEnable((Object*)_player);
+            ((Object*)_levelMgr->player)->position.x = _levelMgr->spawnLocations[_levelMgr->spawnActiveLocation].x;
+            ((Object*)_levelMgr->player)->position.y = _levelMgr->spawnLocations[_levelMgr->spawnActiveLocation].y - ((Object*)_levelMgr->player)->size.y / 2;
+            objEnable((Object*)_levelMgr->player);
 
             // Reduce the lives counter by one
-            --_playerLivesDisplay->numSpritesToDisplay;
+            --_levelMgr->playerLivesDisplay->numSpritesToDisplay;
 
             // Sfx
             soundOneShotPlayIsolated(_sounds[SOUND_SPAWN], true);
 
             // Move to the next spawn location
-            _spawnTimer = 0;
-            if (++_spawnActiveLocation >= _numSpawnLocations) { _spawnActiveLocation = 0; }
+            _levelMgr->spawnTimer = 0;
+            if (++_levelMgr->spawnActiveLocation >= _numSpawnLocations) { _levelMgr->spawnActiveLocation = 0; }
             return;
         }
 
         // Check if an enemy needs to spawn (the number of spawned enemies < number of enemies in wave)
-        if (_numSpawnedEnemies < level->numEnemies)
+        if (_levelMgr->numSpawnedEnemies < level->numEnemies)
         {
             // Avoid any spawn camping if the feature is disabled
             if (_canSpawnCamp == false)
@@ -890,26 +1041,29 @@ static void _levelMgrSpawnEntity(Level* level, uint32_t milliseconds)
                     // Check if there are any players near the active spawn location
                     bool isOpenSpawn = true;
 
-                    if (objIsEnabled((Object*)_player) && toolDistance(_spawnLocations[_spawnActiveLocation], ((Object*)_player)->position) <= _safeSpawnRadius)
+                    if (objIsEnabled((Object*)_levelMgr->player) && toolDistance(_levelMgr->spawnLocations[_levelMgr->spawnActiveLocation], ((Object*)_levelMgr->player)->position) <= _safeSpawnRadius)
                     {
                         isOpenSpawn = false;
                     }
                     if (isOpenSpawn) { break; }
-                    if (++_spawnActiveLocation >= _numSpawnLocations) { _spawnActiveLocation = 0; }
+                    if (++_levelMgr->spawnActiveLocation >= _numSpawnLocations) { _levelMgr->spawnActiveLocation = 0; }
                 }
             }
 
 
-            Enemy* enemy = level->enemies[_numSpawnedEnemies];
-            ((Object*)enemy)->position.x = _spawnLocations[_spawnActiveLocation].x;
-            ((Object*)enemy)->position.y = _spawnLocations[_spawnActiveLocation].y - ((Object*)enemy)->size.y / 2;
-            objEnable((Object*)enemy);
+            Object* enemy = objMgrGet(level->enemies[_levelMgr->numSpawnedEnemies]);
+            if (enemy != NULL)
+            {
+                enemy->position.x = _levelMgr->spawnLocations[_levelMgr->spawnActiveLocation].x;
+                enemy->position.y = _levelMgr->spawnLocations[_levelMgr->spawnActiveLocation].y - enemy->size.y / 2;
+                objEnable(enemy);
+            }
 
             soundOneShotPlayIsolated(_sounds[SOUND_SPAWN], false);
 
-            _spawnTimer = 0;
-            if (++_spawnActiveLocation >= _numSpawnLocations) { _spawnActiveLocation = 0; }
-            ++_numSpawnedEnemies;
+            _levelMgr->spawnTimer = 0;
+            if (++_levelMgr->spawnActiveLocation >= _numSpawnLocations) { _levelMgr->spawnActiveLocation = 0; }
+            ++_levelMgr->numSpawnedEnemies;
             return;
         }
     }
@@ -922,7 +1076,7 @@ static void _levelMgrSpawnEntity(Level* level, uint32_t milliseconds)
 /// <param name="enemy"></param>
 static void _levelMgrEnemyKilled(Object* enemy)
 {
-    --_numAliveEnemies;
+    --_levelMgr->numAliveEnemies;
 
     soundOneShotPlayIsolated(_sounds[SOUND_DEATH], false);
     
@@ -953,14 +1107,14 @@ static void _levelMgrEnemyKilled(Object* enemy)
     }
 
     // Give the player points, and if necessary an extra life
-    _scorePlayer1->numberToDisplay += pointsGained;
-    _extraLifePointCounter += pointsGained;
-    if (_extraLifePointCounter >= _extraLifePointsThreshold)
+    _levelMgr->scorePlayer1->numberToDisplay += pointsGained;
+    _levelMgr->extraLifePointCounter += pointsGained;
+    if (_levelMgr->extraLifePointCounter >= _extraLifePointsThreshold)
     {
-        _extraLifePointCounter -= _extraLifePointsThreshold;
-        if (playerAddLife(_player))
+        _levelMgr->extraLifePointCounter -= _extraLifePointsThreshold;
+        if (playerAddLife(_levelMgr->player))
         {
-            ++_playerLivesDisplay->numSpritesToDisplay;
+            ++_levelMgr->playerLivesDisplay->numSpritesToDisplay;
             soundOneShotPlayIsolated(_sounds[SOUND_EXTRALIFE], true);
         }
     }
@@ -972,7 +1126,7 @@ static void _levelMgrEnemyKilled(Object* enemy)
 /// <param name=""></param>
 static void _levelMgrPlayerKilled(void)
 {
-    _spawnTimer = 0;
+    _levelMgr->spawnTimer = 0;
 
     soundOneShotPlayIsolated(_sounds[SOUND_DEATH], true);
 }
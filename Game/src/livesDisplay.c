@@ -4,50 +4,47 @@
 
 static const Coord2D _LIFE_SPRITE_PLAYER1_TL = { .x = 195.5f, .y = 371 };
 static const Coord2D _LIFE_SPRITE_PLAYER1_BR = { .x = 209, .y = 352 };
-static Sprite* _player1LifeSprite = NULL;
+static SpriteId _player1LifeSprite = 0;
 
 	// These should not be used at all currently, no sprite has been made for player 2. This is only for future development.
 static const Coord2D _LIFE_SPRITE_PLAYER2_TL;
 static const Coord2D _LIFE_SPRITE_PLAYER2_BR;
-static Sprite* _player2LifeSprite = NULL;
+static SpriteId _player2LifeSprite = 0;
 
 
 // =============== vTable ===============
-static void _livesDisplayDraw(Object* obj);
+static void _livesDisplayDraw(const Object* obj);
 static ObjVtable _livesDisplayVtable = {
 	livesDisplayDelete,
 	_livesDisplayDraw,
 	NULL,
+	NULL,
+	NULL,
 	NULL
 };
 
 
 /// <summary>
-/// Initializes the internal life display sprites.
+/// Adds the life display sprites to the sprite atlas.
 /// </summary>
-/// <param name="sheet"></param>
-void livesDisplayInit(const SpriteSheet* const sheet)
+/// <param name="sheetIndex"></param>
+void livesDisplayInit(uint8_t sheetIndex)
 {
 	// This should create the sprites used for displaying lives
-	Bounds2D spriteUV;
+	Bounds2D spriteBounds;
 		// Player 1
-	spriteUV.topLeft.x = _LIFE_SPRITE_PLAYER1_TL.x / sheet->WIDTH_PIXELS;
-	spriteUV.topLeft.y = _LIFE_SPRITE_PLAYER1_TL.y / sheet->HEIGHT_PIXELS;
-	spriteUV.botRight.x = _LIFE_SPRITE_PLAYER1_BR.x / sheet->WIDTH_PIXELS;
-	spriteUV.botRight.y = _LIFE_SPRITE_PLAYER1_BR.y / sheet->HEIGHT_PIXELS;
-	_player1LifeSprite = spriteNew(sheet, spriteUV, 0);
-	assert(_player1LifeSprite != NULL);
+	spriteBounds.topLeft = _LIFE_SPRITE_PLAYER1_TL;
+	spriteBounds.botRight = _LIFE_SPRITE_PLAYER1_BR;
+	_player1LifeSprite = spriteAtlasAdd(sheetIndex, spriteBounds, 0);
 
 		// Player 2 - Not currently implemented (out of scope)
 }
 
 /// <summary>
-/// Deletes the internal life display sprites.
+/// Nothing to free: the life display sprites belong to the sprite atlas.
 /// </summary>
 void livesDisplayShutdown()
 {
-	// This should destroy the sprites used for displaying lives
-	spriteDelete(_player1LifeSprite);
 }
 
 
@@ -119,15 +116,15 @@ void livesDisplayDelete(Object* obj)
 /// Draws the life display object to the screen.
 /// </summary>
 /// <param name="obj"></param>
-static void _livesDisplayDraw(Object* obj)
+static void _livesDisplayDraw(const Object* obj)
 {
-	LivesDisplay* livesDisplay = (LivesDisplay*)obj;
+	const LivesDisplay* livesDisplay = (const LivesDisplay*)obj;
 
 	// Display the number of lives left starting from the left
 	uint8_t numSprites = livesDisplay->numSprites;
 	uint8_t numSpritesToDisplay = livesDisplay->numSpritesToDisplay;
 	for (uint8_t i = 0; i < numSpritesToDisplay; ++i)
 	{
-		spriteDraw(livesDisplay->sprite, livesDisplay->_spritePositions[numSprites - 1 - i], livesDisplay->_dimensionsPerSprite, false);
+		spriteDraw(spriteAtlasGet(livesDisplay->sprite), livesDisplay->_spritePositions[numSprites - 1 - i], livesDisplay->_dimensionsPerSprite, false);
 	}
 }
@@ -5,71 +5,51 @@
 #include "joustGlobalConstants.h"
 
 
-static Sprite* _numbersYellow[10];
-static Sprite* _numbersBlue[10];
-static Sprite* _numbersWhite[10];
+// The first of each set's ten digits in the sprite atlas, which follow it in order
+static SpriteId _numbersYellow = 0;
+static SpriteId _numbersBlue = 0;
+static SpriteId _numbersWhite = 0;
 
 
 // =============== vTable ===============
-static void _numberDisplayDraw(Object* obj);
+static void _numberDisplayDraw(const Object* obj);
 static ObjVtable _numberDisplayVtable = {
 	numberDisplayDelete,
 	_numberDisplayDraw,
 	NULL,
+	NULL,
+	NULL,
 	NULL
 };
 
 
 /// <summary>
-/// Initializes all the internal sprites for various sets of colored numbers.
+/// Adds the sprites for the various sets of colored numbers to the sprite atlas.
 /// </summary>
-/// <param name="sheet"></param>
-void numberDisplayInit(const SpriteSheet* const sheet)
+/// <param name="sheetIndex"></param>
+void numberDisplayInit(uint8_t sheetIndex)
 {
-	// Set all the values of the number sprite arrays
-	
-	Bounds2D spriteUV;
+	Bounds2D spriteBounds;
 
 		// Yellow
-	spriteUV.topLeft.y = NUMBER_SPRITE_YELLOW_0_TL.y / sheet->HEIGHT_PIXELS;
-	spriteUV.botRight.y = NUMBER_SPRITE_YELLOW_0_BR.y / sheet->HEIGHT_PIXELS;
-	for (uint8_t i = 0; i < 10; ++i)
-	{
-		spriteUV.topLeft.x = (NUMBER_SPRITE_YELLOW_0_TL.x + (i * NUMBER_SPRITE_PIXELS_BETWEEN_SPRITES)) / sheet->WIDTH_PIXELS;
-		spriteUV.botRight.x = (NUMBER_SPRITE_YELLOW_0_BR.x + (i * NUMBER_SPRITE_PIXELS_BETWEEN_SPRITES)) / sheet->WIDTH_PIXELS;
-		_numbersYellow[i] = spriteNew(sheet, spriteUV, 0);
-	}
+	spriteBounds.topLeft = NUMBER_SPRITE_YELLOW_0_TL;
+	spriteBounds.botRight = NUMBER_SPRITE_YELLOW_0_BR;
+	_numbersYellow = spriteAtlasAddStrip(sheetIndex, spriteBounds, 10, NUMBER_SPRITE_PIXELS_BETWEEN_SPRITES, 0);
 		// Blue
-	spriteUV.topLeft.y = NUMBER_SPRITE_BLUE_0_TL.y / sheet->HEIGHT_PIXELS;
-	spriteUV.botRight.y = NUMBER_SPRITE_BLUE_0_BR.y / sheet->HEIGHT_PIXELS;
-	for (uint8_t i = 0; i < 10; ++i)
-	{
-		spriteUV.topLeft.x = (NUMBER_SPRITE_BLUE_0_TL.x + (i * NUMBER_SPRITE_PIXELS_BETWEEN_SPRITES)) / sheet->WIDTH_PIXELS;
-		spriteUV.botRight.x = (NUMBER_SPRITE_BLUE_0_BR.x + (i * NUMBER_SPRITE_PIXELS_BETWEEN_SPRITES)) / sheet->WIDTH_PIXELS;
-		_numbersBlue[i] = spriteNew(sheet, spriteUV, 0);
-	}
+	spriteBounds.topLeft = NUMBER_SPRITE_BLUE_0_TL;
+	spriteBounds.botRight = NUMBER_SPRITE_BLUE_0_BR;
+	_numbersBlue = spriteAtlasAddStrip(sheetIndex, spriteBounds, 10, NUMBER_SPRITE_PIXELS_BETWEEN_SPRITES, 0);
 		// White
-	spriteUV.topLeft.y = NUMBER_SPRITE_WHITE_0_TL.y / sheet->HEIGHT_PIXELS;
-	spriteUV.botRight.y = NUMBER_SPRITE_WHITE_0_BR.y / sheet->HEIGHT_PIXELS;
-	for (uint8_t i = 0; i < 10; ++i)
-	{
-		spriteUV.topLeft.x = (NUMBER_SPRITE_WHITE_0_TL.x + (i * NUMBER_SPRITE_PIXELS_BETWEEN_SPRITES)) / sheet->WIDTH_PIXELS;
-		spriteUV.botRight.x = (NUMBER_SPRITE_WHITE_0_BR.x + (i * NUMBER_SPRITE_PIXELS_BETWEEN_SPRITES)) / sheet->WIDTH_PIXELS;
-		_numbersWhite[i] = spriteNew(sheet, spriteUV, 0);
-	}
+	spriteBounds.topLeft = NUMBER_SPRITE_WHITE_0_TL;
+	spriteBounds.botRight = NUMBER_SPRITE_WHITE_0_BR;
+	_numbersWhite = spriteAtlasAddStrip(sheetIndex, spriteBounds, 10, NUMBER_SPRITE_PIXELS_BETWEEN_SPRITES, 0);
 }
 
 /// <summary>
-/// Deletes the internal sprites for all number sets.
+/// Nothing to free: the number sprites belong to the sprite atlas.
 /// </summary>
 void numberDisplayShutdown()
 {
-	for (uint8_t i = 0; i < 10; ++i)
-	{
-		spriteDelete(_numbersWhite[i]);
-		spriteDelete(_numbersBlue[i]);
-		spriteDelete(_numbersYellow[i]);
-	}
 }
 
 
@@ -140,35 +120,37 @@ void numberDisplayDelete(Object* obj)
 /// Draws the number display object to the screen.
 /// </summary>
 /// <param name="obj"></param>
-static void _numberDisplayDraw(Object* obj)
+static void _numberDisplayDraw(const Object* obj)
 {
-	NumberDisplay* numberDisplay = (NumberDisplay*)obj;
+	const NumberDisplay* numberDisplay = (const NumberDisplay*)obj;
 
 	// Get the proper color array of numbers
-	const Sprite** numberArray = NULL;
+	SpriteId numberZero = 0;
+	bool isColorValid = true;
 	switch (numberDisplay->color)
 	{
 	case NUMBERCOLOR_YELLOW:
 	{
-		numberArray = _numbersYellow;
+		numberZero = _numbersYellow;
 		break;
 	}
 	case NUMBERCOLOR_BLUE:
 	{
-		numberArray = _numbersBlue;
+		numberZero = _numbersBlue;
 		break;
 	}
 	case NUMBERCOLOR_WHITE:
 	{
-		numberArray = _numbersWhite;
+		numberZero = _numbersWhite;
 		break;
 	}
 	default:
 	{
+		isColorValid = false;
 		break;
 	}
 	}
-	assert(numberArray != NULL);
+	assert(isColorValid);
 
 
 	// Pull off each of the digits and display them in the proper location based on the world space
@@ -177,7 +159,7 @@ static void _numberDisplayDraw(Object* obj)
 	for (int8_t i = numberDisplay->numDigits - 1; i >= 0; --i)
 	{
 		if (remainder / (uint32_t)pow(10, i) != 0) { isFirstDigitPrinted = true; }
-		if (isFirstDigitPrinted || i == 0) { spriteDraw(numberArray[remainder / (uint32_t)pow(10, i)], numberDisplay->_numberPositions[i], numberDisplay->_dimensionsPerNumber, false); }
+		if (isFirstDigitPrinted || i == 0) { spriteDraw(spriteAtlasGet(numberZero + remainder / (uint32_t)pow(10, i)), numberDisplay->_numberPositions[i], numberDisplay->_dimensionsPerNumber, false); }
 		remainder %= (uint32_t)pow(10, i);
 	}
 }
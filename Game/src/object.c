@@ -1,3 +1,6 @@
+#include <stdlib.h>
+#include <math.h>
+
 #include "baseTypes.h"
 #include "object.h"
 
@@ -5,6 +8,9 @@
 static ObjRegistrationFunc _registerFunc = NULL;
 static ObjRegistrationFunc _deregisterFunc = NULL;
 
+static float _interpolation = 1.0f;
+static const float INTERPOLATION_SNAP_DISTANCE = 64.0f; // moved further than this in one update = teleported/wrapped, so don't blend
+
 
 /// @brief Enable callback to a registrar on ObjInit/Deinit
 /// @param registerFunc 
@@ -22,6 +28,14 @@ void objDisableRegistration()
 }
 
 
+/// @brief Set how far between the previous and current update objects are drawn
+/// @param interpolation 0 = previous position, 1 = current position
+void objSetInterpolation(float interpolation)
+{
+    _interpolation = interpolation;
+}
+
+
 /// @brief Initialize an object. Intended to be called from subclass constructors
 /// @param obj 
 /// @param vtable 
@@ -34,8 +48,11 @@ void objInit(Object* obj, ObjVtable* vtable, Coord2D pos, bool isCollidable)
     obj->enabled = true;
     obj->collidable = isCollidable; //must have a param here for this until a better registering is available/created;
     obj->position = pos;
+    obj->prevPosition = pos;
     obj->size.x = 0;
     obj->size.y = 0;
+    obj->_handle = OBJ_HANDLE_INVALID;
+    obj->_mgrIndex = 0;
 
     if (_registerFunc != NULL)
     {
@@ -56,7 +73,7 @@ void objDeinit(Object* obj)
 
 /// @brief Draw this object, using it's vtable
 /// @param obj 
-void objDraw(Object* obj)
+void objDraw(const Object* obj)
 {
     if (obj->vtable != NULL && obj->vtable->draw != NULL) 
     {
@@ -71,6 +88,8 @@ void objUpdate(Object* obj, uint32_t milliseconds)
 {
     if (obj->enabled)
     {
+        obj->prevPosition = obj->position;
+
         if (obj->vtable != NULL && obj->vtable->update != NULL)
         {
             obj->vtable->update(obj, milliseconds);
@@ -80,12 +99,45 @@ void objUpdate(Object* obj, uint32_t milliseconds)
     }
 }
 
-/// @brief For object cleanup, deletes the object if it is marked for deletion.
+/// @brief Update this object on whichever thread the object manager hands it to, using it's vtable
+/// @param obj 
+/// @param milliseconds 
+void objParallelUpdate(Object* obj, uint32_t milliseconds)
+{
+    if (obj->enabled)
+    {
+        obj->prevPosition = obj->position;
+        obj->vtable->parallelUpdate(obj, milliseconds);
+    }
+}
+
+/// @brief Whether this object updates through objParallelUpdate rather than objUpdate
+/// @param obj 
+/// @return 
+bool objHasParallelUpdate(const Object* obj)
+{
+    return obj->vtable != NULL && obj->vtable->parallelUpdate != NULL;
+}
+
+/// @brief Late update this object, using it's vtable (if it has a late update)
+/// @param obj 
+/// @param milliseconds 
+void objLateUpdate(Object* obj, uint32_t milliseconds)
+{
+    if (obj->enabled && obj->vtable != NULL && obj->vtable->lateUpdate != NULL)
+    {
+        obj->vtable->lateUpdate(obj, milliseconds);
+    }
+}
+
+/// @brief Nothing to do by default. Objects marked for deletion are deleted by the object manager once every object has updated,
+/// so they are never freed while still being iterated.
 /// @param obj 
 /// @param milliseconds 
 void objDefaultUpdate(Object* obj, uint32_t milliseconds)
 {
-    if (obj->markedForDelete) { obj->vtable->delete(obj); } 
+    (void)obj;
+    (void)milliseconds;
 }
 
 
@@ -114,3 +166,30 @@ bool objIsEnabled(Object* obj)
 {
     return obj->enabled;
 }
+
+
+/// <summary>
+/// Offset from the object's current position to where it should be drawn, blending from the previous update by the class-wide interpolation.
+/// </summary>
+/// <param name="obj"></param>
+/// <returns>The offset to add to any drawn position derived from the object's position.</returns>
+Coord2D objGetInterpolationOffset(const Object* obj)
+{
+    Coord2D offset = { .x = obj->prevPosition.x - obj->position.x, .y = obj->prevPosition.y - obj->position.y };
+    if (fabsf(offset.x) > INTERPOLATION_SNAP_DISTANCE || fabsf(offset.y) > INTERPOLATION_SNAP_DISTANCE)
+    {
+        offset.x = offset.y = 0.0f;
+        return offset;
+    }
+
+    offset.x *= 1.0f - _interpolation;
+    offset.y *= 1.0f - _interpolation;
+    return offset;
+}
+
+/// @param obj 
+/// @return The handle the object manager assigned the object, or OBJ_HANDLE_INVALID if it isn't registered.
+ObjHandle objGetHandle(const Object* obj)
+{
+    return obj->_handle;
+}
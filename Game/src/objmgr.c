@@ -1,108 +1,213 @@
-#include <Windows.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
+#include "platform.h"
 #include "objmgr.h"
 #include "baseTypes.h"
 #include "collisionMgr.h"
+#include "physicsMgr.h"
+#include "profiler.h"
+#include "jobs.h"
+#include "world.h"
 
 
-static struct objmgr_t {
-    Object** list;
+// Handles are a slot index in the low bits and that slot's generation in the high bits. Generations start at 1,
+// so OBJ_HANDLE_INVALID (0) never resolves.
+#define HANDLE_INDEX_BITS   16
+#define HANDLE_INDEX_MASK   ((1u << HANDLE_INDEX_BITS) - 1)
+#define HANDLE_NO_SLOT      HANDLE_INDEX_MASK
+
+typedef struct objSlot_t {
+    Object*     obj;            // NULL while the slot is free
+    uint16_t    generation;     // bumped every time the slot is freed, invalidating outstanding handles
+    uint16_t    nextFree;
+} ObjSlot;
+
+struct objmgr_t {
+    Object** list;          // packed: the first count entries are all occupied
     uint32_t max;
     uint32_t count;
-} _objMgr = { NULL, 0, 0 };
 
+    ObjSlot* slots;         // handle slots, stable for as long as the object is registered
+    uint16_t firstFree;
+
+    Object** parallel;      // scratch: the objects to update on the job system this update, in list order
+};
+
+static WORLD_LOCAL ObjMgrState* _objMgr = NULL;  // the current world's
+static uint32_t _numStates = 0;                 // objects register with whichever world is current, for as long as any is around
+
+// Objects per job. Big enough that claiming a batch costs little next to updating it.
+static const uint32_t PARALLEL_UPDATE_BATCH_SIZE = 64;
 
-static bool _isFirstUpdate = true;
 
+// Function Prototypes
+static inline ObjHandle _makeHandle(uint32_t slot, uint16_t generation);
+static void _deleteMarkedObjects();
+static void _parallelUpdateRange(void* data, uint32_t begin, uint32_t end);
 
-/// @brief Initialize the object manager
+
+/// @brief Initialize an object manager, and make it the calling thread's current one
 /// @param maxObjects 
 void objMgrInit(uint32_t maxObjects)
 {
+    // the last slot index is reserved to terminate the free list
+    assert(maxObjects < HANDLE_NO_SLOT);
+
     // allocate the required space
-    _objMgr.list = malloc(maxObjects * sizeof(Object*));
-    if (_objMgr.list != NULL) {
-        // initialize as empty
-        ZeroMemory(_objMgr.list, maxObjects * sizeof(Object*));
-        _objMgr.max = maxObjects;
-        _objMgr.count = 0;
+    _objMgr = malloc(sizeof(ObjMgrState));
+    assert(_objMgr != NULL);
+    ZeroMemory(_objMgr, sizeof(ObjMgrState));
+    _objMgr->firstFree = HANDLE_NO_SLOT;
+    _objMgr->list = malloc(maxObjects * sizeof(Object*));
+    _objMgr->slots = malloc(maxObjects * sizeof(ObjSlot));
+    _objMgr->parallel = malloc(maxObjects * sizeof(Object*));
+    if (_objMgr->list != NULL && _objMgr->slots != NULL && _objMgr->parallel != NULL) {
+        // initialize as empty, w/ every slot on the free list
+        ZeroMemory(_objMgr->list, maxObjects * sizeof(Object*));
+        for (uint32_t i = 0; i < maxObjects; ++i)
+        {
+            _objMgr->slots[i].obj = NULL;
+            _objMgr->slots[i].generation = 1;
+            _objMgr->slots[i].nextFree = (uint16_t)(i + 1 < maxObjects ? i + 1 : HANDLE_NO_SLOT);
+        }
+        _objMgr->firstFree = maxObjects > 0 ? 0 : HANDLE_NO_SLOT;
+        _objMgr->max = maxObjects;
+        _objMgr->count = 0;
     }
 
     // setup registration, so all initialized objects are logged w/ the manager
-    objEnableRegistration(objMgrAdd, objMgrRemove);
+    if (_numStates++ == 0) { objEnableRegistration(objMgrAdd, objMgrRemove); }
 }
 
-/// @brief Shutdown the object manager
+/// @brief Shutdown the calling thread's current object manager
 void objMgrShutdown()
 {
-    // disable registration, since the object manager is shutting down
-    objDisableRegistration();
+    // disable registration, once the last object manager is shutting down
+    if (--_numStates == 0) { objDisableRegistration(); }
 
     // this isn't strictly required, but want to enforce proper cleanup
-    assert(_objMgr.count == 0);
+    assert(_objMgr->count == 0);
 
     // objMgr doesn't own the objects, so just clean up self
-    free(_objMgr.list);
-    _objMgr.list = NULL;
-    _objMgr.max = _objMgr.count = 0;
+    free(_objMgr->list);
+    free(_objMgr->slots);
+    free(_objMgr->parallel);
+    free(_objMgr);
+    _objMgr = NULL;
+}
+
+/// @brief The calling thread's current object manager
+/// @return 
+ObjMgrState* objMgrGetState()
+{
+    return _objMgr;
+}
+
+/// @brief Make an object manager the calling thread's current one
+/// @param state from objMgrGetState, or NULL for none
+void objMgrSetState(ObjMgrState* state)
+{
+    _objMgr = state;
 }
 
 
-/// @brief Add an object to be tracked by the manager, and to the collision manager if necessary.
+/// @brief Add an object to the end of the manager's list, and to the collision manager if necessary.
 /// @param obj 
 void objMgrAdd(Object* obj)
 {
-    for (uint32_t i = 0; i < _objMgr.max; ++i)
+    // out of space to add object!
+    assert(_objMgr->count < _objMgr->max);
+    if (_objMgr->count < _objMgr->max)
     {
-        if (_objMgr.list[i] == NULL)
-        {
-            _objMgr.list[i] = obj;
-            ++_objMgr.count;
+        // take a handle slot off the free list
+        const uint16_t slot = _objMgr->firstFree;
+        _objMgr->firstFree = _objMgr->slots[slot].nextFree;
+        _objMgr->slots[slot].obj = obj;
+        obj->_handle = _makeHandle(slot, _objMgr->slots[slot].generation);
 
-            // Add to collision manager if necessary
-            if (obj->collidable) { collisionMgrAdd((Entity*)obj); }
+        obj->_mgrIndex = _objMgr->count;
+        _objMgr->list[_objMgr->count++] = obj;
 
-            return;
+        // Add to collision/physics managers if necessary (every collidable object is an entity)
+        if (obj->collidable)
+        {
+            collisionMgrAdd((Entity*)obj);
+            physicsMgrAdd((Entity*)obj);
         }
     }
-
-    // out of space to add object!
-    assert(false);
 }
 
 /// @brief Remove an object from the manager's tracking, and from collision manager if necessary.
+/// The last object is moved into the freed slot, so the list never has holes.
 /// @param obj 
 void objMgrRemove(Object* obj)
 {
-    for (uint32_t i = 0; i < _objMgr.max; ++i)
+    const uint32_t index = obj->_mgrIndex;
+
+    // could not find object to remove!
+    assert(index < _objMgr->count && _objMgr->list[index] == obj);
+
+    // Remove from collision/physics managers if necessary (CONSIDER THE LOCATION OF THIS)
+    if (obj->collidable)
     {
-        if (obj == _objMgr.list[i])
-        {
-            // Remove from collision manager if necessary (CONSIDER THE LOCATION OF THIS)
-            if (obj->collidable) { collisionMgrRemove((Entity*)obj); }
+        collisionMgrRemove((Entity*)obj);
+        physicsMgrRemove((Entity*)obj);
+    }
 
-            // no need to free memory, so just clear the reference
-            _objMgr.list[i] = NULL;
-            --_objMgr.count;
+    // no need to free memory, so just fill the hole with the last object
+    Object* last = _objMgr->list[--_objMgr->count];
+    _objMgr->list[index] = last;
+    last->_mgrIndex = index;
+    _objMgr->list[_objMgr->count] = NULL;
 
-            return;
-        }
+    // retire the handle, so anything still holding it resolves to NULL
+    ObjSlot* slot = &_objMgr->slots[obj->_handle & HANDLE_INDEX_MASK];
+    slot->obj = NULL;
+    if (++slot->generation == 0) { slot->generation = 1; }
+    slot->nextFree = _objMgr->firstFree;
+    _objMgr->firstFree = (uint16_t)(obj->_handle & HANDLE_INDEX_MASK);
+    obj->_handle = OBJ_HANDLE_INVALID;
+}
+
+/// @brief Resolve a handle to the object it refers to
+/// @param handle 
+/// @return the object, or NULL if the handle is invalid or its object has been removed
+Object* objMgrGet(ObjHandle handle)
+{
+    const uint32_t slot = handle & HANDLE_INDEX_MASK;
+    if (slot >= _objMgr->max || _objMgr->slots[slot].generation != (uint16_t)(handle >> HANDLE_INDEX_BITS))
+    {
+        return NULL;
     }
+    return _objMgr->slots[slot].obj;
+}
 
-    // could not find object to remove!
-    assert(false);
+/// @brief Point a registered object's handle at a new copy of the object, e.g. after moving it into a pool.
+/// The caller is responsible for copying the object's contents beforehand.
+/// @param handle 
+/// @param newLocation 
+void objMgrRelocate(ObjHandle handle, Object* newLocation)
+{
+    Object* obj = objMgrGet(handle);
+    assert(obj != NULL && newLocation->_handle == handle);
+
+    _objMgr->slots[handle & HANDLE_INDEX_MASK].obj = newLocation;
+    _objMgr->list[obj->_mgrIndex] = newLocation;
 }
 
 
 /// @brief Draws all registered objects
-void objMgrDraw() 
+/// @param interpolation how far the draw is between the previous and current update
+void objMgrDraw(float interpolation) 
 {
-    for (uint32_t i = 0; i < _objMgr.max; ++i)
+    objSetInterpolation(interpolation);
+
+    for (uint32_t i = 0; i < _objMgr->count; ++i)
     {
-        Object* obj = _objMgr.list[i];
-        if (obj != NULL && obj->enabled)
+        Object* obj = _objMgr->list[i];
+        if (obj->enabled)
         {
             // TODO - consider draw order?
             objDraw(obj);
@@ -110,19 +215,120 @@ void objMgrDraw()
     }
 }
 
-/// @brief Updates all registered objects, and handles their collisions if necessary.
+/// @brief Updates all registered objects (the ones that can, in parallel once the rest have), integrates every entity's physics in one batch,
+/// late updates the objects, then handles collisions between them.
 /// @param milliseconds 
 void objMgrUpdate(uint32_t milliseconds)
 {
-    if (_isFirstUpdate) { milliseconds = 0; _isFirstUpdate = false; }
-
-    for (uint32_t i = 0; i < _objMgr.max; ++i)
+    for (uint32_t i = 0; i < _objMgr->count; )
     {
-        Object* obj = _objMgr.list[i];
-        if (obj != NULL && obj->enabled)
+        Object* obj = _objMgr->list[i];
+        if (obj->enabled && !objHasParallelUpdate(obj))
         {
             objUpdate(obj, milliseconds);
-            if (obj->collidable) { handleAllCollisions((Entity*)obj); } // I want to abstract this more, I don't like that this is being called inside object manager.
         }
+
+        // An object that removed itself was replaced by the last object, which still needs its update
+        if (i < _objMgr->count && _objMgr->list[i] == obj) { ++i; }
+    }
+
+    // Parallel updates only write to their own object, so the results don't depend on which thread ran which
+    uint32_t numParallel = 0;
+    for (uint32_t i = 0; i < _objMgr->count; ++i)
+    {
+        Object* obj = _objMgr->list[i];
+        if (obj->enabled && objHasParallelUpdate(obj))
+        {
+            _objMgr->parallel[numParallel++] = obj;
+        }
+    }
+    profilerBeginZone("objParallelUpdate");
+    jobsParallelFor(numParallel, PARALLEL_UPDATE_BATCH_SIZE, _parallelUpdateRange, &milliseconds);
+    profilerEndZone();
+
+    // Behaviour has set velocities, so move everything at once
+    profilerBeginZone("physicsMgrUpdate");
+    physicsMgrUpdate(milliseconds);
+    profilerEndZone();
+
+    for (uint32_t i = 0; i < _objMgr->count; )
+    {
+        Object* obj = _objMgr->list[i];
+        objLateUpdate(obj, milliseconds);
+
+        if (i < _objMgr->count && _objMgr->list[i] == obj) { ++i; }
+    }
+
+    // Collisions are resolved once everything has moved
+    profilerBeginZone("collisionMgrUpdate");
+    collisionMgrUpdate();
+    profilerEndZone();
+
+    // Only now that nothing is iterating them can marked objects be freed
+    _deleteMarkedObjects();
+}
+
+/// @brief Hashes the state of every registered object (FNV-1a), for checking that two runs stayed identical
+/// @return 
+uint32_t objMgrGetChecksum()
+{
+    const uint32_t FNV_OFFSET_BASIS = 2166136261u;
+    const uint32_t FNV_PRIME = 16777619u;
+
+    uint32_t hash = FNV_OFFSET_BASIS;
+    for (uint32_t i = 0; i < _objMgr->count; ++i)
+    {
+        const Object* obj = _objMgr->list[i];
+        uint32_t words[3] = { (uint32_t)obj->enabled, 0, 0 };
+        memcpy(&words[1], &obj->position.x, sizeof(uint32_t));
+        memcpy(&words[2], &obj->position.y, sizeof(uint32_t));
+
+        for (uint32_t w = 0; w < 3; ++w)
+        {
+            for (uint32_t b = 0; b < 4; ++b)
+            {
+                hash = (hash ^ ((words[w] >> (b * 8)) & 0xFF)) * FNV_PRIME;
+            }
+        }
+    }
+
+    return hash ^ _objMgr->count;
+}
+
+
+/// @brief Pack a slot and generation into a handle
+/// @param slot 
+/// @param generation 
+/// @return 
+static inline ObjHandle _makeHandle(uint32_t slot, uint16_t generation)
+{
+    return ((ObjHandle)generation << HANDLE_INDEX_BITS) | slot;
+}
+
+/// @brief Delete every object marked for deletion. Deleting removes the object from the list, moving the last object into its place.
+static void _deleteMarkedObjects()
+{
+    for (uint32_t i = 0; i < _objMgr->count; )
+    {
+        Object* obj = _objMgr->list[i];
+        if (obj->markedForDelete)
+        {
+            obj->vtable->delete(obj);
+            if (i < _objMgr->count && _objMgr->list[i] != obj) { continue; }
+        }
+        ++i;
+    }
+}
+
+/// @brief Job: parallel updates a range of the gathered objects
+/// @param data the milliseconds to update by
+/// @param begin 
+/// @param end 
+static void _parallelUpdateRange(void* data, uint32_t begin, uint32_t end)
+{
+    const uint32_t milliseconds = *(const uint32_t*)data;
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        objParallelUpdate(_objMgr->parallel[i], milliseconds);
     }
 }
@@ -0,0 +1,372 @@
+#include <stdlib.h>
+#include <assert.h>
+
+#include "platform.h"
+#include "physicsMgr.h"
+#include "objmgr.h"
+#include "simd.h"
+#include "jobs.h"
+#include "world.h"
+
+
+// Every awake entity is gathered into structure-of-arrays form, integrated 4 at a time, then scattered back.
+// Batches are padded to a whole number of lanes, so the SSE and scalar kernels run the exact same operations.
+#define PHYSICS_LANES	4
+
+static const float GRAVITY = 300;
+static const uint32_t LANE_GROUPS_PER_JOB = 256;	// entities are integrated a lane group at a time, so jobs are split along them
+
+typedef struct physBatch_t {
+	float*		posX;
+	float*		posY;
+	float*		velX;
+	float*		velY;
+	float*		terminalVelX;
+	float*		terminalVelY;
+	float*		halfHeight;
+	float*		boundsLeft;
+	float*		boundsTop;
+	float*		boundsRight;
+	float*		boundsBottom;
+	uint8_t*	hitFloor;		// per lane, whether the entity was stopped by the bottom of its game bounds
+} PhysBatch;
+
+typedef struct physJob_t {
+	uint32_t	count;			// gathered entities, not counting the padding
+	float		seconds;
+} PhysJob;
+
+struct physmgr_t {
+	ObjHandle*	list;			// packed: the first count slots are all occupied
+	uint32_t	max;
+	uint32_t	count;
+
+	// Awake entities gathered for this update
+	Entity**	entities;
+	float*		batchMemory;
+	PhysBatch	batch;
+};
+
+static WORLD_LOCAL PhysicsMgrState* _physMgr = NULL;	// the current world's
+
+// Function Prototypes
+static uint32_t _gatherBatch();
+static void _integrateBatch(uint32_t first, uint32_t count, float seconds);
+static void _scatterBatch(uint32_t first, uint32_t count);
+static void _integrateJob(void* data, uint32_t beginGroup, uint32_t endGroup);
+
+
+/// <summary>
+/// Initializes a physics manager with empty values, allocates the batch arrays, and makes it the calling thread's current one.
+/// </summary>
+/// <param name="maxObjects"></param>
+void physicsMgrInit(uint32_t maxObjects)
+{
+	_physMgr = (PhysicsMgrState*)malloc(sizeof(PhysicsMgrState));
+	assert(_physMgr != NULL);
+	ZeroMemory(_physMgr, sizeof(PhysicsMgrState));
+
+	// Allocate space for the list
+	_physMgr->list = (ObjHandle*)malloc(maxObjects * sizeof(ObjHandle));
+	if (_physMgr->list != NULL)
+	{
+		// Initialize list as empty
+		ZeroMemory(_physMgr->list, maxObjects * sizeof(ObjHandle));
+		_physMgr->max = maxObjects;
+		_physMgr->count = 0;
+	}
+
+	// Allocate the batch, rounded up to whole lanes
+	const uint32_t capacity = (maxObjects + PHYSICS_LANES - 1) / PHYSICS_LANES * PHYSICS_LANES;
+	_physMgr->entities = (Entity**)malloc(maxObjects * sizeof(Entity*));
+	_physMgr->batchMemory = (float*)malloc(11 * capacity * sizeof(float));
+	_physMgr->batch.hitFloor = (uint8_t*)malloc(capacity * sizeof(uint8_t));
+	assert(_physMgr->entities != NULL && _physMgr->batchMemory != NULL && _physMgr->batch.hitFloor != NULL);
+
+	float* memory = _physMgr->batchMemory;
+	_physMgr->batch.posX = memory;			memory += capacity;
+	_physMgr->batch.posY = memory;			memory += capacity;
+	_physMgr->batch.velX = memory;			memory += capacity;
+	_physMgr->batch.velY = memory;			memory += capacity;
+	_physMgr->batch.terminalVelX = memory;	memory += capacity;
+	_physMgr->batch.terminalVelY = memory;	memory += capacity;
+	_physMgr->batch.halfHeight = memory;		memory += capacity;
+	_physMgr->batch.boundsLeft = memory;		memory += capacity;
+	_physMgr->batch.boundsTop = memory;		memory += capacity;
+	_physMgr->batch.boundsRight = memory;	memory += capacity;
+	_physMgr->batch.boundsBottom = memory;
+}
+
+/// <summary>
+/// Ensures the calling thread's current physics manager is empty, and frees it along with its list and batch arrays.
+/// </summary>
+void physicsMgrShutdown()
+{
+	// Ensure that the list has been totally emptied
+	assert(_physMgr->count == 0);
+
+	// This manager does not own the objects, so only clean itself up
+	free(_physMgr->list);
+	free(_physMgr->entities);
+	free(_physMgr->batchMemory);
+	free(_physMgr->batch.hitFloor);
+
+	free(_physMgr);
+	_physMgr = NULL;
+}
+
+/// <summary>
+/// </summary>
+/// <returns>The calling thread's current physics manager</returns>
+PhysicsMgrState* physicsMgrGetState()
+{
+	return _physMgr;
+}
+
+/// <summary>
+/// Makes a physics manager the calling thread's current one.
+/// </summary>
+/// <param name="state">from physicsMgrGetState, or NULL for none</param>
+void physicsMgrSetState(PhysicsMgrState* state)
+{
+	_physMgr = state;
+}
+
+
+/// <summary>
+/// Adds an entity to the end of the physics manager's list if there is an open space.
+/// </summary>
+/// <param name="entity"></param>
+void physicsMgrAdd(Entity* entity)
+{
+	assert(_physMgr->count < _physMgr->max);
+	if (_physMgr->count < _physMgr->max)
+	{
+		entity->_physIndex = _physMgr->count;
+		_physMgr->list[_physMgr->count++] = objGetHandle(&entity->obj);
+	}
+}
+
+/// <summary>
+/// Removes the entity from the physics manager, moving the last entity into its slot.
+///		<para>
+/// Note: Does not delete/free the entity.
+///		</para>
+/// </summary>
+/// <param name="entity"></param>
+void physicsMgrRemove(Entity* entity)
+{
+	const uint32_t index = entity->_physIndex;
+	assert(index < _physMgr->count && _physMgr->list[index] == objGetHandle(&entity->obj));
+
+	const ObjHandle lastHandle = _physMgr->list[--_physMgr->count];
+	Entity* last = (Entity*)objMgrGet(lastHandle);
+	_physMgr->list[index] = lastHandle;
+	last->_physIndex = index;
+	_physMgr->list[_physMgr->count] = OBJ_HANDLE_INVALID;
+}
+
+
+/// <summary>
+/// Applies physics and gravity to every enabled, awake entity. Checks for collision against each entity's game bounds (top/bottom = bounce | left/right = wrap).
+///		<para>
+/// Note: Also caps velocity based on each entity's terminal velocity. Should be called once per update, after objects have updated their velocities.
+///		</para>
+/// </summary>
+/// <param name="milliseconds"></param>
+void physicsMgrUpdate(uint32_t milliseconds)
+{
+	// Every entity integrates independently of the others, so lane groups can be spread over the job system
+	const uint32_t count = _gatherBatch();
+	const uint32_t numGroups = (count + PHYSICS_LANES - 1) / PHYSICS_LANES;
+	const PhysJob job = { .count = count, .seconds = (float)milliseconds / 1000.0f };
+	jobsParallelFor(numGroups, LANE_GROUPS_PER_JOB, _integrateJob, (void*)&job);
+}
+
+
+/// <summary>
+/// Copies the state of every enabled, awake entity into the batch arrays, and pads the last lanes w/ motionless entries.
+/// </summary>
+/// <returns>The number of entities gathered.</returns>
+static uint32_t _gatherBatch()
+{
+	PhysBatch* batch = &_physMgr->batch;
+
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < _physMgr->count; ++i)
+	{
+		Entity* entity = (Entity*)objMgrGet(_physMgr->list[i]);
+		if (!entity->obj.enabled || !entity->awake) { continue; }
+
+		_physMgr->entities[count] = entity;
+		batch->posX[count] = entity->obj.position.x;
+		batch->posY[count] = entity->obj.position.y;
+		batch->velX[count] = entity->velocity.x;
+		batch->velY[count] = entity->velocity.y;
+		batch->terminalVelX[count] = entity->terminalVelocity.x;
+		batch->terminalVelY[count] = entity->terminalVelocity.y;
+		batch->halfHeight[count] = entity->obj.size.y / 2;
+		batch->boundsLeft[count] = entity->gameBounds.topLeft.x;
+		batch->boundsTop[count] = entity->gameBounds.topLeft.y;
+		batch->boundsRight[count] = entity->gameBounds.botRight.x;
+		batch->boundsBottom[count] = entity->gameBounds.botRight.y;
+		++count;
+	}
+
+	// Padding lanes are never scattered, they only need to hold finite values
+	for (uint32_t i = count; i % PHYSICS_LANES != 0; ++i)
+	{
+		batch->posX[i] = batch->posY[i] = batch->velX[i] = batch->velY[i] = 0.0f;
+		batch->terminalVelX[i] = batch->terminalVelY[i] = batch->halfHeight[i] = 0.0f;
+		batch->boundsLeft[i] = batch->boundsTop[i] = batch->boundsRight[i] = batch->boundsBottom[i] = 0.0f;
+	}
+
+	return count;
+}
+
+/// <summary>
+/// Job: integrates and scatters back a range of lane groups of the batch.
+/// </summary>
+/// <param name="data">The PhysJob.</param>
+/// <param name="beginGroup"></param>
+/// <param name="endGroup"></param>
+static void _integrateJob(void* data, uint32_t beginGroup, uint32_t endGroup)
+{
+	const PhysJob* job = (const PhysJob*)data;
+	const uint32_t first = beginGroup * PHYSICS_LANES;
+	const uint32_t end = endGroup * PHYSICS_LANES;
+
+	_integrateBatch(first, end - first, job->seconds);
+	_scatterBatch(first, (end < job->count ? end : job->count) - first);
+}
+
+/// <summary>
+/// Integrates a range of the gathered entities: clamp velocity, move, stop at the bottom/bounce off the top of the game bounds, wrap horizontally, then apply gravity.
+/// </summary>
+/// <param name="first">A multiple of the lane count.</param>
+/// <param name="count"></param>
+/// <param name="seconds"></param>
+static void _integrateBatch(uint32_t first, uint32_t count, float seconds)
+{
+	PhysBatch* batch = &_physMgr->batch;
+	const float gravityOffset = 0.5f * GRAVITY * (seconds * seconds);
+	const float gravityVelocity = GRAVITY * seconds;
+
+#ifdef GAME_SSE
+	const __m128 dt = _mm_set1_ps(seconds);
+	const __m128 offset = _mm_set1_ps(gravityOffset);
+	const __m128 gravity = _mm_set1_ps(gravityVelocity);
+	const __m128 signBit = _mm_set1_ps(-0.0f);
+
+	for (uint32_t i = first; i < first + count; i += PHYSICS_LANES)
+	{
+		__m128 posX = _mm_loadu_ps(&batch->posX[i]);
+		__m128 posY = _mm_loadu_ps(&batch->posY[i]);
+		__m128 velX = _mm_loadu_ps(&batch->velX[i]);
+		__m128 velY = _mm_loadu_ps(&batch->velY[i]);
+		const __m128 terminalX = _mm_loadu_ps(&batch->terminalVelX[i]);
+		const __m128 terminalY = _mm_loadu_ps(&batch->terminalVelY[i]);
+		const __m128 halfHeight = _mm_loadu_ps(&batch->halfHeight[i]);
+		const __m128 left = _mm_loadu_ps(&batch->boundsLeft[i]);
+		const __m128 top = _mm_loadu_ps(&batch->boundsTop[i]);
+		const __m128 right = _mm_loadu_ps(&batch->boundsRight[i]);
+		const __m128 bottom = _mm_loadu_ps(&batch->boundsBottom[i]);
+
+		// Check for velocity cap
+		velX = _mm_min_ps(_mm_max_ps(velX, _mm_xor_ps(terminalX, signBit)), terminalX);
+		velY = _mm_min_ps(_mm_max_ps(velY, _mm_xor_ps(terminalY, signBit)), terminalY);
+
+		// Initial position update
+		posX = _mm_add_ps(posX, _mm_mul_ps(velX, dt));
+		posY = _mm_add_ps(posY, _mm_add_ps(_mm_mul_ps(velY, dt), offset));
+
+		// Check for game bounds
+		const __m128 hitBottom = _mm_cmpgt_ps(_mm_add_ps(posY, halfHeight), bottom);
+		const __m128 hitTop = _mm_andnot_ps(hitBottom, _mm_cmplt_ps(_mm_sub_ps(posY, halfHeight), top));
+		posY = simdSelect(hitBottom, _mm_sub_ps(bottom, halfHeight), simdSelect(hitTop, _mm_add_ps(top, halfHeight), posY));
+		velY = simdSelect(hitTop, _mm_xor_ps(velY, signBit), _mm_andnot_ps(hitBottom, velY));
+
+		// Check for wall wrap
+		const __m128 pastLeft = _mm_cmplt_ps(posX, left);
+		const __m128 pastRight = _mm_andnot_ps(pastLeft, _mm_cmpgt_ps(posX, right));
+		posX = simdSelect(pastLeft, _mm_sub_ps(right, _mm_sub_ps(left, posX)), simdSelect(pastRight, _mm_add_ps(left, _mm_sub_ps(posX, right)), posX));
+
+		// Apply gravity to velocity
+		velY = _mm_add_ps(velY, gravity);
+
+		_mm_storeu_ps(&batch->posX[i], posX);
+		_mm_storeu_ps(&batch->posY[i], posY);
+		_mm_storeu_ps(&batch->velX[i], velX);
+		_mm_storeu_ps(&batch->velY[i], velY);
+
+		const int hitBottomBits = _mm_movemask_ps(hitBottom);
+		for (uint32_t lane = 0; lane < PHYSICS_LANES; ++lane)
+		{
+			batch->hitFloor[i + lane] = (uint8_t)((hitBottomBits >> lane) & 1);
+		}
+	}
+#else
+	for (uint32_t i = first; i < first + count; ++i)
+	{
+		// Check for velocity cap
+		float velX = batch->velX[i];
+		float velY = batch->velY[i];
+		velX = velX < -batch->terminalVelX[i] ? -batch->terminalVelX[i] : velX;
+		velX = velX > batch->terminalVelX[i] ? batch->terminalVelX[i] : velX;
+		velY = velY < -batch->terminalVelY[i] ? -batch->terminalVelY[i] : velY;
+		velY = velY > batch->terminalVelY[i] ? batch->terminalVelY[i] : velY;
+
+		// Initial position update
+		float posX = batch->posX[i] + velX * seconds;
+		float posY = batch->posY[i] + (velY * seconds + gravityOffset);
+
+		// Check for game bounds
+		batch->hitFloor[i] = posY + batch->halfHeight[i] > batch->boundsBottom[i];
+		if (batch->hitFloor[i])
+		{
+			posY = batch->boundsBottom[i] - batch->halfHeight[i];
+			velY = 0;
+		}
+		else if (posY - batch->halfHeight[i] < batch->boundsTop[i])
+		{
+			posY = batch->boundsTop[i] + batch->halfHeight[i];
+			velY = -velY;
+		}
+
+		// Check for wall wrap
+		if (posX < batch->boundsLeft[i])
+		{
+			posX = batch->boundsRight[i] - (batch->boundsLeft[i] - posX);
+		}
+		else if (posX > batch->boundsRight[i])
+		{
+			posX = batch->boundsLeft[i] + (posX - batch->boundsRight[i]);
+		}
+
+		// Apply gravity to velocity
+		batch->posX[i] = posX;
+		batch->posY[i] = posY;
+		batch->velX[i] = velX;
+		batch->velY[i] = velY + gravityVelocity;
+	}
+#endif
+}
+
+/// <summary>
+/// Copies the integrated state of a range back into the gathered entities.
+/// </summary>
+/// <param name="first"></param>
+/// <param name="count"></param>
+static void _scatterBatch(uint32_t first, uint32_t count)
+{
+	const PhysBatch* batch = &_physMgr->batch;
+	for (uint32_t i = first; i < first + count; ++i)
+	{
+		Entity* entity = _physMgr->entities[i];
+		entity->obj.position.x = batch->posX[i];
+		entity->obj.position.y = batch->posY[i];
+		entity->velocity.x = batch->velX[i];
+		entity->velocity.y = batch->velY[i];
+		if (batch->hitFloor[i]) { entity->isGrounded = true; }
+	}
+}
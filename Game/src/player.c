@@ -1,9 +1,12 @@
 #include <math.h>
+#include <assert.h>
 
 #include "player.h"
 #include "animation.h"
 #include "joustGlobalConstants.h"
 #include "collision.h"
+#include "pool.h"
+#include "world.h"
 
 
 #define VK_X	0x58
@@ -17,9 +20,6 @@
 #define PLAYER_ANIM_IDLE_FRAME		3
 
 
-static bool	_wasPressedLastFrame_X = false;
-
-
 typedef struct player_t {
 	Entity entity;
 
@@ -37,18 +37,22 @@ typedef struct player_t {
 	uint32_t amTimerFly;
 
 	bool		_currentDirection; // [false - left | true - right]
+	bool		_wasPressedLastFrame_X;
 } Player;
 
 
 // =============== vTable ===============
-static void _playerDraw(Object* obj);
+static void _playerDraw(const Object* obj);
 static void _playerUpdate(Object* obj, uint32_t milliseconds);
 static void _playerCollide(Object* thisObj, Object* otherObj, Collision collision);
+static void _playerLateUpdate(Object* obj, uint32_t milliseconds);
 static ObjVtable _playerVtable = {
 	playerDelete,
 	_playerDraw,
 	_playerUpdate,
-	_playerCollide
+	_playerCollide,
+	_playerLateUpdate,
+	NULL
 };
 
 
@@ -57,6 +61,8 @@ static Animation* _animRunning = NULL;
 static Animation* _animRunSlowing = NULL;
 static Animation* _animFlying = NULL;
 
+static WORLD_LOCAL Pool* _playerPool = NULL;	// the current world's
+
 
 // CALLBACKS
 static PlayerEnemyKilledCB _enemyKilledCB = NULL;
@@ -67,6 +73,8 @@ static void _playerTriggerEnemyKilledCB(Object* enemy);
 static void _playerTriggerPlayerKilledCB();
 static void _playerTriggerPlayerActionCB(const char* action);
 
+static void _playerAdvanceAnimation(Player* player);
+
 
 /// <summary>
 /// Sets the internal enemyKilled class callback.
@@ -125,13 +133,13 @@ void playerClearPlayerActionCB()
 /// <summary>
 /// Initializes all necessary player animations.
 /// </summary>
-/// <param name="sheet"></param>
-void playerInitAnimations(const SpriteSheet* const sheet)
+/// <param name="sheetIndex"> - Which of the sprite atlas's sheets the animations are on.</param>
+void playerInitAnimations(uint8_t sheetIndex)
 {
-	_animIdle = animationNew(PLAYER_ANIMATION_IDLE_NUM_FRAMES, sheet, PLAYER_ANIMATION_IDLE_FIRST_SPRITE_BOUNDS, PLAYER_ANIMATION_IDLE_PIXELS_BETWEEN_FRAMES, 0);
-	_animRunning = animationNew(PLAYER_ANIMATION_RUNNING_NUM_FRAMES, sheet, PLAYER_ANIMATION_RUNNING_FIRST_SPRITE_BOUNDS, PLAYER_ANIMATION_RUNNING_PIXELS_BETWEEN_FRAMES, 0);
-	_animRunSlowing = animationNew(PLAYER_ANIMATION_RUNSLOWING_NUM_FRAMES, sheet, PLAYER_ANIMATION_RUNSLOWING_FIRST_SPRITE_BOUNDS, PLAYER_ANIMATION_RUNSLOWING_PIXELS_BETWEEN_FRAMES, 0);
-	_animFlying = animationNew(PLAYER_ANIMATION_FLYING_NUM_FRAMES, sheet, PLAYER_ANIMATION_FLYING_FIRST_SPRITE_BOUNDS, PLAYER_ANIMATION_FLYING_PIXELS_BETWEEN_FRAMES, 0);
+	_animIdle = animationNew(PLAYER_ANIMATION_IDLE_NUM_FRAMES, sheetIndex, PLAYER_ANIMATION_IDLE_FIRST_SPRITE_BOUNDS, PLAYER_ANIMATION_IDLE_PIXELS_BETWEEN_FRAMES, 0);
+	_animRunning = animationNew(PLAYER_ANIMATION_RUNNING_NUM_FRAMES, sheetIndex, PLAYER_ANIMATION_RUNNING_FIRST_SPRITE_BOUNDS, PLAYER_ANIMATION_RUNNING_PIXELS_BETWEEN_FRAMES, 0);
+	_animRunSlowing = animationNew(PLAYER_ANIMATION_RUNSLOWING_NUM_FRAMES, sheetIndex, PLAYER_ANIMATION_RUNSLOWING_FIRST_SPRITE_BOUNDS, PLAYER_ANIMATION_RUNSLOWING_PIXELS_BETWEEN_FRAMES, 0);
+	_animFlying = animationNew(PLAYER_ANIMATION_FLYING_NUM_FRAMES, sheetIndex, PLAYER_ANIMATION_FLYING_FIRST_SPRITE_BOUNDS, PLAYER_ANIMATION_FLYING_PIXELS_BETWEEN_FRAMES, 0);
 }
 
 /// <summary>
@@ -153,6 +161,44 @@ void playerDeinitAnimations()
 }
 
 
+/// <summary>
+/// Allocates room for the passed in number of players up front, so creating and deleting them doesn't touch the heap.
+/// The pool becomes the calling thread's current one.
+/// </summary>
+/// <param name="maxPlayers"></param>
+void playerInitPool(uint32_t maxPlayers)
+{
+	_playerPool = poolNew(sizeof(Player), maxPlayers);
+}
+
+/// <summary>
+/// Frees the player pool. Every player from the pool must have been deleted already.
+/// </summary>
+void playerDeinitPool()
+{
+	assert(_playerPool == NULL || poolGetCount(_playerPool) == 0);
+	poolDelete(_playerPool);
+	_playerPool = NULL;
+}
+
+/// <summary>
+/// </summary>
+/// <returns>The calling thread's current player pool</returns>
+Pool* playerGetPool()
+{
+	return _playerPool;
+}
+
+/// <summary>
+/// Makes a player pool the calling thread's current one, which new players are allocated from.
+/// </summary>
+/// <param name="pool">from playerGetPool, or NULL for none</param>
+void playerSetPool(Pool* pool)
+{
+	_playerPool = pool;
+}
+
+
 /// <summary>
 /// Creates a player object.
 /// </summary>
@@ -161,7 +207,9 @@ void playerDeinitAnimations()
 /// <returns></returns>
 Player* playerNew(Coord2D startPos, Coord2D size)
 {
-	Player* player = (Player*)malloc(sizeof(Player));
+	// Only fall back to the heap if more are alive than the pool was sized for
+	Player* player = _playerPool != NULL ? (Player*)poolAlloc(_playerPool) : NULL;
+	if (player == NULL) { player = (Player*)malloc(sizeof(Player)); }
 	if (player != NULL)
 	{
 		entityInit(&player->entity, &_playerVtable, startPos, size);
@@ -186,6 +234,7 @@ Player* playerNew(Coord2D startPos, Coord2D size)
 		player->amTimerFly = 0;
 
 		player->_currentDirection = true; // Player starts by facing to the right
+		player->_wasPressedLastFrame_X = false;
 	}
 	return player;
 }
@@ -200,7 +249,9 @@ void playerDelete(Object* player)
 	{
 		entityDeinit(&((Player*)player)->entity);
 	}
-	free(player);
+
+	if (poolOwns(_playerPool, player)) { poolFree(_playerPool, player); }
+	else { free(player); }
 }
 
 
@@ -208,53 +259,23 @@ void playerDelete(Object* player)
 /// Draws the player to the screen with their appropriate animation. Also handles screen wrapping.
 /// </summary>
 /// <param name="obj"></param>
-static void _playerDraw(Object* obj)
+static void _playerDraw(const Object* obj)
 {
-	Player* player = (Player*)obj;
+	const Player* player = (const Player*)obj;
 
-	uint32_t animationSpeed = 0;
-	uint32_t* animationTimer = NULL;
 	Coord2D playerSize = player->entity.obj.size;
 	Coord2D playerPos = player->entity.obj.position;
-	if (player->animation == _animIdle)
+	if (player->animation == _animFlying)
 	{
-		animationSpeed = player->amSpeedMSIdle;
-		animationTimer = &player->amTimerIdle;
-	}
-	else if (player->animation == _animRunning)
-	{
-		animationSpeed = player->amSpeedMSRun;
-		animationTimer = &player->amTimerRun;
-	}
-	else if (player->animation == _animRunSlowing)
-	{
-		animationSpeed = player->amSpeedMSRunSlow;
-		animationTimer = &player->amTimerRunSlow;
-	}
-	else if (player->animation == _animFlying)
-	{
-		animationSpeed = player->amSpeedMSFly;
-		animationTimer = &player->amTimerFly;
 		playerSize = player->entity.flyingSize;
 		playerPos = player->entity.flyingPosition;
 	}
-	assert(animationTimer != NULL);
 
-	if (*animationTimer >= animationSpeed)
-	{
-		*animationTimer = 0;
-		if (++player->amCurFrame >= player->animation->numFrames)
-		{
-			if (player->animation == _animFlying)
-			{
-				player->amCurFrame = PLAYER_ANIM_WING_UP_FRAME;
-			}
-			else
-			{
-				player->amCurFrame = 0;
-			}
-		}
-	}
+	// Draw between the last two updates
+	Coord2D interpolationOffset = objGetInterpolationOffset(obj);
+	playerPos.x += interpolationOffset.x;
+	playerPos.y += interpolationOffset.y;
+
 	animationDraw(player->animation, player->amCurFrame, playerPos, playerSize, !player->_currentDirection);
 
 	// Check for other side of screen redraw here!!!
@@ -284,11 +305,11 @@ static void _playerUpdate(Object* obj, uint32_t milliseconds)
 	Player* player = (Player*)obj;
 
 	// Left-Right input detection
-	if (inputKeyPressed(VK_RIGHT) && inputKeyPressed(VK_LEFT))
+	if (worldIsActionPressed(WORLD_ACTION_RIGHT) && worldIsActionPressed(WORLD_ACTION_LEFT))
 	{
 		// Should be empty, neither direction should be affected when both inputs are down
 	}
-	else if (inputKeyPressed(VK_RIGHT))
+	else if (worldIsActionPressed(WORLD_ACTION_RIGHT))
 	{
 		player->entity.velocity.x += ENT_DEFAULT_VELOCITY_CHANGE / ((player->entity.isGrounded) ? 1 : 2);
 		if (player->entity.isGrounded == false) { player->_currentDirection = true; }
@@ -306,7 +327,7 @@ static void _playerUpdate(Object* obj, uint32_t milliseconds)
 			}
 		}
 	}
-	else if (inputKeyPressed(VK_LEFT))
+	else if (worldIsActionPressed(WORLD_ACTION_LEFT))
 	{
 		player->entity.velocity.x -= ENT_DEFAULT_VELOCITY_CHANGE / ((player->entity.isGrounded) ? 1 : 2);
 		if (player->entity.isGrounded == false) { player->_currentDirection = false; }
@@ -335,13 +356,13 @@ static void _playerUpdate(Object* obj, uint32_t milliseconds)
 	
 
 	// Check for flapping
-	if (!inputKeyPressed(VK_SPACE) && _wasPressedLastFrame_X)	// Reset the bool in order to allow another single flap
+	if (!worldIsActionPressed(WORLD_ACTION_FLAP) && player->_wasPressedLastFrame_X)	// Reset the bool in order to allow another single flap
 	{
-		_wasPressedLastFrame_X = false;
+		player->_wasPressedLastFrame_X = false;
 	}
-	if (inputKeyPressed(VK_SPACE) && !_wasPressedLastFrame_X)	// Singular flap
+	if (worldIsActionPressed(WORLD_ACTION_FLAP) && !player->_wasPressedLastFrame_X)	// Singular flap
 	{
-		_wasPressedLastFrame_X = true;
+		player->_wasPressedLastFrame_X = true;
 		player->amCurFrame = PLAYER_ANIM_WING_DOWN_FRAME;
 		player->entity.velocity.y -= ENT_BALANCE_FLAP_SINGLE * ENT_DEFAULT_VELOCITY_CHANGE;
 		if (player->entity.isGrounded) 
@@ -353,10 +374,17 @@ static void _playerUpdate(Object* obj, uint32_t milliseconds)
 		}
 		_playerTriggerPlayerActionCB("flap");
 	}
+}
 
-
-	// Call the parent class's update
-	entityDefaultUpdate(obj, milliseconds);
+/// <summary>
+/// Reacts to the player's integrated position and velocity, by updating their animation timers, facing direction and flying position,
+/// then moves their animation on a frame if the timer for it has run out. Drawing only reads the frame, so it can't change what the update sees.
+/// </summary>
+/// <param name="obj"></param>
+/// <param name="milliseconds"></param>
+static void _playerLateUpdate(Object* obj, uint32_t milliseconds)
+{
+	Player* player = (Player*)obj;
 
 	// Update the animation speed accordingly
 	if (player->animation == _animRunning)
@@ -395,6 +423,55 @@ static void _playerUpdate(Object* obj, uint32_t milliseconds)
 	}
 
 	player->entity.isGrounded = false;
+
+	_playerAdvanceAnimation(player);
+}
+
+/// <summary>
+/// Moves the player's animation on to its next frame once the timer for the animation has run out. Flying loops back to the wing up frame.
+/// </summary>
+/// <param name="player"></param>
+static void _playerAdvanceAnimation(Player* player)
+{
+	uint32_t animationSpeed = 0;
+	uint32_t* animationTimer = NULL;
+	if (player->animation == _animIdle)
+	{
+		animationSpeed = player->amSpeedMSIdle;
+		animationTimer = &player->amTimerIdle;
+	}
+	else if (player->animation == _animRunning)
+	{
+		animationSpeed = player->amSpeedMSRun;
+		animationTimer = &player->amTimerRun;
+	}
+	else if (player->animation == _animRunSlowing)
+	{
+		animationSpeed = player->amSpeedMSRunSlow;
+		animationTimer = &player->amTimerRunSlow;
+	}
+	else if (player->animation == _animFlying)
+	{
+		animationSpeed = player->amSpeedMSFly;
+		animationTimer = &player->amTimerFly;
+	}
+	assert(animationTimer != NULL);
+
+	if (*animationTimer >= animationSpeed)
+	{
+		*animationTimer = 0;
+		if (++player->amCurFrame >= player->animation->numFrames)
+		{
+			if (player->animation == _animFlying)
+			{
+				player->amCurFrame = PLAYER_ANIM_WING_UP_FRAME;
+			}
+			else
+			{
+				player->amCurFrame = 0;
+			}
+		}
+	}
 }
 
 /// <summary>
@@ -0,0 +1,122 @@
+#include <stdlib.h>
+#include <assert.h>
+
+#include "pool.h"
+
+
+#define POOL_ALIGNMENT		16
+#define POOL_NO_ELEMENT		UINT32_MAX
+
+
+typedef struct pool_t {
+	uint8_t*	slab;
+	uint32_t*	nextFree;		// per element, the next element on the free list
+	uint32_t	firstFree;
+	uint32_t	elementSize;	// rounded up to the pool alignment
+	uint32_t	capacity;
+	uint32_t	count;
+} Pool;
+
+
+/// <summary>
+/// Creates a new pool, allocating room for every element it can ever hold.
+/// </summary>
+/// <param name="elementSize"></param>
+/// <param name="capacity"></param>
+/// <returns></returns>
+Pool* poolNew(uint32_t elementSize, uint32_t capacity)
+{
+	assert(elementSize > 0);
+
+	Pool* pool = (Pool*)malloc(sizeof(Pool));
+	if (pool != NULL)
+	{
+		pool->elementSize = (elementSize + POOL_ALIGNMENT - 1) & ~(uint32_t)(POOL_ALIGNMENT - 1);
+		pool->capacity = capacity;
+		pool->slab = (uint8_t*)malloc((size_t)pool->elementSize * capacity);
+		pool->nextFree = (uint32_t*)malloc(capacity * sizeof(uint32_t));
+		assert(capacity == 0 || (pool->slab != NULL && pool->nextFree != NULL));
+
+		poolReset(pool);
+	}
+	return pool;
+}
+
+/// <summary>
+/// Deletes the pool, and with it every element still allocated from it.
+/// </summary>
+/// <param name="pool"></param>
+void poolDelete(Pool* pool)
+{
+	if (pool != NULL)
+	{
+		free(pool->slab);
+		free(pool->nextFree);
+	}
+	free(pool);
+}
+
+
+/// <summary>
+/// Takes an element from the pool. Its contents are left uninitialized.
+/// </summary>
+/// <param name="pool"></param>
+/// <returns>The element, or NULL if the pool is full.</returns>
+void* poolAlloc(Pool* pool)
+{
+	if (pool->firstFree == POOL_NO_ELEMENT)
+	{
+		return NULL;
+	}
+
+	const uint32_t index = pool->firstFree;
+	pool->firstFree = pool->nextFree[index];
+	++pool->count;
+	return pool->slab + (size_t)index * pool->elementSize;
+}
+
+/// <summary>
+/// Returns an element to the pool.
+/// </summary>
+/// <param name="pool"></param>
+/// <param name="element">Must have come from this pool.</param>
+void poolFree(Pool* pool, void* element)
+{
+	assert(poolOwns(pool, element));
+
+	const uint32_t index = (uint32_t)(((uint8_t*)element - pool->slab) / pool->elementSize);
+	pool->nextFree[index] = pool->firstFree;
+	pool->firstFree = index;
+	--pool->count;
+}
+
+/// <summary>
+/// Frees every element at once. The next allocations come out in slab order, so they are contiguous again.
+/// </summary>
+/// <param name="pool"></param>
+void poolReset(Pool* pool)
+{
+	for (uint32_t i = 0; i < pool->capacity; ++i)
+	{
+		pool->nextFree[i] = i + 1 < pool->capacity ? i + 1 : POOL_NO_ELEMENT;
+	}
+	pool->firstFree = pool->capacity > 0 ? 0 : POOL_NO_ELEMENT;
+	pool->count = 0;
+}
+
+
+/// <param name="pool"></param>
+/// <param name="element"></param>
+/// <returns>Whether the element lies in the pool's slab.</returns>
+bool poolOwns(const Pool* const pool, const void* const element)
+{
+	const uint8_t* byte = (const uint8_t*)element;
+	return pool != NULL && pool->capacity > 0 && byte >= pool->slab && byte < pool->slab + (size_t)pool->elementSize * pool->capacity;
+}
+
+/// <param name="pool"></param>
+/// <returns>The number of elements currently allocated.</returns>
+uint32_t poolGetCount(const Pool* const pool)
+{
+	return pool->count;
+}
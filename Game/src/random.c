@@ -1,28 +1,103 @@
-#include <stdlib.h>
+#include <assert.h>
 #include "random.h"
 
+// Philox4x32 constants, from Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3"
+#define PHILOX_M0       0xD2511F53u
+#define PHILOX_M1       0xCD9E8D57u
+#define PHILOX_W0       0x9E3779B9u
+#define PHILOX_W1       0xBB67AE85u
+#define PHILOX_ROUNDS   10
+
+
+/// @brief Create a top level stream
+/// @param seed shared by every stream in a run
+/// @param id must be unique among the top level streams
+/// @return 
+RandStream randStreamNew(uint64_t seed, uint32_t id)
+{
+    RandStream stream = { seed, (uint64_t)id << 32, 0 };
+    return stream;
+}
+
+/// @brief Create a stream of a top level stream's, e.g. one per enemy in a level
+/// @param parent 
+/// @param index must be unique among the parent's children
+/// @return 
+RandStream randStreamDerive(const RandStream* parent, uint32_t index)
+{
+    // Children only have the low bits to themselves, and index 0 is the parent
+    assert((uint32_t)parent->id == 0 && index != UINT32_MAX);
+
+    RandStream stream = { parent->seed, parent->id | ((uint64_t)index + 1), 0 };
+    return stream;
+}
+
+/// @brief The random number a stream produces for a given draw, without needing the stream
+/// @param seed 
+/// @param id 
+/// @param counter 
+/// @return 
+uint32_t randAt(uint64_t seed, uint64_t id, uint64_t counter)
+{
+    uint32_t x0 = (uint32_t)counter;
+    uint32_t x1 = (uint32_t)(counter >> 32);
+    uint32_t x2 = (uint32_t)id;
+    uint32_t x3 = (uint32_t)(id >> 32);
+    uint32_t k0 = (uint32_t)seed;
+    uint32_t k1 = (uint32_t)(seed >> 32);
+
+    for (uint32_t round = 0; round < PHILOX_ROUNDS; ++round)
+    {
+        const uint64_t product0 = (uint64_t)PHILOX_M0 * x0;
+        const uint64_t product1 = (uint64_t)PHILOX_M1 * x2;
+        const uint32_t y0 = (uint32_t)(product1 >> 32) ^ x1 ^ k0;
+        const uint32_t y1 = (uint32_t)product1;
+        const uint32_t y2 = (uint32_t)(product0 >> 32) ^ x3 ^ k1;
+        const uint32_t y3 = (uint32_t)product0;
+        x0 = y0;
+        x1 = y1;
+        x2 = y2;
+        x3 = y3;
+
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    // The other three words are as good, but one per draw keeps a stream's draws independent of each other
+    return x0;
+}
+
+/// @brief Draw the next 32 random bits from a stream
+/// @param stream 
+/// @return 
+uint32_t randNext(RandStream* stream)
+{
+    return randAt(stream->seed, stream->id, stream->counter++);
+}
+
 /// @brief Return a random floating point value in the specified range
+/// @param stream 
 /// @param min 
 /// @param max 
-/// @return 
-float randGetFloat(float min, float max)
+/// @return [min, max)
+float randGetFloat(RandStream* stream, float min, float max)
 {
-    int r = rand();
-    float rPct = (float)r/(float)RAND_MAX;
+    // 24 bits is all a float's mantissa can hold
+    const float rPct = (float)(randNext(stream) >> 8) * (1.0f / 16777216.0f);
 
     return (rPct * (max - min)) + min;
 }
 
 /// @brief Return a random 32-bit value in the specified range
+/// @param stream 
 /// @param min 
 /// @param max 
-/// @return 
-int32_t randGetInt(int32_t min, int32_t max)
+/// @return [min, max)
+int32_t randGetInt(RandStream* stream, int32_t min, int32_t max)
 {
-    int r = rand();
-
-    r %= (max - min);
-    r += min;
+    // Scale by the high bits rather than taking the low bits modulo the range
+    const uint32_t range = (uint32_t)(max - min);
+    const uint32_t r = (uint32_t)(((uint64_t)randNext(stream) * range) >> 32);
 
-    return r;
-}
\ No newline at end of file
+    return (int32_t)r + min;
+}
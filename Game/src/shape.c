@@ -1,9 +1,9 @@
-#include <windows.h>											// Header File For Windows
 #include <math.h>
 #include <stdio.h>
-#include <gl\gl.h>												// Header File For The OpenGL32 Library
-#include <gl\glu.h>												// Header File For The GLu32 Library
+#include "platform.h"
+#ifndef FW_HEADLESS
 #include "glut.h"
+#endif
 
 #include "baseTypes.h"
 
@@ -19,6 +19,7 @@ const float DEG2RAD = 3.14159f/180.0f;
 /// @param filled solid circle, if true, outline otherwise
 void shapeDrawCircle(float radius, float x, float y, uint8_t r, uint8_t g, uint8_t b, bool filled)
 {	
+#ifndef FW_HEADLESS
 	glEnable(GL_POINT_SMOOTH);
 	glDisable(GL_TEXTURE_2D);
 	if(!filled)
@@ -48,6 +49,7 @@ void shapeDrawCircle(float radius, float x, float y, uint8_t r, uint8_t g, uint8
 		glVertex2f(x, y);
 		glEnd();
 	}
+#endif
 }
 
 /// @brief Draws a line to the screen with the given properties
@@ -60,6 +62,7 @@ void shapeDrawCircle(float radius, float x, float y, uint8_t r, uint8_t g, uint8
 /// @param b blue
 void shapeDrawLine(float startX, float startY, float endX, float endY, uint8_t r, uint8_t g, uint8_t b)
 {
+#ifndef FW_HEADLESS
 	glColor3ub(r, g, b);
 	// Draw filtered lines
 	glEnable(GL_LINE_SMOOTH);
@@ -70,4 +73,5 @@ void shapeDrawLine(float startX, float startY, float endX, float endY, uint8_t r
 		glVertex2f(endX, endY);
 	glEnd();
 
+#endif
 }
@@ -3,33 +3,89 @@
 
 #include "soundOneShot.h"
 #include "sound.h"
+#include "world.h"
 
 
 typedef struct soundOneShot_t {
 	int32_t soundId;
-	uint32_t lengthMS;
+	uint32_t durationMS;	// from the sound system, kept here for muted worlds updating on other threads
 } SoundOneShot;
 
 
-static uint32_t _currentSoundLength = 0;
-static int32_t _currentSoundId = SOUND_NOSOUND;
-static uint32_t _internalTimer = 0;
-static bool _isSoundPlaying = false;
+// What's playing in isolation, per world
+typedef struct soundOneShotState_t {
+	uint32_t currentSoundLength;
+	int32_t currentSoundId;
+	uint32_t internalTimer;
+	bool isSoundPlaying;
+	bool isMuted;
+} SoundOneShotState;
+
+static WORLD_LOCAL SoundOneShotState* _state = NULL;	// the current world's
+
+
+/// <summary>
+/// Creates the state for playing sounds in isolation, and makes it the calling thread's current one.
+/// </summary>
+void soundOneShotInit()
+{
+	_state = (SoundOneShotState*)malloc(sizeof(SoundOneShotState));
+	assert(_state != NULL);
+	_state->currentSoundLength = 0;
+	_state->currentSoundId = SOUND_NOSOUND;
+	_state->internalTimer = 0;
+	_state->isSoundPlaying = false;
+	_state->isMuted = false;
+}
+
+/// <summary>
+/// Frees the calling thread's current state for playing sounds in isolation.
+/// </summary>
+void soundOneShotShutdown()
+{
+	free(_state);
+	_state = NULL;
+}
+
+/// <summary>
+/// </summary>
+/// <returns>The calling thread's current state for playing sounds in isolation</returns>
+SoundOneShotState* soundOneShotGetState()
+{
+	return _state;
+}
+
+/// <summary>
+/// Makes a state for playing sounds in isolation the calling thread's current one.
+/// </summary>
+/// <param name="state">from soundOneShotGetState, or NULL for none</param>
+void soundOneShotSetState(SoundOneShotState* state)
+{
+	_state = state;
+}
+
+/// <summary>
+/// Keeps track of what would be playing, without playing anything. For worlds simulated away from the speakers.
+/// </summary>
+/// <param name="isMuted"></param>
+void soundOneShotSetMuted(bool isMuted)
+{
+	_state->isMuted = isMuted;
+}
 
 
 /// <summary>
 /// Creates a soundOneShot object.
 /// </summary>
-/// <param name="fileName"></param>
-/// <param name="lengthMS"></param>
+/// <param name="wav"> - The sound's format and samples, which must outlive the object. NULL for a silent one, which takes no time to play.</param>
 /// <returns></returns>
-SoundOneShot* soundOneShotNew(const char* fileName, uint32_t lengthMS)
+SoundOneShot* soundOneShotNew(const WavInfo* wav)
 {
 	SoundOneShot* soundOneShot = (SoundOneShot*)malloc(sizeof(SoundOneShot));
 	if (soundOneShot != NULL)
 	{
-		soundOneShot->soundId = soundLoad(fileName);
-		soundOneShot->lengthMS = lengthMS;
+		soundOneShot->soundId = wav != NULL ? soundLoadFromMemory(wav) : SOUND_NOSOUND;
+		soundOneShot->durationMS = soundGetDurationMS(soundOneShot->soundId);
 	}
 	return soundOneShot;
 }
@@ -46,7 +102,29 @@ void soundOneShotDelete(SoundOneShot* soundOneShot)
 
 
 /// <summary>
-/// Updates the internal timer for the sound currently playing.
+/// Gives a soundOneShot object its sound, replacing any it had. Must not be called while any world is updating.
+/// </summary>
+/// <param name="soundOneShot"></param>
+/// <param name="wav"> - The sound's format and samples, which must outlive the object.</param>
+void soundOneShotLoad(SoundOneShot* soundOneShot, const WavInfo* wav)
+{
+	soundUnload(soundOneShot->soundId);
+	soundOneShot->soundId = soundLoadFromMemory(wav);
+	soundOneShot->durationMS = soundGetDurationMS(soundOneShot->soundId);
+}
+
+/// <summary>
+/// </summary>
+/// <param name="soundOneShot"></param>
+/// <returns>Whether the soundOneShot object has a sound to play, rather than being silent</returns>
+bool soundOneShotIsLoaded(const SoundOneShot* const soundOneShot)
+{
+	return soundOneShot->soundId != SOUND_NOSOUND;
+}
+
+
+/// <summary>
+/// Updates the internal timer for the sound currently playing, which ends once it's run for the sound's duration.
 ///		<para>
 /// Note: MUST BE CALLED EVERY FRAME TO FUNCTION PROPERLY.
 ///		</para>
@@ -54,10 +132,10 @@ void soundOneShotDelete(SoundOneShot* soundOneShot)
 /// <param name="milliseconds"></param>
 void soundOneShotUpdateInternalFields(uint32_t milliseconds)
 {
-	_internalTimer += milliseconds;
-	if (_internalTimer >= _currentSoundLength)
+	_state->internalTimer += milliseconds;
+	if (_state->internalTimer >= _state->currentSoundLength)
 	{
-		_isSoundPlaying = false;
+		_state->isSoundPlaying = false;
 	}
 }
 
@@ -70,13 +148,13 @@ void soundOneShotUpdateInternalFields(uint32_t milliseconds)
 void soundOneShotPlayIsolated(const SoundOneShot* const soundOneShot, bool priority)
 {
 	assert(soundOneShot != NULL);
-	if (_isSoundPlaying == false || priority == true)
+	if (_state->isSoundPlaying == false || priority == true)
 	{
-		soundStop(_currentSoundId);
-		_currentSoundLength = soundOneShot->lengthMS;
-		_currentSoundId = soundOneShot->soundId;
-		_internalTimer = 0;
-		_isSoundPlaying = true;
-		soundPlay(soundOneShot->soundId);
+		if (!_state->isMuted) { soundStop(_state->currentSoundId); }
+		_state->currentSoundLength = soundOneShot->durationMS;
+		_state->currentSoundId = soundOneShot->soundId;
+		_state->internalTimer = 0;
+		_state->isSoundPlaying = true;
+		if (!_state->isMuted) { soundPlayWithPriority(soundOneShot->soundId, priority ? SOUND_PRIORITY_HIGH : SOUND_PRIORITY_NORMAL); }
 	}
 }
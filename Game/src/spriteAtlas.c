@@ -0,0 +1,387 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#include "platform.h"
+#include "SOIL.h"
+#include "spriteAtlas.h"
+
+
+#define SPRITE_ATLAS_PADDING	2	// empty pixels around each sheet, so no filtering or mipmap ever reaches into a neighbour
+
+static struct spriteatlas_t {
+	SpriteSheet	sheet;			// the atlas texture, which every sprite is drawn from
+	Coord2D*	sheetOrigins;	// bottom left pixel of each packed sheet, from the bottom left of the atlas
+	const SpriteAtlasSheetDef* sheets;
+	uint8_t		numSheets;
+
+	Sprite*		sprites;
+	uint16_t	numSprites;
+	uint16_t	maxSprites;
+} _spriteAtlas = { { 0, 0, 0 }, NULL, NULL, 0, NULL, 0, 0 };
+
+
+// Function Prototypes
+static void _spriteAtlasPack(const SpriteAtlasSheetDef* const sheets, uint8_t numSheets, uint32_t* lefts, uint32_t* tops);
+#ifndef FW_HEADLESS
+static void _spriteAtlasCreateTexture();
+static void _spriteAtlasMakeNTSCSafe(unsigned char* pixels, size_t numPixels);
+#endif
+static Bounds2D _spriteAtlasGetUV(uint8_t sheetIndex, Bounds2D spriteBounds);
+
+
+/// <summary>
+/// Packs every sheet into the atlas, allocates room for the passed in number of sprites, and creates the atlas's texture,
+/// transparent until its image is decoded and loaded (see spriteAtlasDecodeSheet and spriteAtlasLoadTexture).
+///		<para>
+/// Must be called w/ the GL context current, before anything is drawn: the texture's handle is copied into every draw
+/// recorded, possibly while another thread renders, so it never changes after.
+///		</para>
+/// </summary>
+/// <param name="sheets"> - Must match the dimensions of the images they name, and outlive the atlas.</param>
+/// <param name="numSheets"></param>
+/// <param name="maxSprites"></param>
+void spriteAtlasInit(const SpriteAtlasSheetDef* const sheets, uint8_t numSheets, uint16_t maxSprites)
+{
+	assert(numSheets > 0 && maxSprites > 0);
+
+	uint32_t* lefts = (uint32_t*)malloc(numSheets * sizeof(uint32_t));
+	uint32_t* tops = (uint32_t*)malloc(numSheets * sizeof(uint32_t));
+	_spriteAtlas.sheetOrigins = (Coord2D*)malloc(numSheets * sizeof(Coord2D));
+	_spriteAtlas.sprites = (Sprite*)malloc(maxSprites * sizeof(Sprite));
+	assert(lefts != NULL && tops != NULL && _spriteAtlas.sheetOrigins != NULL && _spriteAtlas.sprites != NULL);
+
+	_spriteAtlasPack(sheets, numSheets, lefts, tops);
+	_spriteAtlas.sheet.textureHandle = 0;
+#ifndef FW_HEADLESS
+	_spriteAtlasCreateTexture();
+#endif
+
+	// Sprites are placed from the bottom left, and the packing from the top left
+	for (uint8_t i = 0; i < numSheets; ++i)
+	{
+		_spriteAtlas.sheetOrigins[i].x = (float)lefts[i];
+		_spriteAtlas.sheetOrigins[i].y = (float)(_spriteAtlas.sheet.HEIGHT_PIXELS - tops[i] - sheets[i].HEIGHT_PIXELS);
+	}
+	_spriteAtlas.sheets = sheets;
+	_spriteAtlas.numSheets = numSheets;
+	_spriteAtlas.numSprites = 0;
+	_spriteAtlas.maxSprites = maxSprites;
+
+	free(tops);
+	free(lefts);
+}
+
+/// <summary>
+/// Frees the atlas, and every sprite in it.
+/// </summary>
+void spriteAtlasShutdown()
+{
+#ifndef FW_HEADLESS
+	glDeleteTextures(1, &_spriteAtlas.sheet.textureHandle);
+#endif
+	_spriteAtlas.sheet.textureHandle = 0;
+	free(_spriteAtlas.sprites);
+	free(_spriteAtlas.sheetOrigins);
+	_spriteAtlas.sprites = NULL;
+	_spriteAtlas.sheetOrigins = NULL;
+	_spriteAtlas.sheets = NULL;
+	_spriteAtlas.numSheets = 0;
+	_spriteAtlas.numSprites = _spriteAtlas.maxSprites = 0;
+}
+
+
+/// <summary>
+/// Allocates room for the atlas's image, for the sheets to be decoded into.
+/// </summary>
+/// <returns>Transparent pixels, to be freed by the caller, or NULL if there is no renderer to decode them for.</returns>
+unsigned char* spriteAtlasNewImage()
+{
+#ifdef FW_HEADLESS
+	return NULL;
+#else
+	unsigned char* pixels = (unsigned char*)calloc((size_t)_spriteAtlas.sheet.WIDTH_PIXELS * _spriteAtlas.sheet.HEIGHT_PIXELS, 4);
+	assert(pixels != NULL);
+	return pixels;
+#endif
+}
+
+/// <summary>
+/// Decodes a sheet's image into its place in the atlas's, as the texture wants it: RGBA, bottom row first, and NTSC safe.
+/// This is the slow part of loading the atlas, so the result is meant to be cached (e.g. in an asset pack).
+///		<para>
+/// Sheets touch separate pixels, so different sheets may be decoded on different threads at once.
+///		</para>
+/// </summary>
+/// <param name="sheetIndex"></param>
+/// <param name="pixels"> - From spriteAtlasNewImage.</param>
+void spriteAtlasDecodeSheet(uint8_t sheetIndex, unsigned char* pixels)
+{
+	assert(sheetIndex < _spriteAtlas.numSheets);
+#ifdef FW_HEADLESS
+	(void)pixels;
+#else
+	const SpriteAtlasSheetDef* sheet = &_spriteAtlas.sheets[sheetIndex];
+	int width, height, channels;
+	unsigned char* image = SOIL_load_image(sheet->path, &width, &height, &channels, SOIL_LOAD_RGBA);
+	assert(image != NULL && width == sheet->WIDTH_PIXELS && height == sheet->HEIGHT_PIXELS);
+
+	// Images are decoded top row first
+	const size_t atlasWidth = _spriteAtlas.sheet.WIDTH_PIXELS;
+	const size_t left = (size_t)_spriteAtlas.sheetOrigins[sheetIndex].x;
+	const size_t bottom = (size_t)_spriteAtlas.sheetOrigins[sheetIndex].y;
+	for (int row = 0; row < height; ++row)
+	{
+		unsigned char* atlasRow = &pixels[((bottom + height - 1 - row) * atlasWidth + left) * 4];
+		memcpy(atlasRow, &image[(size_t)row * width * 4], (size_t)width * 4);
+		_spriteAtlasMakeNTSCSafe(atlasRow, (size_t)width);
+	}
+	SOIL_free_image_data(image);
+#endif
+}
+
+/// <summary>
+/// Uploads the atlas's texture, all at once.
+/// </summary>
+/// <param name="pixels"> - The atlas's image, w/ every sheet decoded into it. Only read during the call.</param>
+void spriteAtlasLoadTexture(const void* pixels)
+{
+#ifdef FW_HEADLESS
+	(void)pixels;
+#else
+	glBindTexture(GL_TEXTURE_2D, _spriteAtlas.sheet.textureHandle);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, _spriteAtlas.sheet.WIDTH_PIXELS, _spriteAtlas.sheet.HEIGHT_PIXELS, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+#endif
+}
+
+/// <summary>
+/// Uploads one sheet's part of the atlas's texture, so sheets can be drawn as soon as each is decoded. The rest stays transparent until loaded.
+/// </summary>
+/// <param name="sheetIndex"></param>
+/// <param name="pixels"> - The atlas's image, w/ at least that sheet decoded into it. Only read during the call.</param>
+void spriteAtlasLoadSheet(uint8_t sheetIndex, const void* pixels)
+{
+	assert(sheetIndex < _spriteAtlas.numSheets);
+#ifdef FW_HEADLESS
+	(void)pixels;
+#else
+	const SpriteAtlasSheetDef* sheet = &_spriteAtlas.sheets[sheetIndex];
+	const GLint left = (GLint)_spriteAtlas.sheetOrigins[sheetIndex].x;
+	const GLint bottom = (GLint)_spriteAtlas.sheetOrigins[sheetIndex].y;
+	glBindTexture(GL_TEXTURE_2D, _spriteAtlas.sheet.textureHandle);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, _spriteAtlas.sheet.WIDTH_PIXELS);
+	glPixelStorei(GL_UNPACK_SKIP_PIXELS, left);
+	glPixelStorei(GL_UNPACK_SKIP_ROWS, bottom);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, left, bottom, sheet->WIDTH_PIXELS, sheet->HEIGHT_PIXELS, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+	glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+#endif
+}
+
+
+/// <summary>
+/// Adds a sprite to the atlas.
+/// </summary>
+/// <param name="sheetIndex"> - Which of the sheets the atlas was initialized with the sprite is on.</param>
+/// <param name="spriteBounds"> - In pixels of that sheet.</param>
+/// <param name="depth"></param>
+/// <returns>The sprite's index in the atlas.</returns>
+SpriteId spriteAtlasAdd(uint8_t sheetIndex, Bounds2D spriteBounds, float depth)
+{
+	assert(sheetIndex < _spriteAtlas.numSheets);
+	assert(_spriteAtlas.numSprites < _spriteAtlas.maxSprites);
+
+	const SpriteId id = _spriteAtlas.numSprites++;
+	spriteInit(&_spriteAtlas.sprites[id], &_spriteAtlas.sheet, _spriteAtlasGetUV(sheetIndex, spriteBounds), depth);
+	return id;
+}
+
+/// <summary>
+/// Adds a row of equally sized sprites to the atlas, e.g. an animation's frames. They get consecutive indices.
+///		<para>
+/// Assumes the sprites are ordered from left to right.
+///		</para>
+/// </summary>
+/// <param name="sheetIndex"></param>
+/// <param name="firstSpriteBounds"> - In pixels of the sheet.</param>
+/// <param name="numSprites"></param>
+/// <param name="pixelsPerSprite"> - How far each sprite's left edge is from the one before it.</param>
+/// <param name="depth"></param>
+/// <returns>The first sprite's index in the atlas. The rest follow it.</returns>
+SpriteId spriteAtlasAddStrip(uint8_t sheetIndex, Bounds2D firstSpriteBounds, uint8_t numSprites, float pixelsPerSprite, float depth)
+{
+	assert(numSprites > 0);
+
+	const SpriteId first = spriteAtlasAdd(sheetIndex, firstSpriteBounds, depth);
+	Bounds2D spriteBounds = firstSpriteBounds;
+	for (uint8_t i = 1; i < numSprites; ++i)
+	{
+		spriteBounds.topLeft.x += pixelsPerSprite;
+		spriteBounds.botRight.x += pixelsPerSprite;
+		spriteAtlasAdd(sheetIndex, spriteBounds, depth);
+	}
+	return first;
+}
+
+
+/// <param name="id"></param>
+/// <returns>The sprite at the passed in index.</returns>
+const Sprite* spriteAtlasGet(SpriteId id)
+{
+	assert(id < _spriteAtlas.numSprites);
+
+	return &_spriteAtlas.sprites[id];
+}
+
+/// <returns>The atlas's texture, which every sprite in it is drawn from.</returns>
+const SpriteSheet* spriteAtlasGetSheet()
+{
+	return &_spriteAtlas.sheet;
+}
+
+/// <param name="sheetIndex"></param>
+/// <returns>Where a sheet was packed: its bottom left pixel, from the bottom left of the atlas.</returns>
+Coord2D spriteAtlasGetSheetOrigin(uint8_t sheetIndex)
+{
+	assert(sheetIndex < _spriteAtlas.numSheets);
+
+	return _spriteAtlas.sheetOrigins[sheetIndex];
+}
+
+/// <returns>How many sprites have been added to the atlas.</returns>
+uint16_t spriteAtlasGetNumSprites()
+{
+	return _spriteAtlas.numSprites;
+}
+
+
+/// <summary>
+/// Places each sheet in the atlas, in rows of sheets (tallest first) about as wide as the atlas is tall, and sizes the atlas to fit them.
+/// </summary>
+/// <param name="sheets"></param>
+/// <param name="numSheets"></param>
+/// <param name="lefts"> - Receives each sheet's left pixel in the atlas.</param>
+/// <param name="tops"> - Receives each sheet's top pixel in the atlas, from the top.</param>
+static void _spriteAtlasPack(const SpriteAtlasSheetDef* const sheets, uint8_t numSheets, uint32_t* lefts, uint32_t* tops)
+{
+	uint8_t* order = (uint8_t*)malloc(numSheets * sizeof(uint8_t));
+	assert(order != NULL);
+
+	uint32_t widest = 0;
+	double area = 0;
+	for (uint8_t i = 0; i < numSheets; ++i)
+	{
+		const uint32_t width = sheets[i].WIDTH_PIXELS + 2 * SPRITE_ATLAS_PADDING;
+		const uint32_t height = sheets[i].HEIGHT_PIXELS + 2 * SPRITE_ATLAS_PADDING;
+		if (width > widest) { widest = width; }
+		area += (double)width * height;
+
+		// Tallest first, so each row wastes as little height as it can
+		uint8_t slot = i;
+		for (; slot > 0 && sheets[order[slot - 1]].HEIGHT_PIXELS < sheets[i].HEIGHT_PIXELS; --slot)
+		{
+			order[slot] = order[slot - 1];
+		}
+		order[slot] = i;
+	}
+
+	const uint32_t maxRowWidth = (uint32_t)ceil(sqrt(area)) > widest ? (uint32_t)ceil(sqrt(area)) : widest;
+	uint32_t rowLeft = 0;
+	uint32_t rowTop = 0;
+	uint32_t rowHeight = 0;
+	uint32_t atlasWidth = 0;
+	for (uint8_t i = 0; i < numSheets; ++i)
+	{
+		const SpriteAtlasSheetDef* sheet = &sheets[order[i]];
+		const uint32_t width = sheet->WIDTH_PIXELS + 2 * SPRITE_ATLAS_PADDING;
+		const uint32_t height = sheet->HEIGHT_PIXELS + 2 * SPRITE_ATLAS_PADDING;
+		if (rowLeft + width > maxRowWidth)
+		{
+			rowTop += rowHeight;
+			rowLeft = rowHeight = 0;
+		}
+
+		lefts[order[i]] = rowLeft + SPRITE_ATLAS_PADDING;
+		tops[order[i]] = rowTop + SPRITE_ATLAS_PADDING;
+		rowLeft += width;
+		if (height > rowHeight) { rowHeight = height; }
+		if (rowLeft > atlasWidth) { atlasWidth = rowLeft; }
+	}
+
+	assert(atlasWidth <= UINT16_MAX && rowTop + rowHeight <= UINT16_MAX);
+	_spriteAtlas.sheet.WIDTH_PIXELS = (uint16_t)atlasWidth;
+	_spriteAtlas.sheet.HEIGHT_PIXELS = (uint16_t)(rowTop + rowHeight);
+
+	free(order);
+}
+
+#ifndef FW_HEADLESS
+/// <summary>
+/// Creates the atlas's texture, transparent.
+/// </summary>
+static void _spriteAtlasCreateTexture()
+{
+	const size_t numBytes = (size_t)_spriteAtlas.sheet.WIDTH_PIXELS * _spriteAtlas.sheet.HEIGHT_PIXELS * 4;
+	void* transparent = calloc(numBytes, 1);
+	assert(transparent != NULL);
+
+	GLuint handle;
+	glGenTextures(1, &handle);
+	glBindTexture(GL_TEXTURE_2D, handle);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, _spriteAtlas.sheet.WIDTH_PIXELS, _spriteAtlas.sheet.HEIGHT_PIXELS, 0, GL_RGBA, GL_UNSIGNED_BYTE, transparent);
+	free(transparent);
+
+		// Nearest neighbor scaling: THANK YOU JOSH!
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+
+	_spriteAtlas.sheet.textureHandle = handle;
+}
+
+/// <summary>
+/// Squeezes the colour channels into 16..235, as SOIL_FLAG_NTSC_SAFE_RGB did when SOIL made the texture.
+/// </summary>
+/// <param name="pixels"> - RGBA. Alpha is left alone.</param>
+/// <param name="numPixels"></param>
+static void _spriteAtlasMakeNTSCSafe(unsigned char* pixels, size_t numPixels)
+{
+	const float low = 16.0f - 0.499f;
+	const float high = 235.0f + 0.499f;
+	unsigned char scale[256];
+	for (int i = 0; i < 256; ++i)
+	{
+		scale[i] = (unsigned char)((high - low) * i / 255.0f + low);
+	}
+
+	for (size_t i = 0; i < numPixels * 4; i += 4)
+	{
+		pixels[i] = scale[pixels[i]];
+		pixels[i + 1] = scale[pixels[i + 1]];
+		pixels[i + 2] = scale[pixels[i + 2]];
+	}
+}
+#endif
+
+/// <summary>
+/// Converts a sprite's bounds in pixels of its sheet to UVs in the atlas.
+/// </summary>
+/// <param name="sheetIndex"></param>
+/// <param name="spriteBounds"></param>
+/// <returns></returns>
+static Bounds2D _spriteAtlasGetUV(uint8_t sheetIndex, Bounds2D spriteBounds)
+{
+	const Coord2D origin = _spriteAtlas.sheetOrigins[sheetIndex];
+	const float width = (float)_spriteAtlas.sheet.WIDTH_PIXELS;
+	const float height = (float)_spriteAtlas.sheet.HEIGHT_PIXELS;
+
+	Bounds2D spriteUV = {	.topLeft = {.x = (origin.x + spriteBounds.topLeft.x) / width, .y = (origin.y + spriteBounds.topLeft.y) / height},
+							.botRight = {.x = (origin.x + spriteBounds.botRight.x) / width, .y = (origin.y + spriteBounds.botRight.y) / height} };
+	return spriteUV;
+}
@@ -0,0 +1,292 @@
+#include <stdlib.h>
+#include <assert.h>
+
+#include "spriteBatch.h"
+
+
+// Matches the GL_T2F_V3F interleaved array layout
+typedef struct spriteVertex_t {
+	GLfloat u, v;
+	GLfloat x, y, z;
+} SpriteVertex;
+
+typedef struct spriteQuad_t {
+	SpriteVertex	vertices[4];
+} SpriteQuad;
+
+typedef struct spriteKey_t {
+	float		depth;
+	GLuint		textureHandle;
+	uint32_t	order;			// submission order, so the sort is stable
+} SpriteKey;
+
+// A recorded sprite draw. Everything needed from the sprite is copied, since the object it belongs to
+// may be deleted before the frame is rendered.
+typedef struct spriteCommand_t {
+	GLuint		textureHandle;
+	float		depth;
+	Bounds2D	uv;
+	Coord2D		position;
+	Coord2D		size;
+	bool		horzReflect;
+} SpriteCommand;
+
+typedef struct spriteFrame_t {
+	SpriteCommand*	commands;	// in submission order
+	uint32_t		count;
+	uint32_t		max;
+} SpriteFrame;
+
+static struct spritebatch_t {
+	SpriteFrame	frames[2];
+	uint32_t	recordFrame;	// only used by the thread recording
+	uint32_t	renderFrame;	// only used by the thread rendering
+
+	// Render scratch
+	SpriteKey*	keys;
+	SpriteQuad*	sorted;			// in draw order
+	uint32_t	max;
+	uint32_t	drawCalls;		// issued by the last flush
+} _spriteBatch = { { { NULL, 0, 0 }, { NULL, 0, 0 } }, 0, 0, NULL, NULL, 0, 0 };
+
+
+// Function Prototypes
+static void _spriteBatchGrowFrame(SpriteFrame* frame);
+static void _spriteBatchGrowScratch(uint32_t count);
+static void _spriteBatchBuildQuad(const SpriteCommand* const command, SpriteQuad* quad);
+static int _spriteBatchCompareKeys(const void* a, const void* b);
+static void _spriteBatchDraw(GLuint textureHandle, uint32_t first, uint32_t count);
+
+
+/// <summary>
+/// Allocates room for the passed in number of sprites per frame. Frames drawing more than this grow the batch.
+/// </summary>
+/// <param name="maxSprites"></param>
+void spriteBatchInit(uint32_t maxSprites)
+{
+	assert(maxSprites > 0);
+
+	for (uint32_t i = 0; i < 2; ++i)
+	{
+		SpriteFrame* frame = &_spriteBatch.frames[i];
+		frame->commands = (SpriteCommand*)malloc(maxSprites * sizeof(SpriteCommand));
+		assert(frame->commands != NULL);
+		frame->max = maxSprites;
+		frame->count = 0;
+	}
+	_spriteBatch.recordFrame = _spriteBatch.renderFrame = 0;
+
+	_spriteBatch.keys = (SpriteKey*)malloc(maxSprites * sizeof(SpriteKey));
+	_spriteBatch.sorted = (SpriteQuad*)malloc(maxSprites * sizeof(SpriteQuad));
+	assert(_spriteBatch.keys != NULL && _spriteBatch.sorted != NULL);
+	_spriteBatch.max = maxSprites;
+	_spriteBatch.drawCalls = 0;
+}
+
+/// <summary>
+/// Frees the batch. Anything not yet rendered is dropped.
+/// </summary>
+void spriteBatchShutdown()
+{
+	for (uint32_t i = 0; i < 2; ++i)
+	{
+		free(_spriteBatch.frames[i].commands);
+		_spriteBatch.frames[i].commands = NULL;
+		_spriteBatch.frames[i].max = _spriteBatch.frames[i].count = 0;
+	}
+	free(_spriteBatch.keys);
+	free(_spriteBatch.sorted);
+	_spriteBatch.keys = NULL;
+	_spriteBatch.sorted = NULL;
+	_spriteBatch.max = 0;
+}
+
+
+/// <summary>
+/// Records a sprite to be drawn when the frame is rendered.
+/// </summary>
+/// <param name="sprite"></param>
+/// <param name="screenPosition"></param>
+/// <param name="objDimensions"></param>
+/// <param name="horzReflect"> - True will horizontally reflect the image.</param>
+void spriteBatchAdd(const Sprite* const sprite, Coord2D screenPosition, Coord2D objDimensions, bool horzReflect)
+{
+	SpriteFrame* frame = &_spriteBatch.frames[_spriteBatch.recordFrame];
+	if (frame->count == frame->max)
+	{
+		_spriteBatchGrowFrame(frame);
+	}
+
+	SpriteCommand* command = &frame->commands[frame->count++];
+	command->textureHandle = sprite->spriteSheet->textureHandle;
+	command->depth = sprite->depth;
+	command->uv = sprite->spriteBounds;
+	command->position = screenPosition;
+	command->size = objDimensions;
+	command->horzReflect = horzReflect;
+}
+
+/// <summary>
+/// Finishes recording the frame, and starts recording the next into the other buffer. Should be called once at the end of each frame's drawing.
+/// </summary>
+void spriteBatchEndFrame()
+{
+	_spriteBatch.recordFrame ^= 1;
+}
+
+/// <summary>
+/// Draws every sprite of the oldest recorded frame not yet rendered, back to front and grouped by sprite sheet, then empties that frame.
+/// Should be called once per recorded frame, from the thread owning the GL context.
+/// </summary>
+void spriteBatchFlush()
+{
+	SpriteFrame* frame = &_spriteBatch.frames[_spriteBatch.renderFrame];
+	_spriteBatch.renderFrame ^= 1;
+	_spriteBatch.drawCalls = 0;
+	if (frame->count == 0)
+	{
+		return;
+	}
+
+	if (frame->count > _spriteBatch.max)
+	{
+		_spriteBatchGrowScratch(frame->count);
+	}
+
+	// Transparent texels still write depth, so farther sprites have to go first
+	for (uint32_t i = 0; i < frame->count; ++i)
+	{
+		SpriteKey key = { frame->commands[i].depth, frame->commands[i].textureHandle, i };
+		_spriteBatch.keys[i] = key;
+	}
+	qsort(_spriteBatch.keys, frame->count, sizeof(SpriteKey), _spriteBatchCompareKeys);
+	for (uint32_t i = 0; i < frame->count; ++i)
+	{
+		_spriteBatchBuildQuad(&frame->commands[_spriteBatch.keys[i].order], &_spriteBatch.sorted[i]);
+	}
+
+	// One draw per run of sprites sharing a sprite sheet. Sprites from a sheet w/out a texture would draw as white quads, so are left out.
+	uint32_t runStart = 0;
+	for (uint32_t i = 1; i <= frame->count; ++i)
+	{
+		if (i == frame->count || _spriteBatch.keys[i].textureHandle != _spriteBatch.keys[runStart].textureHandle)
+		{
+			if (_spriteBatch.keys[runStart].textureHandle != 0)
+			{
+				_spriteBatchDraw(_spriteBatch.keys[runStart].textureHandle, runStart, i - runStart);
+			}
+			runStart = i;
+		}
+	}
+
+	frame->count = 0;
+}
+
+/// <returns>The number of draw calls the last flush issued.</returns>
+uint32_t spriteBatchGetDrawCalls()
+{
+	return _spriteBatch.drawCalls;
+}
+
+
+/// <summary>
+/// Doubles a frame's capacity, keeping the sprites recorded so far.
+/// </summary>
+/// <param name="frame"></param>
+static void _spriteBatchGrowFrame(SpriteFrame* frame)
+{
+	const uint32_t newMax = frame->max * 2;
+	SpriteCommand* commands = (SpriteCommand*)realloc(frame->commands, newMax * sizeof(SpriteCommand));
+	assert(commands != NULL);
+	frame->commands = commands;
+	frame->max = newMax;
+}
+
+/// <summary>
+/// Makes room in the render scratch for at least the passed in number of sprites.
+/// </summary>
+/// <param name="count"></param>
+static void _spriteBatchGrowScratch(uint32_t count)
+{
+	uint32_t newMax = _spriteBatch.max;
+	while (newMax < count)
+	{
+		newMax *= 2;
+	}
+
+	free(_spriteBatch.keys);
+	free(_spriteBatch.sorted);
+	_spriteBatch.keys = (SpriteKey*)malloc(newMax * sizeof(SpriteKey));
+	_spriteBatch.sorted = (SpriteQuad*)malloc(newMax * sizeof(SpriteQuad));
+	assert(_spriteBatch.keys != NULL && _spriteBatch.sorted != NULL);
+	_spriteBatch.max = newMax;
+}
+
+/// <summary>
+/// Builds the textured quad for a recorded sprite.
+/// </summary>
+/// <param name="command"></param>
+/// <param name="quad"></param>
+static void _spriteBatchBuildQuad(const SpriteCommand* const command, SpriteQuad* quad)
+{
+	// calculate the bounding box
+	const GLfloat xPositionLeft = (command->position.x - command->size.x / 2);
+	const GLfloat xPositionRight = (command->position.x + command->size.x / 2);
+	const GLfloat yPositionTop = (command->position.y - command->size.y / 2);
+	const GLfloat yPositionBottom = (command->position.y + command->size.y / 2);
+	const float DEPTH = command->depth;
+
+	// This is for horizontally reflecting the image
+	const Bounds2D spriteBounds = command->uv;
+	const GLfloat uLeft = command->horzReflect ? spriteBounds.botRight.x : spriteBounds.topLeft.x;
+	const GLfloat uRight = command->horzReflect ? spriteBounds.topLeft.x : spriteBounds.botRight.x;
+
+	// TL, BL, BR, TR: the same winding as the tristrip this replaces, so back face culling keeps it
+	SpriteVertex tl = { uLeft, spriteBounds.topLeft.y, xPositionLeft, yPositionTop, DEPTH };
+	SpriteVertex bl = { uLeft, spriteBounds.botRight.y, xPositionLeft, yPositionBottom, DEPTH };
+	SpriteVertex br = { uRight, spriteBounds.botRight.y, xPositionRight, yPositionBottom, DEPTH };
+	SpriteVertex tr = { uRight, spriteBounds.topLeft.y, xPositionRight, yPositionTop, DEPTH };
+	quad->vertices[0] = tl;
+	quad->vertices[1] = bl;
+	quad->vertices[2] = br;
+	quad->vertices[3] = tr;
+}
+
+/// <summary>
+/// Orders sprites by depth (farthest first), then sprite sheet, then submission order.
+/// </summary>
+static int _spriteBatchCompareKeys(const void* a, const void* b)
+{
+	const SpriteKey* keyA = (const SpriteKey*)a;
+	const SpriteKey* keyB = (const SpriteKey*)b;
+
+	if (keyA->depth != keyB->depth) { return keyA->depth < keyB->depth ? -1 : 1; }
+	if (keyA->textureHandle != keyB->textureHandle) { return keyA->textureHandle < keyB->textureHandle ? -1 : 1; }
+	return keyA->order < keyB->order ? -1 : (keyA->order > keyB->order ? 1 : 0);
+}
+
+/// <summary>
+/// Draws a run of sorted quads that all use the same sprite sheet.
+/// </summary>
+/// <param name="textureHandle"></param>
+/// <param name="first"></param>
+/// <param name="count"></param>
+static void _spriteBatchDraw(GLuint textureHandle, uint32_t first, uint32_t count)
+{
+#ifdef FW_HEADLESS
+	// Nothing is drawn without a GL context
+	(void)textureHandle;
+	(void)first;
+	(void)count;
+#else
+	glEnable(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, textureHandle);
+	glColor4ub(0xFF, 0xFF, 0xFF, 0xFF);
+
+	glInterleavedArrays(GL_T2F_V3F, 0, &_spriteBatch.sorted[first]);
+	glDrawArrays(GL_QUADS, 0, (GLsizei)(count * 4));
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+#endif
+	++_spriteBatch.drawCalls;
+}
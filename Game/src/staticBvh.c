@@ -0,0 +1,249 @@
+#include <stdlib.h>
+#include <assert.h>
+
+#include "staticBvh.h"
+
+
+#define BVH_LEAF_SIZE		2
+#define BVH_MAX_DEPTH		64
+
+
+typedef struct bvhItem_t {
+	Bounds2D	bounds;
+	Coord2D		center;
+	uint32_t	id;
+} BvhItem;
+
+typedef struct bvhNode_t {
+	Bounds2D	bounds;
+	uint32_t	rightChild;	// interior nodes only: the left child always directly follows its parent
+	uint32_t	first;		// leaves only: first item
+	uint32_t	count;		// number of items for leaves, 0 for interior nodes
+} BvhNode;
+
+typedef struct staticBvh_t {
+	BvhItem*	items;
+	BvhNode*	nodes;
+	uint32_t	maxItems;
+	uint32_t	numItems;
+	uint32_t	numNodes;
+} StaticBvh;
+
+
+// Function Prototypes
+static uint32_t _staticBvhBuildNode(StaticBvh* bvh, uint32_t first, uint32_t count);
+static void _staticBvhSelect(BvhItem* items, uint32_t count, uint32_t nth, bool alongX);
+static inline bool _boundsOverlap(const Bounds2D* const a, const Bounds2D* const b);
+
+
+/// <summary>
+/// Creates a new, empty static BVH.
+/// </summary>
+/// <param name="maxItems">The most items that can be built into the hierarchy.</param>
+/// <returns></returns>
+StaticBvh* staticBvhNew(uint32_t maxItems)
+{
+	StaticBvh* bvh = (StaticBvh*)malloc(sizeof(StaticBvh));
+	if (bvh != NULL)
+	{
+		bvh->items = (BvhItem*)malloc(maxItems * sizeof(BvhItem));
+		bvh->nodes = (BvhNode*)malloc(2 * maxItems * sizeof(BvhNode));	// a binary tree over n leaves has fewer than 2n nodes
+		assert(bvh->items != NULL && bvh->nodes != NULL);
+		bvh->maxItems = maxItems;
+		bvh->numItems = 0;
+		bvh->numNodes = 0;
+	}
+	return bvh;
+}
+
+/// <summary>
+/// Deletes the static BVH.
+/// </summary>
+/// <param name="bvh"></param>
+void staticBvhDelete(StaticBvh* bvh)
+{
+	if (bvh != NULL)
+	{
+		free(bvh->items);
+		free(bvh->nodes);
+	}
+	free(bvh);
+}
+
+
+/// <summary>
+/// Rebuilds the hierarchy from scratch over the passed in boxes, splitting each node at the median along its longer axis.
+/// </summary>
+/// <param name="bvh"></param>
+/// <param name="bounds"></param>
+/// <param name="ids">Returned by queries for the box at the same index.</param>
+/// <param name="count"></param>
+void staticBvhBuild(StaticBvh* bvh, const Bounds2D* const bounds, const uint32_t* const ids, uint32_t count)
+{
+	assert(count <= bvh->maxItems);
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		bvh->items[i].bounds = bounds[i];
+		bvh->items[i].center = boundsGetCenter(&bounds[i]);
+		bvh->items[i].id = ids[i];
+	}
+	bvh->numItems = count;
+	bvh->numNodes = 0;
+
+	if (count > 0)
+	{
+		_staticBvhBuildNode(bvh, 0, count);
+	}
+}
+
+/// <summary>
+/// Finds every item whose bounds overlap the passed in bounds (touching counts as overlapping).
+/// </summary>
+/// <param name="bvh"></param>
+/// <param name="bounds"></param>
+/// <param name="results">Receives the ids of the overlapping items, in no particular order.</param>
+/// <param name="maxResults"></param>
+/// <returns>The number of overlapping items. Only the first maxResults of them are written if there are more, so callers should check.</returns>
+uint32_t staticBvhQuery(const StaticBvh* const bvh, const Bounds2D* const bounds, uint32_t* results, uint32_t maxResults)
+{
+	if (bvh->numNodes == 0)
+	{
+		return 0;
+	}
+
+	uint32_t stack[BVH_MAX_DEPTH];
+	uint32_t stackSize = 0;
+	uint32_t numResults = 0;
+
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		const BvhNode* node = &bvh->nodes[stack[--stackSize]];
+		if (!_boundsOverlap(&node->bounds, bounds))
+		{
+			continue;
+		}
+
+		if (node->count > 0)
+		{
+			for (uint32_t i = node->first; i < node->first + node->count; ++i)
+			{
+				if (_boundsOverlap(&bvh->items[i].bounds, bounds))
+				{
+					if (numResults < maxResults)
+					{
+						results[numResults] = bvh->items[i].id;
+					}
+					++numResults;
+				}
+			}
+		}
+		else
+		{
+			assert(stackSize + 2 <= BVH_MAX_DEPTH);
+			const uint32_t nodeIndex = (uint32_t)(node - bvh->nodes);
+			stack[stackSize++] = node->rightChild;
+			stack[stackSize++] = nodeIndex + 1;
+		}
+	}
+
+	return numResults;
+}
+
+
+/// <summary>
+/// Recursively builds the node covering the passed in range of items.
+/// </summary>
+/// <param name="bvh"></param>
+/// <param name="first"></param>
+/// <param name="count"></param>
+/// <returns>The index of the built node.</returns>
+static uint32_t _staticBvhBuildNode(StaticBvh* bvh, uint32_t first, uint32_t count)
+{
+	const uint32_t nodeIndex = bvh->numNodes++;
+	BvhNode* node = &bvh->nodes[nodeIndex];
+
+	// Bounds of everything in this node, and of their centers to pick a split axis
+	node->bounds = bvh->items[first].bounds;
+	Bounds2D centerBounds = { .topLeft = bvh->items[first].center, .botRight = bvh->items[first].center };
+	for (uint32_t i = first + 1; i < first + count; ++i)
+	{
+		const BvhItem* item = &bvh->items[i];
+		if (item->bounds.topLeft.x < node->bounds.topLeft.x) { node->bounds.topLeft.x = item->bounds.topLeft.x; }
+		if (item->bounds.topLeft.y < node->bounds.topLeft.y) { node->bounds.topLeft.y = item->bounds.topLeft.y; }
+		if (item->bounds.botRight.x > node->bounds.botRight.x) { node->bounds.botRight.x = item->bounds.botRight.x; }
+		if (item->bounds.botRight.y > node->bounds.botRight.y) { node->bounds.botRight.y = item->bounds.botRight.y; }
+
+		if (item->center.x < centerBounds.topLeft.x) { centerBounds.topLeft.x = item->center.x; }
+		if (item->center.y < centerBounds.topLeft.y) { centerBounds.topLeft.y = item->center.y; }
+		if (item->center.x > centerBounds.botRight.x) { centerBounds.botRight.x = item->center.x; }
+		if (item->center.y > centerBounds.botRight.y) { centerBounds.botRight.y = item->center.y; }
+	}
+
+	if (count <= BVH_LEAF_SIZE)
+	{
+		node->first = first;
+		node->count = count;
+		node->rightChild = 0;
+		return nodeIndex;
+	}
+
+	// Split at the median along the longer axis
+	Coord2D centerSpread = boundsGetDimensions(&centerBounds);
+	const uint32_t leftCount = count / 2;
+	_staticBvhSelect(&bvh->items[first], count, leftCount, centerSpread.x >= centerSpread.y);
+
+	node->first = 0;
+	node->count = 0;
+	_staticBvhBuildNode(bvh, first, leftCount);
+	node->rightChild = _staticBvhBuildNode(bvh, first + leftCount, count - leftCount);
+	return nodeIndex;
+}
+
+/// <summary>
+/// Partially orders items in place so the nth is where a full sort by center would put it, w/ no center after it smaller and none
+/// before it bigger. That's all a median split needs, and unlike a full sort it takes linear time and no extra memory.
+/// </summary>
+/// <param name="items"></param>
+/// <param name="count"></param>
+/// <param name="nth"></param>
+/// <param name="alongX">Whether to order by the centers' x, or else their y.</param>
+static void _staticBvhSelect(BvhItem* items, uint32_t count, uint32_t nth, bool alongX)
+{
+	uint32_t left = 0;
+	uint32_t right = count - 1;
+	while (left < right)
+	{
+		// Partition around the middle item's center
+		const BvhItem* middle = &items[left + (right - left) / 2];
+		const float pivot = alongX ? middle->center.x : middle->center.y;
+		uint32_t i = left;
+		uint32_t j = right;
+		while (i <= j)
+		{
+			while ((alongX ? items[i].center.x : items[i].center.y) < pivot) { ++i; }
+			while ((alongX ? items[j].center.x : items[j].center.y) > pivot) { --j; }
+			if (i <= j)
+			{
+				const BvhItem swap = items[i];
+				items[i] = items[j];
+				items[j] = swap;
+				++i;
+				if (j == 0) { break; }
+				--j;
+			}
+		}
+
+		// Carry on in whichever side holds the nth
+		if (nth <= j) { right = j; }
+		else if (nth >= i) { left = i; }
+		else { return; }
+	}
+}
+
+static inline bool _boundsOverlap(const Bounds2D* const a, const Bounds2D* const b)
+{
+	return a->topLeft.x <= b->botRight.x && a->botRight.x >= b->topLeft.x
+		&& a->topLeft.y <= b->botRight.y && a->botRight.y >= b->topLeft.y;
+}
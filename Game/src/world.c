@@ -0,0 +1,219 @@
+#include <stdlib.h>
+#include <assert.h>
+
+#include "platform.h"
+#include "input.h"
+#include "profiler.h"
+#include "jobs.h"
+#include "world.h"
+#include "objmgr.h"
+#include "collisionMgr.h"
+#include "physicsMgr.h"
+#include "levelmgr.h"
+
+
+struct world_t {
+    ObjMgrState* objMgr;
+    CollisionMgrState* collisionMgr;
+    PhysicsMgrState* physicsMgr;
+    LevelMgrState* levelMgr;
+
+    const LevelDef* levelDefs;
+    uint32_t numLevelDefs;
+    Level* level;
+    uint32_t waveIndex;
+
+    bool hasActions;        // the player is controlled through worldSetActions, instead of the keyboard
+    WorldActions actions;
+};
+
+static WORLD_LOCAL World* _currentWorld = NULL;
+
+
+// Function Prototypes
+static void _worldBind(void* world);
+
+
+/// @brief Create a world, with managers of its own, and make it the calling thread's current one
+/// @param levelDefs every level that may be loaded, laid out as the game's (see WORLD_LEVEL_INDEX_*). Must outlive the world.
+/// @param numLevelDefs
+/// @param maxObjects
+/// @param seed for every random stream in the world
+/// @return
+World* worldNew(const LevelDef* levelDefs, uint32_t numLevelDefs, uint32_t maxObjects, uint64_t seed)
+{
+    World* world = (World*)malloc(sizeof(World));
+    assert(world != NULL);
+    world->levelDefs = levelDefs;
+    world->numLevelDefs = numLevelDefs;
+    world->level = NULL;
+    world->waveIndex = WORLD_LEVEL_INDEX_FIRST_WAVE;
+    world->hasActions = false;
+    world->actions = 0;
+
+    // Jobs started while simulating a world switch whichever thread runs them over to it
+    jobsSetContextFunc(_worldBind);
+
+    // Each manager's init makes its new state current, so the world's objects go into the world's own managers
+    objMgrInit(maxObjects);
+    collisionMgrInit(maxObjects);
+    physicsMgrInit(maxObjects);
+    world->objMgr = objMgrGetState();
+    world->collisionMgr = collisionMgrGetState();
+    world->physicsMgr = physicsMgrGetState();
+    world->levelMgr = NULL;
+    worldMakeCurrent(world);
+
+    levelMgrInit(levelDefs, numLevelDefs, seed);
+    world->levelMgr = levelMgrGetState();
+
+    return world;
+}
+
+/// @brief Unload the world's level, and shut down its managers. Whichever world was current before stays current, unless it was this one.
+/// @param world
+void worldDelete(World* world)
+{
+    World* previous = _currentWorld;
+    worldMakeCurrent(world);
+
+    if (world->level != NULL) { levelMgrUnload(world->level); }
+    levelMgrShutdown();
+    physicsMgrShutdown();
+    collisionMgrShutdown();
+    objMgrShutdown();
+
+    worldMakeCurrent(previous != world ? previous : NULL);
+    free(world);
+}
+
+
+/// @brief Point every manager on the calling thread at the world's state, and have jobs the thread starts carry the world with them
+/// @param world or NULL for none
+void worldMakeCurrent(World* world)
+{
+    _worldBind(world);
+    jobsSetContext(world);
+}
+
+/// @brief The calling thread's current world
+/// @return
+World* worldGetCurrent()
+{
+    return _currentWorld;
+}
+
+
+/// @brief Unload the world's level, and load another in its place. The world must be current.
+/// @param world
+/// @param levelIndex into the level definitions the world was created with
+void worldLoadLevel(World* world, uint32_t levelIndex)
+{
+    assert(world == _currentWorld && levelIndex < world->numLevelDefs);
+
+    if (world->level != NULL) { levelMgrUnload(world->level); }
+    world->level = levelMgrLoad(&world->levelDefs[levelIndex]);
+    if (levelIndex >= WORLD_LEVEL_INDEX_FIRST_WAVE) { world->waveIndex = levelIndex; }
+}
+
+/// @param world
+/// @return the level the world is playing, or NULL if none has been loaded
+Level* worldGetLevel(const World* world)
+{
+    return world->level;
+}
+
+/// @brief Performs updates for all of the world's objects for one fixed step, moving between levels as the current one plays out.
+/// The world must be current.
+/// @param world
+/// @param milliseconds
+void worldUpdate(World* world, uint32_t milliseconds)
+{
+    assert(world == _currentWorld && world->level != NULL);
+
+    profilerBeginZone("levelMgrUpdate");
+    const LUO outcome = levelMgrUpdate(world->level, milliseconds);
+    profilerEndZone();
+
+    // Load and unload levels here for waves and game screens -> sequencing based on how the current level's update went
+    switch (outcome)
+    {
+        case LUO_TITLE:         // Show title screen
+        {
+            worldLoadLevel(world, WORLD_LEVEL_INDEX_TITLE_SCREEN);
+            break;
+        }
+        case LUO_HISCORES:      // Show hiscores
+        {
+            worldLoadLevel(world, WORLD_LEVEL_INDEX_HISCORES);
+            break;
+        }
+        case LUO_STARTWAVES:    // Load the first wave
+        {
+            worldLoadLevel(world, WORLD_LEVEL_INDEX_FIRST_WAVE);
+            break;
+        }
+        case LUO_NEXTWAVE:      // Continue to the next wave
+        {
+            const LevelType curLevelType = levelGetType(world->level);
+            if (curLevelType == LEVELTYPE_WAVE) { worldLoadLevel(world, world->waveIndex + 1); }
+            else if (curLevelType == LEVELTYPE_WAVE_ENDLESS) { worldLoadLevel(world, world->waveIndex); }
+            else { assert(false); }
+
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+
+    profilerBeginZone("objMgrUpdate");
+    objMgrUpdate(milliseconds);
+    profilerEndZone();
+}
+
+
+/// @brief Control the world's player with the given actions from now on, instead of the keyboard
+/// @param world
+/// @param actions every action held down until the next call
+void worldSetActions(World* world, WorldActions actions)
+{
+    world->hasActions = true;
+    world->actions = actions;
+}
+
+/// @brief Whether the current world's player is holding down an action
+/// @param action
+/// @return
+bool worldIsActionPressed(WorldAction action)
+{
+    const World* world = _currentWorld;
+    if (world != NULL && world->hasActions)
+    {
+        return (world->actions & action) != 0;
+    }
+
+    switch (action)
+    {
+        case WORLD_ACTION_LEFT:     return inputKeyPressed(VK_LEFT);
+        case WORLD_ACTION_RIGHT:    return inputKeyPressed(VK_RIGHT);
+        case WORLD_ACTION_FLAP:     return inputKeyPressed(VK_SPACE);
+        case WORLD_ACTION_START:    return inputKeyPressed(VK_RETURN);
+        default:                    return false;
+    }
+}
+
+
+/// @brief Job context func: points every manager on the calling thread at a world's state
+/// @param world or NULL for none
+static void _worldBind(void* world)
+{
+    World* bound = (World*)world;
+    _currentWorld = bound;
+
+    objMgrSetState(bound != NULL ? bound->objMgr : NULL);
+    collisionMgrSetState(bound != NULL ? bound->collisionMgr : NULL);
+    physicsMgrSetState(bound != NULL ? bound->physicsMgr : NULL);
+    levelMgrSetState(bound != NULL ? bound->levelMgr : NULL);
+}
@@ -0,0 +1,209 @@
+#include <stdlib.h>
+#include <assert.h>
+
+#include "platform.h"
+#include "jobs.h"
+#include "worldBatch.h"
+#include "levelmgr.h"
+#include "enemy.h"
+#include "soundOneShot.h"
+#include "random.h"
+#include "joustGlobalConstants.h"
+
+
+#define WORLD_BATCH_MAX_OBJECTS     500     // as many as the game allows for
+
+
+struct worldBatch_t {
+    World** worlds;
+    uint32_t numWorlds;
+    uint64_t seed;
+    uint32_t* numResets;                // per world, so every reset plays a different game
+
+    // The step in progress
+    const WorldActions* actions;
+    uint32_t milliseconds;
+    WorldObservation* observations;
+};
+
+
+// Function Prototypes
+static World* _worldBatchNewWorld(const WorldBatch* batch, uint32_t index);
+static void _worldBatchStepRange(void* data, uint32_t begin, uint32_t end);
+static void _worldBatchObserve(const World* world, WorldObservation* observation);
+
+
+/// @brief Create a batch of worlds, each starting at the first wave with a seed of its own
+/// @param numWorlds
+/// @param seed which every world's seed is derived from
+/// @return
+WorldBatch* worldBatchNew(uint32_t numWorlds, uint64_t seed)
+{
+    WorldBatch* batch = (WorldBatch*)malloc(sizeof(WorldBatch));
+    assert(batch != NULL);
+    batch->worlds = (World**)malloc(numWorlds * sizeof(World*));
+    batch->numResets = (uint32_t*)calloc(numWorlds, sizeof(uint32_t));
+    assert(batch->worlds != NULL && batch->numResets != NULL);
+    batch->numWorlds = numWorlds;
+    batch->seed = seed;
+    batch->actions = NULL;
+    batch->milliseconds = 0;
+    batch->observations = NULL;
+
+    World* previous = worldGetCurrent();
+    for (uint32_t i = 0; i < numWorlds; ++i)
+    {
+        batch->worlds[i] = _worldBatchNewWorld(batch, i);
+    }
+    worldMakeCurrent(previous);
+
+    return batch;
+}
+
+/// @brief Delete every world in the batch
+/// @param batch
+void worldBatchDelete(WorldBatch* batch)
+{
+    for (uint32_t i = 0; i < batch->numWorlds; ++i)
+    {
+        worldDelete(batch->worlds[i]);
+    }
+    free(batch->worlds);
+    free(batch->numResets);
+    free(batch);
+}
+
+/// @param batch
+/// @return
+uint32_t worldBatchGetNumWorlds(const WorldBatch* batch)
+{
+    return batch->numWorlds;
+}
+
+/// @brief Replace one of the worlds with a new game, e.g. once it's over. Not to be called during a step.
+/// @param batch
+/// @param index
+/// @param observation receives the new world's first observation, unless NULL
+void worldBatchReset(WorldBatch* batch, uint32_t index, WorldObservation* observation)
+{
+    assert(index < batch->numWorlds);
+
+    World* previous = worldGetCurrent();
+    worldDelete(batch->worlds[index]);
+    ++batch->numResets[index];
+    batch->worlds[index] = _worldBatchNewWorld(batch, index);
+
+    if (observation != NULL) { _worldBatchObserve(batch->worlds[index], observation); }
+    worldMakeCurrent(previous);
+}
+
+/// @brief Step every world by one fixed update, each under its own actions, spread over the job system
+/// @param batch
+/// @param actions one per world
+/// @param milliseconds
+/// @param observations receives one per world, once it has stepped
+void worldBatchStep(WorldBatch* batch, const WorldActions* actions, uint32_t milliseconds, WorldObservation* observations)
+{
+    batch->actions = actions;
+    batch->milliseconds = milliseconds;
+    batch->observations = observations;
+
+    // A world per job: it's plenty of work, and each world's own updates can still be split up across whichever threads are idle
+    jobsParallelFor(batch->numWorlds, 1, _worldBatchStepRange, batch);
+
+    batch->actions = NULL;
+    batch->observations = NULL;
+}
+
+
+/// @brief Create the world at an index of the batch, which is left current
+/// @param batch
+/// @param index
+/// @return
+static World* _worldBatchNewWorld(const WorldBatch* batch, uint32_t index)
+{
+    // Derived from the batch's seed, the world's index, and how many times it has been reset, so no two games are alike
+    const uint32_t resets = batch->numResets[index];
+    const uint64_t seed = ((uint64_t)randAt(batch->seed, index, (uint64_t)resets * 2) << 32) | randAt(batch->seed, index, (uint64_t)resets * 2 + 1);
+
+    World* world = worldNew(LEVEL_DEFS, NUMBER_LEVEL_DEFS, WORLD_BATCH_MAX_OBJECTS, seed);
+    soundOneShotSetMuted(true);
+    worldSetActions(world, 0);
+    worldLoadLevel(world, WORLD_LEVEL_INDEX_FIRST_WAVE);
+    return world;
+}
+
+/// @brief Job: steps a range of the batch's worlds, and observes them
+/// @param data the batch
+/// @param begin
+/// @param end
+static void _worldBatchStepRange(void* data, uint32_t begin, uint32_t end)
+{
+    WorldBatch* batch = (WorldBatch*)data;
+
+    World* previous = worldGetCurrent();
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        World* world = batch->worlds[i];
+        worldMakeCurrent(world);
+        worldSetActions(world, batch->actions[i]);
+        worldUpdate(world, batch->milliseconds);
+        _worldBatchObserve(world, &batch->observations[i]);
+    }
+    worldMakeCurrent(previous);
+}
+
+/// @brief Fills in what an agent gets to see of a world. The world must be current.
+/// @param world
+/// @param observation
+static void _worldBatchObserve(const World* world, WorldObservation* observation)
+{
+    ZeroMemory(observation, sizeof(WorldObservation));
+
+    Player* player = levelMgrGetPlayer();
+    const Entity* playerEntity = (const Entity*)player;
+    observation->playerPosition = playerEntity->obj.position;
+    observation->playerVelocity = playerEntity->velocity;
+    observation->isPlayerSpawned = objIsEnabled((Object*)player);
+    observation->lives = playerGetLives(player);
+    observation->score = levelMgrGetScore();
+    observation->wave = levelMgrGetWaveNumber();
+    observation->numAliveEnemies = levelMgrGetNumAliveEnemies();
+
+    const Level* level = worldGetLevel(world);
+    observation->isGameOver = levelGetType(level) == LEVELTYPE_HISCORES;
+
+    // Keep the nearest spawned enemies, sorted by insertion
+    float distances[WORLD_BATCH_OBSERVED_ENEMIES];
+    const uint16_t numEnemies = levelGetNumEnemies(level);
+    for (uint16_t i = 0; i < numEnemies; ++i)
+    {
+        Object* enemy = levelGetEnemy(level, i);
+        if (enemy == NULL || !objIsEnabled(enemy)) { continue; }
+
+        const float dx = enemy->position.x - observation->playerPosition.x;
+        const float dy = enemy->position.y - observation->playerPosition.y;
+        const float distance = dx * dx + dy * dy;
+
+        uint8_t slot = observation->numEnemies;
+        if (slot == WORLD_BATCH_OBSERVED_ENEMIES)
+        {
+            if (distance >= distances[slot - 1]) { continue; }
+            --slot;
+        }
+        else
+        {
+            ++observation->numEnemies;
+        }
+        for (; slot > 0 && distances[slot - 1] > distance; --slot)
+        {
+            distances[slot] = distances[slot - 1];
+            observation->enemies[slot] = observation->enemies[slot - 1];
+        }
+
+        distances[slot] = distance;
+        observation->enemies[slot].position = enemy->position;
+        observation->enemies[slot].velocity = ((const Entity*)enemy)->velocity;
+        observation->enemies[slot].type = (uint8_t)enemyGetType((Enemy*)enemy);
+    }
+}
@@ -1,6 +1,7 @@
 #pragma once
-#include <Windows.h>
+#include "platform.h"
 #include "baseTypes.h"
+#include "soundSink.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -8,13 +9,17 @@ extern "C" {
 
 typedef struct application_t Application;
 
-typedef void (*AppDrawFunc)();
+typedef void (*AppDrawFunc)(float);
 typedef void (*AppUpdateFunc)(uint32_t);
+typedef void (*AppRenderFunc)();
 
 Application* appNew(HINSTANCE instance, const char* title, AppDrawFunc drawFunc, AppUpdateFunc updateFunc);
 void appDelete(Application* app);
-void appDraw(Application* app);
+void appDraw(Application* app, float interpolation);
+void appRender(Application* app);
 void appUpdate(Application* app, uint32_t milliseconds);
+uint32_t appAdvance(Application* app, uint64_t microseconds);
+float appGetInterpolation(const Application* app);
 
 HINSTANCE appGetInstance(const Application* app);
 const char* appGetTitle(const Application* app);
@@ -23,11 +28,24 @@ void appSetWidth(Application* app, uint32_t width);
 void appSetHeight(Application* app, uint32_t height);
 void appSetBitsPerPixel(Application* app, uint32_t bpp);
 void appSetMaxSounds(Application* app, uint32_t maxSounds);
+void appSetSoundSink(Application* app, SoundSink* sink);
+void appSetFixedStep(Application* app, uint32_t milliseconds);
+void appSetMaxStepsPerFrame(Application* app, uint32_t maxSteps);
+void appSetNumWorkers(Application* app, uint32_t numWorkers);
+void appSetRenderFunc(Application* app, AppRenderFunc renderFunc);
+void appSetPipelined(Application* app, bool isPipelined);
+void appSetMaxUpdates(Application* app, uint64_t maxUpdates);
 
 uint32_t appGetWidth(const Application* app);
 uint32_t appGetHeight(const Application* app);
 uint32_t appGetBitsPerPixel(const Application* app);
 uint32_t appGetMaxSounds(const Application* app);
+SoundSink* appGetSoundSink(const Application* app);
+uint32_t appGetFixedStep(const Application* app);
+uint32_t appGetMaxStepsPerFrame(const Application* app);
+uint32_t appGetNumWorkers(const Application* app);
+bool appIsPipelined(const Application* app);
+uint64_t appGetMaxUpdates(const Application* app);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,57 @@
+#pragma once
+#include "baseTypes.h"
+#include "wav.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A single archive of assets, already decoded into the form they are used in, behind a table of contents.
+// Opening one memory maps it: nothing is read or copied until an asset is used, and then straight from the mapping.
+// Packs are written with an AssetPackWriter, from the source files, whenever those change. Each records a key for what
+// it was written from (a hash of which sources, and how they were laid out: see assetPackHash), so a pack written from
+// a different set of them is out of date too.
+//
+// Layout: header, then each asset's data (aligned to ASSET_PACK_ALIGNMENT), then the table of contents.
+
+#define ASSET_PACK_NAME_LENGTH	48
+#define ASSET_PACK_ALIGNMENT	16
+#define ASSET_PACK_HASH_INIT	14695981039346656037ull
+
+typedef enum asset_type_e {
+	ASSET_TYPE_RAW,
+	ASSET_TYPE_IMAGE,	// params: width, height. data: RGBA8 rows, bottom row first, ready to upload as a texture
+	ASSET_TYPE_SOUND	// params: format bytes, sample bytes. data: the fmt chunk, then the samples (aligned)
+} AssetType;
+
+typedef struct asset_entry_t {
+	char		name[ASSET_PACK_NAME_LENGTH];
+	uint32_t	type;
+	uint32_t	params[3];
+	uint64_t	offset;			// from the start of the pack
+	uint64_t	size;
+} AssetEntry;
+
+typedef struct asset_pack_t AssetPack;
+typedef struct asset_pack_writer_t AssetPackWriter;
+
+AssetPack* assetPackOpen(const char* path);
+void assetPackClose(AssetPack* pack);
+bool assetPackIsOutOfDate(const char* path, const char* const* sourcePaths, uint32_t numSources, uint64_t sourceKey);
+uint64_t assetPackHash(uint64_t hash, const void* data, size_t size);
+
+const AssetEntry* assetPackFind(const AssetPack* pack, const char* name);
+const void* assetPackGetData(const AssetPack* pack, const AssetEntry* entry);
+void assetPackPrefetch(const AssetPack* pack, const AssetEntry* entry);
+const void* assetPackGetImage(const AssetPack* pack, const char* name, uint32_t* width, uint32_t* height);
+bool assetPackGetSound(const AssetPack* pack, const char* name, WavInfo* info);
+
+AssetPackWriter* assetPackWriterNew(uint64_t sourceKey);
+void assetPackWriterAdd(AssetPackWriter* writer, const char* name, AssetType type, const uint32_t params[3], const void* data, size_t size);
+void assetPackWriterAddImage(AssetPackWriter* writer, const char* name, uint32_t width, uint32_t height, const void* pixels);
+void assetPackWriterAddSound(AssetPackWriter* writer, const char* name, const WavInfo* info);
+AssetPack* assetPackWriterFinish(AssetPackWriter* writer, const char* path);
+
+#ifdef __cplusplus
+}
+#endif
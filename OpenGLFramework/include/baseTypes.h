@@ -17,7 +17,7 @@ typedef struct
 /// @brief Utility method to get the center point of a Bounds2D
 /// @param bounds 
 /// @return 
-inline Coord2D boundsGetCenter(const Bounds2D* bounds) {
+static inline Coord2D boundsGetCenter(const Bounds2D* bounds) {
     Coord2D center = { 
         (bounds->topLeft.x + bounds->botRight.x) / 2, 
         (bounds->topLeft.y + bounds->botRight.y) / 2 
@@ -28,7 +28,7 @@ inline Coord2D boundsGetCenter(const Bounds2D* bounds) {
 /// @brief Utility method to get the width and height of a Bounds2D
 /// @param bounds 
 /// @return 
-inline Coord2D boundsGetDimensions(const Bounds2D* bounds) {
+static inline Coord2D boundsGetDimensions(const Bounds2D* bounds) {
     Coord2D size = { 
         bounds->botRight.x - bounds->topLeft.x, 
         bounds->botRight.y - bounds->topLeft.y 
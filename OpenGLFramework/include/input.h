@@ -17,10 +17,23 @@ bool inputKeyPressed(char vkCode);
 Coord2D inputMousePosition();
 bool inputMousePressed(InputButton button);
 
+// Record & replay - captures the keyboard once per fixed update, along with the seed and fixed step the run needs to
+// be reproduced. Start them after the framework is initialized and before the first update; running both re-records
+// the replay. While replaying, the recorded keys are what inputKeyPressed reports, and live key presses are ignored
+// until the recording runs out. Checksums of the game's state are stored periodically, so a replay that diverges
+// reports the first tick it did.
+bool inputRecordStart(const char* path, uint32_t seed, uint32_t fixedStep);
+bool inputReplayStart(const char* path, uint32_t* seed, uint32_t* fixedStep);
+bool inputIsReplaying();
+bool inputIsReplayFinished();
+bool inputHasReplayDiverged();
+void inputSubmitChecksum(uint32_t checksum);
+
 // "private" methods - should only be called by framework
 void inputInit();
 void inputShutdown();
 void inputKeyUpdate(uint8_t vkCode, bool pressed);
+void inputTick();
 void inputMouseUpdatePosition(Coord2D coords);
 void inputMouseUpdateButton(InputButton button, bool pressed);
 
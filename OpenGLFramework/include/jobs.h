@@ -0,0 +1,64 @@
+#pragma once
+#include "baseTypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Work-stealing task scheduler. Every thread in the pool (the thread that initialized it, plus the workers) owns a
+// deque of tasks: it pushes and pops its own tasks at one end, and takes the oldest task from another thread's
+// deque when its own runs dry. Which thread runs which task varies from run to run, so a task must only write
+// state that belongs to it alone.
+//
+// Tasks report to a counter when they finish. A thread can wait on a counter, running other tasks in the meantime,
+// or queue a task to start once a counter reaches zero, which is enough to chain stages into a task graph.
+// Tasks may only be started, and counters waited on, from threads in the pool.
+//
+// Background tasks (long work the pool's users shouldn't stall on, like loading) go on a queue of their own, which only
+// the worker threads take from, once there's nothing else queued. Waiting never runs them, so a thread waiting on a
+// counter can't get stuck in one.
+//
+// Each thread also carries a context, for callers whose state is reached through thread-local pointers (such as which
+// of several game worlds it's simulating). A task takes the context of the thread that started it, and whichever
+// thread runs it switches to that context for the duration, through the context func, and back again afterwards.
+
+#define JOBS_WORKERS_AUTO	0xFFFFFFFFu		// one worker per hardware thread, besides the calling thread
+#define JOBS_MAX_WORKERS	63
+#define JOBS_MAX_TASKS		1024			// per thread, queued or waiting on a counter at once
+
+typedef void (*JobFunc)(void* data);
+typedef void (*JobRangeFunc)(void* data, uint32_t begin, uint32_t end);
+typedef void (*JobContextFunc)(void* context);
+
+/// @brief Counts the tasks started against it that haven't finished yet. Must be zeroed (JOB_COUNTER_INIT) before use,
+/// and must outlive every task started against it, and every wait on it.
+typedef struct jobCounter_t {
+	volatile int64_t	pending;
+	volatile int64_t	lock;		// guards waiters, and pending reaching zero
+	struct jobTask_t*	waiters;	// tasks to start once pending reaches zero
+} JobCounter;
+
+#define JOB_COUNTER_INIT	{ 0, 0, NULL }
+
+// "public" methods
+uint32_t jobsGetNumWorkers();
+uint64_t jobsGetNumOverflows();
+void jobsRun(JobFunc func, void* data, JobCounter* counter);
+void jobsRunAfter(JobCounter* dependency, JobFunc func, void* data, JobCounter* counter);
+void jobsRunBackground(JobFunc func, void* data, JobCounter* counter);
+void jobsRunParallelFor(uint32_t count, uint32_t batchSize, JobRangeFunc func, void* data, JobCounter* counter);
+void jobsWait(JobCounter* counter);
+bool jobsIsDone(JobCounter* counter);
+void jobsParallelFor(uint32_t count, uint32_t batchSize, JobRangeFunc func, void* data);
+
+void jobsSetContextFunc(JobContextFunc func);
+void jobsSetContext(void* context);
+void* jobsGetContext();
+
+// "private" methods - should only be called by framework
+void jobsInit(uint32_t numWorkers);
+void jobsShutdown();
+
+#ifdef __cplusplus
+}
+#endif
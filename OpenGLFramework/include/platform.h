@@ -0,0 +1,40 @@
+#pragma once
+
+/// @brief Platform selection for the framework
+/// The default build targets Win32 + OpenGL. Defining FW_HEADLESS builds the framework
+/// without a window, GL context or XAudio2, so the simulation can run on any POSIX host.
+
+#ifdef FW_HEADLESS
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+typedef void*			HINSTANCE;
+typedef unsigned int	GLuint;
+typedef float			GLfloat;
+
+#define ZeroMemory(dest, length)	memset((dest), 0, (length))
+#define _stricmp					strcasecmp
+
+// MSVC's intrinsic for the lowest set bit
+static inline unsigned char _BitScanForward64(unsigned long* index, unsigned long long mask)
+{
+	if (mask == 0) { return 0; }
+	*index = (unsigned long)__builtin_ctzll(mask);
+	return 1;
+}
+
+// Virtual key codes used by the game (values match the Win32 VK_* codes)
+#define VK_RETURN	0x0D
+#define VK_SPACE	0x20
+#define VK_LEFT		0x25
+#define VK_RIGHT	0x27
+
+#else
+
+#include <Windows.h>
+#include <gl/GL.h>
+#include <gl/GLU.h>
+
+#endif
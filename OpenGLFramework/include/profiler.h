@@ -0,0 +1,47 @@
+#pragma once
+#include <stdio.h>
+#include "baseTypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Scoped zone profiler. Each thread records the zones it closes into its own ring buffer, so recording never
+// takes a lock. The rings can be dumped as Chrome trace_event JSON (load in chrome://tracing or Perfetto),
+// or summarized as per-zone percentiles over the events still in the rings.
+//
+// Zone names must be string literals (or otherwise outlive the profiler), since only the pointer is recorded.
+
+#define PROFILER_DEFAULT_EVENTS_PER_THREAD	65536
+
+typedef struct profile_zone_stats_t {
+    uint32_t    count;
+    double      meanMicroseconds;
+    double      p50Microseconds;
+    double      p90Microseconds;
+    double      p99Microseconds;
+    double      maxMicroseconds;
+} ProfileZoneStats;
+
+uint64_t profilerGetNanoseconds();
+
+// "public" methods - bracket the code to time, begins and ends must nest. Nothing is recorded until the profiler
+// is enabled, which should only be toggled outside of any zone.
+void profilerSetEnabled(bool enabled);
+bool profilerIsEnabled();
+void profilerBeginZone(const char* name);
+void profilerEndZone();
+const char* profilerGetCurrentZone();
+void profilerReset();
+
+bool profilerGetZoneStats(const char* name, ProfileZoneStats* stats);
+void profilerPrintStats(FILE* file);
+bool profilerWriteTrace(const char* path);
+
+// "private" methods - should only be called by framework
+void profilerInit(uint32_t eventsPerThread);
+void profilerShutdown();
+
+#ifdef __cplusplus
+}
+#endif
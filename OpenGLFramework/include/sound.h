@@ -1,19 +1,51 @@
 #pragma once
 #include "baseTypes.h"
+#include "wav.h"
+#include "soundSink.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// Clips are mixed in process, on SOUND_MIXER_CHANNELS channels, into one stream of 16 bit stereo at SOUND_SAMPLE_RATE
+// that goes to a sink (see soundSink.h). Everything here is called from the thread that updates the application.
+// Long clips (music) can be loaded as streams instead, which only keep a few chunks in memory, read ahead on a thread
+// of their own; they're played, stopped and unloaded like any other clip.
+
 #define SOUND_NOSOUND -1
+#define SOUND_NOCHANNEL -1
+
+#define SOUND_SAMPLE_RATE       44100
+#define SOUND_MIXER_CHANNELS    16
+
+// When every channel is busy, a clip takes over the one playing the lowest priority clip, if that's no higher
+#define SOUND_PRIORITY_LOW      0
+#define SOUND_PRIORITY_NORMAL   1
+#define SOUND_PRIORITY_HIGH     2
 
-bool soundInit(int32_t maxSounds);
+// Called by soundUpdate when a clip has played to its end on a channel
+typedef void (*SoundEndFunc)(int32_t soundId, int32_t channel);
+
+bool soundInit(int32_t maxSounds, SoundSink* sink);
 bool soundShutdown();
+void soundUpdate(uint32_t milliseconds);
 int32_t soundLoad(const char* filename);
+int32_t soundLoadFromMemory(const WavInfo* info);
+int32_t soundLoadStream(const char* filename);
+int32_t soundLoadStreamFromMemory(const WavInfo* info);
 void soundUnload(int32_t soundId);
-void soundPlay(int32_t soundId);
+int32_t soundPlay(int32_t soundId);
+int32_t soundPlayWithPriority(int32_t soundId, int32_t priority);
+void soundPlayOnChannel(int32_t soundId, int32_t channel);
 void soundStop(int32_t soundId);
+void soundStopChannel(int32_t channel);
+void soundSetChannelGain(int32_t channel, float gain);
+uint32_t soundGetNumFrames(int32_t soundId);
+uint32_t soundGetDurationMS(int32_t soundId);
+int32_t soundGetChannelSound(int32_t channel);
+uint32_t soundGetChannelPositionMS(int32_t channel);
+void soundSetEndCallback(SoundEndFunc onEnd);
 
 #ifdef __cplusplus
 }
-#endif
\ No newline at end of file
+#endif
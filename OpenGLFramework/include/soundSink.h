@@ -0,0 +1,35 @@
+#pragma once
+#include "baseTypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Where the mixer's output goes: interleaved 16 bit stereo frames, at the mixer's sample rate.
+// A sink with a clock of its own (an audio device) pulls frames from the mixer as it needs them, on a thread of its own.
+// A sink without one (a file, or nothing) leaves write set, and is written to as the application's clock advances,
+// on the thread that updates it, so what it gets doesn't depend on how fast the application runs.
+//
+// Each sink is a struct that starts with a SoundSink, so its functions can find the rest of it.
+
+typedef void (*SoundSinkPullFunc)(int16_t* frames, uint32_t numFrames);
+
+typedef struct sound_sink_t SoundSink;
+
+struct sound_sink_t {
+	bool	(*start)(SoundSink* sink, uint32_t sampleRate, SoundSinkPullFunc pull);
+	void	(*write)(SoundSink* sink, const int16_t* frames, uint32_t numFrames);	// NULL for a sink that pulls
+	void	(*stop)(SoundSink* sink);
+	void	(*destroy)(SoundSink* sink);
+};
+
+SoundSink* soundSinkNewNull();
+SoundSink* soundSinkNewWavFile(const char* path);
+#ifndef FW_HEADLESS
+SoundSink* soundSinkNewXAudio2();
+#endif
+void soundSinkDelete(SoundSink* sink);
+
+#ifdef __cplusplus
+}
+#endif
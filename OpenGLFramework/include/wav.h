@@ -0,0 +1,39 @@
+#pragma once
+#include "baseTypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Finds the chunks of a RIFF WAVE file held in memory, without copying them.
+
+typedef struct wav_info_t {
+	const void*	format;			// the fmt chunk: a WAVEFORMATEX, or a WAVEFORMATEXTENSIBLE
+	uint32_t	formatBytes;
+	const void*	samples;		// the data chunk
+	uint32_t	sampleBytes;
+} WavInfo;
+
+typedef enum wav_encoding_e {
+	WAV_ENCODING_PCM8,				// unsigned
+	WAV_ENCODING_PCM16,
+	WAV_ENCODING_FLOAT32
+} WavEncoding;
+
+// What a fmt chunk says about the samples, for the encodings that can be played
+typedef struct wav_format_t {
+	WavEncoding	encoding;
+	uint16_t	numChannels;
+	uint16_t	frameBytes;		// one sample for every channel
+	uint32_t	sampleRate;
+	uint32_t	numFrames;		// in the data chunk
+} WavFormat;
+
+bool wavParse(const void* file, size_t fileBytes, WavInfo* info);
+void* wavLoad(const char* path, WavInfo* info);
+void* wavLoadHeader(const char* path, WavInfo* info, uint32_t* dataOffset);
+bool wavGetFormat(const WavInfo* info, WavFormat* format);
+
+#ifdef __cplusplus
+}
+#endif
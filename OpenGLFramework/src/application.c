@@ -1,4 +1,10 @@
+#include <assert.h>
+
 #include "application.h"
+#include "input.h"
+#include "jobs.h"
+#include "profiler.h"
+#include "sound.h"
 
 struct application_t {
     // windows instance
@@ -8,6 +14,7 @@ struct application_t {
     const char* title;
     AppDrawFunc drawFunc;
     AppUpdateFunc updateFunc;
+    AppRenderFunc renderFunc;
 
     // window settings
     uint32_t    width;
@@ -16,6 +23,19 @@ struct application_t {
 
     // audio
     uint32_t    maxSounds;
+    SoundSink*  soundSink;      // where the mix goes, NULL for the platform's audio device
+
+    // simulation clock
+    uint32_t    fixedStep;
+    uint32_t    maxStepsPerFrame;
+    uint64_t    accumulator;    // microseconds not yet simulated
+
+    // worker threads
+    uint32_t    numWorkers;
+    bool        isPipelined;    // render on a thread of its own, while the next frame is simulated
+
+    // headless simulation
+    uint64_t    maxUpdates;
 };
 
 /// @brief Create an instance of an application with default settings
@@ -28,6 +48,8 @@ Application* appNew(HINSTANCE instance, const char* title, AppDrawFunc drawFunc,
     const uint32_t DEFAULT_HEIGHT = 768;
     const uint32_t DEFAULT_BPP = 24;
     const uint32_t DEFAULT_MAXSOUNDS = 20;
+    const uint32_t DEFAULT_FIXEDSTEP = 8;
+    const uint32_t DEFAULT_MAXSTEPSPERFRAME = 10;
 
     Application* app = malloc(sizeof(Application));
     if (app != NULL) {
@@ -35,11 +57,22 @@ Application* appNew(HINSTANCE instance, const char* title, AppDrawFunc drawFunc,
         app->title = title;
         app->drawFunc = drawFunc;
         app->updateFunc = updateFunc;
+        app->renderFunc = NULL;
 
         app->width = DEFAULT_WIDTH;
         app->height = DEFAULT_HEIGHT;
         app->bpp = DEFAULT_BPP;
         app->maxSounds = DEFAULT_MAXSOUNDS;
+        app->soundSink = NULL;
+
+        app->fixedStep = DEFAULT_FIXEDSTEP;
+        app->maxStepsPerFrame = DEFAULT_MAXSTEPSPERFRAME;
+        app->accumulator = 0;
+
+        app->numWorkers = JOBS_WORKERS_AUTO;
+        app->isPipelined = false;
+
+        app->maxUpdates = 0;
     }
 
     return app;
@@ -54,11 +87,27 @@ void appDelete(Application* application)
 
 /// @brief Does any required drawing for the application
 /// @param application 
-void appDraw(Application* app)
+/// @param interpolation fraction of a fixed step between the previous and current simulation state
+void appDraw(Application* app, float interpolation)
 {
     if (app->drawFunc != NULL)
     {
-        app->drawFunc();
+        profilerBeginZone("Draw");
+        app->drawFunc(interpolation);
+        profilerEndZone();
+    }
+}
+
+/// @brief Submits what the last draw recorded to GL. Only called from the thread owning the GL context,
+/// which is a render thread of its own when the application is pipelined.
+/// @param application 
+void appRender(Application* app)
+{
+    if (app->renderFunc != NULL)
+    {
+        profilerBeginZone("Render");
+        app->renderFunc();
+        profilerEndZone();
     }
 }
 
@@ -67,19 +116,78 @@ void appDraw(Application* app)
 /// @param milliseconds 
 void appUpdate(Application* app, uint32_t milliseconds)
 {
+    // The keyboard is recorded/replayed per update, so every update in a frame sees the same keys either way
+    inputTick();
+
     if (app->updateFunc != NULL) 
     {
+        profilerBeginZone("Update");
         app->updateFunc(milliseconds);
+        profilerEndZone();
+    }
+
+    soundUpdate(milliseconds);
+}
+
+/// @brief Advances the simulation clock by real elapsed time, running as many fixed steps as fit.
+/// Leftover time carries over to the next call, and is capped at the max steps per frame so a hitch
+/// can't make the simulation spiral trying to catch up.
+/// @param application 
+/// @param microseconds elapsed since the last call
+/// @return the number of fixed steps run
+uint32_t appAdvance(Application* app, uint64_t microseconds)
+{
+    const uint64_t stepMicroseconds = (uint64_t)app->fixedStep * 1000;
+    const uint64_t maxMicroseconds = stepMicroseconds * app->maxStepsPerFrame;
+
+    app->accumulator += microseconds;
+    if (app->accumulator > maxMicroseconds)
+    {
+        app->accumulator = maxMicroseconds;
     }
+
+    uint32_t steps = 0;
+    while (app->accumulator >= stepMicroseconds)
+    {
+        appUpdate(app, app->fixedStep);
+        app->accumulator -= stepMicroseconds;
+        ++steps;
+    }
+
+    return steps;
+}
+
+/// @brief How far the clock is into the next fixed step, for interpolating draws
+/// @param application 
+/// @return [0, 1)
+float appGetInterpolation(const Application* app)
+{
+    return (float)app->accumulator / (float)((uint64_t)app->fixedStep * 1000);
 }
 
 /*
  * Additional setters for height, width and bits-per-pixel
+ * The fixed step must be non-zero (a zero step is ignored, keeping the last). The number of workers is the job system's threads besides the main one,
+ * JOBS_WORKERS_AUTO by default. Max updates is only used by the headless framework (FW_HEADLESS),
+ * where a max of 0 runs until terminated.
+ * Without a render function, the draw function has to submit to GL itself. With one, the draw function only records
+ * the frame, and the render function submits it; pipelining then renders each frame while the next is simulated and
+ * drawn, so the two must not share anything but what the draw function hands over (double buffered).
+ * Pipelining has to be chosen before the window is created.
+ * The sound sink is where the audio mix goes, the platform's audio device by default (nothing, headless); the sound
+ * system takes it over when the window is created.
  */
 void appSetWidth(Application* app, uint32_t width) { app->width = width; }
 void appSetHeight(Application* app, uint32_t height) { app->height = height; }
 void appSetBitsPerPixel(Application* app, uint32_t bpp) { app->bpp = bpp; }
 void appSetMaxSounds(Application* app, uint32_t maxSounds) { app->maxSounds = maxSounds; }
+void appSetSoundSink(Application* app, SoundSink* sink) { app->soundSink = sink; }
+void appSetFixedStep(Application* app, uint32_t milliseconds) { assert(milliseconds > 0); if (milliseconds > 0) { app->fixedStep = milliseconds; } }
+void appSetMaxStepsPerFrame(Application* app, uint32_t maxSteps) { app->maxStepsPerFrame = maxSteps; }
+void appSetNumWorkers(Application* app, uint32_t numWorkers) { app->numWorkers = numWorkers; }
+void appSetRenderFunc(Application* app, AppRenderFunc renderFunc) { app->renderFunc = renderFunc; }
+void appSetPipelined(Application* app, bool isPipelined) { app->isPipelined = isPipelined; }
+void appSetMaxUpdates(Application* app, uint64_t maxUpdates) { app->maxUpdates = maxUpdates; }
 
 /*
  * Getters for various application fields
@@ -90,3 +198,9 @@ uint32_t appGetWidth(const Application* app) { return app->width; }
 uint32_t appGetHeight(const Application* app) { return app->height; }
 uint32_t appGetBitsPerPixel(const Application* app) { return app->bpp; }
 uint32_t appGetMaxSounds(const Application* app) { return app->maxSounds; }
+SoundSink* appGetSoundSink(const Application* app) { return app->soundSink; }
+uint32_t appGetFixedStep(const Application* app) { return app->fixedStep; }
+uint32_t appGetMaxStepsPerFrame(const Application* app) { return app->maxStepsPerFrame; }
+uint32_t appGetNumWorkers(const Application* app) { return app->numWorkers; }
+bool appIsPipelined(const Application* app) { return app->isPipelined && app->renderFunc != NULL; }
+uint64_t appGetMaxUpdates(const Application* app) { return app->maxUpdates; }
@@ -0,0 +1,488 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "assetPack.h"
+
+#define ASSET_PACK_MAGIC		0x4B41504Au		// "JPAK"
+#define ASSET_PACK_VERSION		2
+#define ASSET_PACK_PAGE_SIZE	4096
+
+#ifdef _WIN32
+typedef struct _stat64 AssetStat;
+#define _assetStat _stat64
+#else
+typedef struct stat AssetStat;
+#define _assetStat stat
+#endif
+
+typedef struct asset_pack_header_t {
+	uint32_t	magic;
+	uint32_t	version;
+	uint32_t	numEntries;
+	uint32_t	reserved;
+	uint64_t	tocOffset;
+	uint64_t	sourceKey;
+} AssetPackHeader;
+
+struct asset_pack_t {
+	const uint8_t*		base;
+	size_t				size;
+	const AssetEntry*	entries;
+	uint32_t			numEntries;
+	void*				heap;			// the pack's bytes, when they weren't mapped from a file
+#ifdef _WIN32
+	HANDLE				file;
+	HANDLE				mapping;
+#endif
+};
+
+struct asset_pack_writer_t {
+	uint8_t*	bytes;
+	size_t		size;
+	size_t		capacity;
+	AssetEntry*	entries;
+	uint32_t	numEntries;
+	uint32_t	maxEntries;
+	uint64_t	sourceKey;
+};
+
+static AssetPack* _assetPackNew(const uint8_t* base, size_t size);
+static AssetEntry* _assetPackWriterBeginEntry(AssetPackWriter* writer, const char* name, AssetType type);
+static void _assetPackWriterAppend(AssetPackWriter* writer, const void* data, size_t size);
+static void _assetPackWriterAlign(AssetPackWriter* writer);
+
+/// @brief Memory maps a pack
+/// @param path
+/// @return NULL if there's no pack there, or it isn't one this version can read
+AssetPack* assetPackOpen(const char* path)
+{
+	AssetPack* pack = NULL;
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return NULL;
+	}
+	LARGE_INTEGER size;
+	HANDLE mapping = NULL;
+	const uint8_t* base = NULL;
+	if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+	{
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping != NULL)
+		{
+			base = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		}
+	}
+	if (base != NULL)
+	{
+		pack = _assetPackNew(base, (size_t)size.QuadPart);
+	}
+	if (pack == NULL)
+	{
+		if (base != NULL) { UnmapViewOfFile(base); }
+		if (mapping != NULL) { CloseHandle(mapping); }
+		CloseHandle(file);
+		return NULL;
+	}
+	pack->file = file;
+	pack->mapping = mapping;
+#else
+	const int file = open(path, O_RDONLY);
+	if (file < 0)
+	{
+		return NULL;
+	}
+	AssetStat fileStat;
+	void* base = MAP_FAILED;
+	if (fstat(file, &fileStat) == 0 && fileStat.st_size > 0)
+	{
+		base = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	}
+	// The mapping keeps the file open
+	close(file);
+	if (base == MAP_FAILED)
+	{
+		return NULL;
+	}
+	pack = _assetPackNew((const uint8_t*)base, (size_t)fileStat.st_size);
+	if (pack == NULL)
+	{
+		munmap(base, (size_t)fileStat.st_size);
+		return NULL;
+	}
+#endif
+	return pack;
+}
+
+/// @brief Unmaps a pack. Nothing from it may be used after.
+/// @param pack
+void assetPackClose(AssetPack* pack)
+{
+	if (pack == NULL)
+	{
+		return;
+	}
+
+	if (pack->heap != NULL)
+	{
+		free(pack->heap);
+	}
+	else
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(pack->base);
+		CloseHandle(pack->mapping);
+		CloseHandle(pack->file);
+#else
+		munmap((void*)pack->base, pack->size);
+#endif
+	}
+	free(pack);
+}
+
+/// @brief Whether a pack needs writing again: it's missing, it was written from different sources (or by another version),
+/// or any of the files it was written from has changed since
+/// @param path
+/// @param sourcePaths
+/// @param numSources
+/// @param sourceKey what the pack should have been written from, as passed to assetPackWriterNew
+/// @return
+bool assetPackIsOutOfDate(const char* path, const char* const* sourcePaths, uint32_t numSources, uint64_t sourceKey)
+{
+	AssetStat packStat;
+	if (_assetStat(path, &packStat) != 0)
+	{
+		return true;
+	}
+
+	AssetPackHeader header;
+	FILE* file = fopen(path, "rb");
+	if (file == NULL)
+	{
+		return true;
+	}
+	const bool isHeaderRead = fread(&header, sizeof(AssetPackHeader), 1, file) == 1;
+	fclose(file);
+	if (!isHeaderRead || header.magic != ASSET_PACK_MAGIC || header.version != ASSET_PACK_VERSION || header.sourceKey != sourceKey)
+	{
+		return true;
+	}
+
+	for (uint32_t i = 0; i < numSources; ++i)
+	{
+		AssetStat sourceStat;
+		if (_assetStat(sourcePaths[i], &sourceStat) == 0 && sourceStat.st_mtime > packStat.st_mtime)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/// @brief Folds bytes into a hash (FNV-1a), for building a pack's source key
+/// @param hash ASSET_PACK_HASH_INIT, or the hash so far
+/// @param data
+/// @param size
+/// @return
+uint64_t assetPackHash(uint64_t hash, const void* data, size_t size)
+{
+	const uint64_t FNV_PRIME = 1099511628211ull;
+
+	const uint8_t* bytes = (const uint8_t*)data;
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash = (hash ^ bytes[i]) * FNV_PRIME;
+	}
+	return hash;
+}
+
+/// @brief Looks an asset up in the table of contents
+/// @param pack
+/// @param name
+/// @return NULL if the pack doesn't have it
+const AssetEntry* assetPackFind(const AssetPack* pack, const char* name)
+{
+	for (uint32_t i = 0; i < pack->numEntries; ++i)
+	{
+		if (strncmp(pack->entries[i].name, name, ASSET_PACK_NAME_LENGTH) == 0)
+		{
+			return &pack->entries[i];
+		}
+	}
+	return NULL;
+}
+
+/// @brief An asset's data, which stays valid until the pack is closed
+/// @param pack
+/// @param entry
+/// @return
+const void* assetPackGetData(const AssetPack* pack, const AssetEntry* entry)
+{
+	return pack->base + entry->offset;
+}
+
+/// @brief Reads an asset's pages into memory, so whoever uses it next doesn't stall on the disk. Safe to call from any thread.
+/// @param pack
+/// @param entry
+void assetPackPrefetch(const AssetPack* pack, const AssetEntry* entry)
+{
+	const volatile uint8_t* data = pack->base + entry->offset;
+	uint8_t sum = 0;
+	for (uint64_t i = 0; i < entry->size; i += ASSET_PACK_PAGE_SIZE)
+	{
+		sum += data[i];
+	}
+	(void)sum;
+}
+
+/// @brief Looks up an image
+/// @param pack
+/// @param name
+/// @param width receives the image's width, if not NULL
+/// @param height receives the image's height, if not NULL
+/// @return the image's pixels, or NULL if the pack doesn't have it (or it's too short for its size)
+const void* assetPackGetImage(const AssetPack* pack, const char* name, uint32_t* width, uint32_t* height)
+{
+	const AssetEntry* entry = assetPackFind(pack, name);
+	if (entry == NULL || entry->type != ASSET_TYPE_IMAGE ||
+		(uint64_t)entry->params[0] * entry->params[1] * 4 > entry->size)
+	{
+		return NULL;
+	}
+
+	if (width != NULL) { *width = entry->params[0]; }
+	if (height != NULL) { *height = entry->params[1]; }
+	return assetPackGetData(pack, entry);
+}
+
+/// @brief Looks up a sound
+/// @param pack
+/// @param name
+/// @param info receives the sound's format and samples
+/// @return false if the pack doesn't have it (or it's too short for its format and samples)
+bool assetPackGetSound(const AssetPack* pack, const char* name, WavInfo* info)
+{
+	const AssetEntry* entry = assetPackFind(pack, name);
+	if (entry == NULL || entry->type != ASSET_TYPE_SOUND)
+	{
+		return false;
+	}
+
+	const uint64_t formatBytes = entry->params[0];
+	const uint64_t samplesOffset = (formatBytes + ASSET_PACK_ALIGNMENT - 1) & ~(uint64_t)(ASSET_PACK_ALIGNMENT - 1);
+	if (samplesOffset + entry->params[1] > entry->size)
+	{
+		return false;
+	}
+
+	const uint8_t* data = (const uint8_t*)assetPackGetData(pack, entry);
+	info->format = data;
+	info->formatBytes = entry->params[0];
+	info->samples = data + samplesOffset;
+	info->sampleBytes = entry->params[1];
+	return true;
+}
+
+/// @brief Starts writing a pack in memory
+/// @param sourceKey what the pack is written from, for assetPackIsOutOfDate to check against
+/// @return
+AssetPackWriter* assetPackWriterNew(uint64_t sourceKey)
+{
+	AssetPackWriter* writer = (AssetPackWriter*)calloc(1, sizeof(AssetPackWriter));
+	assert(writer != NULL);
+	writer->sourceKey = sourceKey;
+
+	// Room for the header, filled in once everything else is written
+	AssetPackHeader header = { 0 };
+	_assetPackWriterAppend(writer, &header, sizeof(AssetPackHeader));
+	return writer;
+}
+
+/// @brief Adds an asset
+/// @param writer
+/// @param name must be unique, and shorter than ASSET_PACK_NAME_LENGTH
+/// @param type
+/// @param params see AssetType, or NULL for none
+/// @param data copied into the pack
+/// @param size
+void assetPackWriterAdd(AssetPackWriter* writer, const char* name, AssetType type, const uint32_t params[3], const void* data, size_t size)
+{
+	AssetEntry* entry = _assetPackWriterBeginEntry(writer, name, type);
+	if (params != NULL)
+	{
+		memcpy(entry->params, params, sizeof(entry->params));
+	}
+	_assetPackWriterAppend(writer, data, size);
+	writer->entries[writer->numEntries - 1].size = writer->size - entry->offset;
+}
+
+/// @brief Adds an image, which should already be laid out as it is uploaded (see ASSET_TYPE_IMAGE)
+/// @param writer
+/// @param name
+/// @param width
+/// @param height
+/// @param pixels
+void assetPackWriterAddImage(AssetPackWriter* writer, const char* name, uint32_t width, uint32_t height, const void* pixels)
+{
+	const uint32_t params[3] = { width, height, 0 };
+	assetPackWriterAdd(writer, name, ASSET_TYPE_IMAGE, params, pixels, (size_t)width * height * 4);
+}
+
+/// @brief Adds a sound: just its format and samples, none of the rest of the file
+/// @param writer
+/// @param name
+/// @param info from wavParse
+void assetPackWriterAddSound(AssetPackWriter* writer, const char* name, const WavInfo* info)
+{
+	AssetEntry* entry = _assetPackWriterBeginEntry(writer, name, ASSET_TYPE_SOUND);
+	entry->params[0] = info->formatBytes;
+	entry->params[1] = info->sampleBytes;
+	const uint64_t offset = entry->offset;
+
+	_assetPackWriterAppend(writer, info->format, info->formatBytes);
+	_assetPackWriterAlign(writer);
+	_assetPackWriterAppend(writer, info->samples, info->sampleBytes);
+	writer->entries[writer->numEntries - 1].size = writer->size - offset;
+}
+
+/// @brief Writes the pack out, frees the writer, and opens the pack
+/// @param writer
+/// @param path
+/// @return the pack, mapped from the file, or held in memory if it couldn't be written
+AssetPack* assetPackWriterFinish(AssetPackWriter* writer, const char* path)
+{
+	_assetPackWriterAlign(writer);
+	const uint64_t tocOffset = writer->size;
+	_assetPackWriterAppend(writer, writer->entries, writer->numEntries * sizeof(AssetEntry));
+
+	AssetPackHeader header = { ASSET_PACK_MAGIC, ASSET_PACK_VERSION, writer->numEntries, 0, tocOffset, writer->sourceKey };
+	memcpy(writer->bytes, &header, sizeof(AssetPackHeader));
+
+	AssetPack* pack = NULL;
+	FILE* file = fopen(path, "wb");
+	if (file != NULL)
+	{
+		const bool isWritten = fwrite(writer->bytes, 1, writer->size, file) == writer->size;
+		if (fclose(file) == 0 && isWritten)
+		{
+			pack = assetPackOpen(path);
+		}
+	}
+
+	if (pack == NULL)
+	{
+		pack = _assetPackNew(writer->bytes, writer->size);
+		assert(pack != NULL);
+		pack->heap = writer->bytes;
+	}
+	else
+	{
+		free(writer->bytes);
+	}
+	free(writer->entries);
+	free(writer);
+	return pack;
+}
+
+/// @brief Checks a pack's bytes are whole, and wraps them
+/// @param base
+/// @param size
+/// @return NULL if they aren't
+static AssetPack* _assetPackNew(const uint8_t* base, size_t size)
+{
+	if (size < sizeof(AssetPackHeader))
+	{
+		return NULL;
+	}
+	AssetPackHeader header;
+	memcpy(&header, base, sizeof(AssetPackHeader));
+	if (header.magic != ASSET_PACK_MAGIC || header.version != ASSET_PACK_VERSION ||
+		header.tocOffset > size || (size - header.tocOffset) / sizeof(AssetEntry) < header.numEntries)
+	{
+		return NULL;
+	}
+
+	const AssetEntry* entries = (const AssetEntry*)(base + header.tocOffset);
+	for (uint32_t i = 0; i < header.numEntries; ++i)
+	{
+		if (entries[i].offset > size || entries[i].size > size - entries[i].offset)
+		{
+			return NULL;
+		}
+	}
+
+	AssetPack* pack = (AssetPack*)calloc(1, sizeof(AssetPack));
+	assert(pack != NULL);
+	pack->base = base;
+	pack->size = size;
+	pack->entries = entries;
+	pack->numEntries = header.numEntries;
+	return pack;
+}
+
+/// @brief Adds an entry to the table of contents, starting at the next aligned byte
+/// @return the entry, valid until the next is begun
+static AssetEntry* _assetPackWriterBeginEntry(AssetPackWriter* writer, const char* name, AssetType type)
+{
+	assert(strlen(name) < ASSET_PACK_NAME_LENGTH);
+
+	if (writer->numEntries == writer->maxEntries)
+	{
+		const uint32_t maxEntries = writer->maxEntries > 0 ? writer->maxEntries * 2 : 16;
+		AssetEntry* entries = (AssetEntry*)realloc(writer->entries, maxEntries * sizeof(AssetEntry));
+		assert(entries != NULL);
+		writer->entries = entries;
+		writer->maxEntries = maxEntries;
+	}
+
+	_assetPackWriterAlign(writer);
+	AssetEntry* entry = &writer->entries[writer->numEntries++];
+	memset(entry, 0, sizeof(AssetEntry));
+	strncpy(entry->name, name, ASSET_PACK_NAME_LENGTH - 1);
+	entry->type = (uint32_t)type;
+	entry->offset = writer->size;
+	return entry;
+}
+
+static void _assetPackWriterAppend(AssetPackWriter* writer, const void* data, size_t size)
+{
+	if (writer->size + size > writer->capacity)
+	{
+		size_t capacity = writer->capacity > 0 ? writer->capacity : 4096;
+		while (capacity < writer->size + size)
+		{
+			capacity *= 2;
+		}
+		uint8_t* bytes = (uint8_t*)realloc(writer->bytes, capacity);
+		assert(bytes != NULL);
+		writer->bytes = bytes;
+		writer->capacity = capacity;
+	}
+
+	if (data != NULL)
+	{
+		memcpy(writer->bytes + writer->size, data, size);
+	}
+	else
+	{
+		memset(writer->bytes + writer->size, 0, size);
+	}
+	writer->size += size;
+}
+
+static void _assetPackWriterAlign(AssetPackWriter* writer)
+{
+	const size_t padding = (ASSET_PACK_ALIGNMENT - writer->size % ASSET_PACK_ALIGNMENT) % ASSET_PACK_ALIGNMENT;
+	_assetPackWriterAppend(writer, NULL, padding);
+}
@@ -1,3 +1,6 @@
+// Win32 / OpenGL / XAudio2 implementation; the headless build uses the matching *Headless.c file instead
+#ifndef FW_HEADLESS
+
 #include <Windows.h>
 #include <stdio.h>
 #include <io.h>
@@ -7,6 +10,8 @@
 #include "openglDraw.h"
 #include "input.h"
 #include "sound.h"
+#include "profiler.h"
+#include "jobs.h"
 
 // Application Define Message For Toggling
 #define WM_TOGGLEFULLSCREEN (WM_USER+1)
@@ -29,7 +34,16 @@ typedef struct gl_window_t {						// Contains Information Vital To A Window
 
 	// state information
 	bool				isVisible;					// Window Visible?
-	ULONGLONG			lastTickCount;				// Tick Counter
+	bool				isFirstFrame;				// Nothing To Simulate Until The First Frame
+	LARGE_INTEGER		counterFrequency;			// Performance Counter Ticks Per Second
+	LARGE_INTEGER		lastCounter;				// Performance Counter At The Last Frame
+
+	// pipelined rendering
+	HANDLE				renderThread;				// Owns The GL Context While Running
+	HANDLE				renderStart;				// Signalled Once A Frame Has Been Drawn
+	HANDLE				renderDone;					// Signalled Once The Render Thread Is Idle
+	volatile bool		isRenderStopping;
+	volatile LONG		pendingSize;				// Resize For The Render Thread To Apply (LoWord=Width, HiWord=Height), 0 If None
 } GLWindow;
 
 // private helper methods
@@ -39,6 +53,11 @@ static void _destroyWindow(GLWindow* window);
 static HWND _initializeWindowEx(GLWindow* window, Application* app);
 static bool _setPixelFormat(HDC deviceContext, uint32_t bitsPerPixel);
 static LRESULT CALLBACK _messageHandler(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
+static void _resize(GLWindow* window, int32_t width, int32_t height);
+static void _renderFrame(GLWindow* window);
+static bool _startRenderThread(GLWindow* window);
+static void _stopRenderThread(GLWindow* window);
+static DWORD WINAPI _renderThreadMain(LPVOID param);
 
 /// @brief Initialize windows for running this application
 /// @param app 
@@ -62,8 +81,10 @@ GLWindow* fwInitWindow(Application* app)
 	*stdin = *hf_in;
 
 	// initialize core systems
-	soundInit(appGetMaxSounds(app));
+	soundInit(appGetMaxSounds(app), appGetSoundSink(app));
 	inputInit();
+	profilerInit(PROFILER_DEFAULT_EVENTS_PER_THREAD);
+	jobsInit(appGetNumWorkers(app));
 
 	// Register A Class For Our Window To Use
 	if (!_registerWindowClass(app))
@@ -96,6 +117,8 @@ bool fwUpdateWindow(GLWindow* window)
 	{
 		if (msg.message == WM_QUIT)
 		{
+			// Whatever the last frame is still rendering from has to outlive it
+			_stopRenderThread(window);
 			return false;
 		}
 		else
@@ -107,17 +130,42 @@ bool fwUpdateWindow(GLWindow* window)
 	{
 		if (window->isVisible) 
 		{
-			ULONGLONG tickCount = GetTickCount64();
-			uint32_t ticks = (uint32_t)(tickCount - window->lastTickCount);
-			window->lastTickCount = tickCount;
+			// GetTickCount64 only has ~16ms resolution, so time frames with the performance counter
+			LARGE_INTEGER counter;
+			QueryPerformanceCounter(&counter);
+			uint64_t microseconds = (uint64_t)(counter.QuadPart - window->lastCounter.QuadPart) * 1000000 / (uint64_t)window->counterFrequency.QuadPart;
+			window->lastCounter = counter;
+
+			// Don't count the time spent loading between window creation and the first frame
+			if (window->isFirstFrame)
+			{
+				microseconds = 0;
+				window->isFirstFrame = false;
+			}
+
+			profilerBeginZone("Frame");
 
-			appUpdate(window->app, ticks);
+			// Simulate in fixed steps, then draw interpolated between the last two steps
+			appAdvance(window->app, microseconds);
 
-			glDrawStart();
-			appDraw(window->app);
-			glDrawEnd();
+			if (appIsPipelined(window->app) && (window->renderThread != NULL || _startRenderThread(window)))
+			{
+				// Record this frame while the render thread is still on the last one, then hand it over
+				appDraw(window->app, appGetInterpolation(window->app));
+
+				profilerBeginZone("WaitForRender");
+				WaitForSingleObject(window->renderDone, INFINITE);
+				profilerEndZone();
+				SetEvent(window->renderStart);
+			}
+			else
+			{
+				glDrawStart();
+				appDraw(window->app, appGetInterpolation(window->app));
+				_renderFrame(window);
+			}
 
-			SwapBuffers(window->hDC);
+			profilerEndZone();
 		}
 		else
 		{
@@ -135,8 +183,11 @@ void fwShutdownWindow(GLWindow* window)
 	// store the instance, so we can still safely use it after destroying the window
 	HINSTANCE inst = appGetInstance(window->app);
 
+	_stopRenderThread(window);
+	jobsShutdown();
 	inputShutdown();
 	soundShutdown();
+	profilerShutdown();
 
 	_destroyWindow(window);
 
@@ -268,8 +319,10 @@ static GLWindow* _createWindow(Application* app)
 		// Reshape Our GL Window
 		glDrawResize(appGetWidth(app), appGetHeight(app));
 
-		// Get Tick Count
-		window->lastTickCount = GetTickCount64();
+		// Start The Frame Clock
+		QueryPerformanceFrequency(&window->counterFrequency);
+		QueryPerformanceCounter(&window->lastCounter);
+		window->isFirstFrame = true;
 	}
 
 	return window;
@@ -419,12 +472,12 @@ static LRESULT CALLBACK _messageHandler(HWND hWnd, UINT uMsg, WPARAM wParam, LPA
 
 				case SIZE_MAXIMIZED:									// Was Window Maximized?
 					window->isVisible = TRUE;							// Set isVisible To True
-					glDrawResize(LOWORD(lParam), HIWORD(lParam));		// Reshape Window - LoWord=Width, HiWord=Height
+					_resize(window, LOWORD(lParam), HIWORD(lParam));	// Reshape Window - LoWord=Width, HiWord=Height
 					return 0;
 
 				case SIZE_RESTORED:										// Was Window Restored?
 					window->isVisible = TRUE;							// Set isVisible To True
-					glDrawResize(LOWORD(lParam), HIWORD(lParam));		// Reshape Window - LoWord=Width, HiWord=Height
+					_resize(window, LOWORD(lParam), HIWORD(lParam));	// Reshape Window - LoWord=Width, HiWord=Height
 					return 0;
 			}
 			break;
@@ -477,3 +530,121 @@ static LRESULT CALLBACK _messageHandler(HWND hWnd, UINT uMsg, WPARAM wParam, LPA
 	return DefWindowProc(hWnd, uMsg, wParam, lParam);					// Pass Unhandled Messages To DefWindowProc
 }
 
+/// @brief Reshapes GL for a new window size, on whichever thread owns the context
+/// @param window 
+/// @param width 
+/// @param height 
+static void _resize(GLWindow* window, int32_t width, int32_t height)
+{
+	if (window->renderThread != NULL)
+	{
+		InterlockedExchange(&window->pendingSize, MAKELONG(width, height));
+	}
+	else
+	{
+		glDrawResize(width, height);
+	}
+}
+
+/// @brief Submits the frame the application last drew, and presents it
+/// @param window 
+static void _renderFrame(GLWindow* window)
+{
+	appRender(window->app);
+	glDrawEnd();
+
+	profilerBeginZone("SwapBuffers");
+	SwapBuffers(window->hDC);
+	profilerEndZone();
+}
+
+/// @brief Hands the GL context over to a new render thread. Started on the first pipelined frame, so everything loaded
+/// before then (textures) still had the context on the main thread.
+/// @param window 
+/// @return false if the thread couldn't be started, leaving the context with the main thread
+static bool _startRenderThread(GLWindow* window)
+{
+	window->renderStart = CreateEvent(NULL, FALSE, FALSE, NULL);
+	window->renderDone = CreateEvent(NULL, FALSE, TRUE, NULL);
+	window->isRenderStopping = false;
+	window->pendingSize = 0;
+	if (window->renderStart == NULL || window->renderDone == NULL)
+	{
+		_stopRenderThread(window);
+		return false;
+	}
+
+	wglMakeCurrent(NULL, NULL);
+	window->renderThread = CreateThread(NULL, 0, _renderThreadMain, window, 0, NULL);
+	if (window->renderThread == NULL)
+	{
+		wglMakeCurrent(window->hDC, window->hRC);
+		_stopRenderThread(window);
+		return false;
+	}
+	return true;
+}
+
+/// @brief Waits for the render thread to finish its frame, stops it, and takes the GL context back
+/// @param window 
+static void _stopRenderThread(GLWindow* window)
+{
+	if (window->renderThread != NULL)
+	{
+		WaitForSingleObject(window->renderDone, INFINITE);
+		window->isRenderStopping = true;
+		SetEvent(window->renderStart);
+		WaitForSingleObject(window->renderThread, INFINITE);
+		CloseHandle(window->renderThread);
+		window->renderThread = NULL;
+
+		wglMakeCurrent(window->hDC, window->hRC);
+	}
+
+	if (window->renderStart != NULL)
+	{
+		CloseHandle(window->renderStart);
+		window->renderStart = NULL;
+	}
+	if (window->renderDone != NULL)
+	{
+		CloseHandle(window->renderDone);
+		window->renderDone = NULL;
+	}
+}
+
+/// @brief Render thread: renders each frame handed over by the main thread, until stopped
+/// @param param the window
+/// @return 
+static DWORD WINAPI _renderThreadMain(LPVOID param)
+{
+	GLWindow* window = (GLWindow*)param;
+	wglMakeCurrent(window->hDC, window->hRC);
+
+	for (;;)
+	{
+		WaitForSingleObject(window->renderStart, INFINITE);
+		if (window->isRenderStopping)
+		{
+			break;
+		}
+
+		const LONG size = InterlockedExchange(&window->pendingSize, 0);
+		if (size != 0)
+		{
+			glDrawResize(LOWORD(size), HIWORD(size));
+		}
+
+		profilerBeginZone("RenderFrame");
+		glDrawStart();
+		_renderFrame(window);
+		profilerEndZone();
+
+		SetEvent(window->renderDone);
+	}
+
+	wglMakeCurrent(NULL, NULL);
+	return 0;
+}
+
+#endif // !FW_HEADLESS
@@ -0,0 +1,220 @@
+// Headless implementation: no window, GL context or audio device; updates run back to back, and audio is mixed for a
+// sink that doesn't play it (nothing, or a file)
+#ifdef FW_HEADLESS
+
+#include <stdio.h>
+#include <pthread.h>
+
+#include "framework.h"
+#include "input.h"
+#include "sound.h"
+#include "profiler.h"
+#include "jobs.h"
+
+typedef struct gl_window_t {
+	Application*		app;
+
+	// state information
+	bool				isRunning;
+	uint64_t			updateCount;
+	uint64_t			startNanoseconds;
+
+	// pipelined rendering: frames are drawn (recorded) and rendered, just without GL
+	pthread_t			renderThread;
+	pthread_mutex_t		renderMutex;
+	pthread_cond_t		renderChanged;			// signalled when a frame is handed over or finished, or the thread is stopped
+	bool				isRenderThreadRunning;
+	bool				isRenderPending;		// a frame has been handed over, and not rendered yet
+	bool				isRenderStopping;
+} GLWindow;
+
+static bool _startRenderThread(GLWindow* window);
+static void _stopRenderThread(GLWindow* window);
+static void* _renderThreadMain(void* param);
+
+/// @brief Initialize the headless backend for running this application
+/// @param app
+/// @return
+GLWindow* fwInitWindow(Application* app)
+{
+	// initialize core systems
+	soundInit(appGetMaxSounds(app), appGetSoundSink(app));
+	inputInit();
+	profilerInit(PROFILER_DEFAULT_EVENTS_PER_THREAD);
+	jobsInit(appGetNumWorkers(app));
+
+	GLWindow* window = malloc(sizeof(GLWindow));
+	if (window != NULL)
+	{
+		ZeroMemory(window, sizeof(GLWindow));
+
+		window->app = app;
+		window->isRunning = true;
+		window->startNanoseconds = profilerGetNanoseconds();
+	}
+
+	return window;
+}
+
+/// @brief Advances the application by exactly one fixed step, without waiting on a real clock. Nothing is drawn,
+/// unless the application is pipelined: then each step is drawn and rendered the same way as with a window, minus GL.
+/// @param window
+/// @return false once terminated, the application's max updates has been reached, or a replay has run out
+bool fwUpdateWindow(GLWindow* window)
+{
+	const uint64_t maxUpdates = appGetMaxUpdates(window->app);
+	if (!window->isRunning || (maxUpdates != 0 && window->updateCount >= maxUpdates) || inputIsReplayFinished())
+	{
+		// Whatever the last frame is still rendering from has to outlive it
+		_stopRenderThread(window);
+		return false;
+	}
+
+	window->updateCount += appAdvance(window->app, (uint64_t)appGetFixedStep(window->app) * 1000);
+
+	if (appIsPipelined(window->app) && (window->isRenderThreadRunning || _startRenderThread(window)))
+	{
+		// Record this frame while the render thread is still on the last one, then hand it over
+		appDraw(window->app, appGetInterpolation(window->app));
+
+		pthread_mutex_lock(&window->renderMutex);
+		profilerBeginZone("WaitForRender");
+		while (window->isRenderPending)
+		{
+			pthread_cond_wait(&window->renderChanged, &window->renderMutex);
+		}
+		profilerEndZone();
+		window->isRenderPending = true;
+		pthread_cond_broadcast(&window->renderChanged);
+		pthread_mutex_unlock(&window->renderMutex);
+	}
+
+	return true;
+}
+
+/// @brief Report throughput and release resources associated with the headless backend
+/// @param window
+void fwShutdownWindow(GLWindow* window)
+{
+	const double seconds = (double)(profilerGetNanoseconds() - window->startNanoseconds) / 1e9;
+	const double simulatedSeconds = (double)window->updateCount * appGetFixedStep(window->app) / 1e3;
+	// Drivers that step the application themselves (e.g. the benchmark) report their own numbers
+	if (window->updateCount > 0)
+	{
+		printf("%s: %llu updates (%.1f simulated s) in %.3f s, %.0f updates/s\n",
+			appGetTitle(window->app),
+			(unsigned long long)window->updateCount,
+			simulatedSeconds,
+			seconds,
+			seconds > 0.0 ? (double)window->updateCount / seconds : 0.0);
+	}
+
+	_stopRenderThread(window);
+	jobsShutdown();
+	inputShutdown();
+	soundShutdown();
+	profilerShutdown();
+
+	free(window);
+}
+
+/// @brief Stops the update loop after the current update
+/// @param window
+void fwSendTerminate(GLWindow* window)
+{
+	window->isRunning = false;
+}
+
+/// @brief No display to change in headless mode
+void fwSendFullscreen(GLWindow* window, bool fullscreen)
+{
+	(void)window;
+	(void)fullscreen;
+}
+
+/// @brief No display to change in headless mode
+bool fwChangeResolution(GLWindow* window, uint32_t width, uint32_t height, uint32_t bitsPerPixel)
+{
+	(void)window;
+	(void)width;
+	(void)height;
+	(void)bitsPerPixel;
+	return false;
+}
+
+/// @brief Starts the render thread, on the first pipelined frame
+/// @param window
+/// @return false if the thread couldn't be started
+static bool _startRenderThread(GLWindow* window)
+{
+	pthread_mutex_init(&window->renderMutex, NULL);
+	pthread_cond_init(&window->renderChanged, NULL);
+	window->isRenderPending = false;
+	window->isRenderStopping = false;
+
+	if (pthread_create(&window->renderThread, NULL, _renderThreadMain, window) != 0)
+	{
+		pthread_cond_destroy(&window->renderChanged);
+		pthread_mutex_destroy(&window->renderMutex);
+		return false;
+	}
+	window->isRenderThreadRunning = true;
+	return true;
+}
+
+/// @brief Waits for the render thread to finish its frame, and stops it
+/// @param window
+static void _stopRenderThread(GLWindow* window)
+{
+	if (!window->isRenderThreadRunning)
+	{
+		return;
+	}
+
+	pthread_mutex_lock(&window->renderMutex);
+	while (window->isRenderPending)
+	{
+		pthread_cond_wait(&window->renderChanged, &window->renderMutex);
+	}
+	window->isRenderStopping = true;
+	pthread_cond_broadcast(&window->renderChanged);
+	pthread_mutex_unlock(&window->renderMutex);
+
+	pthread_join(window->renderThread, NULL);
+	pthread_cond_destroy(&window->renderChanged);
+	pthread_mutex_destroy(&window->renderMutex);
+	window->isRenderThreadRunning = false;
+}
+
+/// @brief Render thread: renders each frame handed over by the main thread, until stopped
+/// @param param the window
+/// @return
+static void* _renderThreadMain(void* param)
+{
+	GLWindow* window = (GLWindow*)param;
+
+	pthread_mutex_lock(&window->renderMutex);
+	for (;;)
+	{
+		while (!window->isRenderPending && !window->isRenderStopping)
+		{
+			pthread_cond_wait(&window->renderChanged, &window->renderMutex);
+		}
+		if (!window->isRenderPending)
+		{
+			break;
+		}
+		pthread_mutex_unlock(&window->renderMutex);
+
+		appRender(window->app);
+
+		pthread_mutex_lock(&window->renderMutex);
+		window->isRenderPending = false;
+		pthread_cond_broadcast(&window->renderChanged);
+	}
+	pthread_mutex_unlock(&window->renderMutex);
+
+	return NULL;
+}
+
+#endif // FW_HEADLESS
@@ -1,7 +1,23 @@
-#include <Windows.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "platform.h"
 #include "baseTypes.h"
 #include "input.h"
 
+#define INPUT_REPLAY_VERSION			1
+#define INPUT_CHECKSUM_INTERVAL			60		// ticks between stored checksums
+
+// A recording is a 16 byte header (magic, version, fixed step, seed), then blocks. Each block starts with the
+// number of ticks since the previous block as a varint, then a tag saying what follows.
+typedef enum {
+	INPUT_BLOCK_END,			// nothing follows, the recording ran for this many ticks
+	INPUT_BLOCK_KEYS,			// a count byte, then that many keys that toggled before this tick's update
+	INPUT_BLOCK_CHECKSUM,		// the game's checksum of its state after this tick's update, 4 bytes
+} InputBlockTag;
+
+static const char INPUT_REPLAY_MAGIC[4] = { 'J', 'R', 'P', 'L' };
+
 /// @brief Keyboard state
 typedef struct {
 	bool keyDown[256];
@@ -13,15 +29,41 @@ typedef struct {
 	bool	buttons[INPUT_BUTTON_COUNT];
 } Mouse;
 
+/// @brief Record or replay stream state
+typedef struct {
+	FILE*		file;
+	uint64_t	tick;				// fixed updates seen so far
+	uint64_t	blockTick;			// the tick of the last block written, or of the next block to read
+	uint8_t		blockTag;			// replay only, the tag of the next block to read
+	Keyboard	keyboard;			// record only, the key state as of the last block written
+	uint32_t	checksum;			// the latest checksum submitted
+	uint64_t	checksumTick;		// the tick it was submitted for, UINT64_MAX if none has been
+	bool		isFinished;
+	bool		isDiverged;
+} InputStream;
+
 static Keyboard s_Keyboard;
 static Mouse s_Mouse;
+static InputStream s_Record;
+static InputStream s_Replay;
+
+static void _inputStreamReset(InputStream* stream);
+static void _inputRecordStop();
+static void _inputRecordBlock(uint64_t tick, InputBlockTag tag);
+static void _inputReplayStop();
+static void _inputReplayCatchUp();
+static bool _inputReplayReadBlock();
+static void _writeU32(FILE* file, uint32_t value);
+static bool _readU32(FILE* file, uint32_t* value);
+static void _writeVarint(FILE* file, uint64_t value);
+static bool _readVarint(FILE* file, uint64_t* value);
 
 /// @brief Retrieves the pressed state for a keyboard key
 /// @param vkCode 
 /// @return 
 bool inputKeyPressed(char vkCode) 
 {
-	return s_Keyboard.keyDown[vkCode];
+	return s_Keyboard.keyDown[(uint8_t)vkCode];
 }
 
 /// @brief Retrieves the current mouse position
@@ -39,26 +81,191 @@ bool inputMousePressed(InputButton button)
 	return s_Mouse.buttons[button];
 }
 
+/// @brief Starts recording the keyboard at every fixed update from here on, until the input system shuts down
+/// @param path 
+/// @param seed the random seed the run was started with
+/// @param fixedStep the milliseconds per fixed update the run uses
+/// @return false if the file couldn't be opened, or a recording is already running
+bool inputRecordStart(const char* path, uint32_t seed, uint32_t fixedStep)
+{
+	if (s_Record.file != NULL)
+	{
+		return false;
+	}
+
+	_inputStreamReset(&s_Record);
+	s_Record.file = fopen(path, "wb");
+	if (s_Record.file == NULL)
+	{
+		return false;
+	}
+
+	fwrite(INPUT_REPLAY_MAGIC, 1, sizeof(INPUT_REPLAY_MAGIC), s_Record.file);
+	_writeU32(s_Record.file, INPUT_REPLAY_VERSION);
+	_writeU32(s_Record.file, fixedStep);
+	_writeU32(s_Record.file, seed);
+
+	return true;
+}
+
+/// @brief Starts replaying a recording. The caller must seed and step the run with the values it was recorded with.
+/// @param path 
+/// @param seed receives the random seed the recording was started with
+/// @param fixedStep receives the milliseconds per fixed update the recording used
+/// @return false if the file couldn't be opened or isn't a recording, or a replay is already running
+bool inputReplayStart(const char* path, uint32_t* seed, uint32_t* fixedStep)
+{
+	if (s_Replay.file != NULL)
+	{
+		return false;
+	}
+
+	_inputStreamReset(&s_Replay);
+	s_Replay.file = fopen(path, "rb");
+	if (s_Replay.file == NULL)
+	{
+		return false;
+	}
+
+	char magic[sizeof(INPUT_REPLAY_MAGIC)];
+	uint32_t version = 0;
+	if (fread(magic, 1, sizeof(magic), s_Replay.file) != sizeof(magic) || memcmp(magic, INPUT_REPLAY_MAGIC, sizeof(magic)) != 0 ||
+		!_readU32(s_Replay.file, &version) || version != INPUT_REPLAY_VERSION ||
+		!_readU32(s_Replay.file, fixedStep) || !_readU32(s_Replay.file, seed) ||
+		!_inputReplayReadBlock())
+	{
+		fclose(s_Replay.file);
+		s_Replay.file = NULL;
+		return false;
+	}
+
+	ZeroMemory(&s_Keyboard, sizeof(Keyboard));
+	return true;
+}
+
+/// @brief Whether the keyboard is currently coming from a recording
+/// @return 
+bool inputIsReplaying()
+{
+	return s_Replay.file != NULL;
+}
+
+/// @brief Whether a replay was started and has run out
+/// @return 
+bool inputIsReplayFinished()
+{
+	return s_Replay.isFinished;
+}
+
+/// @brief Whether the replay has produced a different checksum than the recording did
+/// @return 
+bool inputHasReplayDiverged()
+{
+	return s_Replay.isDiverged;
+}
+
+/// @brief Hands the input system the game's checksum of its state, after the update it was computed for.
+/// Recording stores one every so often; replaying compares them against the recording's.
+/// @param checksum 
+void inputSubmitChecksum(uint32_t checksum)
+{
+	if (s_Record.file != NULL && s_Record.tick > 0)
+	{
+		s_Record.checksum = checksum;
+		s_Record.checksumTick = s_Record.tick - 1;
+		if (s_Record.tick % INPUT_CHECKSUM_INTERVAL == 0)
+		{
+			_inputRecordBlock(s_Record.checksumTick, INPUT_BLOCK_CHECKSUM);
+		}
+	}
+
+	if (s_Replay.file != NULL && s_Replay.tick > 0)
+	{
+		s_Replay.checksum = checksum;
+		s_Replay.checksumTick = s_Replay.tick - 1;
+		_inputReplayCatchUp();
+	}
+}
+
 /// @brief Input system initialization
 void inputInit()
 {
 	ZeroMemory(&s_Keyboard, sizeof(Keyboard));
 	ZeroMemory(&s_Mouse, sizeof(Mouse));
+	_inputStreamReset(&s_Record);
+	_inputStreamReset(&s_Replay);
 }
 
-/// @brief Input system shutdown
+/// @brief Input system shutdown, finishing off any recording
 void inputShutdown() 
 {
+	_inputRecordStop();
+	_inputReplayStop();
+
 	ZeroMemory(&s_Keyboard, sizeof(Keyboard));
 	ZeroMemory(&s_Mouse, sizeof(Mouse));
 }
 
-/// @brief Updates the pressed state of a keyboard key
+/// @brief Updates the pressed state of a keyboard key. Ignored while replaying.
 /// @param vkCode 
 /// @param pressed 
 void inputKeyUpdate(uint8_t vkCode, bool pressed) 
 {
-	s_Keyboard.keyDown[vkCode] = pressed;
+	if (s_Replay.file == NULL)
+	{
+		s_Keyboard.keyDown[vkCode] = pressed;
+	}
+}
+
+/// @brief Marks the start of a fixed update: loads the keyboard from the replay, then records it as the update will see it.
+/// Doing both re-records a replay, e.g. to refresh its checksums after an intended change to the game.
+void inputTick()
+{
+	if (s_Replay.file != NULL)
+	{
+		_inputReplayCatchUp();
+		while (s_Replay.file != NULL && s_Replay.blockTick == s_Replay.tick && s_Replay.blockTag == INPUT_BLOCK_KEYS)
+		{
+			const int count = fgetc(s_Replay.file);
+			for (int i = 0; i < count; ++i)
+			{
+				const int key = fgetc(s_Replay.file);
+				if (key != EOF)
+				{
+					s_Keyboard.keyDown[key] = !s_Keyboard.keyDown[key];
+				}
+			}
+			if (count == EOF || !_inputReplayReadBlock())
+			{
+				printf("Replay: recording is truncated at tick %llu\n", (unsigned long long)s_Replay.tick);
+				_inputReplayStop();
+			}
+		}
+		++s_Replay.tick;
+	}
+
+	if (s_Record.file != NULL)
+	{
+		// Keys that changed since the last block, in blocks of up to 255
+		uint8_t toggled[256];
+		uint32_t numToggled = 0;
+		for (uint32_t key = 0; key < 256; ++key)
+		{
+			if (s_Keyboard.keyDown[key] != s_Record.keyboard.keyDown[key])
+			{
+				toggled[numToggled++] = (uint8_t)key;
+			}
+		}
+		for (uint32_t first = 0; first < numToggled; first += 255)
+		{
+			const uint8_t count = (uint8_t)(numToggled - first < 255 ? numToggled - first : 255);
+			_inputRecordBlock(s_Record.tick, INPUT_BLOCK_KEYS);
+			fputc(count, s_Record.file);
+			fwrite(&toggled[first], 1, count, s_Record.file);
+		}
+		s_Record.keyboard = s_Keyboard;
+		++s_Record.tick;
+	}
 }
 
 /// @brief Updates the coordinates of the mouse
@@ -76,4 +283,155 @@ void inputMouseUpdateButton(InputButton button, bool pressed)
 	s_Mouse.buttons[button] = pressed;
 }
 
+/// @brief Clears a stream's state, without touching its file
+/// @param stream 
+static void _inputStreamReset(InputStream* stream)
+{
+	ZeroMemory(stream, sizeof(InputStream));
+	stream->checksumTick = UINT64_MAX;
+}
+
+/// @brief Writes the last checksum if it hasn't been already and the end of the recording, then closes it
+static void _inputRecordStop()
+{
+	if (s_Record.file == NULL)
+	{
+		return;
+	}
+
+	if (s_Record.checksumTick != UINT64_MAX && s_Record.checksumTick + 1 == s_Record.tick && s_Record.tick % INPUT_CHECKSUM_INTERVAL != 0)
+	{
+		_inputRecordBlock(s_Record.checksumTick, INPUT_BLOCK_CHECKSUM);
+	}
+	_inputRecordBlock(s_Record.tick, INPUT_BLOCK_END);
+
+	fclose(s_Record.file);
+	s_Record.file = NULL;
+}
+
+/// @brief Writes a block's header, and a checksum block's checksum. Blocks must be written in tick order.
+/// @param tick 
+/// @param tag 
+static void _inputRecordBlock(uint64_t tick, InputBlockTag tag)
+{
+	_writeVarint(s_Record.file, tick - s_Record.blockTick);
+	fputc((int)tag, s_Record.file);
+	if (tag == INPUT_BLOCK_CHECKSUM)
+	{
+		_writeU32(s_Record.file, s_Record.checksum);
+	}
+	s_Record.blockTick = tick;
+}
+
+/// @brief Closes the replay, and gives the keyboard back to live input
+static void _inputReplayStop()
+{
+	if (s_Replay.file == NULL)
+	{
+		return;
+	}
+
+	fclose(s_Replay.file);
+	s_Replay.file = NULL;
+	s_Replay.isFinished = true;
+	ZeroMemory(&s_Keyboard, sizeof(Keyboard));
+}
+
+/// @brief Compares the checksums of updates that have already run, and stops the replay once the recording ends
+static void _inputReplayCatchUp()
+{
+	while (s_Replay.file != NULL && s_Replay.blockTick < s_Replay.tick && s_Replay.blockTag == INPUT_BLOCK_CHECKSUM)
+	{
+		uint32_t expected = 0;
+		if (!_readU32(s_Replay.file, &expected))
+		{
+			printf("Replay: recording is truncated at tick %llu\n", (unsigned long long)s_Replay.blockTick);
+			_inputReplayStop();
+			return;
+		}
+
+		// Games that don't submit checksums can't be checked
+		if (s_Replay.checksumTick == s_Replay.blockTick && s_Replay.checksum != expected && !s_Replay.isDiverged)
+		{
+			printf("Replay: diverged from the recording at tick %llu\n", (unsigned long long)s_Replay.blockTick);
+			s_Replay.isDiverged = true;
+		}
+
+		if (!_inputReplayReadBlock())
+		{
+			printf("Replay: recording is truncated at tick %llu\n", (unsigned long long)s_Replay.tick);
+			_inputReplayStop();
+			return;
+		}
+	}
+
+	if (s_Replay.file != NULL && s_Replay.blockTag == INPUT_BLOCK_END && s_Replay.blockTick <= s_Replay.tick)
+	{
+		_inputReplayStop();
+	}
+}
+
+/// @brief Reads the next block's header
+/// @return false at the end of the file
+static bool _inputReplayReadBlock()
+{
+	uint64_t ticks = 0;
+	const int tag = _readVarint(s_Replay.file, &ticks) ? fgetc(s_Replay.file) : EOF;
+	if (tag == EOF || tag > INPUT_BLOCK_CHECKSUM)
+	{
+		return false;
+	}
+
+	s_Replay.blockTick += ticks;
+	s_Replay.blockTag = (uint8_t)tag;
+	return true;
+}
 
+/*
+ * Little-endian encoding helpers, so recordings are portable between machines
+ */
+static void _writeU32(FILE* file, uint32_t value)
+{
+	const uint8_t bytes[4] = { (uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24) };
+	fwrite(bytes, 1, sizeof(bytes), file);
+}
+
+static bool _readU32(FILE* file, uint32_t* value)
+{
+	uint8_t bytes[4];
+	if (fread(bytes, 1, sizeof(bytes), file) != sizeof(bytes))
+	{
+		return false;
+	}
+	*value = (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+	return true;
+}
+
+static void _writeVarint(FILE* file, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		fputc((int)(value & 0x7F) | 0x80, file);
+		value >>= 7;
+	}
+	fputc((int)value, file);
+}
+
+static bool _readVarint(FILE* file, uint64_t* value)
+{
+	*value = 0;
+	for (uint32_t shift = 0; shift < 64; shift += 7)
+	{
+		const int byte = fgetc(file);
+		if (byte == EOF)
+		{
+			return false;
+		}
+		*value |= (uint64_t)(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
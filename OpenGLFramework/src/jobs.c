@@ -0,0 +1,750 @@
+#include <stdlib.h>
+#include <assert.h>
+#ifdef FW_HEADLESS
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#include "platform.h"
+#include "jobs.h"
+
+#ifdef FW_HEADLESS
+typedef pthread_t			JobThread;
+typedef pthread_mutex_t		JobMutex;
+typedef pthread_cond_t		JobCondition;
+typedef volatile int64_t		JobAtomic;
+#define JOBS_THREAD_LOCAL						__thread
+#define _atomicIncrement(value)					__atomic_add_fetch((value), 1, __ATOMIC_SEQ_CST)
+#define _atomicDecrement(value)					__atomic_sub_fetch((value), 1, __ATOMIC_SEQ_CST)
+#define _atomicLoad(value)						__atomic_load_n((value), __ATOMIC_SEQ_CST)
+#define _atomicStore(value, new)				__atomic_store_n((value), (new), __ATOMIC_SEQ_CST)
+#define _atomicCompareExchange(value, old, new)	__atomic_compare_exchange_n((value), &(old), (new), false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
+#define _atomicLoadPointer(value)				__atomic_load_n((value), __ATOMIC_RELAXED)
+#define _atomicStorePointer(value, new)			__atomic_store_n((value), (new), __ATOMIC_RELAXED)
+#else
+typedef HANDLE				JobThread;
+typedef SRWLOCK				JobMutex;
+typedef CONDITION_VARIABLE	JobCondition;
+typedef volatile LONG64		JobAtomic;
+#define JOBS_THREAD_LOCAL						__declspec(thread)
+#define _atomicIncrement(value)					InterlockedIncrement64(value)
+#define _atomicDecrement(value)					InterlockedDecrement64(value)
+#define _atomicLoad(value)						InterlockedCompareExchange64((value), 0, 0)
+#define _atomicStore(value, new)				InterlockedExchange64((value), (new))
+#define _atomicCompareExchange(value, old, new)	(InterlockedCompareExchange64((value), (new), (old)) == (old))
+#define _atomicLoadPointer(value)				(*(value))
+#define _atomicStorePointer(value, new)			(*(value) = (new))
+#endif
+
+#define JOBS_NO_THREAD		0xFFFFFFFFu
+#define JOBS_TASK_MASK		(JOBS_MAX_TASKS - 1)
+#define JOBS_CACHE_LINE		64
+
+/// @brief Either a single task, or a range of a parallel-for, which is split in half for as long as it spans more than one batch
+typedef struct jobTask_t {
+	JobFunc				func;
+	JobRangeFunc		rangeFunc;
+	void*				data;
+	uint32_t			begin;
+	uint32_t			end;
+	uint32_t			batchSize;
+	void*				context;	// of the thread that started it
+	JobCounter*			counter;	// told once the task has run
+	struct jobTask_t*	next;		// in a counter's waiters, or the background queue
+	JobAtomic			isInUse;	// from being started until it has run, possibly on another thread
+} JobTask;
+
+/// @brief A thread's deque (Chase-Lev, fixed size) and the ring its tasks are allocated from. The owner pushes and pops at the
+/// bottom, other threads steal from the top. top and bottom sit on separate cache lines, as they are written by different threads.
+typedef struct {
+	JobAtomic			top;
+	char				padTop[JOBS_CACHE_LINE - sizeof(JobAtomic)];
+	JobAtomic			bottom;
+	char				padBottom[JOBS_CACHE_LINE - sizeof(JobAtomic)];
+	JobTask* volatile	deque[JOBS_MAX_TASKS];
+
+	JobTask				tasks[JOBS_MAX_TASKS];
+	uint32_t			nextTask;
+	uint32_t			randomState;	// picks which thread to steal from first
+	JobThread			thread;
+} JobWorker;
+
+/// @brief The pool. Worker 0 is the thread that initialized it, which has no thread of its own.
+static struct {
+	uint32_t		numThreads;		// deques, counting worker 0
+	uint32_t		numWorkers;		// worker threads that started, not counting worker 0
+	JobWorker*		workers;
+	JobMutex		mutex;			// guards the background queue, and sleeping
+	JobCondition	wake;			// signalled when a task is queued while workers sleep, or the pool shuts down
+	bool			isShuttingDown;
+	JobTask*		background;		// oldest first
+	JobTask*		backgroundTail;
+	JobAtomic		numQueued;		// tasks sitting in deques
+	JobAtomic		numSleeping;
+	JobAtomic		numOverflows;	// times a thread's task ring or deque was full
+} s_Jobs;
+
+static JOBS_THREAD_LOCAL uint32_t s_WorkerIndex = JOBS_NO_THREAD;
+static JOBS_THREAD_LOCAL void* s_Context = NULL;
+static JobContextFunc s_ContextFunc = NULL;
+
+static JobTask* _jobsNewTask(JobCounter* counter);
+static void _jobsPush(JobTask* task);
+static JobTask* _jobsPop(JobWorker* worker);
+static JobTask* _jobsSteal(JobWorker* victim);
+static JobTask* _jobsFindTask();
+static void _jobsHelp();
+static JobTask* _jobsTakeBackground();
+static void _jobsRunTask(JobTask* task);
+static void _jobsRunTaskInContext(JobTask* task);
+static void _jobsFinish(JobCounter* counter);
+static void _jobsLockCounter(JobCounter* counter);
+static void _jobsUnlockCounter(JobCounter* counter);
+static uint32_t _jobsGetHardwareThreads();
+static void _jobsYield();
+#ifdef FW_HEADLESS
+static void* _jobsWorkerMain(void* index);
+#else
+static DWORD WINAPI _jobsWorkerMain(LPVOID index);
+#endif
+
+/// @brief The number of worker threads, not counting the thread that initialized the pool
+/// @return
+uint32_t jobsGetNumWorkers()
+{
+	return s_Jobs.numWorkers;
+}
+
+/// @brief How many times a thread's task ring or deque has been full, so a task had to wait for a free one, or was run there and then.
+/// Work still gets done when this happens, but some of it less in parallel: JOBS_MAX_TASKS is too small for the load if this is often nonzero.
+/// @return
+uint64_t jobsGetNumOverflows()
+{
+	return (uint64_t)_atomicLoad(&s_Jobs.numOverflows);
+}
+
+/// @brief Queues a task on the calling thread's deque
+/// @param func
+/// @param data passed through to func
+/// @param counter told once the task has run, or NULL
+void jobsRun(JobFunc func, void* data, JobCounter* counter)
+{
+	JobTask* task = _jobsNewTask(counter);
+	task->func = func;
+	task->data = data;
+	_jobsPush(task);
+}
+
+/// @brief Queues a task once every task started against a counter has finished, straight away if none are left.
+/// The task counts against its own counter from now, so waiting on that covers the dependency too.
+/// @param dependency
+/// @param func
+/// @param data passed through to func
+/// @param counter told once the task has run, or NULL
+void jobsRunAfter(JobCounter* dependency, JobFunc func, void* data, JobCounter* counter)
+{
+	JobTask* task = _jobsNewTask(counter);
+	task->func = func;
+	task->data = data;
+
+	_jobsLockCounter(dependency);
+	const bool isDone = _atomicLoad(&dependency->pending) == 0;
+	if (!isDone)
+	{
+		task->next = dependency->waiters;
+		dependency->waiters = task;
+	}
+	_jobsUnlockCounter(dependency);
+
+	if (isDone)
+	{
+		_jobsPush(task);
+	}
+}
+
+/// @brief Queues a task on the background queue, for a worker thread to run once it has nothing else to. The task runs without
+/// a context. With no worker threads, runs it there and then, as nothing else ever would (and without switching the calling
+/// thread's context: a background task mustn't reach for it, and the caller may be partway through setting it up).
+/// @param func
+/// @param data passed through to func
+/// @param counter told once the task has run, or NULL
+void jobsRunBackground(JobFunc func, void* data, JobCounter* counter)
+{
+	JobTask* task = _jobsNewTask(counter);
+	task->func = func;
+	task->data = data;
+	task->context = NULL;
+	if (s_Jobs.numWorkers == 0)
+	{
+		_jobsRunTask(task);
+		return;
+	}
+
+#ifdef FW_HEADLESS
+	pthread_mutex_lock(&s_Jobs.mutex);
+#else
+	AcquireSRWLockExclusive(&s_Jobs.mutex);
+#endif
+	if (s_Jobs.backgroundTail != NULL)
+	{
+		s_Jobs.backgroundTail->next = task;
+	}
+	else
+	{
+		s_Jobs.background = task;
+	}
+	s_Jobs.backgroundTail = task;
+#ifdef FW_HEADLESS
+	pthread_cond_signal(&s_Jobs.wake);
+	pthread_mutex_unlock(&s_Jobs.mutex);
+#else
+	WakeConditionVariable(&s_Jobs.wake);
+	ReleaseSRWLockExclusive(&s_Jobs.mutex);
+#endif
+}
+
+/// @brief Queues func over [0, count) in batches of batchSize. Batches always start at a multiple of batchSize, whichever thread runs them.
+/// @param count
+/// @param batchSize
+/// @param func called with a [begin, end) range of at most batchSize
+/// @param data passed through to func
+/// @param counter told once every batch has run, or NULL
+void jobsRunParallelFor(uint32_t count, uint32_t batchSize, JobRangeFunc func, void* data, JobCounter* counter)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	JobTask* task = _jobsNewTask(counter);
+	task->rangeFunc = func;
+	task->data = data;
+	task->begin = 0;
+	task->end = count;
+	task->batchSize = batchSize > 0 ? batchSize : 1;
+	_jobsPush(task);
+}
+
+/// @brief Runs queued tasks until every task started against the counter has finished
+/// @param counter
+void jobsWait(JobCounter* counter)
+{
+	// The lock is the last thing the finishing thread touches, after which the counter may go out of scope
+	while (_atomicLoad(&counter->pending) > 0 || _atomicLoad(&counter->lock) != 0)
+	{
+		_jobsHelp();
+	}
+}
+
+/// @brief Whether every task started against the counter has finished, without waiting. Unlike the rest of the
+/// scheduler, this may be called from any thread, e.g. a render thread polling for work it depends on.
+/// @param counter
+/// @return true once the tasks' writes are visible to the calling thread
+bool jobsIsDone(JobCounter* counter)
+{
+	return _atomicLoad(&counter->pending) == 0 && _atomicLoad(&counter->lock) == 0;
+}
+
+/// @brief Runs func over [0, count) in batches of batchSize, and waits for it to finish
+/// @param count
+/// @param batchSize
+/// @param func called with a [begin, end) range of at most batchSize
+/// @param data passed through to func
+void jobsParallelFor(uint32_t count, uint32_t batchSize, JobRangeFunc func, void* data)
+{
+	// Not worth queueing
+	if (s_Jobs.numWorkers == 0 || count <= batchSize)
+	{
+		if (count > 0)
+		{
+			func(data, 0, count);
+		}
+		return;
+	}
+
+	JobCounter counter = JOB_COUNTER_INIT;
+	jobsRunParallelFor(count, batchSize, func, data, &counter);
+	jobsWait(&counter);
+}
+
+/// @brief Sets what switches a thread over to a task's context. Should be set before any task with a context is started.
+/// @param func called with the new context, on the thread switching to it, or NULL if nothing needs switching
+void jobsSetContextFunc(JobContextFunc func)
+{
+	s_ContextFunc = func;
+}
+
+/// @brief Sets the calling thread's context, which every task it starts from now on takes on.
+/// Only records it: the caller is expected to have switched over to it already.
+/// @param context
+void jobsSetContext(void* context)
+{
+	s_Context = context;
+}
+
+/// @brief The context of the calling thread, or of the task it is running
+/// @return
+void* jobsGetContext()
+{
+	return s_Context;
+}
+
+/// @brief Starts the worker threads, and makes the calling thread part of the pool
+/// @param numWorkers how many, or JOBS_WORKERS_AUTO for one per spare hardware thread
+void jobsInit(uint32_t numWorkers)
+{
+	ZeroMemory(&s_Jobs, sizeof(s_Jobs));
+
+	if (numWorkers == JOBS_WORKERS_AUTO)
+	{
+		const uint32_t hardwareThreads = _jobsGetHardwareThreads();
+		numWorkers = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+	}
+	if (numWorkers > JOBS_MAX_WORKERS)
+	{
+		numWorkers = JOBS_MAX_WORKERS;
+	}
+
+	s_Jobs.workers = (JobWorker*)calloc(numWorkers + 1, sizeof(JobWorker));
+	assert(s_Jobs.workers != NULL);
+	s_Jobs.numThreads = numWorkers + 1;
+	for (uint32_t i = 0; i <= numWorkers; ++i)
+	{
+		s_Jobs.workers[i].randomState = 0x9E3779B9u * (i + 1);
+	}
+	s_WorkerIndex = 0;
+
+#ifdef FW_HEADLESS
+	pthread_mutex_init(&s_Jobs.mutex, NULL);
+	pthread_cond_init(&s_Jobs.wake, NULL);
+#else
+	InitializeSRWLock(&s_Jobs.mutex);
+	InitializeConditionVariable(&s_Jobs.wake);
+#endif
+
+	// A worker that fails to start leaves its deque empty, which costs the thieves nothing
+	for (uint32_t i = 1; i <= numWorkers; ++i)
+	{
+		JobWorker* worker = &s_Jobs.workers[i];
+#ifdef FW_HEADLESS
+		if (pthread_create(&worker->thread, NULL, _jobsWorkerMain, (void*)(uintptr_t)i) != 0)
+		{
+			break;
+		}
+#else
+		worker->thread = CreateThread(NULL, 0, _jobsWorkerMain, (LPVOID)(uintptr_t)i, 0, NULL);
+		if (worker->thread == NULL)
+		{
+			break;
+		}
+#endif
+		++s_Jobs.numWorkers;
+	}
+}
+
+/// @brief Stops and joins the worker threads. Every task should have been waited on by now.
+void jobsShutdown()
+{
+#ifdef FW_HEADLESS
+	pthread_mutex_lock(&s_Jobs.mutex);
+	s_Jobs.isShuttingDown = true;
+	pthread_cond_broadcast(&s_Jobs.wake);
+	pthread_mutex_unlock(&s_Jobs.mutex);
+
+	for (uint32_t i = 1; i <= s_Jobs.numWorkers; ++i)
+	{
+		pthread_join(s_Jobs.workers[i].thread, NULL);
+	}
+
+	pthread_cond_destroy(&s_Jobs.wake);
+	pthread_mutex_destroy(&s_Jobs.mutex);
+#else
+	AcquireSRWLockExclusive(&s_Jobs.mutex);
+	s_Jobs.isShuttingDown = true;
+	WakeAllConditionVariable(&s_Jobs.wake);
+	ReleaseSRWLockExclusive(&s_Jobs.mutex);
+
+	for (uint32_t i = 1; i <= s_Jobs.numWorkers; ++i)
+	{
+		WaitForSingleObject(s_Jobs.workers[i].thread, INFINITE);
+		CloseHandle(s_Jobs.workers[i].thread);
+	}
+#endif
+
+	free(s_Jobs.workers);
+	s_Jobs.workers = NULL;
+	s_Jobs.numThreads = 0;
+	s_Jobs.numWorkers = 0;
+	s_WorkerIndex = JOBS_NO_THREAD;
+}
+
+/// @brief Takes the next free task from the calling thread's ring, and counts it against the counter.
+/// Tasks finish out of order (the first half of a parallel-for can sit queued while the rest is split up and run), so some may be skipped.
+/// If every task in the ring is still queued or waiting, runs queued tasks until one of them frees up.
+/// @param counter
+/// @return
+static JobTask* _jobsNewTask(JobCounter* counter)
+{
+	assert(s_WorkerIndex != JOBS_NO_THREAD);
+	JobWorker* worker = &s_Jobs.workers[s_WorkerIndex];
+
+	JobTask* task = NULL;
+	bool isOverflowing = false;
+	for (;;)
+	{
+		for (uint32_t tries = 0; tries < JOBS_MAX_TASKS && task == NULL; ++tries)
+		{
+			JobTask* candidate = &worker->tasks[worker->nextTask++ & JOBS_TASK_MASK];
+			if (_atomicLoad(&candidate->isInUse) == 0)
+			{
+				task = candidate;
+			}
+		}
+		if (task != NULL)
+		{
+			break;
+		}
+
+		if (!isOverflowing)
+		{
+			_atomicIncrement(&s_Jobs.numOverflows);
+			isOverflowing = true;
+		}
+		_jobsHelp();
+	}
+	ZeroMemory(task, sizeof(JobTask));
+	_atomicStore(&task->isInUse, 1);
+	task->context = s_Context;
+	task->counter = counter;
+	if (counter != NULL)
+	{
+		_atomicIncrement(&counter->pending);
+	}
+	return task;
+}
+
+/// @brief Pushes a task onto the bottom of the calling thread's deque, and wakes a worker if any are asleep.
+/// If the deque is full (a thread also queues the tasks that were waiting on counters it finished), runs the task there and then instead.
+/// @param task
+static void _jobsPush(JobTask* task)
+{
+	JobWorker* worker = &s_Jobs.workers[s_WorkerIndex];
+	const int64_t bottom = _atomicLoad(&worker->bottom);
+	if (bottom - _atomicLoad(&worker->top) >= JOBS_MAX_TASKS)
+	{
+		_atomicIncrement(&s_Jobs.numOverflows);
+		_jobsRunTaskInContext(task);
+		return;
+	}
+	_atomicStorePointer(&worker->deque[bottom & JOBS_TASK_MASK], task);
+	_atomicStore(&worker->bottom, bottom + 1);
+
+	// A worker going to sleep counts itself before checking numQueued, so one of the two always sees the other
+	_atomicIncrement(&s_Jobs.numQueued);
+	if (_atomicLoad(&s_Jobs.numSleeping) > 0)
+	{
+#ifdef FW_HEADLESS
+		pthread_mutex_lock(&s_Jobs.mutex);
+		pthread_cond_signal(&s_Jobs.wake);
+		pthread_mutex_unlock(&s_Jobs.mutex);
+#else
+		AcquireSRWLockExclusive(&s_Jobs.mutex);
+		WakeConditionVariable(&s_Jobs.wake);
+		ReleaseSRWLockExclusive(&s_Jobs.mutex);
+#endif
+	}
+}
+
+/// @brief Pops the most recently pushed task off the bottom of the thread's own deque
+/// @param worker the calling thread's
+/// @return NULL if it's empty, or a thief took the last task
+static JobTask* _jobsPop(JobWorker* worker)
+{
+	const int64_t bottom = _atomicLoad(&worker->bottom) - 1;
+	_atomicStore(&worker->bottom, bottom);
+	int64_t top = _atomicLoad(&worker->top);
+
+	JobTask* task = NULL;
+	if (top <= bottom)
+	{
+		task = _atomicLoadPointer(&worker->deque[bottom & JOBS_TASK_MASK]);
+		if (top == bottom)
+		{
+			// The last task, which a thief may be after as well
+			if (!_atomicCompareExchange(&worker->top, top, top + 1))
+			{
+				task = NULL;
+			}
+			_atomicStore(&worker->bottom, bottom + 1);
+		}
+	}
+	else
+	{
+		_atomicStore(&worker->bottom, bottom + 1);
+	}
+	return task;
+}
+
+/// @brief Steals the oldest task off the top of another thread's deque
+/// @param victim
+/// @return NULL if it's empty, or another thread got there first
+static JobTask* _jobsSteal(JobWorker* victim)
+{
+	int64_t top = _atomicLoad(&victim->top);
+	const int64_t bottom = _atomicLoad(&victim->bottom);
+	if (top >= bottom)
+	{
+		return NULL;
+	}
+
+	JobTask* task = _atomicLoadPointer(&victim->deque[top & JOBS_TASK_MASK]);
+	return _atomicCompareExchange(&victim->top, top, top + 1) ? task : NULL;
+}
+
+/// @brief The calling thread's own newest task, or else one stolen from the other threads, starting from a random one
+/// @return NULL if none was found
+static JobTask* _jobsFindTask()
+{
+	JobWorker* self = &s_Jobs.workers[s_WorkerIndex];
+	JobTask* task = _jobsPop(self);
+
+	const uint32_t numThreads = s_Jobs.numThreads;
+	if (task == NULL && numThreads > 1)
+	{
+		// xorshift32
+		self->randomState ^= self->randomState << 13;
+		self->randomState ^= self->randomState >> 17;
+		self->randomState ^= self->randomState << 5;
+
+		const uint32_t first = self->randomState % numThreads;
+		for (uint32_t i = 0; i < numThreads && task == NULL; ++i)
+		{
+			const uint32_t victim = (first + i) % numThreads;
+			if (victim != s_WorkerIndex)
+			{
+				task = _jobsSteal(&s_Jobs.workers[victim]);
+			}
+		}
+	}
+
+	if (task != NULL)
+	{
+		_atomicDecrement(&s_Jobs.numQueued);
+	}
+	return task;
+}
+
+/// @brief Runs one queued task, from anywhere in the pool, or gives up the thread's time slice if there are none
+static void _jobsHelp()
+{
+	JobTask* task = _jobsFindTask();
+	if (task != NULL)
+	{
+		_jobsRunTaskInContext(task);
+	}
+	else
+	{
+		_jobsYield();
+	}
+}
+
+/// @brief Takes the oldest task off the background queue. The pool's mutex must be held.
+/// @return NULL if it's empty
+static JobTask* _jobsTakeBackground()
+{
+	JobTask* task = s_Jobs.background;
+	if (task != NULL)
+	{
+		s_Jobs.background = task->next;
+		if (s_Jobs.background == NULL)
+		{
+			s_Jobs.backgroundTail = NULL;
+		}
+		task->next = NULL;
+	}
+	return task;
+}
+
+/// @brief Runs a task. A range is split in half, the upper half queued for someone else, until only one batch is left.
+/// @param task
+static void _jobsRunTask(JobTask* task)
+{
+	if (task->rangeFunc != NULL)
+	{
+		const uint32_t batchSize = task->batchSize;
+		uint32_t end = task->end;
+		uint32_t numBatches = (end - task->begin + batchSize - 1) / batchSize;
+		while (numBatches > 1)
+		{
+			const uint32_t middle = task->begin + (numBatches / 2) * batchSize;
+			JobTask* upper = _jobsNewTask(task->counter);
+			upper->rangeFunc = task->rangeFunc;
+			upper->data = task->data;
+			upper->begin = middle;
+			upper->end = end;
+			upper->batchSize = batchSize;
+			_jobsPush(upper);
+
+			end = middle;
+			numBatches = (end - task->begin + batchSize - 1) / batchSize;
+		}
+		task->rangeFunc(task->data, task->begin, end);
+	}
+	else
+	{
+		task->func(task->data);
+	}
+
+	// Done with the task itself, its owner may hand it out again
+	JobCounter* counter = task->counter;
+	_atomicStore(&task->isInUse, 0);
+	if (counter != NULL)
+	{
+		_jobsFinish(counter);
+	}
+}
+
+/// @brief Runs a task in the context of the thread that started it, switching the calling thread over to it and back if it differs
+/// @param task
+static void _jobsRunTaskInContext(JobTask* task)
+{
+	void* context = s_Context;
+	if (task->context == context)
+	{
+		_jobsRunTask(task);
+		return;
+	}
+
+	s_Context = task->context;
+	if (s_ContextFunc != NULL) { s_ContextFunc(s_Context); }
+	_jobsRunTask(task);
+	s_Context = context;
+	if (s_ContextFunc != NULL) { s_ContextFunc(context); }
+}
+
+/// @brief Counts a task as finished, and queues the tasks waiting on the counter if it was the last
+/// @param counter
+static void _jobsFinish(JobCounter* counter)
+{
+	_jobsLockCounter(counter);
+	JobTask* waiters = NULL;
+	if (_atomicDecrement(&counter->pending) == 0)
+	{
+		waiters = counter->waiters;
+		counter->waiters = NULL;
+	}
+	_jobsUnlockCounter(counter);
+
+	while (waiters != NULL)
+	{
+		JobTask* next = waiters->next;
+		_jobsPush(waiters);
+		waiters = next;
+	}
+}
+
+/// @brief Spins until the counter's lock is taken. It's only ever held for a few instructions.
+/// @param counter
+static void _jobsLockCounter(JobCounter* counter)
+{
+	for (;;)
+	{
+		int64_t unlocked = 0;
+		if (_atomicCompareExchange(&counter->lock, unlocked, 1))
+		{
+			return;
+		}
+	}
+}
+
+/// @brief
+/// @param counter
+static void _jobsUnlockCounter(JobCounter* counter)
+{
+	_atomicStore(&counter->lock, 0);
+}
+
+/// @brief Worker loop: run tasks while there are any, then background tasks, otherwise sleep until either is queued
+#ifdef FW_HEADLESS
+static void* _jobsWorkerMain(void* index)
+#else
+static DWORD WINAPI _jobsWorkerMain(LPVOID index)
+#endif
+{
+	s_WorkerIndex = (uint32_t)(uintptr_t)index;
+
+	for (;;)
+	{
+		JobTask* task = _jobsFindTask();
+		if (task != NULL)
+		{
+			_jobsRunTaskInContext(task);
+			continue;
+		}
+
+		// Queued tasks may just not be stealable yet, so only sleep once there are none at all
+		if (_atomicLoad(&s_Jobs.numQueued) > 0)
+		{
+			_jobsYield();
+			continue;
+		}
+
+#ifdef FW_HEADLESS
+		pthread_mutex_lock(&s_Jobs.mutex);
+		_atomicIncrement(&s_Jobs.numSleeping);
+		while (_atomicLoad(&s_Jobs.numQueued) == 0 && s_Jobs.background == NULL && !s_Jobs.isShuttingDown)
+		{
+			pthread_cond_wait(&s_Jobs.wake, &s_Jobs.mutex);
+		}
+		_atomicDecrement(&s_Jobs.numSleeping);
+		const bool isShuttingDown = s_Jobs.isShuttingDown;
+		JobTask* background = _atomicLoad(&s_Jobs.numQueued) == 0 ? _jobsTakeBackground() : NULL;
+		pthread_mutex_unlock(&s_Jobs.mutex);
+#else
+		AcquireSRWLockExclusive(&s_Jobs.mutex);
+		_atomicIncrement(&s_Jobs.numSleeping);
+		while (_atomicLoad(&s_Jobs.numQueued) == 0 && s_Jobs.background == NULL && !s_Jobs.isShuttingDown)
+		{
+			SleepConditionVariableSRW(&s_Jobs.wake, &s_Jobs.mutex, INFINITE, 0);
+		}
+		_atomicDecrement(&s_Jobs.numSleeping);
+		const bool isShuttingDown = s_Jobs.isShuttingDown;
+		JobTask* background = _atomicLoad(&s_Jobs.numQueued) == 0 ? _jobsTakeBackground() : NULL;
+		ReleaseSRWLockExclusive(&s_Jobs.mutex);
+#endif
+
+		if (background != NULL)
+		{
+			_jobsRunTaskInContext(background);
+		}
+		else if (isShuttingDown)
+		{
+			return 0;
+		}
+	}
+}
+
+/// @brief The number of threads the hardware can run at once
+/// @return
+static uint32_t _jobsGetHardwareThreads()
+{
+#ifdef FW_HEADLESS
+	const long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (uint32_t)count : 1;
+#else
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (uint32_t)info.dwNumberOfProcessors;
+#endif
+}
+
+/// @brief Gives up the rest of the thread's time slice
+static void _jobsYield()
+{
+#ifdef FW_HEADLESS
+	sched_yield();
+#else
+	SwitchToThread();
+#endif
+}
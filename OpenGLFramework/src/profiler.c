@@ -0,0 +1,383 @@
+#include <stdlib.h>
+#include <string.h>
+#ifdef FW_HEADLESS
+#include <time.h>
+#endif
+
+#include "platform.h"
+#include "profiler.h"
+
+#define PROFILER_MAX_THREADS	32
+#define PROFILER_MAX_DEPTH		32
+#define PROFILER_MAX_ZONES		64
+
+#ifdef _MSC_VER
+#define THREAD_LOCAL	__declspec(thread)
+#else
+#define THREAD_LOCAL	_Thread_local
+#endif
+
+/// @brief A closed zone
+typedef struct {
+	const char*	name;
+	uint64_t	start;			// nanoseconds since the profiler started
+	uint64_t	duration;		// nanoseconds
+} ProfileEvent;
+
+/// @brief One thread's ring of closed zones, and the stack of zones it still has open
+typedef struct {
+	ProfileEvent*	events;
+	uint64_t		written;	// total ever written, the ring holds the last eventsPerThread of them
+	const char*		openNames[PROFILER_MAX_DEPTH];
+	uint64_t		openStarts[PROFILER_MAX_DEPTH];
+	uint32_t		depth;
+	uint32_t		id;
+} ProfileThread;
+
+static struct {
+	ProfileThread	threads[PROFILER_MAX_THREADS];
+	volatile long	numThreads;
+	uint32_t		eventsPerThread;
+	uint64_t		startNanoseconds;
+	uint32_t		session;		// bumped on init, so threads registered with an earlier session register again
+	bool			enabled;
+} s_Profiler;
+
+static THREAD_LOCAL ProfileThread* s_Thread = NULL;
+static THREAD_LOCAL uint32_t s_ThreadSession = 0;
+
+static ProfileThread* _getThread();
+static uint32_t _getNumThreads();
+static uint32_t _gatherDurations(const char* name, uint64_t* durations);
+static int _compareDurations(const void* a, const void* b);
+
+/// @brief Profiler initialization
+/// @param eventsPerThread size of each thread's ring, the oldest events are overwritten once it is full
+void profilerInit(uint32_t eventsPerThread)
+{
+	profilerShutdown();
+
+	s_Profiler.eventsPerThread = eventsPerThread;
+	s_Profiler.startNanoseconds = profilerGetNanoseconds();
+	++s_Profiler.session;
+}
+
+/// @brief Profiler shutdown, frees every thread's ring
+void profilerShutdown()
+{
+	for (uint32_t i = 0; i < PROFILER_MAX_THREADS; ++i)
+	{
+		free(s_Profiler.threads[i].events);
+		s_Profiler.threads[i].events = NULL;
+	}
+	s_Profiler.numThreads = 0;
+	s_Profiler.eventsPerThread = 0;
+	s_Profiler.enabled = false;
+}
+
+/// @brief Starts or stops recording zones
+/// @param enabled 
+void profilerSetEnabled(bool enabled)
+{
+	s_Profiler.enabled = enabled;
+}
+
+/// @brief Whether zones are being recorded
+/// @return 
+bool profilerIsEnabled()
+{
+	return s_Profiler.enabled;
+}
+
+/// @brief High resolution monotonic clock
+/// @return nanoseconds since an arbitrary fixed point
+uint64_t profilerGetNanoseconds()
+{
+#ifdef FW_HEADLESS
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+#else
+	static LARGE_INTEGER frequency = { 0 };
+	if (frequency.QuadPart == 0)
+	{
+		QueryPerformanceFrequency(&frequency);
+	}
+
+	// Split the conversion so the multiply can't overflow
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	const uint64_t ticks = (uint64_t)counter.QuadPart;
+	const uint64_t ticksPerSecond = (uint64_t)frequency.QuadPart;
+	return ticks / ticksPerSecond * 1000000000ull + ticks % ticksPerSecond * 1000000000ull / ticksPerSecond;
+#endif
+}
+
+/// @brief Opens a zone on the calling thread
+/// @param name 
+void profilerBeginZone(const char* name)
+{
+	if (!s_Profiler.enabled)
+	{
+		return;
+	}
+
+	ProfileThread* thread = _getThread();
+	if (thread == NULL)
+	{
+		return;
+	}
+
+	// Zones nested too deep are dropped, but still counted so their ends match up
+	if (thread->depth < PROFILER_MAX_DEPTH)
+	{
+		thread->openNames[thread->depth] = name;
+		thread->openStarts[thread->depth] = profilerGetNanoseconds();
+	}
+	++thread->depth;
+}
+
+/// @brief Closes the calling thread's innermost open zone, recording it
+void profilerEndZone()
+{
+	if (!s_Profiler.enabled)
+	{
+		return;
+	}
+
+	ProfileThread* thread = _getThread();
+	if (thread == NULL || thread->depth == 0)
+	{
+		return;
+	}
+
+	--thread->depth;
+	if (thread->depth < PROFILER_MAX_DEPTH)
+	{
+		const uint64_t end = profilerGetNanoseconds();
+		ProfileEvent* event = &thread->events[thread->written % s_Profiler.eventsPerThread];
+		event->name = thread->openNames[thread->depth];
+		event->start = thread->openStarts[thread->depth] - s_Profiler.startNanoseconds;
+		event->duration = end - thread->openStarts[thread->depth];
+		++thread->written;
+	}
+}
+
+/// @brief The calling thread's innermost open zone. Never allocates, so it is safe to call from an allocation hook.
+/// @return NULL if the thread has no zone open
+const char* profilerGetCurrentZone()
+{
+	ProfileThread* thread = s_ThreadSession == s_Profiler.session ? s_Thread : NULL;
+	if (!s_Profiler.enabled || thread == NULL || thread->depth == 0 || thread->depth > PROFILER_MAX_DEPTH)
+	{
+		return NULL;
+	}
+	return thread->openNames[thread->depth - 1];
+}
+
+/// @brief Drops every recorded event, keeping the rings. Should not be called while any zone is open.
+void profilerReset()
+{
+	for (uint32_t t = 0; t < _getNumThreads(); ++t)
+	{
+		s_Profiler.threads[t].written = 0;
+		s_Profiler.threads[t].depth = 0;
+	}
+}
+
+/// @brief Summarizes every recorded instance of a zone still in the rings. Should not be called while other threads are recording.
+/// @param name 
+/// @param stats 
+/// @return false if no instance of the zone was found
+bool profilerGetZoneStats(const char* name, ProfileZoneStats* stats)
+{
+	ZeroMemory(stats, sizeof(ProfileZoneStats));
+
+	uint64_t* durations = malloc((size_t)_getNumThreads() * s_Profiler.eventsPerThread * sizeof(uint64_t) + 1);
+	if (durations == NULL)
+	{
+		return false;
+	}
+
+	const uint32_t count = _gatherDurations(name, durations);
+	if (count > 0)
+	{
+		qsort(durations, count, sizeof(uint64_t), _compareDurations);
+
+		uint64_t total = 0;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			total += durations[i];
+		}
+
+		// Nearest rank percentiles
+		stats->count = count;
+		stats->meanMicroseconds = (double)total / count / 1e3;
+		stats->p50Microseconds = (double)durations[(count - 1) * 50 / 100] / 1e3;
+		stats->p90Microseconds = (double)durations[(count - 1) * 90 / 100] / 1e3;
+		stats->p99Microseconds = (double)durations[(count - 1) * 99 / 100] / 1e3;
+		stats->maxMicroseconds = (double)durations[count - 1] / 1e3;
+	}
+
+	free(durations);
+	return count > 0;
+}
+
+/// @brief Prints a table of every zone's stats. Should not be called while other threads are recording.
+/// @param file 
+void profilerPrintStats(FILE* file)
+{
+	// Collect the distinct zone names, in the order they first appear
+	const char* names[PROFILER_MAX_ZONES];
+	uint32_t numNames = 0;
+	for (uint32_t t = 0; t < _getNumThreads(); ++t)
+	{
+		const ProfileThread* thread = &s_Profiler.threads[t];
+		if (thread->events == NULL)
+		{
+			continue;
+		}
+
+		const uint64_t available = thread->written < s_Profiler.eventsPerThread ? thread->written : s_Profiler.eventsPerThread;
+		for (uint64_t i = 0; i < available; ++i)
+		{
+			const char* name = thread->events[i].name;
+			uint32_t n = 0;
+			while (n < numNames && strcmp(names[n], name) != 0) { ++n; }
+			if (n == numNames && numNames < PROFILER_MAX_ZONES)
+			{
+				names[numNames++] = name;
+			}
+		}
+	}
+
+	fprintf(file, "%-24s %8s %10s %10s %10s %10s %10s\n", "zone (us)", "count", "mean", "p50", "p90", "p99", "max");
+	for (uint32_t n = 0; n < numNames; ++n)
+	{
+		ProfileZoneStats stats;
+		if (profilerGetZoneStats(names[n], &stats))
+		{
+			fprintf(file, "%-24s %8u %10.2f %10.2f %10.2f %10.2f %10.2f\n",
+				names[n], stats.count, stats.meanMicroseconds, stats.p50Microseconds, stats.p90Microseconds, stats.p99Microseconds, stats.maxMicroseconds);
+		}
+	}
+}
+
+/// @brief Writes every event still in the rings as Chrome trace_event JSON. Should not be called while other threads are recording.
+/// @param path 
+/// @return false if the file couldn't be written
+bool profilerWriteTrace(const char* path)
+{
+	FILE* file = fopen(path, "w");
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	bool first = true;
+	for (uint32_t t = 0; t < _getNumThreads(); ++t)
+	{
+		const ProfileThread* thread = &s_Profiler.threads[t];
+		if (thread->events == NULL)
+		{
+			continue;
+		}
+
+		// Oldest first, which is wherever the next write would go once the ring has wrapped
+		const uint64_t available = thread->written < s_Profiler.eventsPerThread ? thread->written : s_Profiler.eventsPerThread;
+		for (uint64_t i = thread->written - available; i < thread->written; ++i)
+		{
+			const ProfileEvent* event = &thread->events[i % s_Profiler.eventsPerThread];
+			fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+				first ? "" : ",", event->name, thread->id, (double)event->start / 1e3, (double)event->duration / 1e3);
+			first = false;
+		}
+	}
+	fprintf(file, "\n]}\n");
+
+	const bool succeeded = ferror(file) == 0;
+	fclose(file);
+	return succeeded;
+}
+
+/// @brief The calling thread's ring, registering the thread on its first zone
+/// @return NULL if the profiler isn't running, or every thread slot is taken
+static ProfileThread* _getThread()
+{
+	if (s_Thread != NULL && s_ThreadSession == s_Profiler.session)
+	{
+		return s_Thread;
+	}
+	if (s_Profiler.eventsPerThread == 0)
+	{
+		return NULL;
+	}
+
+#ifdef FW_HEADLESS
+	const uint32_t id = (uint32_t)__atomic_fetch_add(&s_Profiler.numThreads, 1, __ATOMIC_RELAXED);
+#else
+	const uint32_t id = (uint32_t)InterlockedIncrement(&s_Profiler.numThreads) - 1;
+#endif
+	if (id >= PROFILER_MAX_THREADS)
+	{
+		return NULL;
+	}
+
+	ProfileThread* thread = &s_Profiler.threads[id];
+	thread->events = malloc((size_t)s_Profiler.eventsPerThread * sizeof(ProfileEvent));
+	if (thread->events == NULL)
+	{
+		return NULL;
+	}
+	thread->written = 0;
+	thread->depth = 0;
+	thread->id = id;
+
+	s_Thread = thread;
+	s_ThreadSession = s_Profiler.session;
+	return thread;
+}
+
+/// @brief How many thread slots are in use
+/// @return 
+static uint32_t _getNumThreads()
+{
+	const uint32_t numThreads = (uint32_t)s_Profiler.numThreads;
+	return numThreads < PROFILER_MAX_THREADS ? numThreads : PROFILER_MAX_THREADS;
+}
+
+/// @brief Copies the duration of every instance of a zone still in the rings
+/// @param name 
+/// @param durations room for every event of every thread
+/// @return the number of durations copied
+static uint32_t _gatherDurations(const char* name, uint64_t* durations)
+{
+	uint32_t count = 0;
+	for (uint32_t t = 0; t < _getNumThreads(); ++t)
+	{
+		const ProfileThread* thread = &s_Profiler.threads[t];
+		if (thread->events == NULL)
+		{
+			continue;
+		}
+
+		const uint64_t available = thread->written < s_Profiler.eventsPerThread ? thread->written : s_Profiler.eventsPerThread;
+		for (uint64_t i = 0; i < available; ++i)
+		{
+			if (thread->events[i].name == name || strcmp(thread->events[i].name, name) == 0)
+			{
+				durations[count++] = thread->events[i].duration;
+			}
+		}
+	}
+	return count;
+}
+
+/// @brief qsort comparison for ascending durations
+static int _compareDurations(const void* a, const void* b)
+{
+	const uint64_t durationA = *(const uint64_t*)a;
+	const uint64_t durationB = *(const uint64_t*)b;
+	return durationA < durationB ? -1 : (durationA > durationB ? 1 : 0);
+}
@@ -1,331 +1,1129 @@
-#include <Windows.h>
-#include <xaudio2.h>
+// Software mixer: clips play on a fixed set of channels, which are mixed in process into one stream for a sink.
+// The game thread and the mixer only talk through a ring of commands, which the game thread fills and the mixer empties,
+// without either ever waiting on the other. The mixer runs on whichever thread the sink pulls from, or on the game thread,
+// in soundUpdate, for a sink that's written to; then the mix only depends on the application's clock.
+//
+// Streams are clips too long to keep in memory: only a small ring of chunks of one is resident, which the streamer
+// thread keeps topped up, from a file or from memory (e.g. a mapped pack), ahead of the mixer.
+#ifdef FW_HEADLESS
+#include <pthread.h>
+#include <sched.h>
+#endif
+#include <math.h>
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "platform.h"
 #include "sound.h"
+#include "soundSink.h"
+#include "profiler.h"
+#include "wav.h"
 
-// MS chunk types
-#define fourccRIFF 'FFIR'
-#define fourccDATA 'atad'
-#define fourccFMT ' tmf'
-#define fourccWAVE 'EVAW'
-#define fourccXWMA 'AMWX'
-#define fourccDPDS 'sdpd'
-
-// MS XAudio2 RIFF-parsing code
-static HRESULT FindChunk(HANDLE hFile, DWORD fourcc, DWORD* dwChunkSize, DWORD* dwChunkDataPosition);
-static HRESULT ReadChunkData(HANDLE hFile, void* buffer, DWORD buffersize, DWORD bufferoffset);
-static HRESULT LoadChunkFile(const char* filename, WAVEFORMATEXTENSIBLE* wfx, XAUDIO2_BUFFER* buffer);
-static HRESULT PlayAudio(IXAudio2* pXAudio2, WAVEFORMATEX* wfx, XAUDIO2_BUFFER* buffer, int soundId);
-static HRESULT StopAudio(IXAudio2* pXAudio2, int soundId);
+#ifdef FW_HEADLESS
+typedef volatile uint32_t SoundAtomic;
+typedef pthread_t SoundThread;
+typedef pthread_mutex_t SoundMutex;
+typedef pthread_cond_t SoundCondition;
+#define AtomicLoad(value)           __atomic_load_n((value), __ATOMIC_ACQUIRE)
+#define AtomicStore(value, new)     __atomic_store_n((value), (new), __ATOMIC_RELEASE)
+#define YieldThread()               sched_yield()
+#define MutexLock(mutex)            pthread_mutex_lock(mutex)
+#define MutexUnlock(mutex)          pthread_mutex_unlock(mutex)
+#define ConditionWait(cond, mutex)  pthread_cond_wait((cond), (mutex))
+#define ConditionWake(cond)         pthread_cond_signal(cond)
+#else
+typedef volatile LONG SoundAtomic;
+typedef HANDLE SoundThread;
+typedef SRWLOCK SoundMutex;
+typedef CONDITION_VARIABLE SoundCondition;
+#define AtomicLoad(value)           ((uint32_t)InterlockedCompareExchange((value), 0, 0))
+#define AtomicStore(value, new)     InterlockedExchange((value), (LONG)(new))
+#define YieldThread()               SwitchToThread()
+#define MutexLock(mutex)            AcquireSRWLockExclusive(mutex)
+#define MutexUnlock(mutex)          ReleaseSRWLockExclusive(mutex)
+#define ConditionWait(cond, mutex)  SleepConditionVariableSRW((cond), (mutex), INFINITE, 0)
+#define ConditionWake(cond)         WakeConditionVariable(cond)
+#endif
+
+#define SOUND_COMMANDS              256             // queued for the mixer at once, a power of two
+#define SOUND_MIX_FRAMES            256             // mixed at a time
+#define SOUND_FRACTION_BITS         16              // of a channel's position in its clip, which steps through it at the clip's own rate
+#define SOUND_STREAM_CHUNKS         4               // resident per stream, a power of two
+#define SOUND_STREAM_CHUNK_BYTES    (32 * 1024)     // ~0.19s of 16 bit stereo at 44.1kHz
+#define SOUND_SILENCE               (1.0f / 1024)   // of full scale (~-60dB), the loudest a clip's trailing padding can be
+
+typedef enum sound_command_type_e {
+    SOUND_COMMAND_PLAY,
+    SOUND_COMMAND_STOP_CHANNEL,
+    SOUND_COMMAND_STOP_SOUND,
+    SOUND_COMMAND_SET_GAIN
+} SoundCommandType;
+
+typedef struct sound_command_t {
+    SoundCommandType type;
+    int32_t channel;
+    int32_t soundId;
+    float gain;
+    uint32_t seek;                  // for a stream, which of its plays this is
+} SoundCommand;
+
+typedef struct sound_stream_chunk_t {
+    uint8_t* samples;
+    uint32_t bytes;                 // read into it, a whole number of frames
+    uint32_t seek;                  // the play it was read for
+    bool isLast;                    // holds the end of the samples
+} SoundStreamChunk;
+
+typedef struct sound_stream_t {
+    struct sound_stream_t* next;    // in the streamer's list
+    FILE* file;                     // read from, or NULL to copy from memory
+    const uint8_t* memory;
+    uint32_t dataOffset;            // of the samples, in the file
+    uint32_t sampleBytes;
+    uint32_t frameBytes;
+    uint32_t chunkBytes;            // a whole number of frames
+    uint8_t* buffer;                // every chunk's samples
+    SoundStreamChunk chunks[SOUND_STREAM_CHUNKS];
+
+    SoundAtomic seekRequest;        // written by the game thread, to start again from the top
+    SoundAtomic numFilled;          // written by the streamer
+    SoundAtomic numConsumed;        // written by the mixer
+
+    // streamer
+    uint32_t seek;
+    uint32_t cursor;                // bytes of samples read for this play
+    bool isFinished;
+
+    // game thread
+    uint32_t numPlays;
+} SoundStream;
 
 typedef struct sound_source_t {
-    const char* filename;
-    WAVEFORMATEXTENSIBLE wfx;
-    XAUDIO2_BUFFER buffer;
+    bool isLoaded;
+    void* fileData;                 // owned, if the samples point into a file read by soundLoad, or it's a stream's fmt chunk
+    const uint8_t* samples;
+    SoundStream* stream;            // or NULL, if the samples are all in memory
+    WavFormat format;
+    uint32_t step;                  // clip frames per output frame, in fixed point
+    uint32_t audibleFrames;         // up to the last frame above SOUND_SILENCE, as clips are often padded w/ silence
+    uint64_t outputFrames;          // how long it's heard for
+    uint32_t durationMS;            // the same, rounded up
 } SoundSource;
 
+// A channel as the mixer sees it
+typedef struct sound_channel_t {
+    int32_t soundId;                // SOUND_NOSOUND while silent
+    uint64_t position;              // in clip frames, in fixed point
+    float gain;
+    uint32_t seek;                  // for a stream, which play to take chunks from
+    uint64_t chunkStart;            // for a stream, the clip frame its current chunk starts at
+} SoundChannel;
+
+// A channel as the game thread sees it, to pick which to play on: what it last started there, and when that ends by the
+// game thread's clock. For a sink that pulls, that's an estimate, as the device keeps its own time.
+typedef struct sound_channel_use_t {
+    int32_t soundId;
+    int32_t priority;
+    uint32_t startedAt;             // in plays since init, to take over the oldest channel of a priority
+    uint64_t startsAt;              // in output frames since init
+    uint64_t endsAt;
+    bool isPlaying;                 // until it ends, or is stopped or cut off
+} SoundChannelUse;
+
+static void PushCommand(SoundCommandType type, int32_t channel, int32_t soundId, float gain, uint32_t seek);
+static void ProcessCommands();
+static void WaitForMixer();
+static bool IsMixedOnGameThread();
+static int32_t AddSound(const WavInfo* info, void* fileData, bool isStream);
+static int32_t AddStream(const WavInfo* info, void* fileData, FILE* file, uint32_t dataOffset);
+static uint32_t FindAudibleFrames(const uint8_t* samples, const WavFormat* format);
+static void RemoveStream(SoundStream* stream);
+static void StopUses(int32_t soundId);
+static int32_t FindChannel(int32_t priority);
+static void StartChannel(int32_t channel, int32_t soundId, int32_t priority);
+static void PullMix(int16_t* frames, uint32_t numFrames);
+static void Mix(int16_t* frames, uint32_t numFrames);
+static void MixChannel(SoundChannel* channel, float* mix, uint32_t numFrames);
+static void MixStream(SoundChannel* channel, float* mix, uint32_t numFrames);
+static uint32_t MixSamples(const SoundSource* sound, const uint8_t* samples, uint64_t first, uint64_t end, SoundChannel* channel, float* mix, uint32_t numFrames);
+static void FillStream(SoundStream* stream);
+static void StartStreamer();
+static void StopStreamer();
+static void WakeStreamer();
+#ifdef FW_HEADLESS
+static void* StreamerMain(void* param);
+#else
+static DWORD WINAPI StreamerMain(LPVOID param);
+#endif
+
 static struct sound_manager_t {
     SoundSource*    sounds;
     int32_t         maxSounds;
+    SoundSink*      sink;
+
+    // game thread
+    SoundChannelUse uses[SOUND_MIXER_CHANNELS];
+    uint64_t        clock;                  // output frames the application has been updated by
+    uint32_t        clockRemainder;         // the fraction of a frame left over, in 1000ths
+    uint32_t        numPlays;
+    SoundEndFunc    onEnd;
+
+    // from the game thread to the mixer
+    SoundCommand    commands[SOUND_COMMANDS];
+    SoundAtomic     numPushed;              // written by the game thread
+    SoundAtomic     numProcessed;           // written by the mixer
 
-    // dx audio system
-    IXAudio2SourceVoice** audios;
-    IXAudio2* pXAudio2;
-    IXAudio2MasteringVoice* pMasterVoice;
-} _soundMgr = { NULL, 0, NULL, NULL, NULL };
+    // mixer
+    SoundChannel    channels[SOUND_MIXER_CHANNELS];
+    float           mix[SOUND_MIX_FRAMES * 2];
+
+    // streamer, started when the first stream is loaded
+    SoundStream*    streams;                // added and removed by the game thread, under streamsMutex
+    SoundMutex      streamsMutex;
+    SoundThread     streamer;
+    SoundMutex      streamerMutex;          // guards being woken or stopped
+    SoundCondition  streamerWake;
+    bool            isStreamerRunning;
+    bool            isStreamerWoken;
+    bool            isStreamerStopping;
+} _soundMgr;
 
 /**
- * @brief allocate sound system resources
- * @return 
+ * @brief allocate sound system resources, and start the sink
+ * @param maxSounds
+ * @param sink which the sound system takes over, or NULL for the platform's audio device. If it won't start, the mix
+ * goes nowhere, but is still made.
+ * @return false if the sink couldn't be started
 */
-bool soundInit(int32_t maxSounds) {
-    HRESULT hr = CoInitializeEx(NULL, COINIT_MULTITHREADED);
-    if (FAILED(hr)) {
+bool soundInit(int32_t maxSounds, SoundSink* sink) {
+    _soundMgr.sounds = malloc(maxSounds * sizeof(SoundSource));
+    if (_soundMgr.sounds == NULL) {
+        soundSinkDelete(sink);
         return false;
     }
+    ZeroMemory(_soundMgr.sounds, maxSounds * sizeof(SoundSource));
+    _soundMgr.maxSounds = maxSounds;
 
-    hr = XAudio2Create(&_soundMgr.pXAudio2, 0, XAUDIO2_DEFAULT_PROCESSOR);
-    if (FAILED(hr)) {
-        return false;
-    }
+    for (int32_t c = 0; c < SOUND_MIXER_CHANNELS; ++c)
+    {
+        _soundMgr.uses[c].soundId = SOUND_NOSOUND;
+        _soundMgr.uses[c].priority = SOUND_PRIORITY_LOW;
+        _soundMgr.uses[c].startedAt = 0;
+        _soundMgr.uses[c].startsAt = 0;
+        _soundMgr.uses[c].endsAt = 0;
+        _soundMgr.uses[c].isPlaying = false;
 
-    hr = IXAudio2_CreateMasteringVoice(_soundMgr.pXAudio2, &_soundMgr.pMasterVoice,
-        XAUDIO2_DEFAULT_CHANNELS,
-        XAUDIO2_DEFAULT_SAMPLERATE,
-        0,
-        NULL,
-        NULL,
-        AudioCategory_GameEffects
-    );
-    if (FAILED(hr)) {
-        IXAudio2_Release(_soundMgr.pXAudio2);
-        _soundMgr.pXAudio2 = NULL;
-        return false;
+        _soundMgr.channels[c].soundId = SOUND_NOSOUND;
+        _soundMgr.channels[c].position = 0;
+        _soundMgr.channels[c].gain = 1.0f;
     }
+    _soundMgr.clock = 0;
+    _soundMgr.clockRemainder = 0;
+    _soundMgr.numPlays = 0;
+    _soundMgr.onEnd = NULL;
+    _soundMgr.numPushed = 0;
+    _soundMgr.numProcessed = 0;
 
-    _soundMgr.sounds = malloc(maxSounds * sizeof(SoundSource));
-    if(_soundMgr.sounds != NULL)
-        ZeroMemory(_soundMgr.sounds, maxSounds * sizeof(SoundSource));
-    _soundMgr.audios = malloc(maxSounds * sizeof(IXAudio2SourceVoice*));
-    if(_soundMgr.audios != NULL)
-        ZeroMemory(_soundMgr.audios, maxSounds * sizeof(IXAudio2SourceVoice*));
-    _soundMgr.maxSounds = maxSounds;
+    _soundMgr.streams = NULL;
+    _soundMgr.isStreamerRunning = false;
+#ifdef FW_HEADLESS
+    pthread_mutex_init(&_soundMgr.streamsMutex, NULL);
+    pthread_mutex_init(&_soundMgr.streamerMutex, NULL);
+    pthread_cond_init(&_soundMgr.streamerWake, NULL);
+#else
+    InitializeSRWLock(&_soundMgr.streamsMutex);
+    InitializeSRWLock(&_soundMgr.streamerMutex);
+    InitializeConditionVariable(&_soundMgr.streamerWake);
+#endif
 
-    return true;
+#ifndef FW_HEADLESS
+    if (sink == NULL) {
+        sink = soundSinkNewXAudio2();
+    }
+#endif
+    bool isStarted = sink != NULL && sink->start(sink, SOUND_SAMPLE_RATE, PullMix);
+    if (!isStarted) {
+        soundSinkDelete(sink);
+        sink = soundSinkNewNull();
+        if (sink != NULL) {
+            sink->start(sink, SOUND_SAMPLE_RATE, PullMix);
+        }
+    }
+    _soundMgr.sink = sink;
+
+    return isStarted;
 }
 
 /**
  * @brief release sound system resources
- * @return 
+ * @return
 */
 bool soundShutdown() {
+    // Once stopped, a sink that pulls doesn't mix any more, so the mixer is the game thread's alone from here
+    if (_soundMgr.sink != NULL) {
+        _soundMgr.sink->stop(_soundMgr.sink);
+        soundSinkDelete(_soundMgr.sink);
+        _soundMgr.sink = NULL;
+    }
+    StopStreamer();
 
     for (int32_t i = 0; i < _soundMgr.maxSounds; ++i)
     {
-        StopAudio(_soundMgr.pXAudio2, i);
-
         SoundSource* sound = &_soundMgr.sounds[i];
-        if (sound->filename != NULL)
+        if (sound->isLoaded)
         {
             soundUnload(i);
         }
     }
     free(_soundMgr.sounds);
-    free(_soundMgr.audios);
+    _soundMgr.sounds = NULL;
+    _soundMgr.maxSounds = 0;
 
-    IXAudio2_Release(_soundMgr.pXAudio2);
-    _soundMgr.pXAudio2 = NULL;
+#ifdef FW_HEADLESS
+    pthread_cond_destroy(&_soundMgr.streamerWake);
+    pthread_mutex_destroy(&_soundMgr.streamerMutex);
+    pthread_mutex_destroy(&_soundMgr.streamsMutex);
+#endif
 
     return true;
 }
 
+/**
+ * @brief Advances the sound system's clock, and has the streamer top up any streams. For a sink that's written to,
+ * mixes that much audio and writes it. Then reports every clip that's ended by the new clock. Called by the framework
+ * after every update.
+ * @param milliseconds
+*/
+void soundUpdate(uint32_t milliseconds) {
+    const uint64_t elapsed = (uint64_t)milliseconds * SOUND_SAMPLE_RATE + _soundMgr.clockRemainder;
+    uint64_t numFrames = elapsed / 1000;
+    _soundMgr.clockRemainder = (uint32_t)(elapsed % 1000);
+    _soundMgr.clock += numFrames;
+
+    if (_soundMgr.streams != NULL) {
+        WakeStreamer();
+    }
+
+    SoundSink* sink = _soundMgr.sink;
+    if (sink != NULL && sink->write != NULL) {
+        profilerBeginZone("soundMix");
+        int16_t frames[SOUND_MIX_FRAMES * 2];
+        while (numFrames > 0)
+        {
+            const uint32_t count = numFrames < SOUND_MIX_FRAMES ? (uint32_t)numFrames : SOUND_MIX_FRAMES;
+            Mix(frames, count);
+            sink->write(sink, frames, count);
+            numFrames -= count;
+        }
+        profilerEndZone();
+    }
+
+    for (int32_t c = 0; c < SOUND_MIXER_CHANNELS; ++c)
+    {
+        SoundChannelUse* use = &_soundMgr.uses[c];
+        if (use->isPlaying && use->endsAt <= _soundMgr.clock) {
+            use->isPlaying = false;
+            if (_soundMgr.onEnd != NULL)
+                _soundMgr.onEnd(use->soundId, c);
+        }
+    }
+}
+
 /**
  * @brief Loads a clip from file into memory for playback
- * @param filename 
+ * @param filename
  * @return id which is a handle to the clip data
 */
 int32_t soundLoad(const char* filename) {
-    for (int32_t i = 0; i < _soundMgr.maxSounds; ++i)
-    {
-        if (_soundMgr.sounds[i].filename == NULL)
-        {
-            SoundSource* sound = &_soundMgr.sounds[i];
-            sound->filename = filename;
+    WavInfo info;
+    void* fileData = wavLoad(filename, &info);
+    if (fileData == NULL) {
+        return SOUND_NOSOUND;
+    }
 
-            HRESULT hr = LoadChunkFile(filename, &sound->wfx, &sound->buffer);
-            if (FAILED(hr)) {
-                sound->filename = NULL;
-                return SOUND_NOSOUND;
-            }
-            return i;
-        }
+    int32_t soundId = AddSound(&info, fileData, false);
+    if (soundId == SOUND_NOSOUND) {
+        free(fileData);
     }
+    return soundId;
+}
 
-    return SOUND_NOSOUND;
+/**
+ * @brief Loads a clip whose samples are already in memory (e.g. an asset pack), without copying them
+ * @param info the clip's format and samples, which must stay valid until it's unloaded
+ * @return id which is a handle to the clip data
+*/
+int32_t soundLoadFromMemory(const WavInfo* info) {
+    return AddSound(info, NULL, false);
+}
+
+/**
+ * @brief Opens a clip to stream from file: only a few chunks of it are ever in memory, read ahead as it plays.
+ * For music, and anything else long. Only one channel plays a stream at a time.
+ * @param filename
+ * @return id which is a handle to the stream, played like any other clip
+*/
+int32_t soundLoadStream(const char* filename) {
+    WavInfo info;
+    uint32_t dataOffset = 0;
+    void* header = wavLoadHeader(filename, &info, &dataOffset);
+    FILE* file = header != NULL ? fopen(filename, "rb") : NULL;
+    if (file == NULL) {
+        free(header);
+        return SOUND_NOSOUND;
+    }
+
+    int32_t soundId = AddStream(&info, header, file, dataOffset);
+    if (soundId == SOUND_NOSOUND) {
+        fclose(file);
+        free(header);
+    }
+    return soundId;
+}
+
+/**
+ * @brief Opens a clip that's in memory (e.g. mapped from an asset pack) to stream, a chunk at a time, so that only
+ * the chunks being played need to be resident. Like a stream from file, it plays to the end of its data chunk.
+ * @param info the clip's format and samples, which must stay valid until it's unloaded
+ * @return id which is a handle to the stream, played like any other clip
+*/
+int32_t soundLoadStreamFromMemory(const WavInfo* info) {
+    return AddStream(info, NULL, NULL, 0);
 }
 
 /**
  * @brief Releases resources associated w/ a loaded clip
- * @param soundId 
+ * @param soundId
 */
 void soundUnload(int32_t soundId) {
     if (soundId == SOUND_NOSOUND)
         return;
 
     SoundSource* sound = &_soundMgr.sounds[soundId];
-    if (sound->buffer.pAudioData != NULL) {
-        free((BYTE*)sound->buffer.pAudioData);
-        sound->buffer.pAudioData = NULL;
+    if (sound->isLoaded) {
+        // The samples may be mapped from a pack about to be closed: nothing can still be reading them
+        soundStop(soundId);
+        WaitForMixer();
+        if (sound->stream != NULL) {
+            RemoveStream(sound->stream);
+            sound->stream = NULL;
+        }
+        free(sound->fileData);
+        sound->fileData = NULL;
+        sound->samples = NULL;
 
-        sound->filename = NULL;
+        sound->isLoaded = false;
     }
 }
 
 /**
  * @brief Plays a clip loaded w/ LoadSound
- * @param soundId 
+ * @param soundId
+ * @return the channel it plays on, or SOUND_NOCHANNEL
 */
-void soundPlay(int32_t soundId) {
-    if (soundId == SOUND_NOSOUND)
+int32_t soundPlay(int32_t soundId) {
+    return soundPlayWithPriority(soundId, SOUND_PRIORITY_NORMAL);
+}
+
+/**
+ * @brief Plays a clip loaded w/ LoadSound on a free channel. If they're all busy, the one playing the lowest priority
+ * clip (the oldest, of those) is cut off for it, unless that clip's priority is higher.
+ * @param soundId
+ * @param priority
+ * @return the channel it plays on, or SOUND_NOCHANNEL
+*/
+int32_t soundPlayWithPriority(int32_t soundId, int32_t priority) {
+    if (soundId == SOUND_NOSOUND || !_soundMgr.sounds[soundId].isLoaded)
+        return SOUND_NOCHANNEL;
+
+    int32_t channel = FindChannel(priority);
+    if (channel != SOUND_NOCHANNEL) {
+        StartChannel(channel, soundId, priority);
+    }
+    return channel;
+}
+
+/**
+ * @brief Plays a clip loaded w/ LoadSound on a particular channel, cutting off whatever it was playing
+ * @param soundId
+ * @param channel
+*/
+void soundPlayOnChannel(int32_t soundId, int32_t channel) {
+    if (soundId == SOUND_NOSOUND || !_soundMgr.sounds[soundId].isLoaded || channel < 0 || channel >= SOUND_MIXER_CHANNELS)
         return;
 
-    SoundSource* sound = &_soundMgr.sounds[soundId];
-    PlayAudio(_soundMgr.pXAudio2, (WAVEFORMATEX*)&sound->wfx, &sound->buffer, soundId);
+    StartChannel(channel, soundId, SOUND_PRIORITY_NORMAL);
 }
 
+/**
+ * @brief Cuts off every channel playing a clip
+ * @param soundId
+*/
 void soundStop(int32_t soundId) {
     if (soundId == SOUND_NOSOUND)
         return;
 
-    SoundSource* sound = &_soundMgr.sounds[soundId];
-    StopAudio(_soundMgr.pXAudio2, soundId);
+    PushCommand(SOUND_COMMAND_STOP_SOUND, SOUND_NOCHANNEL, soundId, 0.0f, 0);
+    StopUses(soundId);
+}
+
+/**
+ * @brief Cuts off whatever a channel is playing
+ * @param channel
+*/
+void soundStopChannel(int32_t channel) {
+    if (channel < 0 || channel >= SOUND_MIXER_CHANNELS)
+        return;
+
+    PushCommand(SOUND_COMMAND_STOP_CHANNEL, channel, SOUND_NOSOUND, 0.0f, 0);
+    _soundMgr.uses[channel].endsAt = 0;
+    _soundMgr.uses[channel].isPlaying = false;
+}
+
+/**
+ * @brief Scales everything a channel plays, from now on
+ * @param channel
+ * @param gain 1 to play clips as they are
+*/
+void soundSetChannelGain(int32_t channel, float gain) {
+    if (channel < 0 || channel >= SOUND_MIXER_CHANNELS)
+        return;
+
+    PushCommand(SOUND_COMMAND_SET_GAIN, channel, SOUND_NOSOUND, gain, 0);
+}
+
+/**
+ * @brief How many frames a clip has, going by its fmt chunk and the size of its data chunk
+ * @param soundId
+ * @return 0 if it isn't loaded
+*/
+uint32_t soundGetNumFrames(int32_t soundId) {
+    if (soundId == SOUND_NOSOUND || !_soundMgr.sounds[soundId].isLoaded)
+        return 0;
+
+    return _soundMgr.sounds[soundId].format.numFrames;
+}
+
+/**
+ * @brief How long a clip is heard for: up to its last frame above SOUND_SILENCE, not counting the padding after it.
+ * This is also when it counts as ended, and its channel as free. Streams, from file or memory, are heard to the end of
+ * their data chunk, as finding the last audible frame would mean reading (or paging in) all of it up front.
+ * @param soundId
+ * @return in milliseconds, rounded up; 0 if it isn't loaded
+*/
+uint32_t soundGetDurationMS(int32_t soundId) {
+    if (soundId == SOUND_NOSOUND || !_soundMgr.sounds[soundId].isLoaded)
+        return 0;
+
+    return _soundMgr.sounds[soundId].durationMS;
 }
 
 /**
- * @brief FROM: https://learn.microsoft.com/en-us/windows/win32/xaudio2/how-to--load-audio-data-files-in-xaudio2
+ * @brief The clip playing on a channel, by the sound system's clock
+ * @param channel
+ * @return SOUND_NOSOUND if it's ended, or been stopped or cut off, or nothing's been played on the channel
 */
-static HRESULT FindChunk(HANDLE hFile, DWORD fourcc, DWORD* dwChunkSize, DWORD* dwChunkDataPosition)
-{
-    HRESULT hr = S_OK;
-    if (INVALID_SET_FILE_POINTER == SetFilePointer(hFile, 0, NULL, FILE_BEGIN))
-        return HRESULT_FROM_WIN32(GetLastError());
+int32_t soundGetChannelSound(int32_t channel) {
+    if (channel < 0 || channel >= SOUND_MIXER_CHANNELS || !_soundMgr.uses[channel].isPlaying)
+        return SOUND_NOSOUND;
 
-    DWORD dwChunkType;
-    DWORD dwChunkDataSize;
-    DWORD dwRIFFDataSize = 0;
-    DWORD dwFileType;
-    DWORD bytesRead = 0;
-    DWORD dwOffset = 0;
+    return _soundMgr.uses[channel].soundId;
+}
 
-    while (hr == S_OK)
+/**
+ * @brief How far into its clip a channel is, by the sound system's clock. For a sink that pulls, the device may be a
+ * little behind.
+ * @param channel
+ * @return in milliseconds; 0 if it's not playing anything
+*/
+uint32_t soundGetChannelPositionMS(int32_t channel) {
+    if (soundGetChannelSound(channel) == SOUND_NOSOUND)
+        return 0;
+
+    return (uint32_t)((_soundMgr.clock - _soundMgr.uses[channel].startsAt) * 1000 / SOUND_SAMPLE_RATE);
+}
+
+/**
+ * @brief Has soundUpdate call a function for every clip that plays to its end (not those stopped or cut off), once
+ * the sound system's clock passes it. The function may play more clips.
+ * @param onEnd or NULL for none
+*/
+void soundSetEndCallback(SoundEndFunc onEnd) {
+    _soundMgr.onEnd = onEnd;
+}
+
+/**
+ * @brief Queues a command for the mixer. If the ring's full, waits for the mixer to make room.
+*/
+static void PushCommand(SoundCommandType type, int32_t channel, int32_t soundId, float gain, uint32_t seek) {
+    const uint32_t numPushed = AtomicLoad(&_soundMgr.numPushed);
+    while (numPushed - AtomicLoad(&_soundMgr.numProcessed) >= SOUND_COMMANDS)
     {
-        DWORD dwRead;
-        if (0 == ReadFile(hFile, &dwChunkType, sizeof(DWORD), &dwRead, NULL))
-            hr = HRESULT_FROM_WIN32(GetLastError());
+        if (IsMixedOnGameThread())
+            ProcessCommands();
+        else
+            YieldThread();
+    }
 
-        if (0 == ReadFile(hFile, &dwChunkDataSize, sizeof(DWORD), &dwRead, NULL))
-            hr = HRESULT_FROM_WIN32(GetLastError());
+    SoundCommand* command = &_soundMgr.commands[numPushed & (SOUND_COMMANDS - 1)];
+    command->type = type;
+    command->channel = channel;
+    command->soundId = soundId;
+    command->gain = gain;
+    command->seek = seek;
+    AtomicStore(&_soundMgr.numPushed, numPushed + 1);
+}
 
-        switch (dwChunkType)
+/**
+ * @brief Applies every command queued so far to the channels. Only called by the mixer.
+*/
+static void ProcessCommands() {
+    const uint32_t numPushed = AtomicLoad(&_soundMgr.numPushed);
+    uint32_t numProcessed = AtomicLoad(&_soundMgr.numProcessed);
+    for (; numProcessed != numPushed; ++numProcessed)
+    {
+        const SoundCommand* command = &_soundMgr.commands[numProcessed & (SOUND_COMMANDS - 1)];
+        switch (command->type)
         {
-        case fourccRIFF:
-            dwRIFFDataSize = dwChunkDataSize;
-            dwChunkDataSize = 4;
-            if (0 == ReadFile(hFile, &dwFileType, sizeof(DWORD), &dwRead, NULL))
-                hr = HRESULT_FROM_WIN32(GetLastError());
+        case SOUND_COMMAND_PLAY:
+            // A stream's chunks can only be taken by one channel
+            if (_soundMgr.sounds[command->soundId].stream != NULL)
+            {
+                for (int32_t c = 0; c < SOUND_MIXER_CHANNELS; ++c)
+                {
+                    if (_soundMgr.channels[c].soundId == command->soundId)
+                        _soundMgr.channels[c].soundId = SOUND_NOSOUND;
+                }
+            }
+            _soundMgr.channels[command->channel].soundId = command->soundId;
+            _soundMgr.channels[command->channel].position = 0;
+            _soundMgr.channels[command->channel].seek = command->seek;
+            _soundMgr.channels[command->channel].chunkStart = 0;
+            break;
+        case SOUND_COMMAND_STOP_CHANNEL:
+            _soundMgr.channels[command->channel].soundId = SOUND_NOSOUND;
+            break;
+        case SOUND_COMMAND_STOP_SOUND:
+            for (int32_t c = 0; c < SOUND_MIXER_CHANNELS; ++c)
+            {
+                if (_soundMgr.channels[c].soundId == command->soundId)
+                    _soundMgr.channels[c].soundId = SOUND_NOSOUND;
+            }
+            break;
+        case SOUND_COMMAND_SET_GAIN:
+            _soundMgr.channels[command->channel].gain = command->gain;
             break;
-
-        default:
-            if (INVALID_SET_FILE_POINTER == SetFilePointer(hFile, dwChunkDataSize, NULL, FILE_CURRENT))
-                return HRESULT_FROM_WIN32(GetLastError());
         }
+    }
+    AtomicStore(&_soundMgr.numProcessed, numProcessed);
+}
 
-        dwOffset += sizeof(DWORD) * 2;
+/**
+ * @brief Waits for the mixer to have applied every command queued so far
+*/
+static void WaitForMixer() {
+    if (IsMixedOnGameThread()) {
+        ProcessCommands();
+        return;
+    }
 
-        if (dwChunkType == fourcc)
+    const uint32_t numPushed = AtomicLoad(&_soundMgr.numPushed);
+    while (AtomicLoad(&_soundMgr.numProcessed) != numPushed)
+    {
+        YieldThread();
+    }
+}
+
+/**
+ * @brief Whether the mixer runs on the game thread: the sink is written to, or there isn't one any more
+*/
+static bool IsMixedOnGameThread() {
+    return _soundMgr.sink == NULL || _soundMgr.sink->write != NULL;
+}
+
+/**
+ * @brief Takes the first free id for a clip
+ * @param info the clip's format and samples
+ * @param fileData freed along w/ the clip, or NULL if the samples belong to someone else
+ * @param isStream whether it'll be streamed, so mustn't be read through for its audible length
+ * @return the id, or SOUND_NOSOUND if there are none free, or the clip's in an encoding that can't be mixed
+*/
+static int32_t AddSound(const WavInfo* info, void* fileData, bool isStream) {
+    WavFormat format;
+    if (!wavGetFormat(info, &format)) {
+        return SOUND_NOSOUND;
+    }
+
+    for (int32_t i = 0; i < _soundMgr.maxSounds; ++i)
+    {
+        SoundSource* sound = &_soundMgr.sounds[i];
+        if (!sound->isLoaded)
         {
-            *dwChunkSize = dwChunkDataSize;
-            *dwChunkDataPosition = dwOffset;
-            return S_OK;
+            sound->samples = (const uint8_t*)info->samples;
+            sound->stream = NULL;
+            sound->format = format;
+            sound->step = (uint32_t)(((uint64_t)format.sampleRate << SOUND_FRACTION_BITS) / SOUND_SAMPLE_RATE);
+            sound->audibleFrames = !isStream && info->samples != NULL ? FindAudibleFrames(info->samples, &format) : format.numFrames;
+            sound->outputFrames = ((uint64_t)sound->audibleFrames * SOUND_SAMPLE_RATE + format.sampleRate - 1) / format.sampleRate;
+            sound->durationMS = (uint32_t)(((uint64_t)sound->audibleFrames * 1000 + format.sampleRate - 1) / format.sampleRate);
+            sound->fileData = fileData;
+            sound->isLoaded = true;
+            return i;
         }
+    }
 
-        dwOffset += dwChunkDataSize;
+    return SOUND_NOSOUND;
+}
+
+/**
+ * @brief Takes the first free id for a stream, and hands it to the streamer, which starts reading it straight away
+ * @param info the stream's format, and its samples if they're in memory
+ * @param fileData freed along w/ the stream
+ * @param file to read the samples from, closed along w/ the stream, or NULL if they're in memory
+ * @param dataOffset where the samples start in the file
+ * @return the id, or SOUND_NOSOUND
+*/
+static int32_t AddStream(const WavInfo* info, void* fileData, FILE* file, uint32_t dataOffset) {
+    WavFormat format;
+    SoundStream* stream = wavGetFormat(info, &format) ? malloc(sizeof(SoundStream)) : NULL;
+    if (stream == NULL) {
+        return SOUND_NOSOUND;
+    }
+    ZeroMemory(stream, sizeof(SoundStream));
+    stream->chunkBytes = SOUND_STREAM_CHUNK_BYTES / format.frameBytes * format.frameBytes;
+    stream->buffer = malloc((size_t)stream->chunkBytes * SOUND_STREAM_CHUNKS);
 
-        if (bytesRead >= dwRIFFDataSize) return S_FALSE;
+    int32_t soundId = stream->buffer != NULL ? AddSound(info, fileData, true) : SOUND_NOSOUND;
+    if (soundId == SOUND_NOSOUND) {
+        free(stream->buffer);
+        free(stream);
+        return SOUND_NOSOUND;
+    }
 
+    stream->file = file;
+    stream->memory = (const uint8_t*)info->samples;
+    stream->dataOffset = dataOffset;
+    stream->sampleBytes = info->sampleBytes;
+    stream->frameBytes = format.frameBytes;
+    for (uint32_t i = 0; i < SOUND_STREAM_CHUNKS; ++i)
+    {
+        stream->chunks[i].samples = stream->buffer + (size_t)i * stream->chunkBytes;
     }
+    _soundMgr.sounds[soundId].samples = NULL;
+    _soundMgr.sounds[soundId].stream = stream;
 
-    return S_OK;
+    StartStreamer();
+    MutexLock(&_soundMgr.streamsMutex);
+    stream->next = _soundMgr.streams;
+    _soundMgr.streams = stream;
+    MutexUnlock(&_soundMgr.streamsMutex);
+    WakeStreamer();
 
+    return soundId;
 }
 
 /**
- * @brief FROM: https://learn.microsoft.com/en-us/windows/win32/xaudio2/how-to--load-audio-data-files-in-xaudio2
+ * @brief Finds where a clip falls silent for good, looking back from its end
+ * @param samples
+ * @param format
+ * @return the number of frames up to and including the last one w/ a sample above SOUND_SILENCE
 */
-static HRESULT ReadChunkData(HANDLE hFile, void* buffer, DWORD buffersize, DWORD bufferoffset)
-{
-    HRESULT hr = S_OK;
-    if (INVALID_SET_FILE_POINTER == SetFilePointer(hFile, bufferoffset, NULL, FILE_BEGIN))
-        return HRESULT_FROM_WIN32(GetLastError());
-    DWORD dwRead;
-    if (0 == ReadFile(hFile, buffer, buffersize, &dwRead, NULL))
-        hr = HRESULT_FROM_WIN32(GetLastError());
-    return hr;
+static uint32_t FindAudibleFrames(const uint8_t* samples, const WavFormat* format) {
+    const uint32_t numSamples = format->numFrames * format->numChannels;
+    uint32_t i = numSamples;
+    switch (format->encoding)
+    {
+    case WAV_ENCODING_PCM8:
+        while (i > 0 && abs((int32_t)samples[i - 1] - 128) <= (int32_t)(SOUND_SILENCE * 128.0f))
+        {
+            --i;
+        }
+        break;
+    case WAV_ENCODING_PCM16:
+        while (i > 0 && abs((int32_t)((const int16_t*)samples)[i - 1]) <= (int32_t)(SOUND_SILENCE * 32768.0f))
+        {
+            --i;
+        }
+        break;
+    case WAV_ENCODING_FLOAT32:
+        while (i > 0 && fabsf(((const float*)samples)[i - 1]) <= SOUND_SILENCE)
+        {
+            --i;
+        }
+        break;
+    }
+
+    return (i + format->numChannels - 1) / format->numChannels;
 }
 
 /**
- * @brief FROM: https://learn.microsoft.com/en-us/windows/win32/xaudio2/how-to--load-audio-data-files-in-xaudio2
+ * @brief Takes a stream off the streamer, and frees it. The mixer must be done w/ it.
 */
-static HRESULT LoadChunkFile(const char* filename, WAVEFORMATEXTENSIBLE* wfx, XAUDIO2_BUFFER* buffer) {
-    // Open the file
-    HANDLE hFile = CreateFile(
-        filename,
-        GENERIC_READ,
-        FILE_SHARE_READ,
-        NULL,
-        OPEN_EXISTING,
-        0,
-        NULL);
+static void RemoveStream(SoundStream* stream) {
+    MutexLock(&_soundMgr.streamsMutex);
+    SoundStream** link = &_soundMgr.streams;
+    while (*link != stream)
+    {
+        link = &(*link)->next;
+    }
+    *link = stream->next;
+    MutexUnlock(&_soundMgr.streamsMutex);
 
-    if (INVALID_HANDLE_VALUE == hFile) {
-        return S_FALSE;
+    if (stream->file != NULL) {
+        fclose(stream->file);
     }
+    free(stream->buffer);
+    free(stream);
+}
 
-    if (INVALID_SET_FILE_POINTER == SetFilePointer(hFile, 0, NULL, FILE_BEGIN)) {
-        CloseHandle(hFile);
-        return S_FALSE;
+/**
+ * @brief Marks every channel the game thread last started a clip on as done w/ it, without reporting it as ended
+*/
+static void StopUses(int32_t soundId) {
+    for (int32_t c = 0; c < SOUND_MIXER_CHANNELS; ++c)
+    {
+        if (_soundMgr.uses[c].soundId == soundId) {
+            _soundMgr.uses[c].endsAt = 0;
+            _soundMgr.uses[c].isPlaying = false;
+        }
     }
+}
 
-    DWORD dwChunkSize;
-    DWORD dwChunkPosition;
-    //check the file type, should be fourccWAVE or 'XWMA'
-    FindChunk(hFile, fourccRIFF, &dwChunkSize, &dwChunkPosition);
-    DWORD filetype;
-    ReadChunkData(hFile, &filetype, sizeof(DWORD), dwChunkPosition);
-    if (filetype != fourccWAVE) {
-        CloseHandle(hFile);
-        return S_FALSE;
+/**
+ * @brief A free channel, or else the one to take over
+ * @param priority of the clip about to play
+ * @return SOUND_NOCHANNEL if every channel is playing something of a higher priority
+*/
+static int32_t FindChannel(int32_t priority) {
+    int32_t steal = SOUND_NOCHANNEL;
+    for (int32_t c = 0; c < SOUND_MIXER_CHANNELS; ++c)
+    {
+        const SoundChannelUse* use = &_soundMgr.uses[c];
+        if (use->endsAt <= _soundMgr.clock)
+            return c;
+
+        if (steal == SOUND_NOCHANNEL || use->priority < _soundMgr.uses[steal].priority ||
+            (use->priority == _soundMgr.uses[steal].priority && use->startedAt < _soundMgr.uses[steal].startedAt))
+        {
+            steal = c;
+        }
     }
 
-    FindChunk(hFile, fourccFMT, &dwChunkSize, &dwChunkPosition);
-    ReadChunkData(hFile, wfx, dwChunkSize, dwChunkPosition);
+    return steal != SOUND_NOCHANNEL && _soundMgr.uses[steal].priority <= priority ? steal : SOUND_NOCHANNEL;
+}
 
-    //fill out the audio data buffer with the contents of the fourccDATA chunk
-    FindChunk(hFile, fourccDATA, &dwChunkSize, &dwChunkPosition);
-    BYTE* pDataBuffer = malloc(dwChunkSize * sizeof(BYTE));
-    ReadChunkData(hFile, pDataBuffer, dwChunkSize, dwChunkPosition);
+/**
+ * @brief Starts a clip on a channel, cutting off whatever it was playing. A stream starts again from the top, cutting
+ * off the channel it was playing on, if any; the chunks read since it was loaded are kept for its first play.
+*/
+static void StartChannel(int32_t channel, int32_t soundId, int32_t priority) {
+    SoundStream* stream = _soundMgr.sounds[soundId].stream;
+    uint32_t seek = 0;
+    if (stream != NULL) {
+        seek = AtomicLoad(&stream->seekRequest);
+        if (stream->numPlays++ > 0) {
+            AtomicStore(&stream->seekRequest, ++seek);
+            WakeStreamer();
+        }
+        StopUses(soundId);
+    }
+
+    SoundChannelUse* use = &_soundMgr.uses[channel];
+    use->soundId = soundId;
+    use->priority = priority;
+    use->startedAt = ++_soundMgr.numPlays;
+    use->startsAt = _soundMgr.clock;
+    use->endsAt = _soundMgr.clock + _soundMgr.sounds[soundId].outputFrames;
+    use->isPlaying = true;
+
+    PushCommand(SOUND_COMMAND_PLAY, channel, soundId, 0.0f, seek);
+}
+
+/**
+ * @brief Mixes for a sink that pulls, on its thread
+*/
+static void PullMix(int16_t* frames, uint32_t numFrames) {
+    profilerBeginZone("soundMix");
+    Mix(frames, numFrames);
+    profilerEndZone();
+}
 
-    buffer->AudioBytes = dwChunkSize;  //size of the audio buffer in bytes
-    buffer->pAudioData = pDataBuffer;  //buffer containing audio data
-    buffer->Flags = XAUDIO2_END_OF_STREAM; // tell the source voice not to expect any data after this buffer
+/**
+ * @brief Applies the commands queued so far, then mixes every channel into the next frames of output
+ * @param frames receives interleaved 16 bit stereo
+ * @param numFrames
+*/
+static void Mix(int16_t* frames, uint32_t numFrames) {
+    ProcessCommands();
 
-    CloseHandle(hFile);
+    float* mix = _soundMgr.mix;
+    while (numFrames > 0)
+    {
+        const uint32_t count = numFrames < SOUND_MIX_FRAMES ? numFrames : SOUND_MIX_FRAMES;
+        memset(mix, 0, count * 2 * sizeof(float));
+        for (int32_t c = 0; c < SOUND_MIXER_CHANNELS; ++c)
+        {
+            if (_soundMgr.channels[c].soundId != SOUND_NOSOUND)
+                MixChannel(&_soundMgr.channels[c], mix, count);
+        }
 
-    return S_OK;
+        for (uint32_t i = 0; i < count * 2; ++i)
+        {
+            const float sample = mix[i] < -1.0f ? -1.0f : mix[i] > 1.0f ? 1.0f : mix[i];
+            frames[i] = (int16_t)(sample * 32767.0f);
+        }
+        frames += count * 2;
+        numFrames -= count;
+    }
 }
 
 /**
- * @brief FROM: https://learn.microsoft.com/en-us/windows/win32/xaudio2/how-to--load-audio-data-files-in-xaudio2
+ * @brief Adds the next frames of a channel's clip to the mix, and silences the channel once the clip ends
+ * @param channel
+ * @param mix interleaved stereo
+ * @param numFrames
 */
-static HRESULT PlayAudio(IXAudio2* pXAudio2, WAVEFORMATEX* wfx, XAUDIO2_BUFFER* buffer, int soundId) {
-    HRESULT hr = S_OK;
+static void MixChannel(SoundChannel* channel, float* mix, uint32_t numFrames) {
+    const SoundSource* sound = &_soundMgr.sounds[channel->soundId];
+    if (sound->stream != NULL) {
+        MixStream(channel, mix, numFrames);
+        return;
+    }
 
-    //if (_soundMgr.audios[soundId] == NULL)
+    MixSamples(sound, sound->samples, 0, sound->format.numFrames, channel, mix, numFrames);
+    if ((channel->position >> SOUND_FRACTION_BITS) >= sound->format.numFrames) {
+        channel->soundId = SOUND_NOSOUND;
+    }
+}
+
+/**
+ * @brief Adds the next frames of a channel's stream to the mix, chunk by chunk, handing each back to the streamer
+ * once it's done w/ it, and silences the channel once the stream ends. If the streamer hasn't read far enough, a
+ * device just gets a gap, as it can't wait; a sink that's written to waits, so what it gets doesn't depend on the disk.
+ * @param channel
+ * @param mix interleaved stereo
+ * @param numFrames
+*/
+static void MixStream(SoundChannel* channel, float* mix, uint32_t numFrames) {
+    const SoundSource* sound = &_soundMgr.sounds[channel->soundId];
+    SoundStream* stream = sound->stream;
+    while (numFrames > 0)
     {
-        IXAudio2SourceVoice* pSourceVoice;
-
-        hr = IXAudio2_CreateSourceVoice(_soundMgr.pXAudio2, &pSourceVoice, wfx,
-            0,
-            XAUDIO2_DEFAULT_FREQ_RATIO,
-            NULL,
-            NULL,
-            NULL);
-        if (FAILED(hr)) {
-            return hr;
+        const uint32_t numConsumed = AtomicLoad(&stream->numConsumed);
+        if (numConsumed == AtomicLoad(&stream->numFilled))
+        {
+            if (!IsMixedOnGameThread())
+                return;
+
+            if (_soundMgr.isStreamerRunning) {
+                WakeStreamer();
+                YieldThread();
+            }
+            else {
+                FillStream(stream);
+            }
+            continue;
         }
 
-        hr = IXAudio2SourceVoice_SubmitSourceBuffer(pSourceVoice, buffer, NULL);
-        if (FAILED(hr)) {
-            return hr;
+        // Chunks read for an earlier play are skipped
+        const SoundStreamChunk* chunk = &stream->chunks[numConsumed & (SOUND_STREAM_CHUNKS - 1)];
+        const bool isCurrent = chunk->seek == channel->seek;
+        const bool isLast = isCurrent && chunk->isLast;
+        if (isCurrent)
+        {
+            const uint64_t end = channel->chunkStart + chunk->bytes / stream->frameBytes;
+            const uint32_t mixed = MixSamples(sound, chunk->samples, channel->chunkStart, end, channel, mix, numFrames);
+            mix += mixed * 2;
+            numFrames -= mixed;
+            if ((channel->position >> SOUND_FRACTION_BITS) < end)
+                break;
+
+            channel->chunkStart = end;
         }
 
-        _soundMgr.audios[soundId] = pSourceVoice;
+        AtomicStore(&stream->numConsumed, numConsumed + 1);
+        if (isLast) {
+            channel->soundId = SOUND_NOSOUND;
+            return;
+        }
     }
+}
 
-    hr = IXAudio2SourceVoice_Start(_soundMgr.audios[soundId], 0, XAUDIO2_COMMIT_NOW);
+/**
+ * @brief Adds frames of a clip to the mix, resampled to the output rate (nearest frame), until the mix is full or the
+ * channel's position passes the end of the frames at hand. Mono clips play on both sides; past the first two channels
+ * are ignored.
+ * @param sound
+ * @param samples the clip's frames from first on
+ * @param first the clip frame samples starts at
+ * @param end the clip frame past the last one in samples
+ * @param channel whose position is advanced, and whose gain is applied
+ * @param mix interleaved stereo
+ * @param numFrames
+ * @return the number of frames of the mix added to
+*/
+static uint32_t MixSamples(const SoundSource* sound, const uint8_t* samples, uint64_t first, uint64_t end, SoundChannel* channel, float* mix, uint32_t numFrames) {
+    const uint64_t last = (end - first) << SOUND_FRACTION_BITS;
+    const uint32_t right = sound->format.numChannels > 1 ? 1 : 0;
+    const uint32_t frameBytes = sound->format.frameBytes;
+    const float gain = channel->gain;
+
+    uint64_t position = channel->position - (first << SOUND_FRACTION_BITS);
+    uint32_t i = 0;
+    switch (sound->format.encoding)
+    {
+    case WAV_ENCODING_PCM8:
+        for (; i < numFrames && position < last; ++i, position += sound->step)
+        {
+            const uint8_t* frame = samples + (size_t)(position >> SOUND_FRACTION_BITS) * frameBytes;
+            mix[i * 2] += ((float)frame[0] - 128.0f) * (gain / 128.0f);
+            mix[i * 2 + 1] += ((float)frame[right] - 128.0f) * (gain / 128.0f);
+        }
+        break;
+    case WAV_ENCODING_PCM16:
+        for (; i < numFrames && position < last; ++i, position += sound->step)
+        {
+            const int16_t* frame = (const int16_t*)(samples + (size_t)(position >> SOUND_FRACTION_BITS) * frameBytes);
+            mix[i * 2] += (float)frame[0] * (gain / 32768.0f);
+            mix[i * 2 + 1] += (float)frame[right] * (gain / 32768.0f);
+        }
+        break;
+    case WAV_ENCODING_FLOAT32:
+        for (; i < numFrames && position < last; ++i, position += sound->step)
+        {
+            const float* frame = (const float*)(samples + (size_t)(position >> SOUND_FRACTION_BITS) * frameBytes);
+            mix[i * 2] += frame[0] * gain;
+            mix[i * 2 + 1] += frame[right] * gain;
+        }
+        break;
+    }
 
-    return hr;
+    channel->position = position + (first << SOUND_FRACTION_BITS);
+    return i;
 }
 
-static HRESULT StopAudio(IXAudio2* pXAudio2, int soundId) {
-    HRESULT hr = S_FALSE;
+/**
+ * @brief Reads a stream into every chunk the mixer has handed back, from wherever it's up to, or from the top if it's
+ * been played again since. Called by the streamer, or by the mixer once there isn't one.
+*/
+static void FillStream(SoundStream* stream) {
+    const uint32_t seek = AtomicLoad(&stream->seekRequest);
+    if (seek != stream->seek) {
+        stream->seek = seek;
+        stream->cursor = 0;
+        stream->isFinished = false;
+    }
 
-    if (_soundMgr.audios[soundId] != NULL)
+    uint32_t numFilled = AtomicLoad(&stream->numFilled);
+    while (!stream->isFinished && numFilled - AtomicLoad(&stream->numConsumed) < SOUND_STREAM_CHUNKS)
     {
-        hr = IXAudio2SourceVoice_Stop(_soundMgr.audios[soundId], 0, XAUDIO2_COMMIT_NOW);
+        SoundStreamChunk* chunk = &stream->chunks[numFilled & (SOUND_STREAM_CHUNKS - 1)];
+        const uint32_t remaining = stream->sampleBytes - stream->cursor;
+        const uint32_t wanted = remaining < stream->chunkBytes ? remaining : stream->chunkBytes;
+
+        uint32_t bytes = wanted;
+        if (stream->file == NULL) {
+            memcpy(chunk->samples, stream->memory + stream->cursor, bytes);
+        }
+        else if (fseek(stream->file, (long)stream->dataOffset + (long)stream->cursor, SEEK_SET) == 0) {
+            bytes = (uint32_t)fread(chunk->samples, 1, wanted, stream->file);
+        }
+        else {
+            bytes = 0;
+        }
+
+        // A file cut short ends where it's cut
+        chunk->bytes = bytes - bytes % stream->frameBytes;
+        chunk->seek = seek;
+        chunk->isLast = bytes < wanted || bytes == remaining;
+        stream->cursor += bytes;
+        stream->isFinished = chunk->isLast;
+
+        AtomicStore(&stream->numFilled, ++numFilled);
     }
+}
+
+/**
+ * @brief Starts the streamer, if it isn't running yet
+*/
+static void StartStreamer() {
+    if (_soundMgr.isStreamerRunning)
+        return;
 
-    return hr;
+    _soundMgr.isStreamerWoken = false;
+    _soundMgr.isStreamerStopping = false;
+#ifdef FW_HEADLESS
+    _soundMgr.isStreamerRunning = pthread_create(&_soundMgr.streamer, NULL, StreamerMain, NULL) == 0;
+#else
+    _soundMgr.streamer = CreateThread(NULL, 0, StreamerMain, NULL, 0, NULL);
+    _soundMgr.isStreamerRunning = _soundMgr.streamer != NULL;
+#endif
 }
 
+/**
+ * @brief Stops the streamer, once it's done w/ the streams it's reading
+*/
+static void StopStreamer() {
+    if (!_soundMgr.isStreamerRunning)
+        return;
+
+    MutexLock(&_soundMgr.streamerMutex);
+    _soundMgr.isStreamerStopping = true;
+    ConditionWake(&_soundMgr.streamerWake);
+    MutexUnlock(&_soundMgr.streamerMutex);
 
+#ifdef FW_HEADLESS
+    pthread_join(_soundMgr.streamer, NULL);
+#else
+    WaitForSingleObject(_soundMgr.streamer, INFINITE);
+    CloseHandle(_soundMgr.streamer);
+#endif
+    _soundMgr.isStreamerRunning = false;
+}
+
+/**
+ * @brief Has the streamer top up every stream's chunks
+*/
+static void WakeStreamer() {
+    if (!_soundMgr.isStreamerRunning)
+        return;
+
+    MutexLock(&_soundMgr.streamerMutex);
+    _soundMgr.isStreamerWoken = true;
+    ConditionWake(&_soundMgr.streamerWake);
+    MutexUnlock(&_soundMgr.streamerMutex);
+}
+
+/**
+ * @brief Streamer thread: each time it's woken, reads every stream as far ahead as its chunks allow
+*/
+#ifdef FW_HEADLESS
+static void* StreamerMain(void* param) {
+#else
+static DWORD WINAPI StreamerMain(LPVOID param) {
+#endif
+    (void)param;
+
+    MutexLock(&_soundMgr.streamerMutex);
+    while (!_soundMgr.isStreamerStopping)
+    {
+        if (!_soundMgr.isStreamerWoken) {
+            ConditionWait(&_soundMgr.streamerWake, &_soundMgr.streamerMutex);
+            continue;
+        }
+        _soundMgr.isStreamerWoken = false;
+        MutexUnlock(&_soundMgr.streamerMutex);
+
+        MutexLock(&_soundMgr.streamsMutex);
+        for (SoundStream* stream = _soundMgr.streams; stream != NULL; stream = stream->next)
+        {
+            FillStream(stream);
+        }
+        MutexUnlock(&_soundMgr.streamsMutex);
+
+        MutexLock(&_soundMgr.streamerMutex);
+    }
+    MutexUnlock(&_soundMgr.streamerMutex);
+
+    return 0;
+}
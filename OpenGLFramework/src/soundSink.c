@@ -0,0 +1,196 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "soundSink.h"
+
+#define SOUND_SINK_WAV_HEADER_BYTES	44		// RIFF header, fmt chunk (a PCMWAVEFORMAT) and the data chunk's header
+
+/// @brief Throws the mix away, for when there's nothing to play it on. The mixing still happens.
+typedef struct sound_sink_null_t {
+	SoundSink	sink;
+} SoundSinkNull;
+
+/// @brief Writes the mix to a WAV file, as it's made
+typedef struct sound_sink_wav_t {
+	SoundSink	sink;
+	const char*	path;
+	FILE*		file;
+	uint32_t	sampleRate;
+	uint32_t	dataBytes;
+} SoundSinkWav;
+
+static bool _soundSinkNullStart(SoundSink* sink, uint32_t sampleRate, SoundSinkPullFunc pull);
+static void _soundSinkNullWrite(SoundSink* sink, const int16_t* frames, uint32_t numFrames);
+static void _soundSinkNullStop(SoundSink* sink);
+static void _soundSinkDestroy(SoundSink* sink);
+static bool _soundSinkWavStart(SoundSink* sink, uint32_t sampleRate, SoundSinkPullFunc pull);
+static void _soundSinkWavWrite(SoundSink* sink, const int16_t* frames, uint32_t numFrames);
+static void _soundSinkWavStop(SoundSink* sink);
+static void _soundSinkWavWriteHeader(SoundSinkWav* wav);
+static void _soundSinkPutU16(uint8_t* bytes, uint16_t value);
+static void _soundSinkPutU32(uint8_t* bytes, uint32_t value);
+
+/// @brief A sink that discards everything
+/// @return
+SoundSink* soundSinkNewNull()
+{
+	SoundSinkNull* null = (SoundSinkNull*)malloc(sizeof(SoundSinkNull));
+	if (null != NULL)
+	{
+		null->sink.start = _soundSinkNullStart;
+		null->sink.write = _soundSinkNullWrite;
+		null->sink.stop = _soundSinkNullStop;
+		null->sink.destroy = _soundSinkDestroy;
+	}
+	return (SoundSink*)null;
+}
+
+/// @brief A sink that records everything to a 16 bit stereo WAV file. The file is created when the sink starts, and
+/// only has the right length in its header once the sink stops.
+/// @param path which must outlive the sink
+/// @return
+SoundSink* soundSinkNewWavFile(const char* path)
+{
+	SoundSinkWav* wav = (SoundSinkWav*)malloc(sizeof(SoundSinkWav));
+	if (wav != NULL)
+	{
+		memset(wav, 0, sizeof(SoundSinkWav));
+		wav->sink.start = _soundSinkWavStart;
+		wav->sink.write = _soundSinkWavWrite;
+		wav->sink.stop = _soundSinkWavStop;
+		wav->sink.destroy = _soundSinkDestroy;
+		wav->path = path;
+	}
+	return (SoundSink*)wav;
+}
+
+/// @brief Frees a sink, which must have been stopped if it was started
+/// @param sink may be NULL
+void soundSinkDelete(SoundSink* sink)
+{
+	if (sink != NULL)
+	{
+		sink->destroy(sink);
+	}
+}
+
+/// @brief Nothing to open
+static bool _soundSinkNullStart(SoundSink* sink, uint32_t sampleRate, SoundSinkPullFunc pull)
+{
+	(void)sink;
+	(void)sampleRate;
+	(void)pull;
+	return true;
+}
+
+/// @brief Nowhere to write to
+static void _soundSinkNullWrite(SoundSink* sink, const int16_t* frames, uint32_t numFrames)
+{
+	(void)sink;
+	(void)frames;
+	(void)numFrames;
+}
+
+/// @brief Nothing to close
+static void _soundSinkNullStop(SoundSink* sink)
+{
+	(void)sink;
+}
+
+/// @brief For sinks that own nothing but themselves once stopped
+static void _soundSinkDestroy(SoundSink* sink)
+{
+	free(sink);
+}
+
+/// @brief Creates the file, with a header for no samples so far
+/// @return false if the file can't be created
+static bool _soundSinkWavStart(SoundSink* sink, uint32_t sampleRate, SoundSinkPullFunc pull)
+{
+	(void)pull;
+	SoundSinkWav* wav = (SoundSinkWav*)sink;
+	wav->file = fopen(wav->path, "wb");
+	if (wav->file == NULL)
+	{
+		return false;
+	}
+
+	wav->sampleRate = sampleRate;
+	wav->dataBytes = 0;
+	_soundSinkWavWriteHeader(wav);
+	return true;
+}
+
+/// @brief Appends frames to the data chunk
+static void _soundSinkWavWrite(SoundSink* sink, const int16_t* frames, uint32_t numFrames)
+{
+	SoundSinkWav* wav = (SoundSinkWav*)sink;
+	uint8_t bytes[512 * sizeof(int16_t)];
+
+	const uint32_t numSamples = numFrames * 2;
+	for (uint32_t i = 0; i < numSamples;)
+	{
+		uint32_t count = 0;
+		for (; count < sizeof(bytes) / sizeof(int16_t) && i < numSamples; ++count, ++i)
+		{
+			_soundSinkPutU16(&bytes[count * sizeof(int16_t)], (uint16_t)frames[i]);
+		}
+		wav->dataBytes += (uint32_t)fwrite(bytes, 1, count * sizeof(int16_t), wav->file);
+	}
+}
+
+/// @brief Fills in the header's lengths, now they're known, and closes the file
+static void _soundSinkWavStop(SoundSink* sink)
+{
+	SoundSinkWav* wav = (SoundSinkWav*)sink;
+	if (wav->file == NULL)
+	{
+		return;
+	}
+
+	if (fseek(wav->file, 0, SEEK_SET) == 0)
+	{
+		_soundSinkWavWriteHeader(wav);
+	}
+	fclose(wav->file);
+	wav->file = NULL;
+}
+
+/// @brief Writes the RIFF header, and the fmt chunk, for the data written so far
+/// @param wav
+static void _soundSinkWavWriteHeader(SoundSinkWav* wav)
+{
+	const uint16_t NUM_CHANNELS = 2;
+	const uint16_t FRAME_BYTES = NUM_CHANNELS * sizeof(int16_t);
+
+	uint8_t header[SOUND_SINK_WAV_HEADER_BYTES];
+	memcpy(header, "RIFF", 4);
+	_soundSinkPutU32(header + 4, SOUND_SINK_WAV_HEADER_BYTES - 8 + wav->dataBytes);
+	memcpy(header + 8, "WAVEfmt ", 8);
+	_soundSinkPutU32(header + 16, 16);
+	_soundSinkPutU16(header + 20, 1);					// PCM
+	_soundSinkPutU16(header + 22, NUM_CHANNELS);
+	_soundSinkPutU32(header + 24, wav->sampleRate);
+	_soundSinkPutU32(header + 28, wav->sampleRate * FRAME_BYTES);
+	_soundSinkPutU16(header + 32, FRAME_BYTES);
+	_soundSinkPutU16(header + 34, 16);					// bits per sample
+	memcpy(header + 36, "data", 4);
+	_soundSinkPutU32(header + 40, wav->dataBytes);
+
+	fwrite(header, 1, sizeof(header), wav->file);
+}
+
+/// @brief RIFF is little endian, whatever the host is
+static void _soundSinkPutU16(uint8_t* bytes, uint16_t value)
+{
+	bytes[0] = (uint8_t)value;
+	bytes[1] = (uint8_t)(value >> 8);
+}
+
+/// @brief Little endian, like _soundSinkPutU16
+static void _soundSinkPutU32(uint8_t* bytes, uint32_t value)
+{
+	_soundSinkPutU16(bytes, (uint16_t)value);
+	_soundSinkPutU16(bytes + 2, (uint16_t)(value >> 16));
+}
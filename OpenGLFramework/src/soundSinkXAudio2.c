@@ -0,0 +1,193 @@
+// Win32 / XAudio2 sink; the headless build has no audio device to play on
+#ifndef FW_HEADLESS
+
+#include <Windows.h>
+#include <xaudio2.h>
+#include <stdlib.h>
+
+#include "soundSink.h"
+
+#define SOUND_SINK_XAUDIO2_BUFFERS		3		// queued on the voice at once: one playing, the others mixed and waiting
+#define SOUND_SINK_XAUDIO2_FRAMES		512		// per buffer, ~12ms at 44.1kHz
+
+/// @brief Plays the mix on a single source voice, which pulls the next buffer from the mixer each time it finishes one.
+/// The mixing happens on XAudio2's thread, inside the callback, so it has to keep up with the device.
+typedef struct sound_sink_xaudio2_t {
+	SoundSink				sink;
+	IXAudio2VoiceCallback	callback;
+	IXAudio2*				xaudio2;
+	IXAudio2MasteringVoice*	master;
+	IXAudio2SourceVoice*	source;
+	SoundSinkPullFunc		pull;
+	volatile LONG			isStopping;		// no more buffers are submitted once set
+	int16_t					buffers[SOUND_SINK_XAUDIO2_BUFFERS][SOUND_SINK_XAUDIO2_FRAMES * 2];
+} SoundSinkXAudio2;
+
+static bool _soundSinkXAudio2Start(SoundSink* sink, uint32_t sampleRate, SoundSinkPullFunc pull);
+static void _soundSinkXAudio2Stop(SoundSink* sink);
+static void _soundSinkXAudio2Destroy(SoundSink* sink);
+static void _soundSinkXAudio2Submit(SoundSinkXAudio2* xaudio2, uint32_t buffer);
+static void STDMETHODCALLTYPE _soundSinkXAudio2OnBufferEnd(IXAudio2VoiceCallback* callback, void* bufferContext);
+static void STDMETHODCALLTYPE _soundSinkXAudio2OnPassStart(IXAudio2VoiceCallback* callback, UINT32 bytesRequired);
+static void STDMETHODCALLTYPE _soundSinkXAudio2OnVoiceEvent(IXAudio2VoiceCallback* callback);
+static void STDMETHODCALLTYPE _soundSinkXAudio2OnBufferEvent(IXAudio2VoiceCallback* callback, void* bufferContext);
+static void STDMETHODCALLTYPE _soundSinkXAudio2OnVoiceError(IXAudio2VoiceCallback* callback, void* bufferContext, HRESULT error);
+
+static const IXAudio2VoiceCallbackVtbl SOUND_SINK_XAUDIO2_CALLBACKS = {
+	.OnVoiceProcessingPassStart = _soundSinkXAudio2OnPassStart,
+	.OnVoiceProcessingPassEnd = _soundSinkXAudio2OnVoiceEvent,
+	.OnStreamEnd = _soundSinkXAudio2OnVoiceEvent,
+	.OnBufferStart = _soundSinkXAudio2OnBufferEvent,
+	.OnBufferEnd = _soundSinkXAudio2OnBufferEnd,
+	.OnLoopEnd = _soundSinkXAudio2OnBufferEvent,
+	.OnVoiceError = _soundSinkXAudio2OnVoiceError
+};
+
+/// @brief A sink that plays the mix on the default audio device
+/// @return
+SoundSink* soundSinkNewXAudio2()
+{
+	SoundSinkXAudio2* xaudio2 = (SoundSinkXAudio2*)malloc(sizeof(SoundSinkXAudio2));
+	if (xaudio2 != NULL)
+	{
+		ZeroMemory(xaudio2, sizeof(SoundSinkXAudio2));
+		xaudio2->sink.start = _soundSinkXAudio2Start;
+		xaudio2->sink.write = NULL;
+		xaudio2->sink.stop = _soundSinkXAudio2Stop;
+		xaudio2->sink.destroy = _soundSinkXAudio2Destroy;
+		xaudio2->callback.lpVtbl = (IXAudio2VoiceCallbackVtbl*)&SOUND_SINK_XAUDIO2_CALLBACKS;
+	}
+	return (SoundSink*)xaudio2;
+}
+
+/// @brief Opens the device, queues the first few buffers of the mix, and starts playing them
+/// @return false if there's no device, or it won't take 16 bit stereo at the sample rate
+static bool _soundSinkXAudio2Start(SoundSink* sink, uint32_t sampleRate, SoundSinkPullFunc pull)
+{
+	SoundSinkXAudio2* xaudio2 = (SoundSinkXAudio2*)sink;
+	xaudio2->pull = pull;
+	xaudio2->isStopping = 0;
+
+	HRESULT hr = CoInitializeEx(NULL, COINIT_MULTITHREADED);
+	if (FAILED(hr)) {
+		return false;
+	}
+
+	hr = XAudio2Create(&xaudio2->xaudio2, 0, XAUDIO2_DEFAULT_PROCESSOR);
+	if (FAILED(hr)) {
+		xaudio2->xaudio2 = NULL;
+		return false;
+	}
+
+	hr = IXAudio2_CreateMasteringVoice(xaudio2->xaudio2, &xaudio2->master,
+		XAUDIO2_DEFAULT_CHANNELS,
+		XAUDIO2_DEFAULT_SAMPLERATE,
+		0,
+		NULL,
+		NULL,
+		AudioCategory_GameEffects
+	);
+	if (FAILED(hr)) {
+		xaudio2->master = NULL;
+		_soundSinkXAudio2Stop(sink);
+		return false;
+	}
+
+	WAVEFORMATEX wfx;
+	ZeroMemory(&wfx, sizeof(WAVEFORMATEX));
+	wfx.wFormatTag = WAVE_FORMAT_PCM;
+	wfx.nChannels = 2;
+	wfx.nSamplesPerSec = sampleRate;
+	wfx.wBitsPerSample = 16;
+	wfx.nBlockAlign = wfx.nChannels * wfx.wBitsPerSample / 8;
+	wfx.nAvgBytesPerSec = wfx.nSamplesPerSec * wfx.nBlockAlign;
+
+	hr = IXAudio2_CreateSourceVoice(xaudio2->xaudio2, &xaudio2->source, &wfx,
+		0,
+		XAUDIO2_DEFAULT_FREQ_RATIO,
+		&xaudio2->callback,
+		NULL,
+		NULL);
+	if (FAILED(hr)) {
+		xaudio2->source = NULL;
+		_soundSinkXAudio2Stop(sink);
+		return false;
+	}
+
+	for (uint32_t i = 0; i < SOUND_SINK_XAUDIO2_BUFFERS; ++i)
+	{
+		_soundSinkXAudio2Submit(xaudio2, i);
+	}
+	IXAudio2SourceVoice_Start(xaudio2->source, 0, XAUDIO2_COMMIT_NOW);
+	return true;
+}
+
+/// @brief Stops pulling from the mixer, and closes the device. Once this returns, the mixer isn't called again.
+static void _soundSinkXAudio2Stop(SoundSink* sink)
+{
+	SoundSinkXAudio2* xaudio2 = (SoundSinkXAudio2*)sink;
+	InterlockedExchange(&xaudio2->isStopping, 1);
+
+	// Destroying a voice waits for XAudio2 to be done w/ it, callbacks included
+	if (xaudio2->source != NULL)
+	{
+		IXAudio2SourceVoice_Stop(xaudio2->source, 0, XAUDIO2_COMMIT_NOW);
+		IXAudio2SourceVoice_DestroyVoice(xaudio2->source);
+		xaudio2->source = NULL;
+	}
+	if (xaudio2->master != NULL)
+	{
+		IXAudio2MasteringVoice_DestroyVoice(xaudio2->master);
+		xaudio2->master = NULL;
+	}
+	if (xaudio2->xaudio2 != NULL)
+	{
+		IXAudio2_Release(xaudio2->xaudio2);
+		xaudio2->xaudio2 = NULL;
+	}
+}
+
+/// @brief Frees the sink, once stopped
+static void _soundSinkXAudio2Destroy(SoundSink* sink)
+{
+	free(sink);
+}
+
+/// @brief Mixes the next stretch of audio into a buffer, and queues it
+/// @param xaudio2
+/// @param buffer index, which is handed back when the voice is done w/ it
+static void _soundSinkXAudio2Submit(SoundSinkXAudio2* xaudio2, uint32_t buffer)
+{
+	xaudio2->pull(xaudio2->buffers[buffer], SOUND_SINK_XAUDIO2_FRAMES);
+
+	XAUDIO2_BUFFER submit;
+	ZeroMemory(&submit, sizeof(XAUDIO2_BUFFER));
+	submit.AudioBytes = sizeof(xaudio2->buffers[buffer]);
+	submit.pAudioData = (const BYTE*)xaudio2->buffers[buffer];
+	submit.pContext = (void*)(INT_PTR)buffer;
+	IXAudio2SourceVoice_SubmitSourceBuffer(xaudio2->source, &submit, NULL);
+}
+
+/// @brief Refills a buffer as soon as the voice is done w/ it. Called on XAudio2's thread.
+static void STDMETHODCALLTYPE _soundSinkXAudio2OnBufferEnd(IXAudio2VoiceCallback* callback, void* bufferContext)
+{
+	SoundSinkXAudio2* xaudio2 = CONTAINING_RECORD(callback, SoundSinkXAudio2, callback);
+	if (InterlockedCompareExchange(&xaudio2->isStopping, 0, 0) == 0)
+	{
+		_soundSinkXAudio2Submit(xaudio2, (uint32_t)(INT_PTR)bufferContext);
+	}
+}
+
+static void STDMETHODCALLTYPE _soundSinkXAudio2OnPassStart(IXAudio2VoiceCallback* callback, UINT32 bytesRequired) {
+}
+
+static void STDMETHODCALLTYPE _soundSinkXAudio2OnVoiceEvent(IXAudio2VoiceCallback* callback) {
+}
+
+static void STDMETHODCALLTYPE _soundSinkXAudio2OnBufferEvent(IXAudio2VoiceCallback* callback, void* bufferContext) {
+}
+
+static void STDMETHODCALLTYPE _soundSinkXAudio2OnVoiceError(IXAudio2VoiceCallback* callback, void* bufferContext, HRESULT error) {
+}
+
+#endif // !FW_HEADLESS
@@ -0,0 +1,196 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "wav.h"
+
+#define WAV_MIN_FORMAT_BYTES	16		// a PCMWAVEFORMAT
+#define WAV_EXTENSIBLE_BYTES	40		// a WAVEFORMATEXTENSIBLE, whose sub format's first two bytes are the real format tag
+
+#define WAV_FORMAT_PCM			0x0001
+#define WAV_FORMAT_FLOAT		0x0003
+#define WAV_FORMAT_EXTENSIBLE	0xFFFE
+
+static uint16_t _wavReadU16(const uint8_t* bytes);
+static uint32_t _wavReadU32(const uint8_t* bytes);
+
+/// @brief Finds the format and sample chunks of a RIFF WAVE file
+/// @param file the whole file
+/// @param fileBytes
+/// @param info receives pointers into the file, which stay valid as long as it does
+/// @return false if the file isn't a WAVE file, or is missing either chunk
+bool wavParse(const void* file, size_t fileBytes, WavInfo* info)
+{
+	const uint8_t* bytes = (const uint8_t*)file;
+	memset(info, 0, sizeof(WavInfo));
+	if (fileBytes < 12 || memcmp(bytes, "RIFF", 4) != 0 || memcmp(bytes + 8, "WAVE", 4) != 0)
+	{
+		return false;
+	}
+
+	size_t offset = 12;
+	while (offset + 8 <= fileBytes)
+	{
+		const uint8_t* chunk = bytes + offset + 8;
+		uint32_t chunkBytes = _wavReadU32(bytes + offset + 4);
+		if (chunkBytes > fileBytes - offset - 8)
+		{
+			// Truncated: take what's there
+			chunkBytes = (uint32_t)(fileBytes - offset - 8);
+		}
+
+		if (memcmp(bytes + offset, "fmt ", 4) == 0)
+		{
+			info->format = chunk;
+			info->formatBytes = chunkBytes;
+		}
+		else if (memcmp(bytes + offset, "data", 4) == 0)
+		{
+			info->samples = chunk;
+			info->sampleBytes = chunkBytes;
+		}
+
+		// Chunks are padded to an even size
+		offset += 8 + (size_t)chunkBytes + (chunkBytes & 1);
+	}
+
+	return info->format != NULL && info->formatBytes >= WAV_MIN_FORMAT_BYTES && info->samples != NULL;
+}
+
+/// @brief Reads a whole WAV file, in one go, and finds its chunks
+/// @param path
+/// @param info receives pointers into the file
+/// @return the file, to be freed by the caller once done w/ info, or NULL if it can't be read or isn't a WAV file
+void* wavLoad(const char* path, WavInfo* info)
+{
+	memset(info, 0, sizeof(WavInfo));
+	FILE* file = fopen(path, "rb");
+	if (file == NULL)
+	{
+		return NULL;
+	}
+
+	void* data = NULL;
+	long fileBytes = -1;
+	if (fseek(file, 0, SEEK_END) == 0 && (fileBytes = ftell(file)) > 0 && fseek(file, 0, SEEK_SET) == 0)
+	{
+		data = malloc((size_t)fileBytes);
+	}
+
+	if (data != NULL && (fread(data, 1, (size_t)fileBytes, file) != (size_t)fileBytes || !wavParse(data, (size_t)fileBytes, info)))
+	{
+		memset(info, 0, sizeof(WavInfo));
+		free(data);
+		data = NULL;
+	}
+
+	fclose(file);
+	return data;
+}
+
+/// @brief Reads a WAV file's chunks up to the start of its samples, but not the samples, for streaming them
+/// @param path
+/// @param info receives the format, and how many bytes of samples there are; the samples pointer is left NULL
+/// @param dataOffset receives where the samples start in the file
+/// @return the fmt chunk, to be freed by the caller once done w/ info, or NULL if the file can't be read or isn't a WAV file
+void* wavLoadHeader(const char* path, WavInfo* info, uint32_t* dataOffset)
+{
+	memset(info, 0, sizeof(WavInfo));
+	FILE* file = fopen(path, "rb");
+	if (file == NULL)
+	{
+		return NULL;
+	}
+
+	void* format = NULL;
+	bool isFound = false;
+	uint8_t bytes[12];
+	if (fread(bytes, 1, 12, file) == 12 && memcmp(bytes, "RIFF", 4) == 0 && memcmp(bytes + 8, "WAVE", 4) == 0)
+	{
+		while (!isFound && fread(bytes, 1, 8, file) == 8)
+		{
+			const uint32_t chunkBytes = _wavReadU32(bytes + 4);
+			if (memcmp(bytes, "data", 4) == 0)
+			{
+				*dataOffset = (uint32_t)ftell(file);
+				info->sampleBytes = chunkBytes;
+				isFound = true;
+			}
+			else if (memcmp(bytes, "fmt ", 4) == 0 && format == NULL)
+			{
+				format = malloc(chunkBytes);
+				if (format == NULL || fread(format, 1, chunkBytes, file) != chunkBytes || fseek(file, chunkBytes & 1, SEEK_CUR) != 0)
+				{
+					break;
+				}
+				info->format = format;
+				info->formatBytes = chunkBytes;
+			}
+			else if (fseek(file, (long)chunkBytes + (chunkBytes & 1), SEEK_CUR) != 0)
+			{
+				break;
+			}
+		}
+	}
+	fclose(file);
+
+	if (!isFound || info->format == NULL || info->formatBytes < WAV_MIN_FORMAT_BYTES)
+	{
+		memset(info, 0, sizeof(WavInfo));
+		free(format);
+		return NULL;
+	}
+	return format;
+}
+
+/// @brief Decodes a clip's fmt chunk
+/// @param info
+/// @param format receives the encoding, and how many frames the data chunk holds (a trailing partial frame doesn't count)
+/// @return false if the samples are in an encoding other than 8 or 16 bit PCM, or 32 bit float
+bool wavGetFormat(const WavInfo* info, WavFormat* format)
+{
+	const uint8_t* bytes = (const uint8_t*)info->format;
+	memset(format, 0, sizeof(WavFormat));
+	if (bytes == NULL || info->formatBytes < WAV_MIN_FORMAT_BYTES)
+	{
+		return false;
+	}
+
+	uint16_t tag = _wavReadU16(bytes);
+	if (tag == WAV_FORMAT_EXTENSIBLE)
+	{
+		if (info->formatBytes < WAV_EXTENSIBLE_BYTES)
+		{
+			return false;
+		}
+		tag = _wavReadU16(bytes + 24);
+	}
+	const uint16_t bitsPerSample = _wavReadU16(bytes + 14);
+
+	if (tag == WAV_FORMAT_PCM && bitsPerSample == 8) { format->encoding = WAV_ENCODING_PCM8; }
+	else if (tag == WAV_FORMAT_PCM && bitsPerSample == 16) { format->encoding = WAV_ENCODING_PCM16; }
+	else if (tag == WAV_FORMAT_FLOAT && bitsPerSample == 32) { format->encoding = WAV_ENCODING_FLOAT32; }
+	else { return false; }
+
+	format->numChannels = _wavReadU16(bytes + 2);
+	format->sampleRate = _wavReadU32(bytes + 4);
+	format->frameBytes = (uint16_t)(format->numChannels * (bitsPerSample / 8));
+	if (format->numChannels == 0 || format->sampleRate == 0)
+	{
+		return false;
+	}
+	format->numFrames = info->sampleBytes / format->frameBytes;
+	return true;
+}
+
+/// @brief Little endian, like _wavReadU32
+static uint16_t _wavReadU16(const uint8_t* bytes)
+{
+	return (uint16_t)(bytes[0] | (bytes[1] << 8));
+}
+
+/// @brief RIFF is little endian, whatever the host is
+static uint32_t _wavReadU32(const uint8_t* bytes)
+{
+	return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}